@@ -250,6 +250,11 @@ def libuv_libs
   template.render_to('src/cxx_supportlib/Constants.h')
 end
 
+file 'src/cxx_supportlib/ServerKit/KnownHeaders.h' => 'src/cxx_supportlib/ServerKit/KnownHeaders.h.cxxcodebuilder' do
+  template = CxxCodeTemplateRenderer.new('src/cxx_supportlib/ServerKit/KnownHeaders.h.cxxcodebuilder')
+  template.render_to('src/cxx_supportlib/ServerKit/KnownHeaders.h')
+end
+
 
 ##############################
 
@@ -46,6 +46,14 @@
     "test/cxx/Core/UnionStationTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/Core/ResponseCacheTest.o" =>
     "test/cxx/Core/ResponseCacheTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Core/AccessLogTest.o" =>
+    "test/cxx/Core/AccessLogTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Core/ResponseCompressionTest.o" =>
+    "test/cxx/Core/ResponseCompressionTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Core/StaticFileCacheTest.o" =>
+    "test/cxx/Core/StaticFileCacheTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Core/CgiHeaderNameCacheTest.o" =>
+    "test/cxx/Core/CgiHeaderNameCacheTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/Core/SecurityUpdateCheckerTest.o" =>
       "test/cxx/Core/SecurityUpdateCheckerTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/Core/ControllerTest.o" =>
@@ -58,15 +66,25 @@
     "test/cxx/ServerKit/ChannelTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ServerKit/FileBufferedChannelTest.o" =>
     "test/cxx/ServerKit/FileBufferedChannelTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/ServerKit/FdSourceChannelTest.o" =>
+    "test/cxx/ServerKit/FdSourceChannelTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ServerKit/HeaderTableTest.o" =>
     "test/cxx/ServerKit/HeaderTableTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/ServerKit/HttpHeaderParserTest.o" =>
+    "test/cxx/ServerKit/HttpHeaderParserTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ServerKit/ServerTest.o" =>
     "test/cxx/ServerKit/ServerTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ServerKit/HttpServerTest.o" =>
     "test/cxx/ServerKit/HttpServerTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/ServerKit/TimerWheelTest.o" =>
+    "test/cxx/ServerKit/TimerWheelTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/ServerKit/CookieUtilsTest.o" =>
     "test/cxx/ServerKit/CookieUtilsTest.cpp",
 
+  "#{TEST_OUTPUT_DIR}cxx/Algorithms/ConcurrencyLimiterTest.o" =>
+    "test/cxx/Algorithms/ConcurrencyLimiterTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Algorithms/HistogramTest.o" =>
+    "test/cxx/Algorithms/HistogramTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/MemoryKit/MbufTest.o" =>
     "test/cxx/MemoryKit/MbufTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/MemoryKit/PallocTest.o" =>
@@ -85,6 +103,10 @@
     "test/cxx/FileDescriptorTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/SystemTimeTest.o" =>
     "test/cxx/SystemTimeTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/LoggingTest.o" =>
+    "test/cxx/LoggingTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/SafeLibevTest.o" =>
+    "test/cxx/SafeLibevTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/FilterSupportTest.o" =>
     "test/cxx/FilterSupportTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/CachedFileStatTest.o" =>
@@ -107,6 +129,10 @@
     "test/cxx/UtilsTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/Utils/StrIntUtilsTest.o" =>
     "test/cxx/Utils/StrIntUtilsTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Utils/MetricsRegistryTest.o" =>
+    "test/cxx/Utils/MetricsRegistryTest.cpp",
+  "#{TEST_OUTPUT_DIR}cxx/Utils/HasherTest.o" =>
+    "test/cxx/Utils/HasherTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/IOUtilsTest.o" =>
     "test/cxx/IOUtilsTest.cpp",
   "#{TEST_OUTPUT_DIR}cxx/TemplateTest.o" =>
@@ -3,7 +3,8 @@
 {"src/agent/AgentMain.cpp"=>
   ["src/cxx_supportlib/Constants.h"],
  "src/agent/Core/ApiServer.h"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -17,10 +18,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -32,6 +35,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -76,7 +80,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -85,6 +91,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -97,6 +104,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -167,6 +175,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -227,6 +236,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -274,6 +284,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -328,6 +339,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -370,6 +382,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -436,6 +449,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -515,6 +529,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -594,6 +609,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -673,6 +689,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -752,6 +769,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -832,6 +850,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -911,6 +930,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -990,6 +1010,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1069,6 +1090,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1148,6 +1170,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1227,6 +1250,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1329,6 +1353,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1340,6 +1365,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1383,6 +1409,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1451,6 +1478,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1462,6 +1490,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1536,6 +1565,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1547,6 +1577,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1621,6 +1652,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1632,6 +1664,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1706,6 +1739,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1717,6 +1751,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1791,6 +1826,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1802,6 +1838,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1876,6 +1913,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1887,6 +1925,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -1961,6 +2000,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -1972,6 +2012,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2046,6 +2087,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2057,6 +2099,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2131,6 +2174,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2142,6 +2186,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2210,6 +2255,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2284,6 +2330,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2333,6 +2380,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2377,7 +2425,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller.h"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -2390,10 +2439,12 @@
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -2405,6 +2456,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -2448,7 +2500,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -2457,6 +2511,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2469,6 +2524,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2519,6 +2575,8 @@
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
@@ -2543,7 +2601,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/BufferBody.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -2557,10 +2616,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -2572,6 +2633,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -2615,7 +2677,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -2624,6 +2688,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2636,6 +2701,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2665,8 +2731,20 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/Controller/CgiHeaderNameCache.h"=>
+  ["src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp"],
  "src/agent/Core/Controller/CheckoutSession.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -2680,10 +2758,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -2695,6 +2775,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -2738,7 +2819,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -2747,6 +2830,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2759,6 +2843,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2802,6 +2887,7 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller/AppResponse.h",
    "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -2813,6 +2899,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -2847,6 +2934,8 @@
    "src/cxx_supportlib/ServerKit/HttpClient.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -2854,6 +2943,8 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2865,6 +2956,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -2894,7 +2986,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/ForwardResponse.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -2908,10 +3001,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -2923,6 +3018,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -2966,7 +3062,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -2975,6 +3073,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -2987,6 +3086,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3017,7 +3117,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/Hooks.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3031,10 +3132,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3046,6 +3149,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3089,7 +3193,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3098,6 +3204,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3110,6 +3217,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3140,7 +3248,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/Implementation.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3155,6 +3264,7 @@
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
    "src/agent/Core/Controller/BufferBody.cpp",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/CheckoutSession.cpp",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/ForwardResponse.cpp",
@@ -3165,9 +3275,11 @@
    "src/agent/Core/Controller/Miscellaneous.cpp",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/SendRequest.cpp",
+   "src/agent/Core/Controller/ServeStaticFile.cpp",
    "src/agent/Core/Controller/StateInspectionAndConfiguration.cpp",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3179,6 +3291,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3222,7 +3335,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3231,6 +3346,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3243,6 +3359,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3273,7 +3390,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/InitRequest.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3287,10 +3405,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3302,6 +3422,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3345,7 +3466,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3354,6 +3477,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3366,6 +3490,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3396,7 +3521,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/InitializationAndShutdown.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3410,10 +3536,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3425,6 +3553,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3468,7 +3597,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3477,6 +3608,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3489,6 +3621,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3519,7 +3652,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/InternalUtils.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3533,10 +3667,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3548,6 +3684,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3591,7 +3728,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3600,6 +3739,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3612,6 +3752,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3642,7 +3783,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/Miscellaneous.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3656,10 +3798,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3671,6 +3815,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3714,7 +3859,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3723,6 +3870,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3735,6 +3883,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3777,6 +3926,7 @@
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3788,6 +3938,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -3821,6 +3972,8 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3828,6 +3981,8 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3839,6 +3994,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3868,7 +4024,139 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/SendRequest.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/ErrorRenderer.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
+   "src/agent/Core/Controller/Client.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
+   "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Options.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
+   "src/agent/Core/UnionStation/Connection.h",
+   "src/agent/Core/UnionStation/Context.h",
+   "src/agent/Core/UnionStation/StopwatchLog.h",
+   "src/agent/Core/UnionStation/Transaction.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
+   "src/cxx_supportlib/AppTypes.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/MessageReadersWriters.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/ClientRef.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParser.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpClient.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParser.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
+   "src/cxx_supportlib/ServerKit/http_parser.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
+   "src/cxx_supportlib/Utils/BufferedIO.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HashMap.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/HttpConstants.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/JsonUtils.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MemZeroGuard.h",
+   "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
+   "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/StringMap.h",
+   "src/cxx_supportlib/Utils/StringScanning.h",
+   "src/cxx_supportlib/Utils/SystemMetricsCollector.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/Utils/Template.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../macros.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/agent/Core/Controller/ServeStaticFile.cpp"=>
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -3882,10 +4170,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -3897,11 +4187,14 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
    "src/agent/Core/UnionStation/Transaction.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/ConcurrencyLimiter.h",
+   "src/cxx_supportlib/Algorithms/Histogram.h",
    "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppTypes.h",
    "src/cxx_supportlib/Constants.h",
@@ -3940,7 +4233,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -3949,6 +4244,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -3961,6 +4257,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -3991,7 +4288,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/Controller/StateInspectionAndConfiguration.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -4005,10 +4303,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -4020,6 +4320,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -4063,7 +4364,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -4072,6 +4375,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4084,6 +4388,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -4126,6 +4431,8 @@
    "src/cxx_supportlib/SafeLibev.h",
    "src/cxx_supportlib/ServerKit/Context.h",
    "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
@@ -4151,7 +4458,8 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/CoreMain.cpp"=>
-  ["src/agent/Core/ApiServer.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApiServer.h",
    "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
@@ -4166,11 +4474,13 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/OptionParser.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SecurityUpdateChecker.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
@@ -4183,6 +4493,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -4232,7 +4543,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -4242,6 +4555,7 @@
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/Curl.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4254,6 +4568,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/OptionParsing.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
@@ -4312,11 +4627,14 @@
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/agent/Core/ResponseCache.h"=>
-  ["src/cxx_supportlib/DataStructures/HashedStaticString.h",
+  ["src/agent/Core/ResponseCompression.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/MemoryKit/mbuf.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
    "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
@@ -4422,6 +4740,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4472,6 +4791,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4527,6 +4847,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4569,6 +4890,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4664,6 +4986,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4713,6 +5036,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4756,6 +5080,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4931,7 +5256,9 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/HeaderTable.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -4939,6 +5266,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -4950,6 +5278,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -5162,7 +5491,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/UnionStationFilterSupport.h",
@@ -5173,6 +5504,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/Curl.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -5185,6 +5517,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ReleaseableScopedPointer.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
@@ -5236,6 +5569,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -5288,6 +5622,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/UnionStationFilterSupport.h",
@@ -5562,7 +5897,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/UnionStationFilterSupport.h",
@@ -5573,6 +5910,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/Curl.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -5585,6 +5923,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/OptionParsing.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ReleaseableScopedPointer.h",
@@ -5681,7 +6020,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -5689,6 +6030,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -5701,6 +6043,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -5809,7 +6152,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -5817,6 +6162,7 @@
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -5829,6 +6175,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/OptionParsing.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
@@ -5891,6 +6238,7 @@
    "src/apache2_module/ConfigurationCommands.cpp",
    "src/apache2_module/ConfigurationFields.hpp",
    "src/apache2_module/ConfigurationSetters.cpp",
+   "src/apache2_module/CoreConnectionPool.h",
    "src/apache2_module/CreateDirConfig.cpp",
    "src/apache2_module/MergeDirConfig.cpp",
    "src/cxx_supportlib/Constants.h",
@@ -5925,6 +6273,7 @@
  "src/apache2_module/Configuration.hpp"=>
   ["src/apache2_module/Configuration.h",
    "src/apache2_module/ConfigurationFields.hpp",
+   "src/apache2_module/CoreConnectionPool.h",
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
@@ -5956,12 +6305,26 @@
   [],
  "src/apache2_module/ConfigurationSetters.cpp"=>
   [],
+ "src/apache2_module/CoreConnectionPool.h"=>
+  ["src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp"],
  "src/apache2_module/CreateDirConfig.cpp"=>
   [],
  "src/apache2_module/DirectoryMapper.h"=>
   ["src/apache2_module/Configuration.h",
    "src/apache2_module/Configuration.hpp",
    "src/apache2_module/ConfigurationFields.hpp",
+   "src/apache2_module/CoreConnectionPool.h",
    "src/cxx_supportlib/AppTypes.h",
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/Exceptions.h",
@@ -5970,6 +6333,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/IOUtils.h",
@@ -5997,6 +6361,7 @@
    "src/apache2_module/Configuration.h",
    "src/apache2_module/Configuration.hpp",
    "src/apache2_module/ConfigurationFields.hpp",
+   "src/apache2_module/CoreConnectionPool.h",
    "src/apache2_module/DirectoryMapper.h",
    "src/apache2_module/Hooks.h",
    "src/apache2_module/SetHeaders.cpp",
@@ -6011,6 +6376,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/HttpConstants.h",
@@ -6057,6 +6423,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -6080,6 +6447,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -6419,6 +6787,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
@@ -6618,6 +6987,7 @@
    "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/MemoryKit/mbuf.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/Hasher.h",
    "src/cxx_supportlib/Utils/StrIntUtils.h",
@@ -6655,6 +7025,8 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
@@ -6700,6 +7072,8 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
@@ -6755,6 +7129,8 @@
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
@@ -6809,7 +7185,9 @@
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -6841,6 +7219,11 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/Hasher.h",
    "src/cxx_supportlib/oxt/macros.hpp"],
+ "src/cxx_supportlib/ServerKit/KnownHeaders.h"=>
+  ["src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/oxt/macros.hpp"],
  "src/cxx_supportlib/ServerKit/Server.h"=>
   ["src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/Constants.h",
@@ -6858,6 +7241,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -6882,6 +7266,8 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/cxx_supportlib/ServerKit/TimerWheel.h"=>
+  ["src/cxx_supportlib/oxt/macros.hpp"],
  "src/cxx_supportlib/ServerKit/http_parser.cpp"=>
   ["src/cxx_supportlib/ServerKit/http_parser.h"],
  "src/cxx_supportlib/ServerKit/http_parser.h"=>
@@ -6916,6 +7302,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/IOUtils.h",
@@ -6964,6 +7351,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/CachedFileStat.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/StringMap.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
@@ -7007,6 +7395,7 @@
   ["src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/StringMap.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
@@ -7141,6 +7530,9 @@
    "src/cxx_supportlib/oxt/system_calls.hpp",
    "src/cxx_supportlib/oxt/thread.hpp",
    "src/cxx_supportlib/oxt/tracable_exception.hpp"],
+ "src/cxx_supportlib/Utils/MetricsRegistry.h"=>
+  ["src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/oxt/macros.hpp"],
  "src/cxx_supportlib/Utils/OptionParsing.h"=>
   [],
  "src/cxx_supportlib/Utils/ProcessMetricsCollector.h"=>
@@ -7427,6 +7819,7 @@
    "src/cxx_supportlib/UnionStationFilterSupport.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -7464,6 +7857,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -7492,6 +7886,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -7527,6 +7922,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
@@ -7560,6 +7956,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/IOUtils.h",
@@ -7655,6 +8052,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/IOUtils.h",
@@ -7673,16 +8071,22 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
- "test/cxx/Core/ApplicationPool/OptionsTest.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+ "test/cxx/Core/AccessLogTest.cpp"=>
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
    "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
    "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -7694,28 +8098,54 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
+   "src/agent/Core/UnionStation/StopwatchLog.h",
    "src/agent/Core/UnionStation/Transaction.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/AppTypes.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Hooks.h",
    "src/cxx_supportlib/InstanceDirectory.h",
    "src/cxx_supportlib/Logging.h",
    "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
    "src/cxx_supportlib/RandomGenerator.h",
    "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
+   "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -7726,11 +8156,15 @@
    "src/cxx_supportlib/Utils/Lock.h",
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
    "src/cxx_supportlib/Utils/StrIntUtils.h",
    "src/cxx_supportlib/Utils/StringMap.h",
    "src/cxx_supportlib/Utils/StringScanning.h",
+   "src/cxx_supportlib/Utils/SystemMetricsCollector.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
    "src/cxx_supportlib/Utils/Timer.h",
    "src/cxx_supportlib/Utils/VariantMap.h",
@@ -7746,6 +8180,7 @@
    "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
    "src/cxx_supportlib/oxt/macros.hpp",
    "src/cxx_supportlib/oxt/spin_lock.hpp",
    "src/cxx_supportlib/oxt/system_calls.hpp",
@@ -7753,15 +8188,13 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
- "test/cxx/Core/ApplicationPool/PoolTest.cpp"=>
+ "test/cxx/Core/ApplicationPool/OptionsTest.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
    "src/agent/Core/ApplicationPool/Context.h",
-   "src/agent/Core/ApplicationPool/Group.h",
    "src/agent/Core/ApplicationPool/Options.h",
-   "src/agent/Core/ApplicationPool/Pool.h",
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
@@ -7778,7 +8211,6 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
-   "src/agent/Core/UnionStation/StopwatchLog.h",
    "src/agent/Core/UnionStation/Transaction.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/AppTypes.h",
@@ -7788,20 +8220,18 @@
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
-   "src/cxx_supportlib/Hooks.h",
    "src/cxx_supportlib/InstanceDirectory.h",
    "src/cxx_supportlib/Logging.h",
    "src/cxx_supportlib/LveLoggingDecorator.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
-   "src/cxx_supportlib/MessageReadersWriters.h",
    "src/cxx_supportlib/RandomGenerator.h",
    "src/cxx_supportlib/ResourceLocator.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
-   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -7812,14 +8242,11 @@
    "src/cxx_supportlib/Utils/Lock.h",
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
-   "src/cxx_supportlib/Utils/MessagePassing.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
-   "src/cxx_supportlib/Utils/SpeedMeter.h",
    "src/cxx_supportlib/Utils/StrIntUtils.h",
    "src/cxx_supportlib/Utils/StringMap.h",
    "src/cxx_supportlib/Utils/StringScanning.h",
-   "src/cxx_supportlib/Utils/SystemMetricsCollector.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
    "src/cxx_supportlib/Utils/Timer.h",
    "src/cxx_supportlib/Utils/VariantMap.h",
@@ -7835,7 +8262,6 @@
    "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
-   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
    "src/cxx_supportlib/oxt/macros.hpp",
    "src/cxx_supportlib/oxt/spin_lock.hpp",
    "src/cxx_supportlib/oxt/system_calls.hpp",
@@ -7843,13 +8269,15 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
- "test/cxx/Core/ApplicationPool/ProcessTest.cpp"=>
+ "test/cxx/Core/ApplicationPool/PoolTest.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
    "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
    "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
@@ -7866,6 +8294,7 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
+   "src/agent/Core/UnionStation/StopwatchLog.h",
    "src/agent/Core/UnionStation/Transaction.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
    "src/cxx_supportlib/AppTypes.h",
@@ -7875,17 +8304,21 @@
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Hooks.h",
    "src/cxx_supportlib/InstanceDirectory.h",
    "src/cxx_supportlib/Logging.h",
    "src/cxx_supportlib/LveLoggingDecorator.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/MessageReadersWriters.h",
    "src/cxx_supportlib/RandomGenerator.h",
    "src/cxx_supportlib/ResourceLocator.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -7896,11 +8329,15 @@
    "src/cxx_supportlib/Utils/Lock.h",
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
    "src/cxx_supportlib/Utils/StrIntUtils.h",
    "src/cxx_supportlib/Utils/StringMap.h",
    "src/cxx_supportlib/Utils/StringScanning.h",
+   "src/cxx_supportlib/Utils/SystemMetricsCollector.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
    "src/cxx_supportlib/Utils/Timer.h",
    "src/cxx_supportlib/Utils/VariantMap.h",
@@ -7916,6 +8353,7 @@
    "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
    "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
    "src/cxx_supportlib/oxt/macros.hpp",
    "src/cxx_supportlib/oxt/spin_lock.hpp",
    "src/cxx_supportlib/oxt/system_calls.hpp",
@@ -7923,26 +8361,16 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
- "test/cxx/Core/ControllerTest.cpp"=>
+ "test/cxx/Core/ApplicationPool/ProcessTest.cpp"=>
   ["src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
    "src/agent/Core/ApplicationPool/Context.h",
-   "src/agent/Core/ApplicationPool/ErrorRenderer.h",
-   "src/agent/Core/ApplicationPool/Group.h",
    "src/agent/Core/ApplicationPool/Options.h",
-   "src/agent/Core/ApplicationPool/Pool.h",
    "src/agent/Core/ApplicationPool/Process.h",
    "src/agent/Core/ApplicationPool/Session.h",
    "src/agent/Core/ApplicationPool/Socket.h",
-   "src/agent/Core/ApplicationPool/TestSession.h",
-   "src/agent/Core/Controller.h",
-   "src/agent/Core/Controller/AppResponse.h",
-   "src/agent/Core/Controller/Client.h",
-   "src/agent/Core/Controller/Request.h",
-   "src/agent/Core/Controller/TurboCaching.h",
-   "src/agent/Core/ResponseCache.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -7956,24 +8384,155 @@
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
-   "src/agent/Core/UnionStation/StopwatchLog.h",
    "src/agent/Core/UnionStation/Transaction.h",
    "src/agent/Shared/ApplicationPoolApiKey.h",
-   "src/cxx_supportlib/Algorithms/MovingAverage.h",
    "src/cxx_supportlib/AppTypes.h",
    "src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
    "src/cxx_supportlib/DataStructures/HashedStaticString.h",
-   "src/cxx_supportlib/DataStructures/LString.h",
    "src/cxx_supportlib/DataStructures/StringKeyTable.h",
    "src/cxx_supportlib/Exceptions.h",
    "src/cxx_supportlib/FileDescriptor.h",
-   "src/cxx_supportlib/Hooks.h",
    "src/cxx_supportlib/InstanceDirectory.h",
-   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
    "src/cxx_supportlib/Logging.h",
    "src/cxx_supportlib/LveLoggingDecorator.h",
-   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/BufferedIO.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HashMap.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/JsonUtils.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MemZeroGuard.h",
+   "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/StringMap.h",
+   "src/cxx_supportlib/Utils/StringScanning.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../macros.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
+ "test/cxx/Core/CgiHeaderNameCacheTest.cpp"=>
+  ["src/agent/Core/Controller/CgiHeaderNameCache.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
+ "test/cxx/Core/ControllerTest.cpp"=>
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/ErrorRenderer.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/ApplicationPool/TestSession.h",
+   "src/agent/Core/Controller.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
+   "src/agent/Core/Controller/Client.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/Controller/TurboCaching.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
+   "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Options.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
+   "src/agent/Core/UnionStation/Connection.h",
+   "src/agent/Core/UnionStation/Context.h",
+   "src/agent/Core/UnionStation/StopwatchLog.h",
+   "src/agent/Core/UnionStation/Transaction.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/Algorithms/MovingAverage.h",
+   "src/cxx_supportlib/AppTypes.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Integrations/LibevJsonUtils.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
    "src/cxx_supportlib/MemoryKit/palloc.h",
    "src/cxx_supportlib/MessageReadersWriters.h",
    "src/cxx_supportlib/RandomGenerator.h",
@@ -7999,7 +8558,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -8008,6 +8569,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -8020,6 +8582,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -8052,7 +8615,8 @@
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
  "test/cxx/Core/RequestHandlerTest.cpp"=>
-  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+  ["src/agent/Core/AccessLog.h",
+   "src/agent/Core/ApplicationPool/AbstractSession.h",
    "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
    "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
    "src/agent/Core/ApplicationPool/Common.h",
@@ -8066,10 +8630,12 @@
    "src/agent/Core/ApplicationPool/Socket.h",
    "src/agent/Core/Controller.h",
    "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/CgiHeaderNameCache.h",
    "src/agent/Core/Controller/Client.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/Controller/TurboCaching.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -8081,6 +8647,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -8126,7 +8693,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -8135,6 +8704,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -8147,6 +8717,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -8193,6 +8764,124 @@
    "src/agent/Core/Controller/AppResponse.h",
    "src/agent/Core/Controller/Request.h",
    "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
+   "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
+   "src/agent/Core/SpawningKit/Config.h",
+   "src/agent/Core/SpawningKit/DirectSpawner.h",
+   "src/agent/Core/SpawningKit/DummySpawner.h",
+   "src/agent/Core/SpawningKit/Factory.h",
+   "src/agent/Core/SpawningKit/Options.h",
+   "src/agent/Core/SpawningKit/PipeWatcher.h",
+   "src/agent/Core/SpawningKit/Result.h",
+   "src/agent/Core/SpawningKit/SmartSpawner.h",
+   "src/agent/Core/SpawningKit/Spawner.h",
+   "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
+   "src/agent/Core/UnionStation/Connection.h",
+   "src/agent/Core/UnionStation/Context.h",
+   "src/agent/Core/UnionStation/StopwatchLog.h",
+   "src/agent/Core/UnionStation/Transaction.h",
+   "src/agent/Shared/ApplicationPoolApiKey.h",
+   "src/cxx_supportlib/AppTypes.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/Hooks.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/LveLoggingDecorator.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/CookieUtils.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
+   "src/cxx_supportlib/ServerKit/http_parser.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/AnsiColorConstants.h",
+   "src/cxx_supportlib/Utils/BufferedIO.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/ClassUtils.h",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/HashMap.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/JsonUtils.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/Lock.h",
+   "src/cxx_supportlib/Utils/MemZeroGuard.h",
+   "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
+   "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/SpeedMeter.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/StringMap.h",
+   "src/cxx_supportlib/Utils/StringScanning.h",
+   "src/cxx_supportlib/Utils/SystemMetricsCollector.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/Utils/Timer.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../macros.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_darwin.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_gcc_x86.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_portable.hpp",
+   "src/cxx_supportlib/oxt/detail/spin_lock_pthreads.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/dynamic_thread_group.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/spin_lock.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
+ "test/cxx/Core/ResponseCompressionTest.cpp"=>
+  ["src/agent/Core/ApplicationPool/AbstractSession.h",
+   "src/agent/Core/ApplicationPool/BasicGroupInfo.h",
+   "src/agent/Core/ApplicationPool/BasicProcessInfo.h",
+   "src/agent/Core/ApplicationPool/Common.h",
+   "src/agent/Core/ApplicationPool/Context.h",
+   "src/agent/Core/ApplicationPool/Group.h",
+   "src/agent/Core/ApplicationPool/Options.h",
+   "src/agent/Core/ApplicationPool/Pool.h",
+   "src/agent/Core/ApplicationPool/Process.h",
+   "src/agent/Core/ApplicationPool/Session.h",
+   "src/agent/Core/ApplicationPool/Socket.h",
+   "src/agent/Core/Controller/AppResponse.h",
+   "src/agent/Core/Controller/Request.h",
+   "src/agent/Core/ResponseCache.h",
+   "src/agent/Core/ResponseCompression.h",
    "src/agent/Core/SpawningKit/BackgroundIOCapturer.h",
    "src/agent/Core/SpawningKit/Config.h",
    "src/agent/Core/SpawningKit/DirectSpawner.h",
@@ -8204,6 +8893,7 @@
    "src/agent/Core/SpawningKit/SmartSpawner.h",
    "src/agent/Core/SpawningKit/Spawner.h",
    "src/agent/Core/SpawningKit/UserSwitchingRules.h",
+   "src/agent/Core/StaticFileCache.h",
    "src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
    "src/agent/Core/UnionStation/StopwatchLog.h",
@@ -8240,6 +8930,8 @@
    "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
    "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -8248,6 +8940,7 @@
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
    "src/cxx_supportlib/Utils/ClassUtils.h",
    "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -8259,6 +8952,7 @@
    "src/cxx_supportlib/Utils/MemZeroGuard.h",
    "src/cxx_supportlib/Utils/MessageIO.h",
    "src/cxx_supportlib/Utils/MessagePassing.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
    "src/cxx_supportlib/Utils/ProcessMetricsCollector.h",
    "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/SpeedMeter.h",
@@ -8349,6 +9043,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -8407,6 +9102,7 @@
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/BufferedIO.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/HashMap.h",
    "src/cxx_supportlib/Utils/Hasher.h",
@@ -8439,6 +9135,40 @@
    "test/cxx/TestSupport.h"],
  "test/cxx/Core/SpawningKit/SpawnerTestCases.cpp"=>
   [],
+ "test/cxx/Core/StaticFileCacheTest.cpp"=>
+  ["src/agent/Core/StaticFileCache.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/StringKeyTable.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DateParsing.h",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
  "test/cxx/Core/UnionStationTest.cpp"=>
   ["src/agent/Core/UnionStation/Connection.h",
    "src/agent/Core/UnionStation/Context.h",
@@ -8475,6 +9205,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/UnionStationFilterSupport.h",
@@ -8650,6 +9381,7 @@
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/CachedFileStat.hpp",
+   "src/cxx_supportlib/Utils/DirectoryWatcher.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/FileChangeChecker.h",
    "src/cxx_supportlib/Utils/HashMap.h",
@@ -8752,6 +9484,33 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
+ "test/cxx/LoggingTest.cpp"=>
+  ["src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
  "test/cxx/MemoryKit/MbufTest.cpp"=>
   ["src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
@@ -9008,6 +9767,48 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
+ "test/cxx/ServerKit/FdSourceChannelTest.cpp"=>
+  ["src/cxx_supportlib/Algorithms/Histogram.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/JsonUtils.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/MemZeroGuard.h",
+   "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
  "test/cxx/ServerKit/FileBufferedChannelTest.cpp"=>
   ["src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
@@ -9065,15 +9866,74 @@
    "src/cxx_supportlib/RandomGenerator.h",
    "src/cxx_supportlib/ResourceLocator.h",
    "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
+ "test/cxx/ServerKit/HttpHeaderParserTest.cpp"=>
+  ["src/cxx_supportlib/Algorithms/Histogram.h",
+   "src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/SafeLibev.h",
+   "src/cxx_supportlib/ServerKit/Channel.h",
+   "src/cxx_supportlib/ServerKit/Client.h",
+   "src/cxx_supportlib/ServerKit/Context.h",
+   "src/cxx_supportlib/ServerKit/Errors.h",
+   "src/cxx_supportlib/ServerKit/FdSourceChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedChannel.h",
+   "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/Hooks.h",
+   "src/cxx_supportlib/ServerKit/HttpChunkedBodyParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParser.h",
+   "src/cxx_supportlib/ServerKit/HttpHeaderParserState.h",
+   "src/cxx_supportlib/ServerKit/HttpRequest.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
+   "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
    "src/cxx_supportlib/Utils/FastStringStream.h",
    "src/cxx_supportlib/Utils/Hasher.h",
    "src/cxx_supportlib/Utils/IOUtils.h",
    "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/JsonUtils.h",
    "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/MemZeroGuard.h",
+   "src/cxx_supportlib/Utils/MessageIO.h",
+   "src/cxx_supportlib/Utils/ScopeGuard.h",
    "src/cxx_supportlib/Utils/StrIntUtils.h",
    "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/Utils/VariantMap.h",
    "src/cxx_supportlib/oxt/backtrace.hpp",
    "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
    "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
@@ -9121,7 +9981,9 @@
    "src/cxx_supportlib/ServerKit/HttpRequest.h",
    "src/cxx_supportlib/ServerKit/HttpRequestRef.h",
    "src/cxx_supportlib/ServerKit/HttpServer.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -9174,6 +10036,7 @@
    "src/cxx_supportlib/ServerKit/FileBufferedFdSinkChannel.h",
    "src/cxx_supportlib/ServerKit/Hooks.h",
    "src/cxx_supportlib/ServerKit/Server.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
    "src/cxx_supportlib/ServerKit/http_parser.h",
    "src/cxx_supportlib/StaticString.h",
    "src/cxx_supportlib/Utils.h",
@@ -9201,6 +10064,34 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
+ "test/cxx/ServerKit/TimerWheelTest.cpp"=>
+  ["src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/ServerKit/TimerWheel.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
  "test/cxx/StaticStringTest.cpp"=>
   ["src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
@@ -9412,6 +10303,71 @@
    "src/cxx_supportlib/oxt/tracable_exception.hpp",
    "test/cxx/../tut/tut.h",
    "test/cxx/TestSupport.h"],
+ "test/cxx/Utils/HasherTest.cpp"=>
+  ["src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/DataStructures/HashedStaticString.h",
+   "src/cxx_supportlib/DataStructures/LString.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/MemoryKit/mbuf.h",
+   "src/cxx_supportlib/MemoryKit/palloc.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/ServerKit/HeaderTable.h",
+   "src/cxx_supportlib/ServerKit/KnownHeaders.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/Hasher.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/backtrace.hpp",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/backtrace_enabled.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
+ "test/cxx/Utils/MetricsRegistryTest.cpp"=>
+  ["src/cxx_supportlib/BackgroundEventLoop.h",
+   "src/cxx_supportlib/Constants.h",
+   "src/cxx_supportlib/Exceptions.h",
+   "src/cxx_supportlib/FileDescriptor.h",
+   "src/cxx_supportlib/InstanceDirectory.h",
+   "src/cxx_supportlib/Logging.h",
+   "src/cxx_supportlib/RandomGenerator.h",
+   "src/cxx_supportlib/ResourceLocator.h",
+   "src/cxx_supportlib/StaticString.h",
+   "src/cxx_supportlib/Utils.h",
+   "src/cxx_supportlib/Utils/FastStringStream.h",
+   "src/cxx_supportlib/Utils/IOUtils.h",
+   "src/cxx_supportlib/Utils/IniFile.h",
+   "src/cxx_supportlib/Utils/LargeFiles.h",
+   "src/cxx_supportlib/Utils/MetricsRegistry.h",
+   "src/cxx_supportlib/Utils/StrIntUtils.h",
+   "src/cxx_supportlib/Utils/SystemTime.h",
+   "src/cxx_supportlib/oxt/detail/../spin_lock.hpp",
+   "src/cxx_supportlib/oxt/detail/context.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_disabled.hpp",
+   "src/cxx_supportlib/oxt/detail/tracable_exception_enabled.hpp",
+   "src/cxx_supportlib/oxt/macros.hpp",
+   "src/cxx_supportlib/oxt/system_calls.hpp",
+   "src/cxx_supportlib/oxt/thread.hpp",
+   "src/cxx_supportlib/oxt/tracable_exception.hpp",
+   "test/cxx/../tut/tut.h",
+   "test/cxx/TestSupport.h"],
  "test/cxx/Utils/StrIntUtilsTest.cpp"=>
   ["src/cxx_supportlib/BackgroundEventLoop.h",
    "src/cxx_supportlib/Constants.h",
@@ -0,0 +1,784 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_CORE_ACCESS_LOG_H_
+#define _PASSENGER_CORE_ACCESS_LOG_H_
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <boost/cstdint.hpp>
+#include <oxt/thread.hpp>
+#include <oxt/macros.hpp>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <climits>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <Logging.h>
+#include <Constants.h>
+#include <Exceptions.h>
+#include <StaticString.h>
+#include <DataStructures/LString.h>
+#include <DataStructures/HashedStaticString.h>
+#include <ServerKit/http_parser.h>
+#include <Utils/StrIntUtils.h>
+#include <Core/Controller/Request.h>
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+
+
+/**
+ * An access log format, compiled from a format string into a sequence of
+ * fields, so that formatting a log line doesn't involve any parsing.
+ *
+ * The format string consists of literal text and variables. Variables
+ * start with `$` and consist of lowercase letters, digits and underscores.
+ * `$$` is a literal `$`. The supported variables are:
+ *
+ *  - $remote_addr, $remote_user: as passed by the web server.
+ *  - $time_iso8601: the local time at which the request ended.
+ *  - $msec: the time at which the request ended, in seconds since the
+ *    Epoch, with millisecond resolution.
+ *  - $request_method, $request_uri, $server_protocol, $host.
+ *  - $status: the response status code.
+ *  - $request_time: seconds from request begin until the request ended.
+ *  - $queue_time: seconds spent waiting for the ApplicationPool to
+ *    provide a session, i.e. waiting for a process.
+ *  - $connect_time: seconds spent connecting to the app and sending
+ *    it the request header.
+ *  - $app_response_time: seconds that the app took to begin its response.
+ *  - $app_pid, $app_group: the process that handled the request.
+ *  - $turbocache: `HIT` if the request was served from the turbocache.
+ *  - $http_NAME: the request header NAME, where underscores in NAME
+ *    match dashes in the header name.
+ *
+ * Times have millisecond resolution, are measured with the event loop
+ * clock, and are logged as `-` if the request didn't get to that phase.
+ * Text values are escaped: `"`, `\` and non-printable characters are
+ * logged as `\xHH`.
+ *
+ * This class is not thread-safe; each Controller has its own instance.
+ */
+class AccessLogFormat: public boost::noncopyable {
+public:
+	enum FieldType {
+		LITERAL,
+		REMOTE_ADDR,
+		REMOTE_USER,
+		TIME_ISO8601,
+		MSEC,
+		REQUEST_METHOD,
+		REQUEST_URI,
+		SERVER_PROTOCOL,
+		HOST,
+		STATUS,
+		REQUEST_TIME,
+		QUEUE_TIME,
+		CONNECT_TIME,
+		APP_RESPONSE_TIME,
+		APP_PID,
+		APP_GROUP,
+		TURBOCACHE,
+		HTTP_HEADER
+	};
+
+	struct Field {
+		FieldType type;
+		// The literal text, or the header name for HTTP_HEADER.
+		string text;
+		HashedStaticString header;
+	};
+
+private:
+	vector<Field> fields;
+	bool needsTimings;
+	HashedStaticString PASSENGER_REMOTE_ADDR;
+	HashedStaticString PASSENGER_REMOTE_USER;
+
+	time_t cachedTimeSec;
+	char cachedTime[sizeof("-2147483648-01-01T00:00:00+00:00")];
+	unsigned int cachedTimeSize;
+
+	void addField(FieldType type, const string &text = string()) {
+		if (type == LITERAL && !fields.empty() && fields.back().type == LITERAL) {
+			fields.back().text.append(text);
+		} else {
+			fields.push_back(Field());
+			fields.back().type = type;
+			fields.back().text = text;
+		}
+	}
+
+	void addVariable(const string &name) {
+		if (name == "remote_addr") {
+			addField(REMOTE_ADDR);
+		} else if (name == "remote_user") {
+			addField(REMOTE_USER);
+		} else if (name == "time_iso8601") {
+			addField(TIME_ISO8601);
+		} else if (name == "msec") {
+			addField(MSEC);
+		} else if (name == "request_method") {
+			addField(REQUEST_METHOD);
+		} else if (name == "request_uri") {
+			addField(REQUEST_URI);
+		} else if (name == "server_protocol") {
+			addField(SERVER_PROTOCOL);
+		} else if (name == "host") {
+			addField(HOST);
+		} else if (name == "status") {
+			addField(STATUS);
+		} else if (name == "request_time") {
+			addField(REQUEST_TIME);
+		} else if (name == "queue_time") {
+			addField(QUEUE_TIME);
+			needsTimings = true;
+		} else if (name == "connect_time") {
+			addField(CONNECT_TIME);
+			needsTimings = true;
+		} else if (name == "app_response_time") {
+			addField(APP_RESPONSE_TIME);
+			needsTimings = true;
+		} else if (name == "app_pid") {
+			addField(APP_PID);
+		} else if (name == "app_group") {
+			addField(APP_GROUP);
+		} else if (name == "turbocache") {
+			addField(TURBOCACHE);
+		} else if (startsWith(name, "http_") && name.size() > sizeof("http_") - 1) {
+			// Header names are stored in lowercase in the request header table.
+			string header = name.substr(sizeof("http_") - 1);
+			std::replace(header.begin(), header.end(), '_', '-');
+			addField(HTTP_HEADER, header);
+		} else {
+			throw ArgumentException("Unknown access log format variable: $" + name);
+		}
+	}
+
+	static bool isVariableChar(char ch) {
+		return (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '_';
+	}
+
+	static void appendUint(string &out, boost::uint64_t value) {
+		char buf[sizeof("18446744073709551615")];
+		unsigned int size = integerToOtherBase<boost::uint64_t, 10>(value, buf, sizeof(buf));
+		out.append(buf, size);
+	}
+
+	/** Appends a duration in seconds, with millisecond resolution. */
+	static void appendDuration(string &out, ev_tstamp begin, ev_tstamp end) {
+		if (begin == 0 || end == 0 || end < begin) {
+			out.append(1, '-');
+		} else {
+			appendMsec(out, end - begin);
+		}
+	}
+
+	static void appendMsec(string &out, ev_tstamp seconds) {
+		boost::uint64_t msec = (boost::uint64_t) (seconds * 1000 + 0.5);
+		char fraction[4];
+		appendUint(out, msec / 1000);
+		fraction[0] = '.';
+		fraction[1] = '0' + msec / 100 % 10;
+		fraction[2] = '0' + msec / 10 % 10;
+		fraction[3] = '0' + msec % 10;
+		out.append(fraction, sizeof(fraction));
+	}
+
+	static void appendEscaped(string &out, const char *data, unsigned int size) {
+		static const char hex[] = "0123456789ABCDEF";
+		const char *end = data + size;
+		const char *begin = data;
+
+		while (data < end) {
+			unsigned char ch = (unsigned char) *data;
+			if (OXT_UNLIKELY(ch < 0x20 || ch >= 0x7f || ch == '"' || ch == '\\')) {
+				char escaped[4] = { '\\', 'x', hex[ch >> 4], hex[ch & 0xf] };
+				out.append(begin, data - begin);
+				out.append(escaped, sizeof(escaped));
+				begin = data + 1;
+			}
+			data++;
+		}
+		out.append(begin, end - begin);
+	}
+
+	static void appendEscaped(string &out, const LString *str) {
+		if (str == NULL || str->size == 0) {
+			out.append(1, '-');
+		} else {
+			const LString::Part *part = str->start;
+			while (part != NULL) {
+				appendEscaped(out, part->data, part->size);
+				part = part->next;
+			}
+		}
+	}
+
+	void appendTime(string &out, ev_tstamp now) {
+		time_t sec = (time_t) now;
+		if (sec != cachedTimeSec) {
+			struct tm tm;
+			size_t size;
+
+			localtime_r(&sec, &tm);
+			size = strftime(cachedTime, sizeof(cachedTime), "%Y-%m-%dT%H:%M:%S%z", &tm);
+			// Turn +hhmm into +hh:mm.
+			if (size >= 5 && size + 1 < sizeof(cachedTime)) {
+				memmove(cachedTime + size - 1, cachedTime + size - 2, 3);
+				cachedTime[size - 2] = ':';
+				size++;
+			}
+			cachedTimeSize = size;
+			cachedTimeSec = sec;
+		}
+		out.append(cachedTime, cachedTimeSize);
+	}
+
+	void appendField(string &out, const Field &field, const Request *req, ev_tstamp now) {
+		switch (field.type) {
+		case LITERAL:
+			out.append(field.text);
+			break;
+		case REMOTE_ADDR:
+			appendEscaped(out, req->secureHeaders.lookup(PASSENGER_REMOTE_ADDR));
+			break;
+		case REMOTE_USER:
+			appendEscaped(out, req->secureHeaders.lookup(PASSENGER_REMOTE_USER));
+			break;
+		case TIME_ISO8601:
+			appendTime(out, now);
+			break;
+		case MSEC:
+			appendMsec(out, now);
+			break;
+		case REQUEST_METHOD: {
+			const char *method = http_method_str(req->method);
+			out.append(method);
+			break;
+		}
+		case REQUEST_URI:
+			appendEscaped(out, &req->path);
+			break;
+		case SERVER_PROTOCOL: {
+			char protocol[] = "HTTP/1.0";
+			protocol[5] = '0' + req->httpMajor % 10;
+			protocol[7] = '0' + req->httpMinor % 10;
+			out.append(protocol, sizeof(protocol) - 1);
+			break;
+		}
+		case HOST:
+			appendEscaped(out, req->host);
+			break;
+		case STATUS:
+			if (req->responseStatus == 0) {
+				out.append(1, '-');
+			} else {
+				appendUint(out, req->responseStatus);
+			}
+			break;
+		case REQUEST_TIME:
+			appendDuration(out, req->startedAt, now);
+			break;
+		case QUEUE_TIME:
+			if (req->timed) {
+				appendDuration(out, req->timings.checkoutBegun,
+					req->timings.sessionCheckedOut);
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case CONNECT_TIME:
+			if (req->timed) {
+				appendDuration(out, req->timings.sessionCheckedOut,
+					req->timings.requestHeaderSent);
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case APP_RESPONSE_TIME:
+			if (req->timed) {
+				appendDuration(out, req->timings.requestHeaderSent,
+					req->timings.responseBegun);
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case APP_PID:
+			if (req->session != NULL) {
+				appendUint(out, req->session->getPid());
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case APP_GROUP:
+			if (req->session != NULL && !req->options.getAppGroupName().empty()) {
+				StaticString name = req->options.getAppGroupName();
+				appendEscaped(out, name.data(), name.size());
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case TURBOCACHE:
+			if (req->turboCacheHit) {
+				out.append("HIT", 3);
+			} else {
+				out.append(1, '-');
+			}
+			break;
+		case HTTP_HEADER:
+			appendEscaped(out, req->headers.lookup(field.header));
+			break;
+		}
+	}
+
+public:
+	AccessLogFormat(const StaticString &format = DEFAULT_ACCESS_LOG_FORMAT)
+		: needsTimings(false),
+		  PASSENGER_REMOTE_ADDR("!~REMOTE_ADDR"),
+		  PASSENGER_REMOTE_USER("!~REMOTE_USER"),
+		  cachedTimeSec((time_t) -1),
+		  cachedTimeSize(0)
+	{
+		const char *pos = format.data();
+		const char *end = format.data() + format.size();
+
+		while (pos < end) {
+			const char *dollar = (const char *) memchr(pos, '$', end - pos);
+			if (dollar == NULL) {
+				addField(LITERAL, string(pos, end - pos));
+				break;
+			}
+			if (dollar > pos) {
+				addField(LITERAL, string(pos, dollar - pos));
+			}
+			if (dollar + 1 < end && dollar[1] == '$') {
+				addField(LITERAL, "$");
+				pos = dollar + 2;
+				continue;
+			}
+
+			const char *nameEnd = dollar + 1;
+			while (nameEnd < end && isVariableChar(*nameEnd)) {
+				nameEnd++;
+			}
+			if (nameEnd == dollar + 1) {
+				throw ArgumentException("Invalid access log format: '$' must be "
+					"followed by a variable name, or by another '$'");
+			}
+			addVariable(string(dollar + 1, nameEnd));
+			pos = nameEnd;
+		}
+
+		// Only now that `fields` doesn't grow anymore, is it safe to point to their text.
+		vector<Field>::iterator it, fend = fields.end();
+		for (it = fields.begin(); it != fend; it++) {
+			if (it->type == HTTP_HEADER) {
+				it->header = it->text;
+			}
+		}
+	}
+
+	const vector<Field> &getFields() const {
+		return fields;
+	}
+
+	/**
+	 * Whether the format logs phase timings, which means that they
+	 * should be recorded for every request.
+	 */
+	bool needsRequestTimings() const {
+		return needsTimings;
+	}
+
+	/**
+	 * Appends a log line for the given request to `out`, including the
+	 * newline. `now` is the time at which the request ended.
+	 */
+	void format(string &out, const Request *req, ev_tstamp now) {
+		vector<Field>::const_iterator it, end = fields.end();
+		for (it = fields.begin(); it != end; it++) {
+			appendField(out, *it, req, now);
+		}
+		out.append(1, '\n');
+	}
+};
+
+
+/**
+ * Writes access log lines to a file or a FIFO from a background thread, so
+ * that the event loops never block on log I/O. Controllers format lines into
+ * their own buffer and hand it over with `submit()` once per event loop
+ * iteration.
+ *
+ * If the writer cannot keep up and more than `maxPendingBytes` are waiting
+ * to be written, newly submitted lines are dropped and counted.
+ *
+ * If a rotation size is set, the log file is renamed to `<path>.1` once it
+ * has grown beyond that size, and a new log file is opened. The rotation
+ * hook, if any, is then called from the background thread with the new name
+ * of the old file, e.g. so that it can be compressed or shipped elsewhere.
+ *
+ * This class is thread-safe.
+ */
+class AccessLog: public boost::noncopyable {
+public:
+	typedef boost::function<void (const string &rotatedPath)> RotationHook;
+
+private:
+	struct Batch {
+		string data;
+		unsigned int lines;
+	};
+
+	const string path;
+	const boost::uint64_t rotateSize;
+	const size_t maxPendingBytes;
+
+	mutable boost::mutex syncher;
+	// Signaled when there is work for the writer thread.
+	boost::condition_variable cond;
+	// Signaled when the writer thread has finished a write.
+	boost::condition_variable writtenCond;
+	vector<Batch> pending;
+	// Emptied strings that still have their capacity, for reuse by submit().
+	vector<string> spare;
+	size_t pendingBytes;
+	boost::uint64_t linesWritten;
+	boost::uint64_t linesDropped;
+	boost::uint64_t rotations;
+	bool writing;
+	bool quit;
+	RotationHook rotationHook;
+
+	// Only accessed by the writer thread.
+	int fd;
+	boost::uint64_t fileSize;
+	int lastErrno;
+
+	oxt::thread *thr;
+
+	bool shouldQuit() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return quit;
+	}
+
+	bool openFile() {
+		// O_NONBLOCK so that opening a FIFO without a reader fails with
+		// ENXIO instead of blocking. We try again with the next batch.
+		fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_NONBLOCK, 0644);
+		if (fd == -1) {
+			int e = errno;
+			if (e != lastErrno) {
+				P_ERROR("Cannot open access log file " << path << ": " <<
+					strerror(e) << " (errno=" << e << ")");
+				lastErrno = e;
+			}
+			return false;
+		}
+
+		struct stat buf;
+		if (fstat(fd, &buf) == 0 && S_ISREG(buf.st_mode)) {
+			fileSize = buf.st_size;
+			// Writes to regular files don't honor O_NONBLOCK anyway.
+			int flags = fcntl(fd, F_GETFL);
+			fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+		} else {
+			// FIFOs stay non-blocking, so that writeExact() can wait in
+			// poll() and notice shutdown if the reader stops reading.
+			fileSize = 0;
+		}
+		lastErrno = 0;
+		return true;
+	}
+
+	void rotate() {
+		string rotatedPath = path + ".1";
+		RotationHook hook;
+
+		if (rename(path.c_str(), rotatedPath.c_str()) == -1) {
+			int e = errno;
+			P_ERROR("Cannot rotate access log file " << path << ": " <<
+				strerror(e) << " (errno=" << e << ")");
+			// Don't retry after every batch.
+			fileSize = 0;
+			return;
+		}
+		::close(fd);
+		fd = -1;
+		openFile();
+
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			rotations++;
+			hook = rotationHook;
+		}
+		if (hook) {
+			hook(rotatedPath);
+		}
+	}
+
+	bool writeBatches(vector<Batch> &batches) {
+		struct iovec iov[64];
+		size_t i = 0;
+
+		if (fd == -1 && !openFile()) {
+			return false;
+		}
+
+		while (i < batches.size()) {
+			unsigned int niov = 0;
+			size_t total = 0;
+			while (i < batches.size() && niov < sizeof(iov) / sizeof(struct iovec)) {
+				iov[niov].iov_base = (char *) batches[i].data.data();
+				iov[niov].iov_len  = batches[i].data.size();
+				total += batches[i].data.size();
+				niov++;
+				i++;
+			}
+			if (!writeExact(iov, niov, total)) {
+				return false;
+			}
+			fileSize += total;
+		}
+
+		if (rotateSize > 0 && fileSize >= rotateSize) {
+			rotate();
+		}
+		return true;
+	}
+
+	bool writeExact(struct iovec *iov, unsigned int niov, size_t total) {
+		size_t written = 0;
+		while (written < total) {
+			ssize_t ret;
+			do {
+				ret = ::writev(fd, iov, niov);
+			} while (ret == -1 && errno == EINTR);
+			if (ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+				if (!waitUntilWritable()) {
+					return false;
+				}
+				continue;
+			} else if (ret == -1) {
+				int e = errno;
+				if (e != lastErrno) {
+					P_ERROR("Cannot write to access log file " << path << ": " <<
+						strerror(e) << " (errno=" << e << ")");
+					lastErrno = e;
+				}
+				return false;
+			}
+
+			written += ret;
+			// Skip the buffers that have been written completely.
+			size_t skip = ret;
+			while (niov > 0 && skip >= iov[0].iov_len) {
+				skip -= iov[0].iov_len;
+				iov++;
+				niov--;
+			}
+			if (niov > 0) {
+				iov[0].iov_base = (char *) iov[0].iov_base + skip;
+				iov[0].iov_len -= skip;
+			}
+		}
+		lastErrno = 0;
+		return true;
+	}
+
+	/**
+	 * Waits until the FIFO is writable. Returns false if the log is being
+	 * destroyed in the mean time, in which case the remaining data is dropped.
+	 */
+	bool waitUntilWritable() {
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLOUT;
+		while (!shouldQuit()) {
+			pfd.revents = 0;
+			if (::poll(&pfd, 1, 100) != 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void threadMain() {
+		vector<Batch> batches;
+		boost::unique_lock<boost::mutex> l(syncher);
+
+		while (true) {
+			while (pending.empty() && !quit) {
+				cond.wait(l);
+			}
+			if (pending.empty()) {
+				break;
+			}
+
+			batches.swap(pending);
+			pendingBytes = 0;
+			writing = true;
+			l.unlock();
+
+			bool ok = writeBatches(batches);
+
+			l.lock();
+			writing = false;
+			for (vector<Batch>::iterator it = batches.begin(); it != batches.end(); it++) {
+				if (ok) {
+					linesWritten += it->lines;
+				} else {
+					linesDropped += it->lines;
+				}
+				if (spare.size() < 64) {
+					spare.push_back(string());
+					spare.back().swap(it->data);
+					spare.back().clear();
+				}
+			}
+			batches.clear();
+			writtenCond.notify_all();
+		}
+
+		if (fd != -1) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+
+public:
+	AccessLog(const string &_path, boost::uint64_t _rotateSize = 0,
+		size_t _maxPendingBytes = 32 * 1024 * 1024)
+		: path(_path),
+		  rotateSize(_rotateSize),
+		  maxPendingBytes(_maxPendingBytes),
+		  pendingBytes(0),
+		  linesWritten(0),
+		  linesDropped(0),
+		  rotations(0),
+		  writing(false),
+		  quit(false),
+		  fd(-1),
+		  fileSize(0),
+		  lastErrno(0)
+	{
+		// The file is opened by the writer thread, so that the event
+		// loops never wait for the open.
+		thr = new oxt::thread(boost::bind(&AccessLog::threadMain, this),
+			"Access log writer", 128 * 1024);
+	}
+
+	/**
+	 * Writes all pending lines, then stops the background thread. Lines
+	 * that are waiting for a FIFO reader are dropped instead.
+	 */
+	~AccessLog() {
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			quit = true;
+			cond.notify_one();
+		}
+		thr->join();
+		delete thr;
+	}
+
+	const string &getPath() const {
+		return path;
+	}
+
+	void setRotationHook(const RotationHook &hook) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		rotationHook = hook;
+	}
+
+	/**
+	 * Hands over `buffer`, which contains `lines` complete log lines, to the
+	 * background thread. `buffer` is replaced by an empty string, which may
+	 * have capacity left over from an earlier batch. Never blocks on I/O.
+	 */
+	void submit(string &buffer, unsigned int lines) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		if (OXT_UNLIKELY(pendingBytes + buffer.size() > maxPendingBytes)) {
+			linesDropped += lines;
+			buffer.clear();
+			return;
+		}
+
+		pendingBytes += buffer.size();
+		pending.push_back(Batch());
+		pending.back().data.swap(buffer);
+		pending.back().lines = lines;
+		if (!spare.empty()) {
+			buffer.swap(spare.back());
+			spare.pop_back();
+		}
+		cond.notify_one();
+	}
+
+	/**
+	 * Waits until all submitted lines have been written (or dropped).
+	 */
+	void flush() {
+		boost::unique_lock<boost::mutex> l(syncher);
+		while (!pending.empty() || writing) {
+			writtenCond.wait(l);
+		}
+	}
+
+	boost::uint64_t getLinesWritten() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return linesWritten;
+	}
+
+	boost::uint64_t getLinesDropped() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return linesDropped;
+	}
+
+	boost::uint64_t getRotations() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return rotations;
+	}
+};
+
+
+} // namespace Core
+} // namespace Passenger
+
+#endif /* _PASSENGER_CORE_ACCESS_LOG_H_ */
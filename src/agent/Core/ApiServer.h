@@ -48,6 +48,7 @@
 #include <Utils/StrIntUtils.h>
 #include <Utils/BufferedIO.h>
 #include <Utils/MessageIO.h>
+#include <Utils/MetricsRegistry.h>
 
 namespace Passenger {
 namespace Core {
@@ -105,6 +106,10 @@ private:
 			processPoolStatusXml(client, req);
 		} else if (path == P_STATIC_STRING("/pool.txt")) {
 			processPoolStatusTxt(client, req);
+		} else if (path == P_STATIC_STRING("/pool/session_latency.json")) {
+			processPoolSessionLatency(client, req);
+		} else if (path == P_STATIC_STRING("/metrics")) {
+			processMetrics(client, req);
 		} else if (path == P_STATIC_STRING("/pool/restart_app_group.json")) {
 			processPoolRestartAppGroup(client, req);
 		} else if (path == P_STATIC_STRING("/pool/detach_process.json")) {
@@ -294,6 +299,51 @@ private:
 		}
 	}
 
+	void processPoolSessionLatency(Client *client, Request *req) {
+		Authorization auth(authorize(this, client, req));
+		if (auth.canReadPool) {
+			ApplicationPool2::Pool::ToXmlOptions options(
+				parseQueryString(req->getQueryString()));
+			options.uid = auth.uid;
+			options.apiKey = auth.apiKey;
+
+			HeaderTable headers;
+			headers.insert(req->pool, "Content-Type", "application/json");
+			writeSimpleResponse(client, 200, &headers,
+				psg_pstrdup(req->pool,
+					appPool->inspectSessionLatenciesAsJson(options).toStyledString()));
+			if (!req->ended()) {
+				endRequest(&client, &req);
+			}
+		} else {
+			apiServerRespondWith401(this, client, req);
+		}
+	}
+
+	/**
+	 * Renders the metrics that the pool and the controllers published in
+	 * the OpenMetrics text format. Unlike /pool.xml, this doesn't lock the
+	 * pool or wait for the controller threads, so it is cheap enough to be
+	 * scraped frequently.
+	 */
+	void processMetrics(Client *client, Request *req) {
+		if (!authorizeStateInspectionOperation(this, client, req)) {
+			apiServerRespondWith401(this, client, req);
+		} else if (metricsRegistry == NULL) {
+			apiServerRespondWith404(this, client, req);
+		} else {
+			HeaderTable headers;
+			headers.insert(req->pool, "Content-Type",
+				"application/openmetrics-text; version=1.0.0; charset=utf-8");
+			headers.insert(req->pool, "Cache-Control", "no-cache, no-store, must-revalidate");
+			writeSimpleResponse(client, 200, &headers,
+				psg_pstrdup(req->pool, metricsRegistry->render()));
+			if (!req->ended()) {
+				endRequest(&client, &req);
+			}
+		}
+	}
+
 	void processPoolRestartAppGroup(Client *client, Request *req) {
 		Authorization auth(authorize(this, client, req));
 		if (!auth.canModifyPool) {
@@ -410,7 +460,7 @@ private:
 		ServerKit::Context *ctx = controller->getContext();
 		unsigned int count;
 
-		count = mbuf_pool_compact(&ctx->mbuf_pool);
+		count = ctx->compactMbufPools();
 		SKS_NOTICE_FROM_STATIC(controller, "Freed " << count << " mbufs");
 
 		controller->compact(LVL_NOTICE);
@@ -641,6 +691,7 @@ public:
 	vector<Controller *> controllers;
 	ApiAccountDatabase *apiAccountDatabase;
 	ApplicationPool2::PoolPtr appPool;
+	MetricsRegistry *metricsRegistry;
 	string instanceDir;
 	string fdPassingPassword;
 	EventFd *exitEvent;
@@ -650,6 +701,7 @@ public:
 		: ParentClass(context),
 		  serverConnectionPath("^/server/(.+)\\.json$"),
 		  apiAccountDatabase(NULL),
+		  metricsRegistry(NULL),
 		  exitEvent(NULL)
 		{ }
 
@@ -59,6 +59,12 @@ public:
 
 	virtual void requestOOBW() { /* Do nothing */ }
 
+	/**
+	 * Called when the app has begun sending its response, i.e. when the
+	 * response header has been received.
+	 */
+	virtual void responseBegun() { /* Do nothing */ }
+
 	/**
 	 * This Session object becomes fully unsable after closing.
 	 */
@@ -188,13 +188,26 @@ struct GetCallback {
 struct GetWaiter {
 	Options options;
 	GetCallback callback;
-
-	GetWaiter(const Options &o, const GetCallback &cb)
+	/** The time (in microseconds) at which this waiter was queued. */
+	unsigned long long queuedAt;
+	/** The time (in microseconds) after which this waiter should be
+	 * rejected instead of assigned a session, or 0 if there is no deadline.
+	 */
+	unsigned long long deadline;
+
+	GetWaiter(const Options &o, const GetCallback &cb,
+		unsigned long long _queuedAt = 0, unsigned long long _deadline = 0)
 		: options(o),
-		  callback(cb)
+		  callback(cb),
+		  queuedAt(_queuedAt),
+		  deadline(_deadline)
 	{
 		options.persist(o);
 	}
+
+	bool isCallback(const GetCallback &cb) const {
+		return callback.func == cb.func && callback.userData == cb.userData;
+	}
 };
 
 struct Ticket {
@@ -45,6 +45,8 @@
 #include <cstdlib>
 #include <cassert>
 #include <SmallVector.h>
+#include <Algorithms/Histogram.h>
+#include <Algorithms/ConcurrencyLimiter.h>
 #include <MemoryKit/palloc.h>
 #include <Hooks.h>
 #include <Utils.h>
@@ -77,6 +79,7 @@ public:
 	struct GetAction {
 		GetCallback callback;
 		SessionPtr session;
+		ExceptionPtr exception;
 	};
 
 	struct DisableWaiter {
@@ -140,6 +143,12 @@ public:
 	 *     if processesBeingSpawned > 0: m_spawning
 	 */
 	short processesBeingSpawned;
+	/**
+	 * The number of processes that this group spawned successfully, and the
+	 * number of spawn attempts that failed. Only used for reporting metrics.
+	 */
+	unsigned long long spawnsSucceeded;
+	unsigned long long spawnsFailed;
 	/**
 	 * A Group object progresses through a life.
 	 *
@@ -202,6 +211,7 @@ public:
 	/****** Session management ******/
 
 	RouteResult route(const Options &options) const;
+	bool canRouteTo(const Process *process) const;
 	SessionPtr newSession(Process *process, unsigned long long now = 0);
 	static void _onSessionInitiateFailure(Session *session);
 	static void _onSessionClose(Session *session);
@@ -269,6 +279,16 @@ public:
 	Group *findOtherGroupWaitingForCapacity() const;
 	bool pushGetWaiter(const Options &newOptions, const GetCallback &callback,
 		boost::container::vector<Callback> &postLockActions);
+	static unsigned long long calculateGetWaiterDeadline(const Options &newOptions,
+		unsigned long long now);
+	void insertGetWaiter(const GetWaiter &waiter);
+	void rejectTimedOutGetWaiter(const GetWaiter &waiter, unsigned long long now,
+		boost::container::vector<Callback> &postLockActions);
+	void recordRequestQueueTime(const GetWaiter &waiter, unsigned long long now);
+	void expireGetWaiters(unsigned long long now,
+		boost::container::vector<Callback> &postLockActions);
+	unsigned long long getEarliestGetWaiterDeadline() const;
+	unsigned int getEffectiveMaxRequestQueueSize(const Options &newOptions) const;
 	template<typename Lock> void assignSessionsToGetWaitersQuickly(Lock &lock);
 	void assignSessionsToGetWaiters(boost::container::vector<Callback> &postLockActions);
 	bool testOverflowRequestQueue() const;
@@ -398,6 +418,29 @@ public:
 	 *       !enabledProcesses.empty() || m_spawning || restarting() || poolAtFullCapacity()
 	 */
 	deque<GetWaiter> getWaitlist;
+	/**
+	 * Statistics about the getWaitlist. `requestQueueTimes` records, in
+	 * microseconds, how long each request that got assigned a session had
+	 * been waiting in the getWaitlist. `requestQueueTimeouts` counts the
+	 * requests that were rejected because their deadline passed, and
+	 * `requestQueueCancellations` counts the requests that were removed
+	 * because their client went away.
+	 */
+	LogHistogram requestQueueTimes;
+	unsigned long long requestQueueTimeouts;
+	unsigned long long requestQueueCancellations;
+	/**
+	 * Limits the number of concurrent sessions per process based on the
+	 * time from session checkout until the app began its response. Only
+	 * active if `options.targetLatency` is nonzero. See `canRouteTo()`.
+	 */
+	ConcurrencyLimiter concurrencyLimiter;
+	/**
+	 * How long, in microseconds, sessions in this group were open. Unlike the
+	 * per-process histograms, this also includes sessions on processes that
+	 * have since been detached. Recorded without holding the pool lock.
+	 */
+	AtomicLogHistogram sessionLatencies;
 	/**
 	 * Disable() commands that couldn't finish immediately will put their callbacks
 	 * in this queue. Note that there may be multiple DisableWaiters pointing to the
@@ -441,6 +484,8 @@ public:
 
 	SessionPtr get(const Options &newOptions, const GetCallback &callback,
 		boost::container::vector<Callback> &postLockActions);
+	bool cancelGetWaiter(const GetCallback &callback,
+		boost::container::vector<Callback> &postLockActions);
 
 	/****** Spawning and restarting ******/
 
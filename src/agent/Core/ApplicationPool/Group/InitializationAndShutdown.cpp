@@ -109,9 +109,14 @@ Group::Group(Pool *_pool, const Options &_options)
 	disablingCount = 0;
 	disabledCount  = 0;
 	nEnabledProcessesTotallyBusy = 0;
+	requestQueueTimeouts = 0;
+	requestQueueCancellations = 0;
+	concurrencyLimiter.setTargetLatency(options.targetLatency * 1000ull);
 	spawner        = getContext()->getSpawningKitFactory()->create(options);
 	restartsInitiated = 0;
 	processesBeingSpawned = 0;
+	spawnsSucceeded = 0;
+	spawnsFailed = 0;
 	m_spawning     = false;
 	m_restarting   = false;
 	lifeStatus.store(ALIVE, boost::memory_order_relaxed);
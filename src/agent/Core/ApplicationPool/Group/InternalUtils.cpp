@@ -218,17 +218,37 @@ bool
 Group::pushGetWaiter(const Options &newOptions, const GetCallback &callback,
 	boost::container::vector<Callback> &postLockActions)
 {
+	unsigned int maxRequestQueueSize = getEffectiveMaxRequestQueueSize(newOptions);
 	if (OXT_LIKELY(!testOverflowRequestQueue()
-		&& (newOptions.maxRequestQueueSize == 0
-		    || getWaitlist.size() < newOptions.maxRequestQueueSize)))
+		&& (maxRequestQueueSize == 0
+		    || getWaitlist.size() < maxRequestQueueSize)))
 	{
-		getWaitlist.push_back(GetWaiter(
-			newOptions.copyAndPersist().detachFromUnionStationTransaction(),
-			callback));
+		// Prefer the time at which the caller began checking out a session,
+		// so that time spent in the Pool's top-level getWaitlist counts too.
+		unsigned long long now = (newOptions.currentTime != 0)
+			? newOptions.currentTime
+			: SystemTime::getUsec();
+		GetWaiter waiter(newOptions.copyAndPersist().detachFromUnionStationTransaction(),
+			callback, now, calculateGetWaiterDeadline(newOptions, now));
+
+		if (OXT_UNLIKELY(waiter.deadline != 0 && waiter.deadline <= now)) {
+			rejectTimedOutGetWaiter(waiter, now, postLockActions);
+			return false;
+		}
+
+		insertGetWaiter(waiter);
+		if (waiter.deadline != 0
+		 && (getPool()->nextGcRunTime == 0 || waiter.deadline < getPool()->nextGcRunTime))
+		{
+			// Make sure that the garbage collector wakes up in time to
+			// reject this request if no process becomes available.
+			getPool()->nextGcRunTime = waiter.deadline;
+			wakeUpGarbageCollector();
+		}
 		return true;
 	} else {
 		postLockActions.push_back(boost::bind(GetCallback::call,
-			callback, SessionPtr(), boost::make_shared<RequestQueueFullException>(newOptions.maxRequestQueueSize)));
+			callback, SessionPtr(), boost::make_shared<RequestQueueFullException>(maxRequestQueueSize)));
 
 		HookScriptOptions hsOptions;
 		if (prepareHookScriptOptions(hsOptions, "queue_full_error")) {
@@ -240,6 +260,121 @@ Group::pushGetWaiter(const Options &newOptions, const GetCallback &callback,
 	}
 }
 
+/**
+ * Returns the time after which a request that is queued at time `now` should
+ * be rejected, or 0 if it may wait indefinitely. This is the earliest of the
+ * request's own deadline and the group's maximum queueing time.
+ */
+unsigned long long
+Group::calculateGetWaiterDeadline(const Options &newOptions, unsigned long long now) {
+	unsigned long long deadline = newOptions.requestQueueDeadline;
+	if (newOptions.maxRequestQueueTime > 0) {
+		unsigned long long maxDeadline = now
+			+ newOptions.maxRequestQueueTime * 1000000ull;
+		if (deadline == 0 || maxDeadline < deadline) {
+			deadline = maxDeadline;
+		}
+	}
+	return deadline;
+}
+
+/**
+ * Inserts the waiter into the getWaitlist behind all waiters with the same
+ * or a higher priority, so that waiters are served in priority order, and
+ * in FIFO order within the same priority. In the common case where all
+ * requests have the same priority, this is a plain push_back().
+ */
+void
+Group::insertGetWaiter(const GetWaiter &waiter) {
+	int priority = waiter.options.requestQueuePriority;
+
+	if (OXT_LIKELY(getWaitlist.empty()
+		|| getWaitlist.back().options.requestQueuePriority >= priority))
+	{
+		getWaitlist.push_back(waiter);
+	} else {
+		deque<GetWaiter>::iterator it = getWaitlist.end();
+		while (it != getWaitlist.begin()
+			&& (it - 1)->options.requestQueuePriority < priority)
+		{
+			it--;
+		}
+		getWaitlist.insert(it, waiter);
+	}
+}
+
+void
+Group::rejectTimedOutGetWaiter(const GetWaiter &waiter, unsigned long long now,
+	boost::container::vector<Callback> &postLockActions)
+{
+	unsigned long long queueTime = (now > waiter.queuedAt) ? now - waiter.queuedAt : 0;
+	P_DEBUG("Request for group " << info.name << " could not be assigned a process "
+		"before its deadline; rejecting it after " << (queueTime / 1000) <<
+		" msec in the queue");
+	requestQueueTimeouts++;
+	postLockActions.push_back(boost::bind(GetCallback::call,
+		waiter.callback, SessionPtr(),
+		boost::make_shared<RequestQueueTimeoutException>(queueTime)));
+}
+
+void
+Group::recordRequestQueueTime(const GetWaiter &waiter, unsigned long long now) {
+	if (now > waiter.queuedAt) {
+		requestQueueTimes.record(now - waiter.queuedAt);
+	} else {
+		requestQueueTimes.record(0);
+	}
+}
+
+/**
+ * Rejects all waiters in the getWaitlist whose deadline has passed.
+ */
+void
+Group::expireGetWaiters(unsigned long long now,
+	boost::container::vector<Callback> &postLockActions)
+{
+	deque<GetWaiter>::iterator it = getWaitlist.begin();
+	while (it != getWaitlist.end()) {
+		if (it->deadline != 0 && it->deadline <= now) {
+			rejectTimedOutGetWaiter(*it, now, postLockActions);
+			it = getWaitlist.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+unsigned long long
+Group::getEarliestGetWaiterDeadline() const {
+	unsigned long long result = 0;
+	deque<GetWaiter>::const_iterator it, end = getWaitlist.end();
+	for (it = getWaitlist.begin(); it != end; it++) {
+		if (it->deadline != 0 && (result == 0 || it->deadline < result)) {
+			result = it->deadline;
+		}
+	}
+	return result;
+}
+
+/**
+ * Returns the maximum size of the getWaitlist. Normally this is the configured
+ * maximum, but while the app is slower than the target latency, queueing
+ * more requests only makes all of them wait longer. In that case we shed
+ * load early by only queueing as many requests as can be in flight at once.
+ */
+unsigned int
+Group::getEffectiveMaxRequestQueueSize(const Options &newOptions) const {
+	unsigned int result = newOptions.maxRequestQueueSize;
+	if (OXT_UNLIKELY(concurrencyLimiter.isOverloaded())) {
+		unsigned int limit = concurrencyLimiter.getLimit()
+			* std::max<unsigned int>(enabledCount, 1);
+		if (result == 0 || limit < result) {
+			result = limit;
+		}
+	}
+	return result;
+}
+
 template<typename Lock>
 void
 Group::assignSessionsToGetWaitersQuickly(Lock &lock) {
@@ -252,16 +387,31 @@ Group::assignSessionsToGetWaitersQuickly(Lock &lock) {
 	SmallVector<GetAction, 8> actions;
 	unsigned int i = 0;
 	bool done = false;
+	unsigned long long now = SystemTime::getUsec();
 
 	actions.reserve(getWaitlist.size());
 
 	while (!done && i < getWaitlist.size()) {
 		const GetWaiter &waiter = getWaitlist[i];
+		if (OXT_UNLIKELY(waiter.deadline != 0 && waiter.deadline <= now)) {
+			unsigned long long queueTime = (now > waiter.queuedAt)
+				? now - waiter.queuedAt
+				: 0;
+			GetAction action;
+			action.callback  = waiter.callback;
+			action.exception = boost::make_shared<RequestQueueTimeoutException>(queueTime);
+			requestQueueTimeouts++;
+			getWaitlist.erase(getWaitlist.begin() + i);
+			actions.push_back(action);
+			continue;
+		}
+
 		RouteResult result = route(waiter.options);
 		if (result.process != NULL) {
 			GetAction action;
 			action.callback = waiter.callback;
 			action.session  = newSession(result.process);
+			recordRequestQueueTime(waiter, now);
 			getWaitlist.erase(getWaitlist.begin() + i);
 			actions.push_back(action);
 		} else {
@@ -276,7 +426,7 @@ Group::assignSessionsToGetWaitersQuickly(Lock &lock) {
 	lock.unlock();
 	SmallVector<GetAction, 50>::const_iterator it, end = actions.end();
 	for (it = actions.begin(); it != end; it++) {
-		it->callback(it->session, ExceptionPtr());
+		it->callback(it->session, it->exception);
 	}
 }
 
@@ -284,9 +434,16 @@ void
 Group::assignSessionsToGetWaiters(boost::container::vector<Callback> &postLockActions) {
 	unsigned int i = 0;
 	bool done = false;
+	unsigned long long now = getWaitlist.empty() ? 0 : SystemTime::getUsec();
 
 	while (!done && i < getWaitlist.size()) {
 		const GetWaiter &waiter = getWaitlist[i];
+		if (OXT_UNLIKELY(waiter.deadline != 0 && waiter.deadline <= now)) {
+			rejectTimedOutGetWaiter(waiter, now, postLockActions);
+			getWaitlist.erase(getWaitlist.begin() + i);
+			continue;
+		}
+
 		RouteResult result = route(waiter.options);
 		if (result.process != NULL) {
 			postLockActions.push_back(boost::bind(
@@ -294,6 +451,7 @@ Group::assignSessionsToGetWaiters(boost::container::vector<Callback> &postLockAc
 				waiter.callback,
 				newSession(result.process),
 				ExceptionPtr()));
+			recordRequestQueueTime(waiter, now);
 			getWaitlist.erase(getWaitlist.begin() + i);
 		} else {
 			done = result.finished;
@@ -421,6 +421,8 @@ Group::attach(const ProcessPtr &process,
 	if (options.forceMaxConcurrentRequestsPerProcess != -1) {
 		process->forceMaxConcurrency(options.forceMaxConcurrentRequestsPerProcess);
 	}
+	// The processes in a group normally all have the same concurrency.
+	concurrencyLimiter.setConcurrency(process->getConcurrency());
 
 	P_DEBUG("Attaching process " << process->inspect());
 	addProcessToList(process, enabledProcesses);
@@ -46,7 +46,8 @@ using namespace boost;
 
 
 /* Determines which process to route a get() action to. The returned process
- * is guaranteed to be `canBeRoutedTo()`, i.e. not totally busy.
+ * is guaranteed to be `canRouteTo()`, i.e. not totally busy and not over its
+ * adaptive concurrency limit.
  *
  * A request is routed to an enabled processes, or if there are none,
  * from a disabling process. The rationale is as follows:
@@ -59,7 +60,7 @@ Group::route(const Options &options) const {
 	if (OXT_LIKELY(enabledCount > 0)) {
 		if (options.stickySessionId == 0) {
 			Process *process = findEnabledProcessWithLowestBusyness();
-			if (process->canBeRoutedTo()) {
+			if (canRouteTo(process)) {
 				return RouteResult(process);
 			} else {
 				return RouteResult(NULL, true);
@@ -68,7 +69,7 @@ Group::route(const Options &options) const {
 			Process *process = findProcessWithStickySessionIdOrLowestBusyness(
 				options.stickySessionId);
 			if (process != NULL) {
-				if (process->canBeRoutedTo()) {
+				if (canRouteTo(process)) {
 					return RouteResult(process);
 				} else {
 					return RouteResult(NULL, false);
@@ -79,7 +80,7 @@ Group::route(const Options &options) const {
 		}
 	} else {
 		Process *process = findProcessWithLowestBusyness(disablingProcesses);
-		if (process->canBeRoutedTo()) {
+		if (canRouteTo(process)) {
 			return RouteResult(process);
 		} else {
 			return RouteResult(NULL, true);
@@ -87,6 +88,21 @@ Group::route(const Options &options) const {
 	}
 }
 
+/* Whether a new session may be opened on the given process. Besides the
+ * process's own concurrency, this takes into account the concurrency limit
+ * that was calculated from the measured session latencies.
+ *
+ * Because the limit is the same for all processes in the group, the process
+ * with the lowest busyness is also the one that is least likely to be over
+ * the limit, so route() doesn't have to look any further.
+ */
+bool
+Group::canRouteTo(const Process *process) const {
+	return process->canBeRoutedTo()
+		&& (OXT_LIKELY(!concurrencyLimiter.isEnabled())
+			|| process->sessions < (int) concurrencyLimiter.getLimit());
+}
+
 SessionPtr
 Group::newSession(Process *process, unsigned long long now) {
 	bool wasTotallyBusy = process->isTotallyBusy();
@@ -141,6 +157,14 @@ Group::onSessionInitiateFailure(Process *process, Session *session) {
 OXT_FORCE_INLINE void
 Group::onSessionClose(Process *process, Session *session) {
 	TRACE_POINT();
+	unsigned long long now = SystemTime::getUsec();
+	unsigned long long latency = (now > session->startTime)
+		? now - session->startTime
+		: 0;
+	// The histograms are atomic, so keep them out of the critical section.
+	process->sessionLatencies.record(latency);
+	sessionLatencies.record(latency);
+
 	// Standard resource management boilerplate stuff...
 	Pool *pool = getPool();
 	boost::unique_lock<boost::mutex> lock(pool->syncher);
@@ -153,6 +177,18 @@ Group::onSessionClose(Process *process, Session *session) {
 
 	/* Update statistics. */
 	bool wasTotallyBusy = process->isTotallyBusy();
+	// Streaming responses and upgraded connections keep their session open
+	// long after the app has responded, so the concurrency limiter only
+	// looks at the time until the response began. Sessions that ended
+	// without a response are measured until they were closed.
+	unsigned long long responseLatency = latency;
+	if (session->responseBegunTime != 0) {
+		responseLatency = (session->responseBegunTime > session->startTime)
+			? session->responseBegunTime - session->startTime
+			: 0;
+	}
+	bool concurrencyLimitIncreased = concurrencyLimiter.update(responseLatency,
+		process->sessions, now);
 	process->sessionClosed(session);
 	assert(process->getLifeStatus() == Process::ALIVE);
 	assert(process->enabled == Process::ENABLED
@@ -223,6 +259,11 @@ Group::onSessionClose(Process *process, Session *session) {
 			maybeInitiateOobw(process);
 		}
 
+		if (concurrencyLimitIncreased) {
+			// Other processes may now be able to serve waiting requests.
+			assignSessionsToGetWaiters(actions);
+		}
+
 		pool->fullVerifyInvariants();
 		lock.unlock();
 		runAllActions(actions);
@@ -233,7 +274,9 @@ Group::onSessionClose(Process *process, Session *session) {
 		// This could change process->enabled.
 		maybeInitiateOobw(process);
 
-		if (!getWaitlist.empty() && process->enabled == Process::ENABLED) {
+		if (!getWaitlist.empty()
+		 && (process->enabled == Process::ENABLED || concurrencyLimitIncreased))
+		{
 			/* If there are clients on this group waiting for a process to
 			 * become available then call them now.
 			 */
@@ -306,7 +349,7 @@ Group::get(const Options &newOptions, const GetCallback &callback,
 		if (disablingCount > 0 && !restarting()) {
 			Process *process = findProcessWithLowestBusyness(disablingProcesses);
 			assert(process != NULL);
-			if (!process->isTotallyBusy()) {
+			if (canRouteTo(process)) {
 				return newSession(process, newOptions.currentTime);
 			}
 		}
@@ -333,6 +376,34 @@ Group::get(const Options &newOptions, const GetCallback &callback,
 	}
 }
 
+/**
+ * Removes the getWaitlist entry that was queued with the given callback,
+ * for example because the client that made the request has gone away.
+ * The callback will be called with a GetAbortedException so that the caller
+ * can release any resources associated with the request. Returns whether
+ * a matching entry was found.
+ */
+bool
+Group::cancelGetWaiter(const GetCallback &callback,
+	boost::container::vector<Callback> &postLockActions)
+{
+	deque<GetWaiter>::iterator it, end = getWaitlist.end();
+	for (it = getWaitlist.begin(); it != end; it++) {
+		if (it->isCallback(callback)) {
+			P_DEBUG("Request for group " << info.name << " canceled while "
+				"waiting in the queue");
+			requestQueueCancellations++;
+			postLockActions.push_back(boost::bind(GetCallback::call,
+				it->callback, SessionPtr(),
+				boost::make_shared<GetAbortedException>(
+					"The request was canceled while waiting in the queue")));
+			getWaitlist.erase(it);
+			return true;
+		}
+	}
+	return false;
+}
+
 
 } // namespace ApplicationPool2
 } // namespace Passenger
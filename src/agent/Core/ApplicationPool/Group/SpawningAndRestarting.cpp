@@ -150,6 +150,7 @@ Group::spawnThreadRealMain(const SpawningKit::SpawnerPtr &spawner,
 		UPDATE_TRACE_POINT();
 		boost::container::vector<Callback> actions;
 		if (process != NULL) {
+			spawnsSucceeded++;
 			AttachResult result = attach(process, actions);
 			if (result == AR_OK) {
 				guard.clear();
@@ -168,6 +169,7 @@ Group::spawnThreadRealMain(const SpawningKit::SpawnerPtr &spawner,
 				}
 			}
 		} else {
+			spawnsFailed++;
 			// TODO: sure this is the best thing? if there are
 			// processes currently alive we should just use them.
 			if (enabledCount == 0) {
@@ -260,6 +262,7 @@ Group::finalizeRestart(GroupPtr self,
 
 	// Atomically swap the new spawner with the old one.
 	resetOptions(newOptions);
+	concurrencyLimiter.setTargetLatency(options.targetLatency * 1000ull);
 	oldSpawner = spawner;
 	spawner    = newSpawner;
 
@@ -130,6 +130,19 @@ Group::inspectXml(std::ostream &stream, bool includeSecrets) const {
 	stream << "<disabled_process_count>" << disabledCount << "</disabled_process_count>";
 	stream << "<capacity_used>" << capacityUsed() << "</capacity_used>";
 	stream << "<get_wait_list_size>" << getWaitlist.size() << "</get_wait_list_size>";
+	stream << "<request_queue_timeouts>" << requestQueueTimeouts << "</request_queue_timeouts>";
+	stream << "<request_queue_cancellations>" << requestQueueCancellations << "</request_queue_cancellations>";
+	stream << "<request_queue_time>";
+	requestQueueTimes.toXml(stream);
+	stream << "</request_queue_time>";
+	stream << "<session_latency>";
+	sessionLatencies.toXml(stream);
+	stream << "</session_latency>";
+	if (concurrencyLimiter.isEnabled()) {
+		stream << "<concurrency_limiter>";
+		concurrencyLimiter.toXml(stream);
+		stream << "</concurrency_limiter>";
+	}
 	stream << "<disable_wait_list_size>" << disableWaitlist.size() << "</disable_wait_list_size>";
 	stream << "<processes_being_spawned>" << processesBeingSpawned << "</processes_being_spawned>";
 	if (m_spawning) {
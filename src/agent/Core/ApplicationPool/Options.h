@@ -364,6 +364,23 @@ public:
 	 */
 	unsigned int maxRequestQueueSize;
 
+	/**
+	 * The maximum amount of time, in seconds, that a request may spend in the
+	 * Group.getWaitlist queue. Requests that could not be assigned a process
+	 * within this time are rejected with a RequestQueueTimeoutException.
+	 * A value of 0 means unlimited.
+	 */
+	unsigned int maxRequestQueueTime;
+
+	/**
+	 * The latency, in milliseconds, that requests to this group should stay
+	 * below. If nonzero, the group adapts the number of concurrent sessions
+	 * per process to the measured session latency, and sheds load early when
+	 * latency exceeds this target. A value of 0 disables adaptive concurrency
+	 * limiting.
+	 */
+	unsigned int targetLatency;
+
 	/**
 	 * Whether websocket connections should be aborted on process shutdown
 	 * or restart.
@@ -428,6 +445,24 @@ public:
 	 */
 	unsigned long maxRequests;
 
+	/**
+	 * An absolute deadline, in microseconds (as returned by
+	 * SystemTime::getUsec()), before which this request must have been
+	 * assigned a session. Once the deadline has passed, the request is
+	 * rejected with a RequestQueueTimeoutException instead of occupying
+	 * a process for a client that has probably given up already.
+	 * A value of 0 means no deadline.
+	 */
+	unsigned long long requestQueueDeadline;
+
+	/**
+	 * The priority class of this request in the Group.getWaitlist queue.
+	 * Waiting requests with a higher priority are assigned a process before
+	 * waiting requests with a lower priority. Requests with equal priorities
+	 * are served in FIFO order. Defaults to 0.
+	 */
+	int requestQueuePriority;
+
 	/** If the current time (in microseconds) has already been queried, set it
 	 * here. Pool will use this timestamp instead of querying it again.
 	 */
@@ -495,11 +530,15 @@ public:
 		  maxPreloaderIdleTime(-1),
 		  maxOutOfBandWorkInstances(1),
 		  maxRequestQueueSize(100),
+		  maxRequestQueueTime(0),
+		  targetLatency(0),
 		  abortWebsocketsOnProcessShutdown(true),
 
 		  stickySessionId(0),
 		  statThrottleRate(DEFAULT_STAT_THROTTLE_RATE),
 		  maxRequests(0),
+		  requestQueueDeadline(0),
+		  requestQueuePriority(0),
 		  currentTime(0),
 		  noop(false)
 		  /*********************************/
@@ -571,6 +610,8 @@ public:
 		hostName = StaticString();
 		uri      = StaticString();
 		stickySessionId = 0;
+		requestQueueDeadline = 0;
+		requestQueuePriority = 0;
 		currentTime     = 0;
 		noop     = false;
 		return detachFromUnionStationTransaction();
@@ -58,6 +58,7 @@
 #include <Utils/VariantMap.h>
 #include <Utils/ProcessMetricsCollector.h>
 #include <Utils/SystemMetricsCollector.h>
+#include <Utils/MetricsRegistry.h>
 #include <Core/UnionStation/StopwatchLog.h>
 #include <Core/ApplicationPool/Common.h>
 #include <Core/ApplicationPool/Context.h>
@@ -212,6 +213,9 @@ public:
 	 *   free capacity.
 	 * - The 'max' option has been increased, resulting in free capacity.
 	 *
+	 * Requests whose deadline passes while they are in this wait list are
+	 * rejected by the garbage collector, just like in Group.getWaitlist.
+	 *
 	 * Invariant 1:
 	 *    for all options in getWaitlist:
 	 *       options.getAppGroupName() is not in 'groups'.
@@ -276,6 +280,9 @@ public:
 
 	SystemMetricsCollector systemMetricsCollector;
 	SystemMetrics systemMetrics;
+	/** Receives a snapshot of the pool's metrics upon every analytics
+	 * collection. May be NULL. */
+	MetricsRegistry::Publisher *metricsPublisher;
 
 	void initializeAnalyticsCollection();
 	static void collectAnalytics(PoolPtr self);
@@ -288,6 +295,7 @@ public:
 	void prepareUnionStationSystemMetricsLogs(vector<UnionStationLogEntry> &logEntries,
 		const GroupPtr &group) const;
 	void realCollectAnalytics();
+	void publishMetrics();
 
 
 	/****** Garbage collection ******/
@@ -299,6 +307,12 @@ public:
 	};
 
 	boost::condition_variable garbageCollectionCond;
+	/**
+	 * The time (in microseconds) at which the garbage collector will run
+	 * next. It is lowered, and the garbage collector woken up, when a
+	 * request with an earlier deadline is queued.
+	 */
+	unsigned long long nextGcRunTime;
 
 	void initializeGarbageCollection();
 	static void garbageCollect(PoolPtr self);
@@ -308,6 +322,8 @@ public:
 	void garbageCollectProcessesInGroup(GarbageCollectorState &state,
 		const GroupPtr &group);
 	void maybeCleanPreloader(GarbageCollectorState &state, const GroupPtr &group);
+	void expireGetWaitersInGroup(GarbageCollectorState &state, const GroupPtr &group);
+	void expireTopLevelGetWaiters(GarbageCollectorState &state);
 	unsigned long long realGarbageCollect();
 	void wakeupGarbageCollector();
 
@@ -445,15 +461,20 @@ public:
 		bool lock = true) const;
 	string toXml(const ToXmlOptions &options = ToXmlOptions::makeAuthorized(),
 		bool lock = true) const;
+	Json::Value inspectSessionLatenciesAsJson(
+		const ToXmlOptions &options = ToXmlOptions::makeAuthorized(),
+		bool lock = true) const;
 
 
 	/****** Miscellaneous ******/
 
 	void asyncGet(const Options &options, const GetCallback &callback, bool lockNow = true, UnionStation::StopwatchLog **stopwatchLog = NULL);
+	bool cancelAsyncGet(const Options &options, const GetCallback &callback);
 	SessionPtr get(const Options &options, Ticket *ticket);
 	void setMax(unsigned int max);
 	void setMaxIdleTime(unsigned long long value);
 	void enableSelfChecking(bool enabled);
+	void setMetricsPublisher(MetricsRegistry::Publisher *publisher);
 	bool isSpawning(bool lock = true) const;
 	bool authorizeByApiKey(const ApiKey &key, bool lock = true) const;
 	bool authorizeByUid(uid_t uid, bool lock = true) const;
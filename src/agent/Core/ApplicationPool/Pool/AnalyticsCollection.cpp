@@ -38,6 +38,78 @@ using namespace std;
 using namespace boost;
 
 
+static const MetricsRegistry::Family POOL_CAPACITY_USED = {
+	"passenger_pool_capacity_used", MetricsRegistry::GAUGE,
+	"Number of processes that count towards the maximum pool size."
+};
+static const MetricsRegistry::Family POOL_MAX_SIZE = {
+	"passenger_pool_max_size", MetricsRegistry::GAUGE,
+	"Maximum number of processes in the pool."
+};
+static const MetricsRegistry::Family POOL_QUEUE_LENGTH = {
+	"passenger_pool_queue_length", MetricsRegistry::GAUGE,
+	"Number of requests waiting for pool capacity to start a new application."
+};
+static const MetricsRegistry::Family GROUP_PROCESSES = {
+	"passenger_group_processes", MetricsRegistry::GAUGE,
+	"Number of processes of the application."
+};
+static const MetricsRegistry::Family GROUP_PROCESSES_SPAWNING = {
+	"passenger_group_processes_spawning", MetricsRegistry::GAUGE,
+	"Number of processes of the application that are being spawned."
+};
+static const MetricsRegistry::Family GROUP_QUEUE_LENGTH = {
+	"passenger_group_queue_length", MetricsRegistry::GAUGE,
+	"Number of requests waiting for a process of the application."
+};
+static const MetricsRegistry::Family GROUP_SPAWNS = {
+	"passenger_group_spawns", MetricsRegistry::COUNTER,
+	"Number of processes of the application that were spawned."
+};
+static const MetricsRegistry::Family GROUP_SPAWN_ERRORS = {
+	"passenger_group_spawn_errors", MetricsRegistry::COUNTER,
+	"Number of failed attempts to spawn a process of the application."
+};
+static const MetricsRegistry::Family GROUP_REQUEST_QUEUE_TIMEOUTS = {
+	"passenger_group_request_queue_timeouts", MetricsRegistry::COUNTER,
+	"Number of requests that timed out while waiting for a process."
+};
+static const MetricsRegistry::Family PROCESS_SESSIONS = {
+	"passenger_process_sessions", MetricsRegistry::GAUGE,
+	"Number of open sessions of the process."
+};
+static const MetricsRegistry::Family PROCESS_BUSYNESS = {
+	"passenger_process_busyness", MetricsRegistry::GAUGE,
+	"Fraction of the process's concurrency that is in use."
+	" Always 0 for processes with unlimited concurrency."
+};
+static const MetricsRegistry::Family PROCESS_SESSIONS_OPENED = {
+	"passenger_process_sessions_opened", MetricsRegistry::COUNTER,
+	"Number of sessions that were opened on the process."
+};
+
+static void
+publishProcessMetrics(MetricsRegistry::Publisher *publisher,
+	const ProcessList &processes, const string &groupLabels, string &labels)
+{
+	foreach (const ProcessPtr &process, processes) {
+		char pid[sizeof(pid_t) * 3 + 1];
+		unsigned int size = uintToString(process->getPid(), pid, sizeof(pid));
+
+		labels = groupLabels;
+		MetricsRegistry::appendLabel(labels, "pid", StaticString(pid, size));
+		publisher->add(PROCESS_SESSIONS, labels, process->sessions);
+		if (process->getConcurrency() == 0) {
+			publisher->add(PROCESS_BUSYNESS, labels, 0);
+		} else {
+			publisher->add(PROCESS_BUSYNESS, labels,
+				process->sessions / (double) process->getConcurrency());
+		}
+		publisher->add(PROCESS_SESSIONS_OPENED, labels, process->processed);
+	}
+}
+
+
 void
 Pool::initializeAnalyticsCollection() {
 	interruptableThreads.create_thread(
@@ -53,6 +125,8 @@ Pool::collectAnalytics(PoolPtr self) {
 	syscalls::usleep(3000000);
 	while (!this_thread::interruption_requested()) {
 		try {
+			UPDATE_TRACE_POINT();
+			self->publishMetrics();
 			UPDATE_TRACE_POINT();
 			self->realCollectAnalytics();
 		} catch (const thread_interrupted &) {
@@ -77,6 +151,54 @@ Pool::collectAnalytics(PoolPtr self) {
 	}
 }
 
+/**
+ * Publishes a snapshot of the pool's metrics to `metricsPublisher`. Only
+ * holds the lock while copying the numbers, so that rendering the metrics
+ * doesn't need it at all.
+ */
+void
+Pool::publishMetrics() {
+	TRACE_POINT();
+	LockGuard l(syncher);
+	GroupMap::ConstIterator g_it(groups);
+	string groupLabels, labels;
+
+	if (metricsPublisher == NULL) {
+		return;
+	}
+
+	metricsPublisher->add(POOL_CAPACITY_USED, capacityUsedUnlocked());
+	metricsPublisher->add(POOL_MAX_SIZE, max);
+	metricsPublisher->add(POOL_QUEUE_LENGTH, getWaitlist.size());
+
+	while (*g_it != NULL) {
+		const GroupPtr &group = g_it.getValue();
+
+		groupLabels.clear();
+		MetricsRegistry::appendLabel(groupLabels, "app", group->getName());
+		metricsPublisher->add(GROUP_PROCESSES, groupLabels, group->getProcessCount());
+		metricsPublisher->add(GROUP_PROCESSES_SPAWNING, groupLabels,
+			group->processesBeingSpawned);
+		metricsPublisher->add(GROUP_QUEUE_LENGTH, groupLabels,
+			group->getWaitlist.size());
+		metricsPublisher->add(GROUP_SPAWNS, groupLabels, group->spawnsSucceeded);
+		metricsPublisher->add(GROUP_SPAWN_ERRORS, groupLabels, group->spawnsFailed);
+		metricsPublisher->add(GROUP_REQUEST_QUEUE_TIMEOUTS, groupLabels,
+			group->requestQueueTimeouts);
+
+		publishProcessMetrics(metricsPublisher, group->enabledProcesses,
+			groupLabels, labels);
+		publishProcessMetrics(metricsPublisher, group->disablingProcesses,
+			groupLabels, labels);
+		publishProcessMetrics(metricsPublisher, group->disabledProcesses,
+			groupLabels, labels);
+
+		g_it.next();
+	}
+
+	metricsPublisher->publish();
+}
+
 void
 Pool::collectPids(const ProcessList &processes, vector<pid_t> &pids) {
 	foreach (const ProcessPtr &process, processes) {
@@ -138,6 +138,46 @@ Pool::maybeCleanPreloader(GarbageCollectorState &state, const GroupPtr &group) {
 	}
 }
 
+void
+Pool::expireGetWaitersInGroup(GarbageCollectorState &state, const GroupPtr &group) {
+	if (!group->getWaitlist.empty()) {
+		group->expireGetWaiters(state.now, state.actions);
+		unsigned long long deadline = group->getEarliestGetWaiterDeadline();
+		if (deadline != 0) {
+			maybeUpdateNextGcRuntime(state, deadline);
+		}
+	}
+}
+
+/**
+ * Rejects requests in the top-level getWaitlist whose deadline has passed.
+ * Unlike requests in a Group's getWaitlist, these are not counted in any
+ * Group's request queue statistics, because their Group doesn't exist yet.
+ */
+void
+Pool::expireTopLevelGetWaiters(GarbageCollectorState &state) {
+	vector<GetWaiter>::iterator it = getWaitlist.begin();
+	while (it != getWaitlist.end()) {
+		if (it->deadline != 0 && it->deadline <= state.now) {
+			unsigned long long queueTime = (state.now > it->queuedAt)
+				? state.now - it->queuedAt
+				: 0;
+			P_DEBUG("Request for group " << it->options.getAppGroupName() <<
+				" could not be assigned a process before its deadline; rejecting it after " <<
+				(queueTime / 1000) << " msec in the top-level queue");
+			state.actions.push_back(boost::bind(GetCallback::call,
+				it->callback, SessionPtr(),
+				boost::make_shared<RequestQueueTimeoutException>(queueTime)));
+			it = getWaitlist.erase(it);
+		} else {
+			if (it->deadline != 0) {
+				maybeUpdateNextGcRuntime(state, it->deadline);
+			}
+			it++;
+		}
+	}
+}
+
 unsigned long long
 Pool::realGarbageCollect() {
 	TRACE_POINT();
@@ -164,11 +204,16 @@ Pool::realGarbageCollect() {
 		// ...cleanup the spawner if it's been idle for more than preloaderIdleTime.
 		maybeCleanPreloader(state, group);
 
+		// ...reject queued requests whose deadline has passed.
+		expireGetWaitersInGroup(state, group);
+
 		g_it.next();
 	}
 
+	// Reject requests in the top-level queue whose deadline has passed.
+	expireTopLevelGetWaiters(state);
+
 	verifyInvariants();
-	lock.unlock();
 
 	// Schedule next garbage collection run.
 	unsigned long long sleepTime;
@@ -181,6 +226,8 @@ Pool::realGarbageCollect() {
 	} else {
 		sleepTime = state.nextGcRunTime - state.now;
 	}
+	nextGcRunTime = state.now + sleepTime;
+	lock.unlock();
 	P_DEBUG("Garbage collection done; next garbage collect in " <<
 		std::fixed << std::setprecision(3) << (sleepTime / 1000000.0) << " sec");
 
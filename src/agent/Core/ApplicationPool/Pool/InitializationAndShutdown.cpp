@@ -40,7 +40,8 @@ using namespace boost;
 
 Pool::Pool(const SpawningKit::FactoryPtr &spawningKitFactory,
 	const VariantMap *agentsOptions)
-	: abortLongRunningConnectionsCallback(NULL)
+	: metricsPublisher(NULL),
+	  abortLongRunningConnectionsCallback(NULL)
 {
 	context.setSpawningKitFactory(spawningKitFactory);
 	context.finalize();
@@ -57,6 +58,7 @@ Pool::Pool(const SpawningKit::FactoryPtr &spawningKitFactory,
 	max          = 6;
 	maxIdleTime  = 60 * 1000000;
 	selfchecking = true;
+	nextGcRunTime = 0;
 	palloc       = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
 
 	// The following code only serve to instantiate certain inline methods
@@ -118,9 +118,21 @@ Pool::asyncGet(const Options &options, const GetCallback &callback, bool lockNow
 			 * become available.
 			 */
 			P_DEBUG("Could not free a process; putting request to top-level getWaitlist");
-			getWaitlist.push_back(GetWaiter(
+			unsigned long long now = (options.currentTime != 0)
+				? options.currentTime
+				: SystemTime::getUsec();
+			GetWaiter waiter(
 				options.copyAndPersist().detachFromUnionStationTransaction(),
-				callback));
+				callback, now, Group::calculateGetWaiterDeadline(options, now));
+			getWaitlist.push_back(waiter);
+			if (waiter.deadline != 0
+			 && (nextGcRunTime == 0 || waiter.deadline < nextGcRunTime))
+			{
+				// The garbage collector rejects this request if its
+				// deadline passes before capacity becomes available.
+				nextGcRunTime = waiter.deadline;
+				wakeupGarbageCollector();
+			}
 		} else {
 			/* Now that a process has been trashed we can create
 			 * the missing Group.
@@ -164,6 +176,50 @@ Pool::asyncGet(const Options &options, const GetCallback &callback, bool lockNow
 	}
 }
 
+/**
+ * Removes a request that was previously passed to `asyncGet()` from the
+ * wait lists, for example because its client has disconnected while the
+ * request was queued. If the request was still queued, then its callback
+ * is called with a GetAbortedException and true is returned. Otherwise,
+ * the callback has already been (or is about to be) called with the result
+ * of the `asyncGet()`, and false is returned.
+ */
+bool
+Pool::cancelAsyncGet(const Options &options, const GetCallback &callback) {
+	ScopedLock lock(syncher);
+	boost::container::vector<Callback> actions;
+	bool result = false;
+
+	assert(lifeStatus == ALIVE || lifeStatus == PREPARED_FOR_SHUTDOWN);
+	verifyInvariants();
+
+	Group *group = findMatchingGroup(options);
+	if (group != NULL) {
+		result = group->cancelGetWaiter(callback, actions);
+		group->verifyInvariants();
+	}
+
+	if (!result) {
+		vector<GetWaiter>::iterator it, end = getWaitlist.end();
+		for (it = getWaitlist.begin(); it != end; it++) {
+			if (it->isCallback(callback)) {
+				actions.push_back(boost::bind(GetCallback::call,
+					it->callback, SessionPtr(),
+					boost::make_shared<GetAbortedException>(
+						"The request was canceled while waiting in the queue")));
+				getWaitlist.erase(it);
+				result = true;
+				break;
+			}
+		}
+	}
+
+	verifyInvariants();
+	lock.unlock();
+	runAllActions(actions);
+	return result;
+}
+
 // TODO: 'ticket' should be a boost::shared_ptr for interruption-safety.
 SessionPtr
 Pool::get(const Options &options, Ticket *ticket) {
@@ -233,6 +289,16 @@ Pool::enableSelfChecking(bool enabled) {
 	selfchecking = enabled;
 }
 
+/**
+ * Makes the pool publish its metrics, such as process busyness and queue
+ * lengths, to the given publisher every few seconds. See publishMetrics().
+ */
+void
+Pool::setMetricsPublisher(MetricsRegistry::Publisher *publisher) {
+	LockGuard l(syncher);
+	metricsPublisher = publisher;
+}
+
 /**
  * Checks whether at least one process is being spawned.
  */
@@ -24,6 +24,7 @@
  *  THE SOFTWARE.
  */
 #include <Core/ApplicationPool/Pool.h>
+#include <Utils/JsonUtils.h>
 
 /*************************************************************************
  *
@@ -178,6 +179,34 @@ Pool::inspect(const InspectOptions &options, bool lock) const {
 			}
 		}
 		result << "  Requests in queue: " << group->getWaitlist.size() << endl;
+		if (group->sessionLatencies.getCount() > 0) {
+			LogHistogram sessionLatencies(group->sessionLatencies.snapshot());
+			result << "  Session latency: p50=" <<
+				(sessionLatencies.getPercentile(50) / 1000) << "ms, p99=" <<
+				(sessionLatencies.getPercentile(99) / 1000) << "ms, max=" <<
+				(sessionLatencies.getMax() / 1000) << "ms" << endl;
+		}
+		if (group->requestQueueTimes.getCount() > 0
+		 || group->requestQueueTimeouts > 0
+		 || group->requestQueueCancellations > 0)
+		{
+			result << "  Queue time: p50=" <<
+				(group->requestQueueTimes.getPercentile(50) / 1000) << "ms, p99=" <<
+				(group->requestQueueTimes.getPercentile(99) / 1000) << "ms, max=" <<
+				(group->requestQueueTimes.getMax() / 1000) << "ms, timed out: " <<
+				group->requestQueueTimeouts << ", canceled: " <<
+				group->requestQueueCancellations << endl;
+		}
+		if (group->concurrencyLimiter.isEnabled()) {
+			result << "  Concurrency limit per process: " <<
+				group->concurrencyLimiter.getLimit();
+			if (group->concurrencyLimiter.getSmoothedLatency() >= 0) {
+				result << " (latency: " <<
+					(unsigned long long) (group->concurrencyLimiter.getSmoothedLatency() / 1000) <<
+					"ms, target: " << group->options.targetLatency << "ms)";
+			}
+			result << endl;
+		}
 		inspectProcessList(options, result, group.get(), group->enabledProcesses);
 		inspectProcessList(options, result, group.get(), group->disablingProcesses);
 		inspectProcessList(options, result, group.get(), group->disabledProcesses);
@@ -195,6 +224,7 @@ Pool::toXml(const ToXmlOptions &options, bool lock) const {
 	stringstream result;
 	GroupMap::ConstIterator g_it(groups);
 	ProcessList::const_iterator p_it;
+	LogHistogram sessionLatencies;
 
 	if (!authorizeByUid(options.uid, false)
 	 && !authorizeByApiKey(options.apiKey, false))
@@ -249,15 +279,78 @@ Pool::toXml(const ToXmlOptions &options, bool lock) const {
 		result << "</group>";
 
 		result << "</supergroup>";
+		group->sessionLatencies.mergeInto(sessionLatencies);
 
 		g_it.next();
 	}
 	result << "</supergroups>";
 
+	result << "<session_latency>";
+	sessionLatencies.toXml(result);
+	result << "</session_latency>";
+
 	result << "</info>";
 	return result.str();
 }
 
+static void
+appendProcessSessionLatencies(Json::Value &doc, const ProcessList &processes) {
+	ProcessList::const_iterator it, end = processes.end();
+
+	for (it = processes.begin(); it != end; it++) {
+		const ProcessPtr &process = *it;
+		Json::Value subdoc = durationHistogramToJson(
+			process->sessionLatencies.snapshot());
+		subdoc["pid"] = (Json::Int) process->getPid();
+		doc.append(subdoc);
+	}
+}
+
+/**
+ * Returns the session latency percentiles of the pool, and of all the
+ * groups and processes that the caller is authorized to see, as JSON.
+ */
+Json::Value
+Pool::inspectSessionLatenciesAsJson(const ToXmlOptions &options, bool lock) const {
+	DynamicScopedLock l(syncher, lock);
+	GroupMap::ConstIterator g_it(groups);
+	Json::Value doc, groupsDoc(Json::objectValue);
+	LogHistogram sessionLatencies;
+
+	if (!authorizeByUid(options.uid, false)
+	 && !authorizeByApiKey(options.apiKey, false))
+	{
+		throw SecurityException("Operation unauthorized");
+	}
+
+	while (*g_it != NULL) {
+		const GroupPtr &group = g_it.getValue();
+		if (!group->authorizeByUid(options.uid)
+		 && !group->authorizeByApiKey(options.apiKey))
+		{
+			g_it.next();
+			continue;
+		}
+
+		Json::Value groupDoc = durationHistogramToJson(
+			group->sessionLatencies.snapshot());
+		Json::Value processesDoc(Json::arrayValue);
+		appendProcessSessionLatencies(processesDoc, group->enabledProcesses);
+		appendProcessSessionLatencies(processesDoc, group->disablingProcesses);
+		appendProcessSessionLatencies(processesDoc, group->disabledProcesses);
+		appendProcessSessionLatencies(processesDoc, group->detachedProcesses);
+		groupDoc["processes"] = processesDoc;
+		groupsDoc[group->getName().toString()] = groupDoc;
+		group->sessionLatencies.mergeInto(sessionLatencies);
+
+		g_it.next();
+	}
+
+	doc = durationHistogramToJson(sessionLatencies);
+	doc["groups"] = groupsDoc;
+	return doc;
+}
+
 
 unsigned int
 Pool::capacityUsed() const {
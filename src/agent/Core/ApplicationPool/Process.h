@@ -43,6 +43,7 @@
 #include <Constants.h>
 #include <FileDescriptor.h>
 #include <Logging.h>
+#include <Algorithms/Histogram.h>
 #include <Utils/SystemTime.h>
 #include <Utils/StrIntUtils.h>
 #include <Utils/Lock.h>
@@ -368,6 +369,10 @@ public:
 	int sessions;
 	/** Number of sessions opened so far. */
 	unsigned int processed;
+	/** How long, in microseconds, sessions on this process were open.
+	 * Recorded by the Group when a session is closed, without holding
+	 * the pool lock. */
+	AtomicLogHistogram sessionLatencies;
 	/** Do not access directly, always use `isAlive()`/`isDead()`/`getLifeStatus()` or
 	 * through `lifetimeSyncher`. */
 	enum LifeStatus {
@@ -700,6 +705,10 @@ public:
 		}
 	}
 
+	int getConcurrency() const {
+		return concurrency;
+	}
+
 	int busyness() const {
 		/* Different processes within a Group may have different
 		 * 'concurrency' values. We want:
@@ -760,7 +769,9 @@ public:
 			} else {
 				lastUsed = SystemTime::getUsec();
 			}
-			return createSessionObject(socket);
+			SessionPtr session = createSessionObject(socket);
+			session->startTime = lastUsed;
+			return session;
 		}
 	}
 
@@ -829,6 +840,9 @@ public:
 		stream << "<sessions>" << sessions << "</sessions>";
 		stream << "<busyness>" << busyness() << "</busyness>";
 		stream << "<processed>" << processed << "</processed>";
+		stream << "<session_latency>";
+		sessionLatencies.toXml(stream);
+		stream << "</session_latency>";
 		stream << "<spawner_creation_time>" << spawnerCreationTime << "</spawner_creation_time>";
 		stream << "<spawn_start_time>" << spawnStartTime << "</spawn_start_time>";
 		stream << "<spawn_end_time>" << spawnEndTime << "</spawn_end_time>";
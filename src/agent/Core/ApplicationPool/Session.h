@@ -33,6 +33,7 @@
 #include <oxt/backtrace.hpp>
 #include <Utils/ScopeGuard.h>
 #include <Utils/Lock.h>
+#include <Utils/SystemTime.h>
 #include <Core/ApplicationPool/Context.h>
 #include <Core/ApplicationPool/BasicProcessInfo.h>
 #include <Core/ApplicationPool/BasicGroupInfo.h>
@@ -117,6 +118,11 @@ private:
 public:
 	Callback onInitiateFailure;
 	Callback onClose;
+	/** The time at which this session was checked out, in microseconds. */
+	unsigned long long startTime;
+	/** The time at which the app began sending its response, in microseconds,
+	 * or 0 if it hasn't done so (yet). */
+	unsigned long long responseBegunTime;
 
 	Session(Context *_context, const BasicProcessInfo *_processInfo, Socket *_socket)
 		: context(_context),
@@ -125,7 +131,9 @@ public:
 		  refcount(1),
 		  closed(false),
 		  onInitiateFailure(NULL),
-		  onClose(NULL)
+		  onClose(NULL),
+		  startTime(0),
+		  responseBegunTime(0)
 		{ }
 
 	~Session() {
@@ -225,6 +233,13 @@ public:
 
 	virtual void requestOOBW();
 
+	virtual void responseBegun() {
+		assert(!closed);
+		if (responseBegunTime == 0) {
+			responseBegunTime = SystemTime::getUsec();
+		}
+	}
+
 
 	virtual void ref() const {
 		refcount.fetch_add(1, boost::memory_order_relaxed);
@@ -29,6 +29,10 @@
 #include <boost/thread.hpp>
 #include <string>
 #include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <oxt/system_calls.hpp>
+#include <Exceptions.h>
 #include <Utils/IOUtils.h>
 #include <Utils/BufferedIO.h>
 #include <Core/ApplicationPool/AbstractSession.h>
@@ -54,10 +58,31 @@ private:
 	SocketPair connection;
 	BufferedIO peerBufferedIO;
 	unsigned int stickySessionId;
+	size_t fillerSize;
+	bool fillSocketBuffer;
 	mutable bool closed;
 	mutable bool success;
 	mutable bool wantKeepAlive;
 
+	void fillKernelBuffer() {
+		char buf[1024];
+		ssize_t ret;
+
+		memset(buf, 'x', sizeof(buf));
+		setNonBlocking(connection.first);
+		do {
+			ret = syscalls::write(connection.first, buf, sizeof(buf));
+			if (ret > 0) {
+				fillerSize += ret;
+			}
+		} while (ret > 0);
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			int e = errno;
+			throw SystemException("Cannot fill socket buffer", e);
+		}
+		setBlocking(connection.first);
+	}
+
 public:
 	TestSession()
 		: refcount(1),
@@ -65,6 +90,8 @@ public:
 		  gupid("gupid-123"),
 		  protocol("session"),
 		  stickySessionId(0),
+		  fillerSize(0),
+		  fillSocketBuffer(false),
 		  closed(false),
 		  success(false),
 		  wantKeepAlive(false)
@@ -129,6 +156,21 @@ public:
 		stickySessionId = v;
 	}
 
+	/**
+	 * If enabled, `initiate()` fills the kernel socket buffer of the
+	 * Core side, so that the first write by the Core fails with EAGAIN.
+	 * The peer must read `getFillerSize()` bytes before the real data.
+	 */
+	void setFillSocketBufferOnInitiate(bool v) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		fillSocketBuffer = v;
+	}
+
+	size_t getFillerSize() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return fillerSize;
+	}
+
 	virtual const ApiKey &getApiKey() const {
 		return apiKey;
 	}
@@ -167,6 +209,9 @@ public:
 		boost::lock_guard<boost::mutex> l(syncher);
 		connection = createUnixSocketPair(__FILE__, __LINE__);
 		peerBufferedIO = BufferedIO(connection.second);
+		if (fillSocketBuffer) {
+			fillKernelBuffer();
+		}
 		if (!blocking) {
 			setNonBlocking(connection.first);
 		}
@@ -78,10 +78,15 @@
 #include <Utils/HttpConstants.h>
 #include <Utils/VariantMap.h>
 #include <Utils/Timer.h>
+#include <Utils/MetricsRegistry.h>
+#include <Algorithms/Histogram.h>
 #include <Core/ApplicationPool/ErrorRenderer.h>
 #include <Core/Controller/Client.h>
 #include <Core/Controller/AppResponse.h>
 #include <Core/Controller/TurboCaching.h>
+#include <Core/Controller/CgiHeaderNameCache.h>
+#include <Core/AccessLog.h>
+#include <Core/StaticFileCache.h>
 #include <Core/UnionStation/Context.h>
 
 namespace Passenger {
@@ -92,11 +97,6 @@ using namespace oxt;
 using namespace ApplicationPool2;
 
 
-namespace ServerKit {
-	extern const HashedStaticString HTTP_COOKIE;
-	extern const HashedStaticString HTTP_SET_COOKIE;
-}
-
 namespace Core {
 
 
@@ -122,18 +122,34 @@ private:
 	// If you change this value, make sure that Request::sessionCheckoutTry
 	// has enough bits.
 	static const unsigned int MAX_SESSION_CHECKOUT_TRY = 10;
+	// Each idle ResponseCompressor holds on to about 256 KB.
+	static const unsigned int MAX_FREE_COMPRESSORS = 8;
+	// Upper bound (in milliseconds) for the request queue deadline header.
+	static const unsigned int MAX_REQUEST_QUEUE_DEADLINE = 24 * 60 * 60 * 1000;
 
 	unsigned int statThrottleRate;
 	unsigned int responseBufferHighWatermark;
+	// Record phase timings for 1 in this many requests. 0 disables
+	// request timing and event loop lag measurement.
+	unsigned int requestTimingSampleRate;
+	unsigned int requestTimingCounter;
 	BenchmarkMode benchmarkMode: 3;
 	bool singleAppMode: 1;
 	bool showVersionInHeader: 1;
 	bool stickySessions: 1;
 	bool gracefulExit: 1;
+	// Whether to serve `<file>.gz` instead of a static file to clients
+	// that accept gzip.
+	bool staticFilesGzip: 1;
 
 	const VariantMap *agentsOptions;
 	psg_pool_t *stringPool;
 	StringKeyTable< boost::shared_ptr<Options> > poolOptionsCache;
+	// Static configuration headers of each web server location, as
+	// registered by the web server module at startup. Requests refer to
+	// them by index with `!~PASSENGER_CONFIG_ID`, so that the web server
+	// module doesn't have to send them with every request.
+	vector<ServerKit::HeaderTable> locationConfigs;
 
 	StaticString defaultRuby;
 	StaticString ustRouterAddress;
@@ -147,26 +163,23 @@ private:
 	StaticString defaultVaryTurbocacheByCookie;
 
 	HashedStaticString PASSENGER_APP_GROUP_NAME;
+	HashedStaticString PASSENGER_CONFIG_ID;
 	HashedStaticString PASSENGER_ENV_VARS;
 	HashedStaticString PASSENGER_MAX_REQUESTS;
 	HashedStaticString PASSENGER_SHOW_VERSION_IN_HEADER;
 	HashedStaticString PASSENGER_STICKY_SESSIONS;
 	HashedStaticString PASSENGER_STICKY_SESSIONS_COOKIE_NAME;
 	HashedStaticString PASSENGER_REQUEST_OOB_WORK;
+	HashedStaticString PASSENGER_REQUEST_QUEUE_PRIORITY;
 	HashedStaticString UNION_STATION_SUPPORT;
 	HashedStaticString REMOTE_ADDR;
 	HashedStaticString REMOTE_PORT;
 	HashedStaticString REMOTE_USER;
 	HashedStaticString FLAGS;
-	HashedStaticString HTTP_COOKIE;
-	HashedStaticString HTTP_DATE;
-	HashedStaticString HTTP_HOST;
-	HashedStaticString HTTP_CONTENT_LENGTH;
-	HashedStaticString HTTP_CONTENT_TYPE;
-	HashedStaticString HTTP_EXPECT;
-	HashedStaticString HTTP_CONNECTION;
-	HashedStaticString HTTP_STATUS;
-	HashedStaticString HTTP_TRANSFER_ENCODING;
+	// Name of the (lowercased) request header from which to read the number
+	// of milliseconds that the client is willing to wait for a process.
+	// Empty if not configured.
+	HashedStaticString requestQueueDeadlineHeader;
 
 	unsigned int threadNumber;
 	StaticString serverLogName;
@@ -175,17 +188,69 @@ private:
 	friend class ResponseCache<Request>;
 	struct ev_check checkWatcher;
 	TurboCaching<Request> turboCaching;
+	ResponseCompression<Request> responseCompression;
+	// Compressors of finished responses, kept for reuse.
+	vector<ResponseCompressor *> freeCompressors;
 
+	struct ev_prepare prepareWatcher;
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
-		struct ev_prepare prepareWatcher;
 		ev_tstamp timeBeforeBlocking;
 	#endif
 
+	/**
+	 * Per-phase timings of sampled requests, in microseconds:
+	 *
+	 *  - initialization: from request begin until session checkout begins.
+	 *    Includes request body buffering.
+	 *  - checkout: waiting for the ApplicationPool to give us a session.
+	 *  - sendRequestHeader: connecting to the app and sending the header.
+	 *  - app: waiting for the app to begin its response.
+	 *  - response: forwarding the response until the request ends.
+	 *  - total: from request begin until the request ends.
+	 *
+	 * Timestamps come from the event loop clock, so phases that complete
+	 * within a single event loop iteration are recorded as 0.
+	 */
+	struct {
+		LogHistogram initialization;
+		LogHistogram checkout;
+		LogHistogram sendRequestHeader;
+		LogHistogram app;
+		LogHistogram response;
+		LogHistogram total;
+	} requestTimings;
+	/**
+	 * How long, in microseconds, each event loop iteration spent processing
+	 * events before going back to polling. Events that arrive in the
+	 * meantime have to wait this long before they are handled.
+	 */
+	LogHistogram eventLoopLag;
+	ev_tstamp eventLoopIterationBegun;
+
+	// Shared by all Controllers. NULL if the access log is disabled.
+	AccessLog *accessLog;
+	AccessLogFormat accessLogFormat;
+	// Lines logged during the current event loop iteration. They are
+	// handed to `accessLog` in onEventLoopPrepare().
+	string accessLogBuffer;
+	unsigned int accessLogBufferLines;
+
+	// Serves files from the application's public directory without
+	// involving the application. NULL if disabled.
+	StaticFileCache *staticFiles;
+
+	CgiHeaderNameCache cgiHeaderNames;
+
+	// Receives a snapshot of this thread's metrics upon every statistics
+	// update. NULL if disabled.
+	MetricsRegistry::Publisher *metricsPublisher;
+
 
 	/****** Stage: initialize request ******/
 
 	struct RequestAnalysis;
 
+	void initializeLocationConfig(Client *client, Request *req);
 	void initializeFlags(Client *client, Request *req, RequestAnalysis &analysis);
 	bool respondFromTurboCache(Client *client, Request *req);
 	void initializePoolOptions(Client *client, Request *req, RequestAnalysis &analysis);
@@ -208,9 +273,21 @@ private:
 		const HashedStaticString &appGroupName);
 	void initializeUnionStation(Client *client, Request *req, RequestAnalysis &analysis);
 	void setStickySessionId(Client *client, Request *req);
+	void setRequestQueueDeadline(Client *client, Request *req);
 	const LString *getStickySessionCookieName(Request *req);
 
 
+	/****** Stage: serve static file ******/
+
+	bool serveStaticFile(Client *client, Request *req);
+	void redirectToStaticDirectory(Client *client, Request *req);
+	StaticFileCache::FilePtr lookupPrecompressedStaticFile(Request *req,
+		const StaticFileCache::FilePtr &file, bool &vary);
+	int checkStaticFilePreconditions(Request *req, const StaticFileCache::File &file,
+		boost::uint64_t &begin, boost::uint64_t &end);
+	void sendStaticFileBody(Client *client, Request *req);
+
+
 	/****** Stage: buffering body ******/
 
 	void beginBufferingBody(Client *client, Request *req);
@@ -222,6 +299,8 @@ private:
 	/****** Stage: checkout session ******/
 
 	void checkoutSession(Client *client, Request *req);
+	static GetCallback createSessionCheckoutCallback(Request *req);
+	void cancelSessionCheckout(Client *client, Request *req);
 	static void sessionCheckedOut(const AbstractSessionPtr &session,
 		const ExceptionPtr &e, void *userData);
 	void sessionCheckedOutFromAnotherThread(Client *client, Request *req,
@@ -235,6 +314,8 @@ private:
 		const ExceptionPtr &e);
 	void writeRequestQueueFullExceptionErrorResponse(Client *client,
 		Request *req, const boost::shared_ptr<RequestQueueFullException> &e);
+	void writeRequestQueueTimeoutExceptionErrorResponse(Client *client,
+		Request *req, const boost::shared_ptr<RequestQueueTimeoutException> &e);
 	void writeSpawnExceptionErrorResponse(Client *client, Request *req,
 		const boost::shared_ptr<SpawnException> &e);
 	void writeOtherExceptionErrorResponse(Client *client, Request *req,
@@ -252,10 +333,12 @@ private:
 	void sendHeaderToApp(Client *client, Request *req);
 	void sendHeaderToAppWithSessionProtocol(Client *client, Request *req);
 	static void sendBodyToAppWhenAppSinkIdle(Channel *_channel, unsigned int size);
-	unsigned int determineHeaderSizeForSessionProtocol(Request *req,
-		SessionProtocolWorkingState &state, string delta_monotonic);
-	bool constructHeaderForSessionProtocol(Request *req, char * restrict buffer,
-		unsigned int &size, const SessionProtocolWorkingState &state, string delta_monotonic);
+	void constructHeaderBuffersForSessionProtocol(Request *req,
+		SessionProtocolWorkingState &state, const string &deltaMonotonic);
+	bool sendHeaderToAppWithSessionProtocolAndWritev(Request *req,
+		const SessionProtocolWorkingState &state, ssize_t &bytesWritten);
+	void sendHeaderToAppWithSessionProtocolWithBuffering(Request *req,
+		const SessionProtocolWorkingState &state, unsigned int offset);
 	void sendHeaderToAppWithHttpProtocol(Client *client, Request *req);
 	bool constructHeaderBuffersForHttpProtocol(Request *req, struct iovec *buffers,
 		unsigned int maxbuffers, unsigned int & restrict_ref nbuffers,
@@ -309,6 +392,10 @@ private:
 		const MemoryKit::mbuf &buffer);
 	void markResponsePartForTurboCaching(Client *client, Request *req,
 		const MemoryKit::mbuf &buffer);
+	void prepareAppResponseCompression(Client *client, Request *req);
+	void writeCompressedResponse(Client *client, Request *req,
+		const char *data, size_t size, bool finish);
+	void releaseResponseCompressor(Request *req);
 	void maybeThrottleAppSource(Client *client, Request *req);
 	static void _outputBuffersFlushed(FileBufferedChannel *_channel);
 	void outputBuffersFlushed(Client *client, Request *req);
@@ -324,17 +411,27 @@ private:
 
 	static Channel::Result onBodyBufferData(Channel *_channel,
 		const MemoryKit::mbuf &buffer, int errcode);
-	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
-		static void onEventLoopPrepare(EV_P_ struct ev_prepare *w, int revents);
-	#endif
+	static void onEventLoopPrepare(EV_P_ struct ev_prepare *w, int revents);
 	static void onEventLoopCheck(EV_P_ struct ev_check *w, int revents);
 
 
+	/****** State inspection ******/
+
+	void publishMetrics();
+
+
 	/****** Internal utility functions ******/
 
 	static TurboCaching<Request>::State getTurboCachingInitialState(
 		const VariantMap *agentsOptions);
 	void generateServerLogName(unsigned int number);
+	void loadLocationConfigs();
+	void setRequestTimingSampleRate(unsigned int rate);
+	void updatePrepareWatcher();
+	bool shouldTimeRequest();
+	void recordRequestTimings(Request *req);
+	void logAccess(Request *req);
+	void submitAccessLogBuffer();
 	void disconnectWithClientSocketWriteError(Client **client, int e);
 	void disconnectWithAppSocketIncompleteResponseError(Client **client);
 	void disconnectWithAppSocketReadError(Client **client, int e);
@@ -383,12 +480,15 @@ protected:
 	virtual void onNextRequestEarlyReadError(Client *client, Request *req, int errcode);
 	virtual bool shouldDisconnectClientOnShutdown(Client *client);
 	virtual bool supportsUpgrade(Client *client, Request *req);
+	virtual void onUpdateStatistics();
 
 
 	/****** Marked virtual so that unit tests can mock these ******/
 
 	virtual void asyncGetFromApplicationPool(Request *req,
 		ApplicationPool2::GetCallback callback);
+	virtual void cancelAsyncGetFromApplicationPool(Request *req,
+		ApplicationPool2::GetCallback callback);
 
 
 public:
@@ -418,6 +518,9 @@ public:
 	virtual Json::Value inspectStateAsJson() const;
 	virtual Json::Value inspectClientStateAsJson(const Client *client) const;
 	virtual Json::Value inspectRequestStateAsJson(const Request *req) const;
+	void setAccessLog(AccessLog *log);
+	void enableStaticFiles(const StaticString &documentRoot, CachedFileStat *cstat);
+	void setMetricsPublisher(MetricsRegistry::Publisher *publisher);
 
 
 	/****** Miscellaneous *******/
@@ -0,0 +1,205 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_CORE_CGI_HEADER_NAME_CACHE_H_
+#define _PASSENGER_CORE_CGI_HEADER_NAME_CACHE_H_
+
+#include <boost/cstdint.hpp>
+#include <cstddef>
+#include <cstring>
+#include <MemoryKit/palloc.h>
+#include <DataStructures/LString.h>
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+
+
+/**
+ * Converts request header names to the CGI variable names that the session
+ * protocol sends them as: "user-agent" becomes "HTTP_USER_AGENT".
+ *
+ * Apps receive mostly the same few dozen headers with every request, so
+ * the converted names are cached in a small direct-mapped table that is
+ * indexed by the header's hash. The session protocol header builder can
+ * then refer to the cached name instead of converting it again.
+ *
+ * Names returned for a request stay valid until nextRequest() is called:
+ * entries that have been used for the current request are not evicted.
+ *
+ * Not thread-safe. Each Controller has its own cache.
+ */
+class CgiHeaderNameCache {
+public:
+	/** Number of entries. Must be a power of two. */
+	static const unsigned int SIZE = 64;
+	/** Longer names are converted every time. */
+	static const unsigned int MAX_KEY_SIZE = 48;
+	/** The size of the CGI name that a header name of size 0 results in:
+	 * "HTTP_" plus the NUL terminator. */
+	static const unsigned int OVERHEAD = sizeof("HTTP_");
+
+private:
+	struct Entry {
+		boost::uint32_t hash;
+		// The request that this entry was last returned for.
+		boost::uint32_t generation;
+		// 0 if the entry is empty.
+		boost::uint8_t keySize;
+		char key[MAX_KEY_SIZE];
+		char cgiName[MAX_KEY_SIZE + OVERHEAD];
+	};
+
+	Entry entries[SIZE];
+	boost::uint32_t generation;
+	unsigned int hits, misses;
+
+	static char *convert(const LString *key, char *output) {
+		memcpy(output, "HTTP_", sizeof("HTTP_") - 1);
+		char *pos = output + sizeof("HTTP_") - 1;
+		const LString::Part *part = key->start;
+		while (part != NULL) {
+			convertName((const unsigned char *) part->data,
+				(unsigned char *) pos, part->size);
+			pos += part->size;
+			part = part->next;
+		}
+		*pos = '\0';
+		return output;
+	}
+
+public:
+	CgiHeaderNameCache()
+		: generation(1),
+		  hits(0),
+		  misses(0)
+	{
+		for (unsigned int i = 0; i < SIZE; i++) {
+			entries[i].generation = 0;
+			entries[i].keySize = 0;
+		}
+	}
+
+	/**
+	 * Call this before looking up the names of the next request. Names
+	 * returned for previous requests may be evicted from now on.
+	 */
+	void nextRequest() {
+		generation++;
+	}
+
+	/**
+	 * Returns the NUL-terminated CGI name for the given lowercase header
+	 * name. Its size, including the NUL terminator, is `key->size + OVERHEAD`.
+	 * The result stays valid until nextRequest() is called, or until `pool`
+	 * is destroyed, whichever comes first.
+	 */
+	const char *lookup(const LString *key, boost::uint32_t hash, psg_pool_t *pool) {
+		if (key->size == 0 || key->size > MAX_KEY_SIZE || key->start != key->end) {
+			return convert(key, (char *) psg_pnalloc(pool, key->size + OVERHEAD));
+		}
+
+		Entry &entry = entries[hash & (SIZE - 1)];
+		if (entry.keySize == key->size && entry.hash == hash
+		 && memcmp(entry.key, key->start->data, key->size) == 0)
+		{
+			hits++;
+			entry.generation = generation;
+			return entry.cgiName;
+		}
+
+		misses++;
+		if (entry.generation == generation) {
+			// Another name of this request is using this entry.
+			return convert(key, (char *) psg_pnalloc(pool, key->size + OVERHEAD));
+		}
+		entry.hash = hash;
+		entry.generation = generation;
+		entry.keySize = key->size;
+		memcpy(entry.key, key->start->data, key->size);
+		return convert(key, entry.cgiName);
+	}
+
+	unsigned int getHits() const {
+		return hits;
+	}
+
+	unsigned int getMisses() const {
+		return misses;
+	}
+
+	/**
+	 * Converts `len` bytes of a header name to uppercase, and dashes to
+	 * underscores. Other bytes are copied unchanged. Processes 8 bytes
+	 * at a time, like convertLowerCase().
+	 */
+	static void convertName(const unsigned char *data, unsigned char *output, size_t len) {
+		const boost::uint64_t ONES = 0x0101010101010101ull;
+		const boost::uint64_t HIGH_BITS = 0x8080808080808080ull;
+		const boost::uint64_t LOW_BITS = 0x7f7f7f7f7f7f7f7full;
+		const unsigned char *end = data + len;
+
+		while (end - data >= 8) {
+			boost::uint64_t word, low, isLower, y, isDash;
+
+			// memcpy() compiles to a single load or store, without
+			// violating strict aliasing.
+			memcpy(&word, data, 8);
+			low = word & LOW_BITS;
+
+			// The high bit of each byte in `isLower` is set if that byte is
+			// in 'a'..'z'. `low` plus these constants never carries into the
+			// next byte.
+			isLower = ((low + ONES * (0x80 - 'a')) ^ (low + ONES * (0x7f - 'z')))
+				& ~word & HIGH_BITS;
+
+			// The high bit of each byte in `isDash` is set if that byte is '-'.
+			y = word ^ (ONES * '-');
+			isDash = ~(((y & LOW_BITS) + LOW_BITS) | y) & HIGH_BITS;
+
+			word = word - (isLower >> 2) + (isDash >> 7) * ('_' - '-');
+			memcpy(output, &word, 8);
+			data += 8;
+			output += 8;
+		}
+
+		while (data < end) {
+			unsigned char ch = *data++;
+			if (ch >= 'a' && ch <= 'z') {
+				ch -= 'a' - 'A';
+			} else if (ch == '-') {
+				ch = '_';
+			}
+			*output++ = ch;
+		}
+	}
+};
+
+
+} // namespace Core
+} // namespace Passenger
+
+#endif /* _PASSENGER_CORE_CGI_HEADER_NAME_CACHE_H_ */
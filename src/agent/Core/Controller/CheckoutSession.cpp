@@ -48,7 +48,7 @@ using namespace boost;
 
 void
 Controller::checkoutSession(Client *client, Request *req) {
-	GetCallback callback;
+	GetCallback callback = createSessionCheckoutCallback(req);
 	Options &options = req->options;
 
 	CC_BENCHMARK_POINT(client, req, BM_BEFORE_CHECKOUT);
@@ -61,12 +61,13 @@ Controller::checkoutSession(Client *client, Request *req) {
 		assert(!req->bodyChannel.isStarted());
 	}
 
-	callback.func = sessionCheckedOut;
-	callback.userData = req;
-
 	options.currentTime = SystemTime::getUsec();
 
 	refRequest(req, __FILE__, __LINE__);
+	req->waitingForSession = true;
+	if (OXT_UNLIKELY(req->timed) && req->timings.checkoutBegun == 0) {
+		req->timings.checkoutBegun = ev_now(getLoop());
+	}
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		req->timeBeforeAccessingApplicationPool = ev_now(getLoop());
 	#endif
@@ -81,6 +82,28 @@ Controller::checkoutSession(Client *client, Request *req) {
 	#endif
 }
 
+GetCallback
+Controller::createSessionCheckoutCallback(Request *req) {
+	GetCallback callback;
+	callback.func = sessionCheckedOut;
+	callback.userData = req;
+	return callback;
+}
+
+/**
+ * Called when a request ends while it may still be waiting in one of the
+ * ApplicationPool's queues, e.g. because the client disconnected. Removes
+ * the request from the queue so that it doesn't occupy a process that
+ * becomes available later.
+ */
+void
+Controller::cancelSessionCheckout(Client *client, Request *req) {
+	SKC_DEBUG(client, "Request ended while waiting for a session; "
+		"removing it from the application pool queue");
+	req->waitingForSession = false;
+	cancelAsyncGetFromApplicationPool(req, createSessionCheckoutCallback(req));
+}
+
 void
 Controller::asyncGetFromApplicationPool(Request *req, ApplicationPool2::GetCallback callback) {
 	appPool->asyncGet(req->options, callback, true,
@@ -89,6 +112,13 @@ Controller::asyncGetFromApplicationPool(Request *req, ApplicationPool2::GetCallb
 		: NULL);
 }
 
+void
+Controller::cancelAsyncGetFromApplicationPool(Request *req,
+	ApplicationPool2::GetCallback callback)
+{
+	appPool->cancelAsyncGet(req->options, callback);
+}
+
 void
 Controller::sessionCheckedOut(const AbstractSessionPtr &session, const ExceptionPtr &e,
 	void *userData)
@@ -120,9 +150,13 @@ void
 Controller::sessionCheckedOutFromEventLoopThread(Client *client, Request *req,
 	const AbstractSessionPtr &session, const ExceptionPtr &e)
 {
+	req->waitingForSession = false;
 	if (req->ended()) {
 		return;
 	}
+	if (OXT_UNLIKELY(req->timed)) {
+		req->timings.sessionCheckedOut = ev_now(getLoop());
+	}
 
 	TRACE_POINT();
 	CC_BENCHMARK_POINT(client, req, BM_AFTER_CHECKOUT);
@@ -157,7 +191,7 @@ Controller::maybeSend100Continue(Client *client, Request *req) {
 	if (httpVersion >= 1010 && req->hasBody() && !req->strip100ContinueHeader) {
 		// Apps with the "session" protocol don't respond with 100-Continue,
 		// so we do it for them.
-		const LString *value = req->headers.lookup(HTTP_EXPECT);
+		const LString *value = req->headers.lookup(ServerKit::KH_EXPECT);
 		if (value != NULL
 		 && psg_lstr_cmp(value, P_STATIC_STRING("100-continue"))
 		 && req->session->getProtocol() == P_STATIC_STRING("session"))
@@ -241,6 +275,14 @@ Controller::reportSessionCheckoutError(Client *client, Request *req,
 			return;
 		}
 	}
+	{
+		boost::shared_ptr<RequestQueueTimeoutException> e2 =
+			dynamic_pointer_cast<RequestQueueTimeoutException>(e);
+		if (e2 != NULL) {
+			writeRequestQueueTimeoutExceptionErrorResponse(client, req, e2);
+			return;
+		}
+	}
 	{
 		boost::shared_ptr<SpawnException> e2 = dynamic_pointer_cast<SpawnException>(e);
 		if (e2 != NULL) {
@@ -256,7 +298,7 @@ Controller::writeRequestQueueFullExceptionErrorResponse(Client *client, Request
 	const boost::shared_ptr<RequestQueueFullException> &e)
 {
 	TRACE_POINT();
-	const LString *value = req->secureHeaders.lookup(
+	const LString *value = req->lookupSecureHeader(
 		"!~PASSENGER_REQUEST_QUEUE_OVERFLOW_STATUS_CODE");
 	int requestQueueOverflowStatusCode = 503;
 	if (value != NULL && value->size > 0) {
@@ -275,6 +317,20 @@ Controller::writeRequestQueueFullExceptionErrorResponse(Client *client, Request
 		requestQueueOverflowStatusCode);
 }
 
+void
+Controller::writeRequestQueueTimeoutExceptionErrorResponse(Client *client, Request *req,
+	const boost::shared_ptr<RequestQueueTimeoutException> &e)
+{
+	TRACE_POINT();
+	SKC_WARN(client, "Returning HTTP 504 due to: " << e->what());
+
+	endRequestWithSimpleResponse(&client, &req,
+		"<h2>This website is under heavy load (queue timeout)</h2>"
+		"<p>We're sorry, this website could not handle your request in time. "
+		"We're working on this problem. Please try again later.</p>",
+		504);
+}
+
 void
 Controller::writeSpawnExceptionErrorResponse(Client *client, Request *req,
 	const boost::shared_ptr<SpawnException> &e)
@@ -208,7 +208,7 @@ Controller::onAppSourceData(Client *client, Request *req, const MemoryKit::mbuf
 				.feed(buffer));
 			resp->bodyAlreadyRead += event.consumed;
 
-			if (req->dechunkResponse) {
+			if (req->dechunkResponse || req->compressor != NULL) {
 				UPDATE_TRACE_POINT();
 				switch (event.type) {
 				case ServerKit::HttpChunkedEvent::NONE:
@@ -297,6 +297,9 @@ Controller::onAppSourceData(Client *client, Request *req, const MemoryKit::mbuf
 			SKC_TRACE(client, 2, "Application sent EOF");
 			SKC_TRACE(client, 2, "Not keep-aliving application session connection");
 			req->session->close(true, false);
+			if (req->compressor != NULL) {
+				writeCompressedResponse(client, req, NULL, 0, true);
+			}
 			endRequest(&client, &req);
 			return Channel::Result(0, false);
 		} else {
@@ -319,6 +322,12 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 	ssize_t bytesWritten;
 	bool oobw;
 
+	if (OXT_UNLIKELY(req->timed)) {
+		req->timings.responseBegun = ev_now(getLoop());
+	}
+	req->session->responseBegun();
+	req->responseStatus = resp->statusCode;
+
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		req->timeOnRequestHeaderSent = ev_now(getLoop());
 		reportLargeTimeDiff(client,
@@ -329,8 +338,8 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 
 	// Localize hash table operations for better CPU caching.
 	oobw = resp->secureHeaders.lookup(PASSENGER_REQUEST_OOB_WORK) != NULL;
-	resp->date = resp->headers.lookup(HTTP_DATE);
-	resp->setCookie = resp->headers.lookup(ServerKit::HTTP_SET_COOKIE);
+	resp->date = resp->headers.lookup(ServerKit::KH_DATE);
+	resp->setCookie = resp->headers.lookup(ServerKit::KH_SET_COOKIE);
 	if (resp->setCookie != NULL) {
 		// Move the Set-Cookie header from resp->headers to resp->setCookie;
 		// remove Set-Cookie from resp->headers without deallocating it.
@@ -342,23 +351,23 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 
 		P_ASSERT_EQ(resp->setCookie->size, 0);
 		psg_lstr_append(resp->setCookie, req->pool, "x", 1);
-		resp->headers.erase(ServerKit::HTTP_SET_COOKIE);
+		resp->headers.erase(ServerKit::KH_SET_COOKIE);
 
 		resp->setCookie = copy;
 	}
-	resp->headers.erase(HTTP_CONNECTION);
-	resp->headers.erase(HTTP_STATUS);
+	resp->headers.erase(ServerKit::KH_CONNECTION);
+	resp->headers.erase(ServerKit::KH_STATUS);
 	if (resp->bodyType == AppResponse::RBT_CONTENT_LENGTH) {
-		resp->headers.erase(HTTP_CONTENT_LENGTH);
+		resp->headers.erase(ServerKit::KH_CONTENT_LENGTH);
 	}
 	if (resp->bodyType == AppResponse::RBT_CHUNKED) {
-		resp->headers.erase(HTTP_TRANSFER_ENCODING);
+		resp->headers.erase(ServerKit::KH_TRANSFER_ENCODING);
 		if (req->dechunkResponse) {
 			req->wantKeepAlive = false;
 		}
 	}
-	if (resp->headers.lookup(ServerKit::HTTP_X_SENDFILE) != NULL
-	 || resp->headers.lookup(ServerKit::HTTP_X_ACCEL_REDIRECT) != NULL)
+	if (resp->headers.lookup(ServerKit::KH_X_SENDFILE) != NULL
+	 || resp->headers.lookup(ServerKit::KH_X_ACCEL_REDIRECT) != NULL)
 	{
 		// If X-Sendfile or X-Accel-Redirect is set, then HttpHeaderParser
 		// treats the app response as having no body, and removes the
@@ -369,6 +378,7 @@ Controller::onAppResponseBegin(Client *client, Request *req) {
 	}
 
 	prepareAppResponseCaching(client, req);
+	prepareAppResponseCompression(client, req);
 
 	if (OXT_UNLIKELY(oobw)) {
 		SKC_TRACE(client, 2, "Response with OOBW detected");
@@ -674,7 +684,12 @@ Controller::constructHeaderBuffersForResponse(Request *req, struct iovec *buffer
 
 	nCacheableBuffers = i;
 
-	if (resp->bodyType == AppResponse::RBT_CONTENT_LENGTH) {
+	if (req->compressor != NULL) {
+		// The compressed body size is not known in advance.
+		if (req->chunkCompressedResponse) {
+			PUSH_STATIC_BUFFER("Transfer-Encoding: chunked\r\n");
+		}
+	} else if (resp->bodyType == AppResponse::RBT_CONTENT_LENGTH) {
 		PUSH_STATIC_BUFFER("Content-Length: ");
 		if (buffers != NULL) {
 			BEGIN_PUSH_NEXT_BUFFER();
@@ -813,6 +828,20 @@ Controller::sendResponseHeaderWithWritev(Client *client, Request *req,
 		return true;
 	}
 
+	if (client->outputCorked
+	 || client->output.getTotalBytesBuffered() > 0
+	 || client->output.getState() != Channel::IDLE)
+	{
+		// The responses to earlier pipelined requests haven't been
+		// written out completely yet: either they're still buffered,
+		// or the channel is waiting for the socket to become writable.
+		// Writing to the socket directly would put this header in
+		// front of them.
+		SKC_TRACE(client, 2, "Client output is not empty; not using writev()");
+		bytesWritten = 0;
+		return false;
+	}
+
 	unsigned int maxbuffers = std::min<unsigned int>(
 		8 + req->appResponse.headers.size() * 4 + 11, IOV_MAX);
 	struct iovec *buffers = (struct iovec *) psg_palloc(req->pool,
@@ -983,6 +1012,10 @@ void
 Controller::writeResponseAndMarkForTurboCaching(Client *client, Request *req,
 	const MemoryKit::mbuf &buffer)
 {
+	if (req->compressor != NULL) {
+		writeCompressedResponse(client, req, buffer.start, buffer.size(), false);
+		return;
+	}
 	if (OXT_LIKELY(benchmarkMode != BM_RESPONSE_BEGIN)) {
 		writeResponse(client, buffer);
 	}
@@ -1010,6 +1043,123 @@ Controller::markResponsePartForTurboCaching(Client *client, Request *req,
 	}
 }
 
+void
+Controller::prepareAppResponseCompression(Client *client, Request *req) {
+	if (req->acceptedEncoding == ResponseCompressor::IDENTITY
+	 || OXT_UNLIKELY(benchmarkMode == BM_RESPONSE_BEGIN)
+	 || !responseCompression.responseAllowsCompression(req))
+	{
+		return;
+	}
+
+	TRACE_POINT();
+	ResponseCompressor *compressor;
+	if (freeCompressors.empty()) {
+		compressor = new ResponseCompressor();
+	} else {
+		compressor = freeCompressors.back();
+		freeCompressors.pop_back();
+	}
+	try {
+		compressor->reset((ResponseCompressor::Encoding) req->acceptedEncoding,
+			responseCompression.getLevel());
+	} catch (const std::bad_alloc &) {
+		SKC_WARN(client, "Not enough memory to compress the response; "
+			"sending it uncompressed");
+		delete compressor;
+		return;
+	}
+
+	SKC_TRACE(client, 2, "Compressing response with " <<
+		ResponseCompressor::getEncodingName(compressor->getEncoding()));
+	req->compressor = compressor;
+	responseCompression.prepareResponseHeaders(req);
+
+	unsigned int httpVersion = req->httpMajor * 1000 + req->httpMinor * 10;
+	if (httpVersion >= 1010 && req->wantKeepAlive) {
+		req->chunkCompressedResponse = true;
+	} else {
+		req->wantKeepAlive = false;
+	}
+}
+
+/**
+ * Compresses app response body data and writes it to the client. If `finish`
+ * is true, then the compressed stream is ended. The compressed data is
+ * written in mbufs which have room for the chunked framing around it, so
+ * that every chunk is written with a single mbuf.
+ */
+void
+Controller::writeCompressedResponse(Client *client, Request *req,
+	const char *data, size_t size, bool finish)
+{
+	const unsigned int CHUNK_HEADER_SPACE  = sizeof("ffffffff\r\n") - 1;
+	const unsigned int CHUNK_TRAILER_SPACE = sizeof("\r\n0\r\n\r\n") - 1;
+	MemoryKit::mbuf_pool &mbuf_pool = getContext()->mbuf_pool;
+	const unsigned int MBUF_MAX_SIZE = mbuf_pool_data_size(&mbuf_pool);
+	ResponseCompressor *compressor = req->compressor;
+	bool done = false;
+	int flush;
+
+	if (finish) {
+		flush = Z_FINISH;
+	} else if (req->appResponse.bodyType == AppResponse::RBT_CONTENT_LENGTH) {
+		// Let zlib gather enough data for good compression. All data
+		// is flushed once the body ends.
+		flush = Z_NO_FLUSH;
+	} else {
+		// The app may be streaming, so don't hold on to data until
+		// the app sends more.
+		flush = Z_SYNC_FLUSH;
+	}
+
+	while (!done) {
+		MemoryKit::mbuf buffer(MemoryKit::mbuf_get(&mbuf_pool));
+		char *begin = buffer.start + CHUNK_HEADER_SPACE;
+		char *end = begin + compressor->compress(data, size, begin,
+			MBUF_MAX_SIZE - CHUNK_HEADER_SPACE - CHUNK_TRAILER_SPACE,
+			flush, done);
+
+		if (end > begin) {
+			markResponsePartForTurboCaching(client, req,
+				MemoryKit::mbuf(buffer, begin - buffer.start, end - begin));
+		}
+
+		if (req->chunkCompressedResponse) {
+			if (end > begin) {
+				unsigned int chunkSize = end - begin;
+				unsigned int hexSize = integerSizeInOtherBase<unsigned int, 16>(chunkSize);
+				begin -= hexSize + 2;
+				integerToOtherBase<unsigned int, 16>(chunkSize, begin, hexSize + 1);
+				begin[hexSize] = '\r';
+				begin[hexSize + 1] = '\n';
+				end = appendData(end, buffer.end, "\r\n", 2);
+			}
+			if (finish && done) {
+				end = appendData(end, buffer.end, "0\r\n\r\n", 5);
+			}
+		}
+
+		if (end > begin) {
+			writeResponse(client, MemoryKit::mbuf(buffer, begin - buffer.start,
+				end - begin));
+			if (req->ended()) {
+				return;
+			}
+		}
+	}
+}
+
+void
+Controller::releaseResponseCompressor(Request *req) {
+	if (freeCompressors.size() < MAX_FREE_COMPRESSORS) {
+		freeCompressors.push_back(req->compressor);
+	} else {
+		delete req->compressor;
+	}
+	req->compressor = NULL;
+}
+
 void
 Controller::maybeThrottleAppSource(Client *client, Request *req) {
 	if (!req->ended()) {
@@ -1070,16 +1220,28 @@ Controller::_outputDataFlushed(FileBufferedChannel *_channel) {
 
 void
 Controller::outputDataFlushed(Client *client, Request *req) {
-	if (!req->ended()) {
+	if (req->ended()) {
+		return;
+	}
+	client->output.setDataFlushedCallback(getClientOutputDataFlushedCallback());
+	if (req->state == Request::SERVING_STATIC_FILE) {
+		SKC_TRACE(client, 2, "The client is ready to receive more data. Resuming static file");
+		sendStaticFileBody(client, req);
+	} else {
 		assert(!req->appSource.isStarted());
 		SKC_TRACE(client, 2, "The client is ready to receive more data. Resuming application socket");
-		client->output.setDataFlushedCallback(getClientOutputDataFlushedCallback());
 		req->appSource.start();
 	}
 }
 
 void
 Controller::handleAppResponseBodyEnd(Client *client, Request *req) {
+	if (req->compressor != NULL) {
+		writeCompressedResponse(client, req, NULL, 0, true);
+		if (req->ended()) {
+			return;
+		}
+	}
 	keepAliveAppConnection(client, req);
 	storeAppResponseInTurboCache(client, req);
 	finalizeUnionStationWithSuccess(client, req);
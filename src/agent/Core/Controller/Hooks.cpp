@@ -60,14 +60,25 @@ Controller::onBodyBufferData(Channel *_channel, const MemoryKit::mbuf &buffer, i
 	return self->whenSendingRequest_onRequestBody(client, req, buffer, errcode);
 }
 
-#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
-	void
-	Controller::onEventLoopPrepare(EV_P_ struct ev_prepare *w, int revents) {
-		Controller *self = static_cast<Controller *>(w->data);
+void
+Controller::onEventLoopPrepare(EV_P_ struct ev_prepare *w, int revents) {
+	Controller *self = static_cast<Controller *>(w->data);
+	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		ev_now_update(EV_A);
 		self->timeBeforeBlocking = ev_now(EV_A);
+	#endif
+	if (self->eventLoopIterationBegun != 0) {
+		ev_tstamp now = ev_time();
+		if (now >= self->eventLoopIterationBegun) {
+			self->eventLoopLag.record((boost::uint64_t)
+				((now - self->eventLoopIterationBegun) * 1000000));
+		}
+		self->eventLoopIterationBegun = 0;
 	}
-#endif
+	if (self->accessLogBufferLines > 0) {
+		self->submitAccessLogBuffer();
+	}
+}
 
 void
 Controller::onEventLoopCheck(EV_P_ struct ev_check *w, int revents) {
@@ -77,6 +88,10 @@ Controller::onEventLoopCheck(EV_P_ struct ev_check *w, int revents) {
 		self->reportLargeTimeDiff(NULL, "Event loop slept",
 			self->timeBeforeBlocking, ev_now(EV_A));
 	#endif
+	if (self->requestTimingSampleRate != 0) {
+		// libev has just updated its clock after polling.
+		self->eventLoopIterationBegun = ev_now(EV_A);
+	}
 }
 
 
@@ -129,11 +144,18 @@ Controller::reinitializeRequest(Client *client, Request *req) {
 	req->requestBodyBuffering = false;
 	req->https = false;
 	req->stickySession = false;
+	req->locationConfig = NULL;
 	req->sessionCheckoutTry = 0;
 	req->halfClosePolicy = Request::HALF_CLOSE_POLICY_UNINITIALIZED;
 	req->appResponseInitialized = false;
 	req->strip100ContinueHeader = false;
 	req->hasPragmaHeader = false;
+	req->waitingForSession = false;
+	req->timed = false;
+	req->timingSampled = false;
+	req->turboCacheHit = false;
+	req->acceptedEncoding = ResponseCompressor::IDENTITY;
+	req->chunkCompressedResponse = false;
 	req->host = NULL;
 	req->bodyBytesBuffered = 0;
 	req->cacheKey = HashedStaticString();
@@ -153,6 +175,19 @@ Controller::reinitializeRequest(Client *client, Request *req) {
 
 void
 Controller::deinitializeRequest(Client *client, Request *req) {
+	if (OXT_UNLIKELY(req->waitingForSession)) {
+		cancelSessionCheckout(client, req);
+	}
+	if (OXT_UNLIKELY(req->timingSampled)) {
+		recordRequestTimings(req);
+	}
+	if (accessLog != NULL) {
+		logAccess(req);
+	}
+	if (req->compressor != NULL) {
+		releaseResponseCompressor(req);
+	}
+	req->staticFile.reset();
 	req->session.reset();
 
 	req->endStopwatchLog(&req->stopwatchLogs.getFromPool, false);
@@ -272,6 +307,14 @@ Controller::onNextRequestEarlyReadError(Client *client, Request *req, int errcod
 	}
 }
 
+void
+Controller::onUpdateStatistics() {
+	ParentClass::onUpdateStatistics();
+	if (metricsPublisher != NULL) {
+		publishMetrics();
+	}
+}
+
 bool
 Controller::shouldDisconnectClientOnShutdown(Client *client) {
 	return ParentClass::shouldDisconnectClientOnShutdown(client) || !gracefulExit;
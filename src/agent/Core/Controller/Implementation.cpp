@@ -26,6 +26,7 @@
 
 #include <Core/Controller.h>
 #include <Core/Controller/InitRequest.cpp>
+#include <Core/Controller/ServeStaticFile.cpp>
 #include <Core/Controller/BufferBody.cpp>
 #include <Core/Controller/CheckoutSession.cpp>
 #include <Core/Controller/SendRequest.cpp>
@@ -48,11 +48,34 @@ using namespace boost;
 
 struct Controller::RequestAnalysis {
 	const LString *flags;
-	ServerKit::HeaderTable::Cell *appGroupNameCell;
+	const LString *appGroupName;
 	bool unionStationSupport;
 };
 
 
+/**
+ * If the web server module refers to a location configuration that it
+ * registered at startup, then make its headers available through
+ * Request::lookupSecureHeader().
+ */
+void
+Controller::initializeLocationConfig(Client *client, Request *req) {
+	const LString *value = req->secureHeaders.lookup(PASSENGER_CONFIG_ID);
+	if (value == NULL || value->size == 0) {
+		return;
+	}
+
+	value = psg_lstr_make_contiguous(value, req->pool);
+	unsigned int id = stringToUint(StaticString(value->start->data, value->size));
+	if (id < locationConfigs.size()) {
+		req->locationConfig = &locationConfigs[id];
+	} else {
+		disconnectWithError(&client, "the !~PASSENGER_CONFIG_ID header refers to "
+			"an unknown configuration");
+	}
+}
+
+
 void
 Controller::initializeFlags(Client *client, Request *req, RequestAnalysis &analysis) {
 	if (analysis.flags != NULL) {
@@ -115,6 +138,8 @@ Controller::respondFromTurboCache(Client *client, Request *req) {
 		if (entry.valid()) {
 			SKC_TRACE(client, 2, "Turbocaching: cache hit (key \"" <<
 				cEscapeString(req->cacheKey) << "\")");
+			req->turboCacheHit = true;
+			req->responseStatus = entry.body->httpStatusCode;
 			turboCaching.writeResponse(this, client, req, entry);
 			if (!req->ended()) {
 				endRequest(&client, &req);
@@ -141,10 +166,9 @@ Controller::initializePoolOptions(Client *client, Request *req, RequestAnalysis
 		poolOptionsCache.lookupRandom(NULL, &options);
 		req->options = **options;
 	} else {
-		ServerKit::HeaderTable::Cell *appGroupNameCell = analysis.appGroupNameCell;
-		if (appGroupNameCell != NULL && appGroupNameCell->header->val.size > 0) {
+		if (analysis.appGroupName != NULL && analysis.appGroupName->size > 0) {
 			const LString *appGroupName = psg_lstr_make_contiguous(
-				&appGroupNameCell->header->val,
+				analysis.appGroupName,
 				req->pool);
 			HashedStaticString hAppGroupName(appGroupName->start->data,
 				appGroupName->size);
@@ -164,7 +188,7 @@ Controller::initializePoolOptions(Client *client, Request *req, RequestAnalysis
 	if (!req->ended()) {
 		// See comment for req->envvars to learn how it is different
 		// from req->options.environmentVariables.
-		req->envvars = req->secureHeaders.lookup(PASSENGER_ENV_VARS);
+		req->envvars = req->lookupSecureHeader(PASSENGER_ENV_VARS);
 		if (req->envvars != NULL && req->envvars->size > 0) {
 			req->envvars = psg_lstr_make_contiguous(req->envvars, req->pool);
 			req->options.environmentVariables = StaticString(
@@ -173,6 +197,9 @@ Controller::initializePoolOptions(Client *client, Request *req, RequestAnalysis
 		}
 
 		fillPoolOption(req, req->options.maxRequests, PASSENGER_MAX_REQUESTS);
+		fillPoolOption(req, req->options.requestQueuePriority,
+			PASSENGER_REQUEST_QUEUE_PRIORITY);
+		setRequestQueueDeadline(client, req);
 	}
 }
 
@@ -208,6 +235,8 @@ Controller::fillPoolOptionsFromAgentsOptions(Options &options) {
 	options.minProcesses = agentsOptions->getInt("min_instances");
 	options.maxPreloaderIdleTime = agentsOptions->getInt("max_preloader_idle_time");
 	options.maxRequestQueueSize = agentsOptions->getInt("max_request_queue_size");
+	options.maxRequestQueueTime = agentsOptions->getUint("max_request_queue_time", false, 0);
+	options.targetLatency = agentsOptions->getUint("target_latency", false, 0);
 	options.abortWebsocketsOnProcessShutdown = agentsOptions->getBool("abort_websockets_on_process_shutdown");
 	options.forceMaxConcurrentRequestsPerProcess = agentsOptions->getInt("force_max_concurrent_requests_per_process");
 	options.spawnMethod = agentsOptions->get("spawn_method");
@@ -221,7 +250,7 @@ void
 Controller::fillPoolOption(Request *req, StaticString &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = StaticString(value->start->data, value->size);
@@ -232,7 +261,7 @@ void
 Controller::fillPoolOption(Request *req, bool &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		field = psg_lstr_first_byte(value) == 't';
 	}
@@ -242,7 +271,7 @@ void
 Controller::fillPoolOption(Request *req, int &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = stringToInt(StaticString(value->start->data, value->size));
@@ -253,7 +282,7 @@ void
 Controller::fillPoolOption(Request *req, unsigned int &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = stringToUint(StaticString(value->start->data, value->size));
@@ -264,7 +293,7 @@ void
 Controller::fillPoolOption(Request *req, unsigned long &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = stringToUint(StaticString(value->start->data, value->size));
@@ -275,7 +304,7 @@ void
 Controller::fillPoolOption(Request *req, long &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = stringToInt(StaticString(value->start->data, value->size));
@@ -286,7 +315,7 @@ void
 Controller::fillPoolOptionSecToMsec(Request *req, unsigned int &field,
 	const HashedStaticString &name)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		value = psg_lstr_make_contiguous(value, req->pool);
 		field = stringToInt(StaticString(value->start->data, value->size)) * 1000;
@@ -297,18 +326,17 @@ void
 Controller::createNewPoolOptions(Client *client, Request *req,
 	const HashedStaticString &appGroupName)
 {
-	ServerKit::HeaderTable &secureHeaders = req->secureHeaders;
 	Options &options = req->options;
 
 	SKC_TRACE(client, 2, "Creating new pool options: app group name=" << appGroupName);
 
 	options = Options();
 
-	const LString *scriptName = secureHeaders.lookup("!~SCRIPT_NAME");
-	const LString *appRoot = secureHeaders.lookup("!~PASSENGER_APP_ROOT");
+	const LString *scriptName = req->lookupSecureHeader("!~SCRIPT_NAME");
+	const LString *appRoot = req->lookupSecureHeader("!~PASSENGER_APP_ROOT");
 	if (scriptName == NULL || scriptName->size == 0) {
 		if (appRoot == NULL || appRoot->size == 0) {
-			const LString *documentRoot = secureHeaders.lookup("!~DOCUMENT_ROOT");
+			const LString *documentRoot = req->secureHeaders.lookup("!~DOCUMENT_ROOT");
 			if (OXT_UNLIKELY(documentRoot == NULL || documentRoot->size == 0)) {
 				disconnectWithError(&client, "client did not send a !~PASSENGER_APP_ROOT or a !~DOCUMENT_ROOT header");
 				return;
@@ -324,7 +352,7 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 		options.appRoot = HashedStaticString(appRoot->start->data, appRoot->size);
 	} else {
 		if (appRoot == NULL || appRoot->size == 0) {
-			const LString *documentRoot = secureHeaders.lookup("!~DOCUMENT_ROOT");
+			const LString *documentRoot = req->secureHeaders.lookup("!~DOCUMENT_ROOT");
 			if (OXT_UNLIKELY(documentRoot == NULL || documentRoot->size == 0)) {
 				disconnectWithError(&client, "client did not send a !~DOCUMENT_ROOT header");
 				return;
@@ -346,7 +374,7 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 
 	fillPoolOptionsFromAgentsOptions(options);
 
-	const LString *appType = secureHeaders.lookup("!~PASSENGER_APP_TYPE");
+	const LString *appType = req->lookupSecureHeader("!~PASSENGER_APP_TYPE");
 	if (appType == NULL || appType->size == 0) {
 		AppTypeDetector detector;
 		PassengerAppType type = detector.checkAppRoot(options.appRoot);
@@ -376,6 +404,8 @@ Controller::createNewPoolOptions(Client *client, Request *req,
 	fillPoolOptionSecToMsec(req, options.startTimeout, "!~PASSENGER_START_TIMEOUT");
 	fillPoolOption(req, options.maxPreloaderIdleTime, "!~PASSENGER_MAX_PRELOADER_IDLE_TIME");
 	fillPoolOption(req, options.maxRequestQueueSize, "!~PASSENGER_MAX_REQUEST_QUEUE_SIZE");
+	fillPoolOption(req, options.maxRequestQueueTime, "!~PASSENGER_MAX_REQUEST_QUEUE_TIME");
+	fillPoolOption(req, options.targetLatency, "!~PASSENGER_TARGET_LATENCY");
 	fillPoolOption(req, options.abortWebsocketsOnProcessShutdown, "!~PASSENGER_ABORT_WEBSOCKETS_ON_PROCESS_SHUTDOWN");
 	fillPoolOption(req, options.forceMaxConcurrentRequestsPerProcess, "!~PASSENGER_FORCE_MAX_CONCURRENT_REQUESTS_PER_PROCESS");
 	fillPoolOption(req, options.restartDir, "!~PASSENGER_RESTART_DIR");
@@ -397,16 +427,15 @@ void
 Controller::initializeUnionStation(Client *client, Request *req, RequestAnalysis &analysis) {
 	if (analysis.unionStationSupport) {
 		Options &options = req->options;
-		ServerKit::HeaderTable &headers = req->secureHeaders;
 
-		const LString *key = headers.lookup("!~UNION_STATION_KEY");
+		const LString *key = req->lookupSecureHeader("!~UNION_STATION_KEY");
 		if (key == NULL || key->size == 0) {
 			disconnectWithError(&client, "header !~UNION_STATION_KEY must be set.");
 			return;
 		}
 		key = psg_lstr_make_contiguous(key, req->pool);
 
-		const LString *filters = headers.lookup("!~UNION_STATION_FILTERS");
+		const LString *filters = req->lookupSecureHeader("!~UNION_STATION_FILTERS");
 		if (filters != NULL) {
 			filters = psg_lstr_make_contiguous(filters, req->pool);
 		}
@@ -434,7 +463,7 @@ Controller::setStickySessionId(Client *client, Request *req) {
 		// TODO: This is not entirely correct. Clients MAY send multiple Cookie
 		// headers, although this is in practice extremely rare.
 		// http://stackoverflow.com/questions/16305814/are-multiple-cookie-headers-allowed-in-an-http-request
-		const LString *cookieHeader = req->headers.lookup(HTTP_COOKIE);
+		const LString *cookieHeader = req->headers.lookup(ServerKit::KH_COOKIE);
 		if (cookieHeader != NULL && cookieHeader->size > 0) {
 			const LString *cookieName = getStickySessionCookieName(req);
 			vector< pair<StaticString, StaticString> > cookies;
@@ -452,9 +481,56 @@ Controller::setStickySessionId(Client *client, Request *req) {
 	}
 }
 
+/**
+ * If configured, reads the number of milliseconds that the client is willing
+ * to wait for a process from a request header (for example set by a load
+ * balancer that knows its own upstream timeout), and turns it into an
+ * absolute deadline for the ApplicationPool request queue.
+ *
+ * Values that are not a positive integer are ignored. Values larger than
+ * MAX_REQUEST_QUEUE_DEADLINE are capped, so that the deadline cannot overflow.
+ */
+void
+Controller::setRequestQueueDeadline(Client *client, Request *req) {
+	if (requestQueueDeadlineHeader.empty()) {
+		return;
+	}
+
+	const LString *value = req->headers.lookup(requestQueueDeadlineHeader);
+	if (value == NULL || value->size == 0) {
+		return;
+	}
+
+	value = psg_lstr_make_contiguous(value, req->pool);
+	StaticString str(value->start->data, value->size);
+	if (!looksLikePositiveNumber(str)) {
+		SKC_DEBUG(client, "Ignoring invalid request queue deadline: \"" <<
+			cEscapeString(str) << "\"");
+		return;
+	}
+
+	// Longer numbers are above the cap anyway and might not even fit
+	// in a long long.
+	unsigned long long timeout = (str.size() > 10)
+		? MAX_REQUEST_QUEUE_DEADLINE
+		: stringToULL(str);
+	if (timeout > MAX_REQUEST_QUEUE_DEADLINE) {
+		timeout = MAX_REQUEST_QUEUE_DEADLINE;
+	}
+	if (timeout == 0) {
+		SKC_DEBUG(client, "Ignoring zero request queue deadline");
+		return;
+	}
+
+	req->options.requestQueueDeadline =
+		(unsigned long long) (ev_now(getLoop()) * 1000000)
+		+ timeout * 1000;
+	SKC_TRACE(client, 2, "Request queue deadline: " << timeout << " msec");
+}
+
 const LString *
 Controller::getStickySessionCookieName(Request *req) {
-	const LString *value = req->headers.lookup(PASSENGER_STICKY_SESSIONS_COOKIE_NAME);
+	const LString *value = req->lookupSecureHeader(PASSENGER_STICKY_SESSIONS_COOKIE_NAME);
 	if (value == NULL || value->size == 0) {
 		return psg_lstr_create(req->pool,
 			defaultStickySessionsCookieName);
@@ -477,30 +553,48 @@ Controller::onRequestBegin(Client *client, Request *req) {
 
 	CC_BENCHMARK_POINT(client, req, BM_AFTER_ACCEPT);
 
+	initializeLocationConfig(client, req);
+	if (req->ended()) {
+		return;
+	}
+
 	{
 		// Perform hash table operations as close to header parsing as possible,
 		// and localize them as much as possible, for better CPU caching.
 		RequestAnalysis analysis;
 		analysis.flags = req->secureHeaders.lookup(FLAGS);
-		analysis.appGroupNameCell = singleAppMode
+		analysis.appGroupName = singleAppMode
 			? NULL
-			: req->secureHeaders.lookupCell(PASSENGER_APP_GROUP_NAME);
+			: req->lookupSecureHeader(PASSENGER_APP_GROUP_NAME);
 		analysis.unionStationSupport = unionStationContext != NULL
 			&& getBoolOption(req, UNION_STATION_SUPPORT, false);
 		req->stickySession = getBoolOption(req, PASSENGER_STICKY_SESSIONS,
 			this->stickySessions);
 		req->showVersionInHeader = getBoolOption(req, PASSENGER_SHOW_VERSION_IN_HEADER,
 			this->showVersionInHeader);
-		req->host = req->headers.lookup(HTTP_HOST);
+		req->host = req->headers.lookup(ServerKit::KH_HOST);
+		responseCompression.prepareRequest(req);
 
 		/***************/
 		/***************/
 
 		SKC_TRACE(client, 2, "Initiating request");
 		req->startedAt = ev_now(getLoop());
+		if (OXT_UNLIKELY(shouldTimeRequest())) {
+			req->timingSampled = true;
+		}
+		if (OXT_UNLIKELY(req->timingSampled
+		 || (accessLog != NULL && accessLogFormat.needsRequestTimings())))
+		{
+			req->timed = true;
+			memset(&req->timings, 0, sizeof(req->timings));
+		}
 		req->bodyChannel.stop();
 
 		initializeFlags(client, req, analysis);
+		if (staticFiles != NULL && serveStaticFile(client, req)) {
+			return;
+		}
 		if (respondFromTurboCache(client, req)) {
 			return;
 		}
@@ -51,40 +51,50 @@ Controller::Controller(ServerKit::Context *context, const VariantMap *_agentsOpt
 
 	  statThrottleRate(_agentsOptions->getInt("stat_throttle_rate")),
 	  responseBufferHighWatermark(_agentsOptions->getInt("response_buffer_high_watermark")),
+	  requestTimingSampleRate(_agentsOptions->getUint("request_timing_sample_rate", false, 0)),
+	  requestTimingCounter(0),
 	  benchmarkMode(parseBenchmarkMode(_agentsOptions->get("benchmark_mode", false))),
 	  singleAppMode(false),
 	  showVersionInHeader(_agentsOptions->getBool("show_version_in_header")),
 	  stickySessions(_agentsOptions->getBool("sticky_sessions")),
 	  gracefulExit(_agentsOptions->getBool("core_graceful_exit")),
+	  staticFilesGzip(_agentsOptions->getBool("static_files_gzip", false, false)),
 
 	  agentsOptions(_agentsOptions),
 	  stringPool(psg_create_pool(1024 * 4)),
 	  poolOptionsCache(4),
 
 	  PASSENGER_APP_GROUP_NAME("!~PASSENGER_APP_GROUP_NAME"),
+	  PASSENGER_CONFIG_ID("!~PASSENGER_CONFIG_ID"),
 	  PASSENGER_ENV_VARS("!~PASSENGER_ENV_VARS"),
 	  PASSENGER_MAX_REQUESTS("!~PASSENGER_MAX_REQUESTS"),
 	  PASSENGER_SHOW_VERSION_IN_HEADER("!~PASSENGER_SHOW_VERSION_IN_HEADER"),
 	  PASSENGER_STICKY_SESSIONS("!~PASSENGER_STICKY_SESSIONS"),
 	  PASSENGER_STICKY_SESSIONS_COOKIE_NAME("!~PASSENGER_STICKY_SESSIONS_COOKIE_NAME"),
 	  PASSENGER_REQUEST_OOB_WORK("!~Request-OOB-Work"),
+	  PASSENGER_REQUEST_QUEUE_PRIORITY("!~PASSENGER_REQUEST_QUEUE_PRIORITY"),
 	  UNION_STATION_SUPPORT("!~UNION_STATION_SUPPORT"),
 	  REMOTE_ADDR("!~REMOTE_ADDR"),
 	  REMOTE_PORT("!~REMOTE_PORT"),
 	  REMOTE_USER("!~REMOTE_USER"),
 	  FLAGS("!~FLAGS"),
-	  HTTP_COOKIE("cookie"),
-	  HTTP_DATE("date"),
-	  HTTP_HOST("host"),
-	  HTTP_CONTENT_LENGTH("content-length"),
-	  HTTP_CONTENT_TYPE("content-type"),
-	  HTTP_EXPECT("expect"),
-	  HTTP_CONNECTION("connection"),
-	  HTTP_STATUS("status"),
-	  HTTP_TRANSFER_ENCODING("transfer-encoding"),
 
 	  threadNumber(_threadNumber),
-	  turboCaching(getTurboCachingInitialState(_agentsOptions))
+	  turboCaching(getTurboCachingInitialState(_agentsOptions)),
+	  responseCompression(
+		_agentsOptions->getBool("response_compression", false, false),
+		_agentsOptions->getInt("response_compression_level", false,
+			DEFAULT_RESPONSE_COMPRESSION_LEVEL),
+		_agentsOptions->getUint("response_compression_min_size", false,
+			DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE),
+		_agentsOptions->get("response_compression_types", false,
+			DEFAULT_RESPONSE_COMPRESSION_TYPES)),
+	  accessLog(NULL),
+	  accessLogFormat(_agentsOptions->get("access_log_format", false,
+		DEFAULT_ACCESS_LOG_FORMAT)),
+	  accessLogBufferLines(0),
+	  staticFiles(NULL),
+	  metricsPublisher(NULL)
 {
 	defaultRuby = psg_pstrdup(stringPool,
 		agentsOptions->get("default_ruby"));
@@ -110,7 +120,19 @@ Controller::Controller(ServerKit::Context *context, const VariantMap *_agentsOpt
 			agentsOptions->get("vary_turbocache_by_cookie"));
 	}
 
+	if (agentsOptions->has("request_queue_deadline_header")) {
+		// Header names are stored in lowercase in the request header table.
+		string name = agentsOptions->get("request_queue_deadline_header");
+		if (!name.empty()) {
+			char *data = (char *) psg_pnalloc(stringPool, name.size());
+			convertLowerCase((const unsigned char *) name.data(),
+				(unsigned char *) data, name.size());
+			requestQueueDeadlineHeader = HashedStaticString(data, name.size());
+		}
+	}
+
 	generateServerLogName(_threadNumber);
+	loadLocationConfigs();
 
 	if (!agentsOptions->getBool("multi_app")) {
 		boost::shared_ptr<Options> options = boost::make_shared<Options>();
@@ -134,17 +156,23 @@ Controller::Controller(ServerKit::Context *context, const VariantMap *_agentsOpt
 	ev_check_start(getLoop(), &checkWatcher);
 	checkWatcher.data = this;
 
+	ev_prepare_init(&prepareWatcher, onEventLoopPrepare);
+	prepareWatcher.data = this;
+	eventLoopIterationBegun = 0;
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
-		ev_prepare_init(&prepareWatcher, onEventLoopPrepare);
-		ev_prepare_start(getLoop(), &prepareWatcher);
-		prepareWatcher.data = this;
-
 		timeBeforeBlocking = 0;
 	#endif
+	updatePrepareWatcher();
 }
 
 Controller::~Controller() {
+	submitAccessLogBuffer();
+	for (unsigned int i = 0; i < freeCompressors.size(); i++) {
+		delete freeCompressors[i];
+	}
+	delete staticFiles;
 	ev_check_stop(getLoop(), &checkWatcher);
+	ev_prepare_stop(getLoop(), &prepareWatcher);
 	psg_destroy_pool(stringPool);
 }
 
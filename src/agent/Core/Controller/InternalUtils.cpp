@@ -61,6 +61,161 @@ Controller::generateServerLogName(unsigned int number) {
 	serverLogName = psg_pstrdup(stringPool, name);
 }
 
+/**
+ * Parses the `location_configs` agent option. Each element is a block of
+ * secure headers ("!~NAME: value\r\n"), as the web server module would
+ * otherwise send with every request for that location. They are parsed
+ * into header tables once, allocated from `stringPool`.
+ */
+void
+Controller::loadLocationConfigs() {
+	vector<string> configs = agentsOptions->getStrSet("location_configs", false);
+	vector<string>::const_iterator it;
+
+	locationConfigs.reserve(configs.size());
+	for (it = configs.begin(); it != configs.end(); it++) {
+		StaticString data = psg_pstrdup(stringPool, *it);
+		const char *pos = data.data();
+		const char *end = data.data() + data.size();
+
+		locationConfigs.push_back(ServerKit::HeaderTable());
+		ServerKit::HeaderTable &table = locationConfigs.back();
+
+		while (pos < end) {
+			const char *lineEnd = (const char *) memmem(pos, end - pos, "\r\n", 2);
+			if (lineEnd == NULL) {
+				lineEnd = end;
+			}
+
+			const char *sep = (const char *) memchr(pos, ':', lineEnd - pos);
+			if (sep != NULL && sep > pos) {
+				const char *value = sep + 1;
+				while (value < lineEnd && *value == ' ') {
+					value++;
+				}
+
+				// Secure header names are case-sensitive, so unlike
+				// HeaderTable::insert(pool, name, value) we don't downcase them.
+				ServerKit::Header *header = (ServerKit::Header *)
+					psg_palloc(stringPool, sizeof(ServerKit::Header));
+				psg_lstr_init(&header->key);
+				psg_lstr_append(&header->key, stringPool, pos, sep - pos);
+				psg_lstr_init(&header->origKey);
+				psg_lstr_append(&header->origKey, stringPool, pos, sep - pos);
+				psg_lstr_init(&header->val);
+				psg_lstr_append(&header->val, stringPool, value, lineEnd - value);
+				header->hash = HashedStaticString(pos, sep - pos).hash();
+				table.insert(&header, stringPool);
+			}
+
+			pos = lineEnd + 2;
+		}
+	}
+}
+
+/**
+ * Enables request timing for 1 in `rate` requests, or disables it if
+ * `rate` is 0. The event loop lag is only measured while request timing
+ * is enabled, so that it costs nothing otherwise.
+ */
+void
+Controller::setRequestTimingSampleRate(unsigned int rate) {
+	requestTimingSampleRate = rate;
+	requestTimingCounter = 0;
+	eventLoopIterationBegun = 0;
+	updatePrepareWatcher();
+}
+
+/**
+ * The prepare watcher runs on every event loop iteration, so it is only
+ * active while request timing, the access log or DEBUG_CC_EVENT_LOOP_BLOCKING
+ * needs it.
+ */
+void
+Controller::updatePrepareWatcher() {
+	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
+		ev_prepare_start(getLoop(), &prepareWatcher);
+	#else
+		if (requestTimingSampleRate != 0 || accessLog != NULL) {
+			ev_prepare_start(getLoop(), &prepareWatcher);
+		} else {
+			ev_prepare_stop(getLoop(), &prepareWatcher);
+		}
+	#endif
+}
+
+bool
+Controller::shouldTimeRequest() {
+	if (OXT_LIKELY(requestTimingSampleRate == 0)) {
+		return false;
+	} else if (++requestTimingCounter >= requestTimingSampleRate) {
+		requestTimingCounter = 0;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Formats an access log line for the given request, which is about to be
+ * deinitialized. Lines are buffered until the end of the event loop
+ * iteration.
+ */
+void
+Controller::logAccess(Request *req) {
+	if (req->startedAt == 0 && req->responseStatus == 0) {
+		// Nothing happened, e.g. the client closed a keep-alive
+		// connection without sending another request.
+		return;
+	}
+	accessLogFormat.format(accessLogBuffer, req, ev_now(getLoop()));
+	accessLogBufferLines++;
+}
+
+void
+Controller::submitAccessLogBuffer() {
+	if (accessLog != NULL && accessLogBufferLines > 0) {
+		accessLog->submit(accessLogBuffer, accessLogBufferLines);
+		accessLogBufferLines = 0;
+	}
+}
+
+static void
+recordTimeDiff(LogHistogram &histogram, ev_tstamp begin, ev_tstamp end) {
+	if (begin != 0 && end >= begin) {
+		histogram.record((boost::uint64_t) ((end - begin) * 1000000));
+	}
+}
+
+void
+Controller::recordRequestTimings(Request *req) {
+	ev_tstamp now = ev_now(getLoop());
+
+	recordTimeDiff(requestTimings.total, req->startedAt, now);
+	if (req->timings.checkoutBegun == 0) {
+		// Served without the ApplicationPool, e.g. from the turbocache.
+		return;
+	}
+	recordTimeDiff(requestTimings.initialization, req->startedAt,
+		req->timings.checkoutBegun);
+	if (req->timings.sessionCheckedOut == 0) {
+		return;
+	}
+	recordTimeDiff(requestTimings.checkout, req->timings.checkoutBegun,
+		req->timings.sessionCheckedOut);
+	if (req->timings.requestHeaderSent == 0) {
+		return;
+	}
+	recordTimeDiff(requestTimings.sendRequestHeader, req->timings.sessionCheckedOut,
+		req->timings.requestHeaderSent);
+	if (req->timings.responseBegun == 0) {
+		return;
+	}
+	recordTimeDiff(requestTimings.app, req->timings.requestHeaderSent,
+		req->timings.responseBegun);
+	recordTimeDiff(requestTimings.response, req->timings.responseBegun, now);
+}
+
 void
 Controller::disconnectWithClientSocketWriteError(Client **client, int e) {
 	stringstream message;
@@ -189,7 +344,7 @@ bool
 Controller::getBoolOption(Request *req, const HashedStaticString &name,
 	bool defaultValue)
 {
-	const LString *value = req->secureHeaders.lookup(name);
+	const LString *value = req->lookupSecureHeader(name);
 	if (value != NULL && value->size > 0) {
 		return psg_lstr_first_byte(value) == 't';
 	} else {
@@ -39,6 +39,8 @@
 #include <Core/UnionStation/Transaction.h>
 #include <Core/UnionStation/StopwatchLog.h>
 #include <Core/Controller/AppResponse.h>
+#include <Core/ResponseCompression.h>
+#include <Core/StaticFileCache.h>
 
 namespace Passenger {
 namespace Core {
@@ -56,7 +58,8 @@ public:
 		CHECKING_OUT_SESSION,
 		SENDING_HEADER_TO_APP,
 		FORWARDING_BODY_TO_APP,
-		WAITING_FOR_APP_OUTPUT
+		WAITING_FOR_APP_OUTPUT,
+		SERVING_STATIC_FILE
 	};
 
 	enum HalfClosePolicy {
@@ -81,10 +84,29 @@ public:
 	bool appResponseInitialized: 1;
 	bool strip100ContinueHeader: 1;
 	bool hasPragmaHeader: 1;
+	// Whether an asyncGet() on the ApplicationPool is in progress, i.e. whether
+	// the request may be sitting in one of the Pool's wait lists.
+	bool waitingForSession: 1;
+	// Whether `timings` are being recorded for this request. They are if
+	// the request was sampled for phase timing, or if the access log is on.
+	bool timed: 1;
+	// Whether this request was sampled for phase timing, i.e. whether its
+	// `timings` are aggregated into the Controller's histograms.
+	bool timingSampled: 1;
+	bool turboCacheHit: 1;
+	// The content coding that the response is compressed with, if it is
+	// eligible for compression. Set by ResponseCompression::prepareRequest().
+	ResponseCompressor::Encoding acceptedEncoding: 2;
+	// Whether we send the compressed response body with chunked framing.
+	// If not, the end of the response is marked by closing the connection.
+	bool chunkCompressedResponse: 1;
 
 	Options options;
 	AbstractSessionPtr session;
 	const LString *host;
+	// The static location configuration that the web server module refers
+	// to with `!~PASSENGER_CONFIG_ID`, or NULL. See lookupSecureHeader().
+	const ServerKit::HeaderTable *locationConfig;
 
 	ServerKit::FdSinkChannel appSink;
 	ServerKit::FdSourceChannel appSource;
@@ -93,6 +115,14 @@ public:
 	ServerKit::FileBufferedChannel bodyBuffer;
 	boost::uint64_t bodyBytesBuffered; // After dechunking
 
+	// Non-NULL while the app response is being compressed.
+	ResponseCompressor *compressor;
+
+	// The file being sent while in the SERVING_STATIC_FILE state.
+	StaticFileCache::FilePtr staticFile;
+	boost::uint64_t staticFileOffset;
+	boost::uint64_t staticFileRemaining;
+
 	struct {
 		UnionStation::StopwatchLog *requestProcessing;
 		UnionStation::StopwatchLog *bufferingRequestBody;
@@ -109,7 +139,18 @@ public:
 	// `options.environmentVariables` retains a previous value.
 	//
 	// This value is guaranteed to be contiguous.
-	LString *envvars;
+	const LString *envvars;
+
+	// When the request entered each phase, according to the event loop
+	// clock. Only set if `timed` is true. Controller::recordRequestTimings()
+	// aggregates these into per-thread histograms when the request ends,
+	// and the access log may log them.
+	struct {
+		ev_tstamp checkoutBegun;
+		ev_tstamp sessionCheckedOut;
+		ev_tstamp requestHeaderSent;
+		ev_tstamp responseBegun;
+	} timings;
 
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		bool timedAppPoolGet;
@@ -120,11 +161,26 @@ public:
 
 
 	Request()
-		: BaseHttpRequest()
+		: BaseHttpRequest(),
+		  locationConfig(NULL),
+		  compressor(NULL)
 	{
 		memset(&stopwatchLogs, 0, sizeof(stopwatchLogs));
 	}
 
+	/**
+	 * Looks up a secure header. Headers that the web server module did not
+	 * send with this request are looked up in the location configuration
+	 * that it registered with the Core at startup, if any.
+	 */
+	const LString *lookupSecureHeader(const HashedStaticString &name) const {
+		const LString *value = secureHeaders.lookup(name);
+		if (value == NULL && locationConfig != NULL) {
+			value = locationConfig->lookup(name);
+		}
+		return value;
+	}
+
 	const char *getStateString() const {
 		switch (state) {
 		case ANALYZING_REQUEST:
@@ -139,6 +195,8 @@ public:
 			return "FORWARDING_BODY_TO_APP";
 		case WAITING_FOR_APP_OUTPUT:
 			return "WAITING_FOR_APP_OUTPUT";
+		case SERVING_STATIC_FILE:
+			return "SERVING_STATIC_FILE";
 		default:
 			return "UNKNOWN";
 		}
@@ -64,6 +64,10 @@ struct Controller::SessionProtocolWorkingState {
 	size_t environmentVariablesSize;
 	bool hasBaseURI;
 
+	struct iovec *buffers;
+	unsigned int nbuffers;
+	unsigned int dataSize;
+
 	SessionProtocolWorkingState()
 		: environmentVariablesData(NULL)
 		{ }
@@ -155,6 +159,7 @@ void
 Controller::sendHeaderToAppWithSessionProtocol(Client *client, Request *req) {
 	TRACE_POINT();
 	SessionProtocolWorkingState state;
+	ssize_t bytesWritten;
 
 	// Workaround for Ruby < 2.1 support.
 	std::string deltaMonotonic;
@@ -167,36 +172,26 @@ Controller::sendHeaderToAppWithSessionProtocol(Client *client, Request *req) {
 		deltaMonotonic = boost::to_string(-diff);
 	}
 
-	unsigned int bufferSize = determineHeaderSizeForSessionProtocol(req,
-		state, deltaMonotonic);
-	MemoryKit::mbuf_pool &mbuf_pool = getContext()->mbuf_pool;
-	const unsigned int MBUF_MAX_SIZE = mbuf_pool_data_size(&mbuf_pool);
-	bool ok;
+	constructHeaderBuffersForSessionProtocol(req, state, deltaMonotonic);
 
-	if (bufferSize <= MBUF_MAX_SIZE) {
-		MemoryKit::mbuf buffer(MemoryKit::mbuf_get(&mbuf_pool));
-		bufferSize = MBUF_MAX_SIZE;
-
-		ok = constructHeaderForSessionProtocol(req, buffer.start,
-			bufferSize, state, deltaMonotonic);
-		assert(ok);
-		buffer = MemoryKit::mbuf(buffer, 0, bufferSize);
-		SKC_TRACE(client, 3, "Header data: \"" << cEscapeString(
-			StaticString(buffer.start, bufferSize)) << "\"");
-		req->appSink.feedWithoutRefGuard(boost::move(buffer));
-	} else {
-		char *buffer = (char *) psg_pnalloc(req->pool, bufferSize);
-
-		ok = constructHeaderForSessionProtocol(req, buffer,
-			bufferSize, state, deltaMonotonic);
-		assert(ok);
-		SKC_TRACE(client, 3, "Header data: \"" << cEscapeString(
-			StaticString(buffer, bufferSize)) << "\"");
-		req->appSink.feedWithoutRefGuard(MemoryKit::mbuf(
-			buffer, bufferSize));
+	if (OXT_UNLIKELY(getLogLevel() >= LVL_DEBUG3)) {
+		char *buffer = (char *) psg_pnalloc(req->pool, state.dataSize);
+		gatherBuffers(buffer, state.dataSize, state.buffers, state.nbuffers);
+		SKC_TRACE(client, 3, "Header data: \"" <<
+			cEscapeString(StaticString(buffer, state.dataSize)) << "\"");
 	}
 
-	(void) ok; // Shut up compiler warning
+	if (!sendHeaderToAppWithSessionProtocolAndWritev(req, state, bytesWritten)) {
+		if (bytesWritten >= 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
+			// bytesWritten is -1 on EAGAIN: nothing was written yet.
+			sendHeaderToAppWithSessionProtocolWithBuffering(req, state,
+				bytesWritten < 0 ? 0 : bytesWritten);
+		} else {
+			int e = errno;
+			P_ASSERT_EQ(bytesWritten, -1);
+			disconnectWithAppSocketWriteError(&client, e);
+		}
+	}
 }
 
 void
@@ -256,71 +251,37 @@ containsNonAlphaNumDash(const LString &s) {
 	return false;
 }
 
-static void
-httpHeaderToScgiUpperCase(unsigned char *data, unsigned int size) {
-	static const boost::uint8_t toUpperMap[256] = {
-		'\0', 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, '\t',
-		'\n', 0x0b, 0x0c, '\r', 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13,
-		0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
-		0x1e, 0x1f,  ' ',  '!',  '"',  '#',  '$',  '%',  '&', '\'',
-		 '(',  ')',  '*',  '+',  ',',  '_',  '.',  '/',  '0',  '1',
-		 '2',  '3',  '4',  '5',  '6',  '7',  '8',  '9',  ':',  ';',
-		 '<',  '=',  '>',  '?',  '@',  'A',  'B',  'C',  'D',  'E',
-		 'F',  'G',  'H',  'I',  'J',  'K',  'L',  'M',  'N',  'O',
-		 'P',  'Q',  'R',  'S',  'T',  'U',  'V',  'W',  'X',  'Y',
-		 'Z',  '[', '\\',  ']',  '^',  '_',  '`',  'A',  'B',  'C',
-		 'D',  'E',  'F',  'G',  'H',  'I',  'J',  'K',  'L',  'M',
-		 'N',  'O',  'P',  'Q',  'R',  'S',  'T',  'U',  'V',  'W',
-		 'X',  'Y',  'Z',  '{',  '|',  '}',  '~', 0x7f, 0x80, 0x81,
-		0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b,
-		0x8c, 0x8d, 0x8e, 0x8f, 0x90, 0x91, 0x92, 0x93, 0x94, 0x95,
-		0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
-		0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9,
-		0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf, 0xb0, 0xb1, 0xb2, 0xb3,
-		0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xbb, 0xbc, 0xbd,
-		0xbe, 0xbf, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
-		0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf, 0xd0, 0xd1,
-		0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xdb,
-		0xdc, 0xdd, 0xde, 0xdf, 0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5,
-		0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef,
-		0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9,
-		0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
-	};
-
-	const unsigned char *buf = data;
-	const size_t imax = size / 8;
-	const size_t leftover = size % 8;
-	size_t i;
-
-	for (i = 0; i < imax; i++, data += 8) {
-		data[0] = (unsigned char) toUpperMap[data[0]];
-		data[1] = (unsigned char) toUpperMap[data[1]];
-		data[2] = (unsigned char) toUpperMap[data[2]];
-		data[3] = (unsigned char) toUpperMap[data[3]];
-		data[4] = (unsigned char) toUpperMap[data[4]];
-		data[5] = (unsigned char) toUpperMap[data[5]];
-		data[6] = (unsigned char) toUpperMap[data[6]];
-		data[7] = (unsigned char) toUpperMap[data[7]];
-	}
-
-	i = imax * 8;
-	switch (leftover) {
-	case 7: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 6: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 5: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 4: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 3: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 2: *data++ = (unsigned char) toUpperMap[buf[i++]];
-	case 1: *data++ = (unsigned char) toUpperMap[buf[i]];
-	case 0: break;
-	}
+static bool
+isSessionProtocolSpecialHeader(const ServerKit::HeaderTable &headers,
+	const ServerKit::Header *header)
+{
+	return header == headers.lookupHeader(ServerKit::KH_CONTENT_LENGTH)
+		|| header == headers.lookupHeader(ServerKit::KH_CONTENT_TYPE)
+		|| header == headers.lookupHeader(ServerKit::KH_CONNECTION);
 }
 
-unsigned int
-Controller::determineHeaderSizeForSessionProtocol(Request *req,
-	SessionProtocolWorkingState &state, string delta_monotonic)
+/**
+ * Constructs the 'session' protocol header data in a single pass. This method
+ * does not copy the request headers: the fixed CGI variables are written to a
+ * single buffer in `req->pool`, but the request headers are described by buffers
+ * that point to their CGI names in `cgiHeaderNames`, and to their values inside
+ * `req->headers`.
+ *
+ * The buffers, their number and their total data size are stored in `state`.
+ */
+void
+Controller::constructHeaderBuffersForSessionProtocol(Request *req,
+	SessionProtocolWorkingState &state, const string &deltaMonotonic)
 {
-	unsigned int dataSize = sizeof(boost::uint32_t);
+	#define PUSH_BUFFER(buf, len) \
+		do { \
+			state.buffers[state.nbuffers].iov_base = (void *) (buf); \
+			state.buffers[state.nbuffers].iov_len  = (len); \
+			state.nbuffers++; \
+			state.dataSize += (len); \
+		} while (false)
+
+	unsigned int fixedSize = sizeof(boost::uint32_t);
 
 	state.path        = req->getPathWithoutQueryString();
 	state.hasBaseURI  = req->options.baseURI != P_STATIC_STRING("/")
@@ -336,9 +297,9 @@ Controller::determineHeaderSizeForSessionProtocol(Request *req,
 	state.remoteAddr  = req->secureHeaders.lookup(REMOTE_ADDR);
 	state.remotePort  = req->secureHeaders.lookup(REMOTE_PORT);
 	state.remoteUser  = req->secureHeaders.lookup(REMOTE_USER);
-	state.contentType   = req->headers.lookup(HTTP_CONTENT_TYPE);
+	state.contentType   = req->headers.lookup(ServerKit::KH_CONTENT_TYPE);
 	if (req->hasBody()) {
-		state.contentLength = req->headers.lookup(HTTP_CONTENT_LENGTH);
+		state.contentLength = req->headers.lookup(ServerKit::KH_CONTENT_LENGTH);
 	} else {
 		state.contentLength = NULL;
 	}
@@ -358,25 +319,6 @@ Controller::determineHeaderSizeForSessionProtocol(Request *req,
 		state.environmentVariablesSize = len;
 	}
 
-	dataSize += sizeof("REQUEST_URI");
-	dataSize += req->path.size + 1;
-
-	dataSize += sizeof("PATH_INFO");
-	dataSize += state.path.size() + 1;
-
-	dataSize += sizeof("SCRIPT_NAME");
-	if (state.hasBaseURI) {
-		dataSize += req->options.baseURI.size();
-	} else {
-		dataSize += sizeof("");
-	}
-
-	dataSize += sizeof("QUERY_STRING");
-	dataSize += state.queryString.size() + 1;
-
-	dataSize += sizeof("REQUEST_METHOD");
-	dataSize += state.methodStr.size() + 1;
-
 	if (req->host != NULL && req->host->size > 0) {
 		const LString *host = psg_lstr_make_contiguous(req->host, req->pool);
 		const char *sep = (const char *) memchr(host->start->data, ':', host->size);
@@ -397,90 +339,66 @@ Controller::determineHeaderSizeForSessionProtocol(Request *req,
 		state.serverPort = defaultServerPort;
 	}
 
-	dataSize += sizeof("SERVER_NAME");
-	dataSize += state.serverName.size() + 1;
-
-	dataSize += sizeof("SERVER_PORT");
-	dataSize += state.serverPort.size() + 1;
-
-	dataSize += sizeof("SERVER_SOFTWARE");
-	dataSize += serverSoftware.size() + 1;
 
-	dataSize += sizeof("SERVER_PROTOCOL");
-	dataSize += sizeof("HTTP/1.1");
+	/***** Fixed CGI variables: determine size *****/
 
-	dataSize += sizeof("REMOTE_ADDR");
+	fixedSize += sizeof("REQUEST_URI") + req->path.size + 1;
+	fixedSize += sizeof("PATH_INFO") + state.path.size() + 1;
+	fixedSize += sizeof("SCRIPT_NAME");
+	if (state.hasBaseURI) {
+		fixedSize += req->options.baseURI.size() + 1;
+	} else {
+		fixedSize += sizeof("");
+	}
+	fixedSize += sizeof("QUERY_STRING") + state.queryString.size() + 1;
+	fixedSize += sizeof("REQUEST_METHOD") + state.methodStr.size() + 1;
+	fixedSize += sizeof("SERVER_NAME") + state.serverName.size() + 1;
+	fixedSize += sizeof("SERVER_PORT") + state.serverPort.size() + 1;
+	fixedSize += sizeof("SERVER_SOFTWARE") + serverSoftware.size() + 1;
+	fixedSize += sizeof("SERVER_PROTOCOL") + sizeof("HTTP/1.1");
+	fixedSize += sizeof("REMOTE_ADDR");
 	if (state.remoteAddr != NULL) {
-		dataSize += state.remoteAddr->size + 1;
+		fixedSize += state.remoteAddr->size + 1;
 	} else {
-		dataSize += sizeof("127.0.0.1");
+		fixedSize += sizeof("127.0.0.1");
 	}
-
-	dataSize += sizeof("REMOTE_PORT");
+	fixedSize += sizeof("REMOTE_PORT");
 	if (state.remotePort != NULL) {
-		dataSize += state.remotePort->size + 1;
+		fixedSize += state.remotePort->size + 1;
 	} else {
-		dataSize += sizeof("0");
+		fixedSize += sizeof("0");
 	}
-
 	if (state.remoteUser != NULL) {
-		dataSize += sizeof("REMOTE_USER");
-		dataSize += state.remoteUser->size + 1;
+		fixedSize += sizeof("REMOTE_USER") + state.remoteUser->size + 1;
 	}
-
 	if (state.contentType != NULL) {
-		dataSize += sizeof("CONTENT_TYPE");
-		dataSize += state.contentType->size + 1;
+		fixedSize += sizeof("CONTENT_TYPE") + state.contentType->size + 1;
 	}
-
 	if (state.contentLength != NULL) {
-		dataSize += sizeof("CONTENT_LENGTH");
-		dataSize += state.contentLength->size + 1;
+		fixedSize += sizeof("CONTENT_LENGTH") + state.contentLength->size + 1;
 	}
-
-	dataSize += sizeof("PASSENGER_CONNECT_PASSWORD");
-	dataSize += ApplicationPool2::ApiKey::SIZE + 1;
-
+	// Null and super API keys are shorter than ApiKey::SIZE, so use the
+	// actual string: the construction below must fill the buffer exactly.
+	const StaticString apiKey = req->session->getApiKey().toStaticString();
+	fixedSize += sizeof("PASSENGER_CONNECT_PASSWORD") + apiKey.size() + 1;
 	if (req->https) {
-		dataSize += sizeof("HTTPS");
-		dataSize += sizeof("on");
+		fixedSize += sizeof("HTTPS") + sizeof("on");
 	}
-
 	if (req->options.analytics) {
-		dataSize += sizeof("PASSENGER_TXN_ID");
-		dataSize += req->options.transaction->getTxnId().size() + 1;
-
-		dataSize += sizeof("PASSENGER_DELTA_MONOTONIC");
-		dataSize += delta_monotonic.size() + 1;
+		fixedSize += sizeof("PASSENGER_TXN_ID")
+			+ req->options.transaction->getTxnId().size() + 1;
+		fixedSize += sizeof("PASSENGER_DELTA_MONOTONIC") + deltaMonotonic.size() + 1;
 	}
-
 	if (req->upgraded()) {
-		dataSize += sizeof("HTTP_CONNECTION");
-		dataSize += sizeof("upgrade");
-	}
-
-	ServerKit::HeaderTable::Iterator it(req->headers);
-	while (*it != NULL) {
-		dataSize += sizeof("HTTP_") - 1 + it->header->key.size + 1;
-		dataSize += it->header->val.size + 1;
-		it.next();
-	}
-
-	if (state.environmentVariablesData != NULL) {
-		dataSize += state.environmentVariablesSize;
+		fixedSize += sizeof("HTTP_CONNECTION") + sizeof("upgrade");
 	}
 
-	return dataSize + 1;
-}
 
-bool
-Controller::constructHeaderForSessionProtocol(Request *req, char * restrict buffer,
-	unsigned int &size, const SessionProtocolWorkingState &state, string delta_monotonic)
-{
-	char *pos = buffer;
-	const char *end = buffer + size;
+	/***** Fixed CGI variables: construct *****/
 
-	pos += sizeof(boost::uint32_t);
+	char *fixed = (char *) psg_pnalloc(req->pool, fixedSize);
+	char *pos = fixed + sizeof(boost::uint32_t);
+	const char *end = fixed + fixedSize;
 
 	pos = appendData(pos, end, P_STATIC_STRING_WITH_NULL("REQUEST_URI"));
 	pos = appendData(pos, end, req->path.start->data, req->path.size);
@@ -556,7 +474,7 @@ Controller::constructHeaderForSessionProtocol(Request *req, char * restrict buff
 	}
 
 	pos = appendData(pos, end, P_STATIC_STRING_WITH_NULL("PASSENGER_CONNECT_PASSWORD"));
-	pos = appendData(pos, end, req->session->getApiKey().toStaticString());
+	pos = appendData(pos, end, apiKey);
 	pos = appendData(pos, end, "", 1);
 
 	if (req->https) {
@@ -570,7 +488,7 @@ Controller::constructHeaderForSessionProtocol(Request *req, char * restrict buff
 		pos = appendData(pos, end, "", 1);
 
 		pos = appendData(pos, end, P_STATIC_STRING_WITH_NULL("PASSENGER_DELTA_MONOTONIC"));
-		pos = appendData(pos, end, delta_monotonic);
+		pos = appendData(pos, end, deltaMonotonic);
 		pos = appendData(pos, end, "", 1);
 	}
 
@@ -579,53 +497,85 @@ Controller::constructHeaderForSessionProtocol(Request *req, char * restrict buff
 		pos = appendData(pos, end, P_STATIC_STRING_WITH_NULL("upgrade"));
 	}
 
+	P_ASSERT_EQ(pos, end);
+
+
+	/***** Request headers and environment variables *****/
+
+	// The fixed CGI variables, 3 buffers per header, and the
+	// environment variables.
+	state.buffers = (struct iovec *) psg_palloc(req->pool,
+		sizeof(struct iovec) * (2 + req->headers.size() * 3));
+	state.nbuffers = 0;
+	state.dataSize = 0;
+	PUSH_BUFFER(fixed, fixedSize);
+
+	cgiHeaderNames.nextRequest();
 	ServerKit::HeaderTable::Iterator it(req->headers);
 	while (*it != NULL) {
-		// This header-skipping is not accounted for in determineHeaderSizeForSessionProtocol(), but
-		// since we are only reducing the size it just wastes some mem bytes.
-		if ((
-				(it->header->hash == HTTP_CONTENT_LENGTH.hash()
-						|| it->header->hash == HTTP_CONTENT_TYPE.hash()
-						|| it->header->hash == HTTP_CONNECTION.hash()
-				) && (psg_lstr_cmp(&it->header->key, P_STATIC_STRING("content-type"))
-						|| psg_lstr_cmp(&it->header->key, P_STATIC_STRING("content-length"))
-						|| psg_lstr_cmp(&it->header->key, P_STATIC_STRING("connection"))
-				)
-			) || containsNonAlphaNumDash(it->header->key)
-		   )
+		const ServerKit::Header *header = it->header;
+
+		if (isSessionProtocolSpecialHeader(req->headers, header)
+		 || containsNonAlphaNumDash(header->key))
 		{
 			it.next();
 			continue;
 		}
 
-		pos = appendData(pos, end, P_STATIC_STRING("HTTP_"));
-		const LString::Part *part = it->header->key.start;
-		while (part != NULL) {
-			char *start = pos;
-			pos = appendData(pos, end, part->data, part->size);
-			httpHeaderToScgiUpperCase((unsigned char *) start, pos - start);
-			part = part->next;
+		PUSH_BUFFER(cgiHeaderNames.lookup(&header->key, header->hash, req->pool),
+			header->key.size + CgiHeaderNameCache::OVERHEAD);
+		if (header->val.size > 0) {
+			const LString *value = psg_lstr_make_contiguous(&header->val, req->pool);
+			PUSH_BUFFER(value->start->data, value->size);
 		}
-		pos = appendData(pos, end, "", 1);
-
-		part = it->header->val.start;
-		while (part != NULL) {
-			pos = appendData(pos, end, part->data, part->size);
-			part = part->next;
-		}
-		pos = appendData(pos, end, "", 1);
+		PUSH_BUFFER("", 1);
 
 		it.next();
 	}
 
 	if (state.environmentVariablesData != NULL) {
-		pos = appendData(pos, end, state.environmentVariablesData, state.environmentVariablesSize);
+		PUSH_BUFFER(state.environmentVariablesData, state.environmentVariablesSize);
 	}
 
-	Uint32Message::generate(buffer, pos - buffer - sizeof(boost::uint32_t));
+	Uint32Message::generate(fixed, state.dataSize - sizeof(boost::uint32_t));
+
+	#undef PUSH_BUFFER
+}
+
+bool
+Controller::sendHeaderToAppWithSessionProtocolAndWritev(Request *req,
+	const SessionProtocolWorkingState &state, ssize_t &bytesWritten)
+{
+	if (state.nbuffers > IOV_MAX) {
+		bytesWritten = 0;
+		return false;
+	}
 
-	size = pos - buffer;
-	return pos < end;
+	ssize_t ret;
+	do {
+		ret = writev(req->session->fd(), state.buffers, state.nbuffers);
+	} while (ret == -1 && errno == EINTR);
+	bytesWritten = ret;
+	return ret == (ssize_t) state.dataSize;
+}
+
+void
+Controller::sendHeaderToAppWithSessionProtocolWithBuffering(Request *req,
+	const SessionProtocolWorkingState &state, unsigned int offset)
+{
+	MemoryKit::mbuf_pool &mbuf_pool = getContext()->mbuf_pool;
+	const unsigned int MBUF_MAX_SIZE = mbuf_pool_data_size(&mbuf_pool);
+	if (state.dataSize <= MBUF_MAX_SIZE) {
+		MemoryKit::mbuf buffer(MemoryKit::mbuf_get(&mbuf_pool));
+		gatherBuffers(buffer.start, MBUF_MAX_SIZE, state.buffers, state.nbuffers);
+		buffer = MemoryKit::mbuf(buffer, offset, state.dataSize - offset);
+		req->appSink.feedWithoutRefGuard(boost::move(buffer));
+	} else {
+		char *buffer = (char *) psg_pnalloc(req->pool, state.dataSize);
+		gatherBuffers(buffer, state.dataSize, state.buffers, state.nbuffers);
+		req->appSink.feedWithoutRefGuard(MemoryKit::mbuf(
+			buffer + offset, state.dataSize - offset));
+	}
 }
 
 void
@@ -659,7 +609,9 @@ Controller::sendHeaderToAppWithHttpProtocol(Client *client, Request *req) {
 
 	if (!sendHeaderToAppWithHttpProtocolAndWritev(req, bytesWritten, cache)) {
 		if (bytesWritten >= 0 || errno == EAGAIN || errno == EWOULDBLOCK) {
-			sendHeaderToAppWithHttpProtocolWithBuffering(req, bytesWritten, cache);
+			// bytesWritten is -1 on EAGAIN: nothing was written yet.
+			sendHeaderToAppWithHttpProtocolWithBuffering(req,
+				bytesWritten < 0 ? 0 : bytesWritten, cache);
 		} else {
 			int e = errno;
 			P_ASSERT_EQ(bytesWritten, -1);
@@ -720,7 +672,7 @@ Controller::constructHeaderBuffersForHttpProtocol(Request *req, struct iovec *bu
 	if (!cache.cached) {
 		cache.methodStr  = http_method_str(req->method);
 		cache.remoteAddr = req->secureHeaders.lookup(REMOTE_ADDR);
-		cache.setCookie  = req->headers.lookup(ServerKit::HTTP_SET_COOKIE);
+		cache.setCookie  = req->headers.lookup(ServerKit::KH_SET_COOKIE);
 		cache.cached     = true;
 	}
 
@@ -772,10 +724,8 @@ Controller::constructHeaderBuffersForHttpProtocol(Request *req, struct iovec *bu
 	}
 
 	while (*it != NULL) {
-		if ((it->header->hash == HTTP_CONNECTION.hash()
-		  || it->header->hash == ServerKit::HTTP_SET_COOKIE.hash())
-		 && (psg_lstr_cmp(&it->header->key, P_STATIC_STRING("connection"))
-		  || psg_lstr_cmp(&it->header->key, ServerKit::HTTP_SET_COOKIE)))
+		if (it->header == req->headers.lookupHeader(ServerKit::KH_CONNECTION)
+		 || it->header == req->headers.lookupHeader(ServerKit::KH_SET_COOKIE))
 		{
 			it.next();
 			continue;
@@ -950,6 +900,9 @@ void
 Controller::sendBodyToApp(Client *client, Request *req) {
 	TRACE_POINT();
 	assert(req->appSink.acceptingInput());
+	if (OXT_UNLIKELY(req->timed)) {
+		req->timings.requestHeaderSent = ev_now(getLoop());
+	}
 	#ifdef DEBUG_CC_EVENT_LOOP_BLOCKING
 		req->timeOnRequestHeaderSent = ev_now(getLoop());
 		reportLargeTimeDiff(client,
@@ -0,0 +1,391 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#include <Core/Controller.h>
+#ifdef __linux__
+	#include <sys/sendfile.h>
+#endif
+
+/*************************************************************************
+ *
+ * Implements Core::Controller methods pertaining serving static files
+ * from the application's public directory, without involving the
+ * application.
+ *
+ *************************************************************************/
+
+namespace Passenger {
+namespace Core {
+
+using namespace std;
+using namespace boost;
+
+
+/****************************
+ *
+ * Private methods
+ *
+ ****************************/
+
+
+static bool
+lookupContiguousHeader(Request *req, ServerKit::KnownHeader id,
+	StaticString &result)
+{
+	const LString *value = req->headers.lookup(id);
+	if (value == NULL) {
+		return false;
+	}
+	value = psg_lstr_make_contiguous(value, req->pool);
+	result = StaticString(value->start->data, value->size);
+	return true;
+}
+
+/**
+ * Checks whether the request refers to a file in the public directory.
+ * If so, sends that file, and returns true. Otherwise, the request
+ * should be forwarded to the application, and this method returns false.
+ */
+bool
+Controller::serveStaticFile(Client *client, Request *req) {
+	TRACE_POINT();
+
+	if ((req->method != HTTP_GET && req->method != HTTP_HEAD)
+	 || req->bodyType != Request::RBT_NO_BODY)
+	{
+		return false;
+	}
+
+	StaticString path = req->getPathWithoutQueryString();
+	bool redirect;
+	StaticFileCache::FilePtr file = staticFiles->lookup(path, &redirect);
+	if (file == NULL) {
+		if (redirect) {
+			redirectToStaticDirectory(client, req);
+			return true;
+		}
+		return false;
+	}
+
+	StaticString contentType = file->contentType;
+	bool vary = false;
+	bool gzip = false;
+	if (staticFilesGzip) {
+		StaticFileCache::FilePtr gzFile = lookupPrecompressedStaticFile(req, file, vary);
+		if (gzFile != NULL) {
+			file = gzFile;
+			gzip = true;
+		}
+	}
+
+	boost::uint64_t begin, end;
+	int status = checkStaticFilePreconditions(req, *file, begin, end);
+	SKC_TRACE(client, 2, "Serving static file " << file->filename <<
+		" with status " << status);
+
+	const unsigned int headerBufSize = 1024;
+	char *header = (char *) psg_pnalloc(req->pool, headerBufSize);
+	char *pos = header;
+	const char *headerEnd = header + headerBufSize - 1;
+	const char *statusAndReason = getStatusCodeAndReasonPhrase(status);
+
+	req->responseStatus = status;
+	pos += snprintf(pos, headerEnd - pos,
+		"HTTP/%d.%d %s\r\n"
+		"Status: %s\r\n",
+		(int) req->httpMajor, (int) req->httpMinor,
+		statusAndReason, statusAndReason);
+	pos += constructDateHeaderBuffersForResponse(pos, headerEnd - pos);
+	pos = appendData(pos, headerEnd, "\r\n");
+
+	if (status == 416) {
+		pos += snprintf(pos, headerEnd - pos,
+			"Content-Range: bytes */%llu\r\n"
+			"Content-Length: 0\r\n",
+			(unsigned long long) file->size);
+		begin = end = 0;
+	} else {
+		if (status != 304) {
+			pos = appendData(pos, headerEnd, "Content-Type: ");
+			pos = appendData(pos, headerEnd, contentType);
+			pos += snprintf(pos, headerEnd - pos,
+				"\r\nContent-Length: %llu\r\n"
+				"Accept-Ranges: bytes\r\n",
+				(unsigned long long) (end - begin));
+		}
+		if (status == 206) {
+			pos += snprintf(pos, headerEnd - pos,
+				"Content-Range: bytes %llu-%llu/%llu\r\n",
+				(unsigned long long) begin,
+				(unsigned long long) end - 1,
+				(unsigned long long) file->size);
+		}
+		pos = appendData(pos, headerEnd, "Last-Modified: ");
+		pos = appendData(pos, headerEnd, file->getLastModified());
+		pos = appendData(pos, headerEnd, "\r\nETag: ");
+		pos = appendData(pos, headerEnd, file->getEtag());
+		pos = appendData(pos, headerEnd, "\r\n");
+		if (gzip && status != 304) {
+			pos = appendData(pos, headerEnd, "Content-Encoding: gzip\r\n");
+		}
+		if (vary) {
+			pos = appendData(pos, headerEnd, "Vary: Accept-Encoding\r\n");
+		}
+		if (StaticFileCache::isFingerprintedAsset(path)) {
+			// Same as the Nginx configuration for the Rails asset pipeline.
+			pos = appendData(pos, headerEnd,
+				"Cache-Control: public, max-age=31536000\r\n"
+				"Expires: Thu, 31 Dec 2037 23:55:55 GMT\r\n");
+		}
+	}
+
+	if (canKeepAlive(req)) {
+		pos = appendData(pos, headerEnd, "Connection: keep-alive\r\n\r\n");
+	} else {
+		pos = appendData(pos, headerEnd, "Connection: close\r\n\r\n");
+	}
+
+	writeResponse(client, header, pos - header);
+	if (req->ended()) {
+		return true;
+	}
+	if (req->method == HTTP_HEAD || begin == end) {
+		endRequest(&client, &req);
+		return true;
+	}
+
+	req->state = Request::SERVING_STATIC_FILE;
+	req->staticFile = file;
+	req->staticFileOffset = begin;
+	req->staticFileRemaining = end - begin;
+	sendStaticFileBody(client, req);
+	return true;
+}
+
+/**
+ * Redirects a request for a directory without a trailing slash, such as
+ * `/docs`, to `/docs/`, like the web servers do.
+ */
+void
+Controller::redirectToStaticDirectory(Client *client, Request *req) {
+	StaticString path = req->getPathWithoutQueryString();
+	StaticString queryString = req->getQueryString();
+	const unsigned int headerBufSize = 300 + path.size() + queryString.size();
+	char *header = (char *) psg_pnalloc(req->pool, headerBufSize);
+	char *pos = header;
+	const char *headerEnd = header + headerBufSize - 1;
+
+	SKC_TRACE(client, 2, "Redirecting to static directory " << path << "/");
+	req->responseStatus = 301;
+	pos += snprintf(pos, headerEnd - pos,
+		"HTTP/%d.%d 301 Moved Permanently\r\n"
+		"Status: 301 Moved Permanently\r\n",
+		(int) req->httpMajor, (int) req->httpMinor);
+	pos += constructDateHeaderBuffersForResponse(pos, headerEnd - pos);
+	pos = appendData(pos, headerEnd, "\r\nLocation: ");
+	pos = appendData(pos, headerEnd, path);
+	pos = appendData(pos, headerEnd, "/");
+	if (!queryString.empty()) {
+		pos = appendData(pos, headerEnd, "?");
+		pos = appendData(pos, headerEnd, queryString);
+	}
+	pos = appendData(pos, headerEnd, "\r\nContent-Length: 0\r\n");
+	if (canKeepAlive(req)) {
+		pos = appendData(pos, headerEnd, "Connection: keep-alive\r\n\r\n");
+	} else {
+		pos = appendData(pos, headerEnd, "Connection: close\r\n\r\n");
+	}
+
+	writeResponse(client, header, pos - header);
+	if (!req->ended()) {
+		endRequest(&client, &req);
+	}
+}
+
+/**
+ * If the client accepts gzip and `<file>.gz` exists, returns the latter.
+ * Sets `vary` if the response depends on the client's Accept-Encoding.
+ */
+StaticFileCache::FilePtr
+Controller::lookupPrecompressedStaticFile(Request *req,
+	const StaticFileCache::FilePtr &file, bool &vary)
+{
+	StaticFileCache::FilePtr gzFile = staticFiles->lookupPrecompressed(*file);
+	StaticString acceptEncoding;
+
+	if (gzFile == NULL) {
+		return StaticFileCache::FilePtr();
+	}
+	vary = true;
+	if (lookupContiguousHeader(req, ServerKit::KH_ACCEPT_ENCODING, acceptEncoding)
+	 && ResponseCompression<Request>::negotiate(acceptEncoding) == ResponseCompressor::GZIP)
+	{
+		return gzFile;
+	} else {
+		return StaticFileCache::FilePtr();
+	}
+}
+
+/**
+ * Evaluates the conditional and range headers against `file`. Returns the
+ * status code to respond with, and sets [`begin`, `end`) to the part of
+ * the file to send.
+ */
+int
+Controller::checkStaticFilePreconditions(Request *req, const StaticFileCache::File &file,
+	boost::uint64_t &begin, boost::uint64_t &end)
+{
+	StaticString value, ifRange;
+
+	begin = 0;
+	end = file.size;
+
+	// If-None-Match takes precedence over If-Modified-Since.
+	if (lookupContiguousHeader(req, ServerKit::KH_IF_NONE_MATCH, value)) {
+		if (StaticFileCache::etagMatches(value, file.getEtag())) {
+			begin = end = 0;
+			return 304;
+		}
+	} else if (lookupContiguousHeader(req, ServerKit::KH_IF_MODIFIED_SINCE, value)) {
+		if (!StaticFileCache::modifiedSince(value, file.mtime)) {
+			begin = end = 0;
+			return 304;
+		}
+	}
+
+	if (lookupContiguousHeader(req, ServerKit::KH_RANGE, value)
+	 && (!lookupContiguousHeader(req, ServerKit::KH_IF_RANGE, ifRange)
+	     || StaticFileCache::ifRangeMatches(ifRange, file)))
+	{
+		switch (StaticFileCache::parseRange(value, file.size, begin, end)) {
+		case StaticFileCache::SATISFIABLE_RANGE:
+			return 206;
+		case StaticFileCache::UNSATISFIABLE_RANGE:
+			return 416;
+		default:
+			begin = 0;
+			end = file.size;
+			break;
+		}
+	}
+
+	return 200;
+}
+
+/**
+ * Sends the remainder of the static file. On Linux, data is sent with
+ * sendfile() whenever the client output channel has nothing buffered
+ * and isn't waiting for the socket to become writable.
+ * Otherwise, or when the socket is full, the next part is read into an
+ * mbuf and passed to the client output channel. Sending resumes from
+ * outputDataFlushed() once the client has received it.
+ */
+void
+Controller::sendStaticFileBody(Client *client, Request *req) {
+	TRACE_POINT();
+	MemoryKit::mbuf_pool &mbuf_pool = getContext()->mbuf_pool;
+	const StaticFileCache::File *file = req->staticFile.get();
+	ssize_t ret;
+
+	#ifdef __linux__
+		// sendfile() bypasses the output channel, so the response header
+		// must not be held back with the responses to pipelined requests.
+		uncorkOutput(client);
+		if (req->ended()) {
+			return;
+		}
+	#endif
+
+	while (req->staticFileRemaining > 0) {
+		#ifdef __linux__
+			if (client->output.getTotalBytesBuffered() == 0
+			 && client->output.getState() == Channel::IDLE)
+			{
+				off_t offset = req->staticFileOffset;
+
+				do {
+					ret = sendfile(client->getFd(), file->fd, &offset,
+						std::min<boost::uint64_t>(req->staticFileRemaining,
+							1024 * 1024));
+				} while (ret == -1 && errno == EINTR);
+
+				if (ret > 0) {
+					req->responseBegun = true;
+					req->lastDataSendTime = ev_now(getLoop());
+					req->staticFileOffset += ret;
+					req->staticFileRemaining -= ret;
+					continue;
+				} else if (ret == 0) {
+					disconnectWithError(&client, "static file " + file->filename
+						+ " was truncated while it was being sent");
+					return;
+				} else if (errno != EAGAIN && errno != EWOULDBLOCK
+					&& errno != EINVAL && errno != ENOSYS)
+				{
+					disconnectWithClientSocketWriteError(&client, errno);
+					return;
+				}
+				// The socket is full, or the file system doesn't support
+				// sendfile(). Let the output channel send the next part.
+			}
+		#endif
+
+		MemoryKit::mbuf buffer(MemoryKit::mbuf_get(&mbuf_pool));
+		do {
+			ret = pread(file->fd, buffer.start,
+				std::min<boost::uint64_t>(req->staticFileRemaining, buffer.size()),
+				req->staticFileOffset);
+		} while (ret == -1 && errno == EINTR);
+
+		if (ret <= 0) {
+			int e = errno;
+			disconnectWithError(&client, "cannot read static file " + file->filename
+				+ ": " + ((ret == 0) ? string("file was truncated") : string(strerror(e))));
+			return;
+		}
+
+		req->staticFileOffset += ret;
+		req->staticFileRemaining -= ret;
+		writeResponse(client, MemoryKit::mbuf(buffer, 0, ret));
+		if (req->ended()) {
+			return;
+		}
+		if (req->staticFileRemaining > 0
+		 && (client->output.getTotalBytesBuffered() > 0
+		  || client->output.getState() != Channel::IDLE))
+		{
+			SKC_TRACE(client, 2, "Waiting for the client to receive the static file"
+				" data before sending more");
+			client->output.setDataFlushedCallback(_outputDataFlushed);
+			return;
+		}
+	}
+
+	endRequest(&client, &req);
+}
+
+
+} // namespace Core
+} // namespace Passenger
@@ -39,6 +39,116 @@ using namespace std;
 using namespace boost;
 
 
+static const MetricsRegistry::Family CONTROLLER_CLIENTS = {
+	"passenger_controller_clients", MetricsRegistry::GAUGE,
+	"Number of connected clients."
+};
+static const MetricsRegistry::Family CONTROLLER_CLIENTS_ACCEPTED = {
+	"passenger_controller_clients_accepted", MetricsRegistry::COUNTER,
+	"Number of client connections that were accepted."
+};
+static const MetricsRegistry::Family CONTROLLER_REQUESTS = {
+	"passenger_controller_requests", MetricsRegistry::COUNTER,
+	"Number of requests that were received."
+};
+static const MetricsRegistry::Family TURBOCACHE_FETCHES = {
+	"passenger_turbocache_fetches", MetricsRegistry::COUNTER,
+	"Number of turbocache lookups."
+};
+static const MetricsRegistry::Family TURBOCACHE_HITS = {
+	"passenger_turbocache_hits", MetricsRegistry::COUNTER,
+	"Number of turbocache lookups that found a fresh response."
+};
+static const MetricsRegistry::Family TURBOCACHE_STORES = {
+	"passenger_turbocache_stores", MetricsRegistry::COUNTER,
+	"Number of attempts to store a response in the turbocache."
+};
+static const MetricsRegistry::Family TURBOCACHE_STORE_SUCCESSES = {
+	"passenger_turbocache_store_successes", MetricsRegistry::COUNTER,
+	"Number of responses that were stored in the turbocache."
+};
+static const MetricsRegistry::Family MBUF_BLOCKS = {
+	"passenger_mbuf_blocks", MetricsRegistry::GAUGE,
+	"Number of mbuf blocks, which buffer network data, by size class and state."
+};
+static const MetricsRegistry::Family MBUF_BLOCK_GETS = {
+	"passenger_mbuf_block_gets", MetricsRegistry::COUNTER,
+	"Number of mbuf blocks that were handed out, by size class."
+};
+static const MetricsRegistry::Family MBUF_BLOCK_MALLOCS = {
+	"passenger_mbuf_block_mallocs", MetricsRegistry::COUNTER,
+	"Number of mbuf blocks that could not be reused from a free list, by size class."
+};
+static const MetricsRegistry::Family FILE_BUFFER_BYTES = {
+	"passenger_file_buffer_bytes", MetricsRegistry::GAUGE,
+	"Number of bytes that request and response buffers hold in memory."
+};
+static const MetricsRegistry::Family FILE_BUFFER_SPILLS = {
+	"passenger_file_buffer_spills", MetricsRegistry::COUNTER,
+	"Number of times that a request or response buffer switched to buffering on disk."
+};
+
+
+/****************************
+ *
+ * Private methods
+ *
+ ****************************/
+
+
+/**
+ * Publishes a snapshot of this thread's metrics to `metricsPublisher`.
+ * Called from the event loop every few seconds, so that rendering the
+ * metrics doesn't require a round trip to this thread.
+ */
+void
+Controller::publishMetrics() {
+	const MemoryKit::mbuf_pool *mbuf_pool;
+	const ServerKit::FileBufferedChannelMemoryUsage &fileBufferUsage =
+		getContext()->fileBufferedChannelMemoryUsage;
+	char number[16];
+	string labels, sizeLabels, stateLabels;
+
+	MetricsRegistry::appendLabel(labels, "thread",
+		StaticString(number, uintToString(threadNumber, number, sizeof(number))));
+
+	metricsPublisher->add(CONTROLLER_CLIENTS, labels, activeClientCount);
+	metricsPublisher->add(CONTROLLER_CLIENTS_ACCEPTED, labels, totalClientsAccepted);
+	metricsPublisher->add(CONTROLLER_REQUESTS, labels, totalRequestsBegun);
+
+	if (turboCaching.isEnabled()) {
+		const ResponseCache<Request> &cache = turboCaching.responseCache;
+		metricsPublisher->add(TURBOCACHE_FETCHES, labels, cache.getFetches());
+		metricsPublisher->add(TURBOCACHE_HITS, labels, cache.getHits());
+		metricsPublisher->add(TURBOCACHE_STORES, labels, cache.getStores());
+		metricsPublisher->add(TURBOCACHE_STORE_SUCCESSES, labels,
+			cache.getStoreSuccesses());
+	}
+
+	for (mbuf_pool = &getContext()->small_mbuf_pool; mbuf_pool != NULL;
+		mbuf_pool = mbuf_pool->larger)
+	{
+		sizeLabels = labels;
+		MetricsRegistry::appendLabel(sizeLabels, "size",
+			StaticString(number, uintToString(mbuf_pool->mbuf_block_chunk_size,
+				number, sizeof(number))));
+		stateLabels = sizeLabels;
+		MetricsRegistry::appendLabel(stateLabels, "state", "active");
+		metricsPublisher->add(MBUF_BLOCKS, stateLabels, mbuf_pool->nactive_mbuf_blockq);
+		stateLabels = sizeLabels;
+		MetricsRegistry::appendLabel(stateLabels, "state", "free");
+		metricsPublisher->add(MBUF_BLOCKS, stateLabels, mbuf_pool->nfree_mbuf_blockq);
+		metricsPublisher->add(MBUF_BLOCK_GETS, sizeLabels, mbuf_pool->nget);
+		metricsPublisher->add(MBUF_BLOCK_MALLOCS, sizeLabels, mbuf_pool->nmalloc);
+	}
+
+	metricsPublisher->add(FILE_BUFFER_BYTES, labels, fileBufferUsage.bytesBuffered);
+	metricsPublisher->add(FILE_BUFFER_SPILLS, labels, fileBufferUsage.spills);
+
+	metricsPublisher->publish();
+}
+
+
 /****************************
  *
  * Public methods
@@ -53,6 +163,16 @@ Controller::getConfigAsJson() const {
 	doc["stat_throttle_rate"] = statThrottleRate;
 	doc["show_version_in_header"] = showVersionInHeader;
 	doc["data_buffer_dir"] = getContext()->defaultFileBufferedChannelConfig.bufferDir;
+	doc["file_buffer_memory_budget"] = getContext()->fileBufferedChannelMemoryBudget;
+	doc["request_timing_sample_rate"] = requestTimingSampleRate;
+	doc["response_compression"] = responseCompression.isEnabled();
+	if (accessLog != NULL) {
+		doc["access_log"] = accessLog->getPath();
+	}
+	if (staticFiles != NULL) {
+		doc["static_files_dir"] = staticFiles->getDocumentRoot();
+		doc["static_files_gzip"] = staticFilesGzip;
+	}
 	return doc;
 }
 
@@ -66,6 +186,13 @@ Controller::configure(const Json::Value &doc) {
 		getContext()->defaultFileBufferedChannelConfig.bufferDir =
 			doc["data_buffer_dir"].asString();
 	}
+	if (doc.isMember("file_buffer_memory_budget")) {
+		getContext()->fileBufferedChannelMemoryBudget =
+			doc["file_buffer_memory_budget"].asUInt();
+	}
+	if (doc.isMember("request_timing_sample_rate")) {
+		setRequestTimingSampleRate(doc["request_timing_sample_rate"].asUInt());
+	}
 }
 
 Json::Value
@@ -81,9 +208,56 @@ Controller::inspectStateAsJson() const {
 		subdoc["store_success_ratio"] = turboCaching.responseCache.getStoreSuccessRatio();
 		doc["turbocaching"] = subdoc;
 	}
+	if (requestTimingSampleRate != 0 || requestTimings.total.getCount() > 0) {
+		Json::Value subdoc;
+		subdoc["sample_rate"] = requestTimingSampleRate;
+		subdoc["initialization"] = durationHistogramToJson(requestTimings.initialization);
+		subdoc["checkout"] = durationHistogramToJson(requestTimings.checkout);
+		subdoc["send_request_header"] = durationHistogramToJson(requestTimings.sendRequestHeader);
+		subdoc["app"] = durationHistogramToJson(requestTimings.app);
+		subdoc["response"] = durationHistogramToJson(requestTimings.response);
+		subdoc["total"] = durationHistogramToJson(requestTimings.total);
+		doc["request_timings"] = subdoc;
+		doc["event_loop_lag"] = durationHistogramToJson(eventLoopLag);
+	}
 	return doc;
 }
 
+/**
+ * Sets the access log to write to, or disables access logging if `log`
+ * is NULL. Must be called from the event loop thread, or before the event
+ * loop is started. `log` must outlive this Controller.
+ */
+void
+Controller::setAccessLog(AccessLog *log) {
+	submitAccessLogBuffer();
+	accessLog = log;
+	updatePrepareWatcher();
+}
+
+/**
+ * Makes the Controller serve files in `documentRoot` directly, instead of
+ * forwarding requests for them to the application. Only supported in
+ * single-app mode. Must be called before the event loop is started.
+ * `cstat` must outlive this Controller.
+ */
+void
+Controller::enableStaticFiles(const StaticString &documentRoot, CachedFileStat *cstat) {
+	assert(singleAppMode);
+	delete staticFiles;
+	staticFiles = new StaticFileCache(documentRoot, cstat, statThrottleRate);
+}
+
+/**
+ * Makes this Controller publish its metrics to the given publisher every
+ * few seconds, or stops that if `publisher` is NULL. Must be called from
+ * the event loop thread, or before the event loop is started.
+ */
+void
+Controller::setMetricsPublisher(MetricsRegistry::Publisher *publisher) {
+	metricsPublisher = publisher;
+}
+
 Json::Value
 Controller::inspectClientStateAsJson(const Client *client) const {
 	Json::Value doc = ParentClass::inspectClientStateAsJson(client);
@@ -116,6 +290,11 @@ Controller::inspectRequestStateAsJson(const Request *req) const {
 		doc["body_bytes_buffered"] = byteSizeToJson(req->bodyBytesBuffered);
 	}
 
+	if (req->staticFile != NULL) {
+		doc["static_file"] = req->staticFile->filename;
+		doc["static_file_bytes_remaining"] = byteSizeToJson(req->staticFileRemaining);
+	}
+
 	if (req->session != NULL) {
 		Json::Value &sessionDoc = doc["session"] = Json::Value(Json::objectValue);
 		const AbstractSession *session = req->session.get();
@@ -86,6 +86,7 @@
 #include <Utils/IOUtils.h>
 #include <Utils/MessageIO.h>
 #include <Utils/VariantMap.h>
+#include <Utils/MetricsRegistry.h>
 #include <Core/OptionParser.h>
 #include <Core/Controller.h>
 #include <Core/ApiServer.h>
@@ -155,6 +156,9 @@ namespace Core {
 		oxt::thread *prestarterThread;
 
 		SecurityUpdateChecker *securityUpdateChecker;
+		Core::AccessLog *accessLog;
+		CachedFileStat *staticFileStat;
+		MetricsRegistry metrics;
 
 		WorkingObjects()
 			: exitEvent(__FILE__, __LINE__, "WorkingObjects: exitEvent"),
@@ -162,7 +166,9 @@ namespace Core {
 			  terminationCount(0),
 			  shutdownCounter(0),
 			  prestarterThread(NULL),
-			  securityUpdateChecker(NULL)
+			  securityUpdateChecker(NULL),
+			  accessLog(NULL),
+			  staticFileStat(NULL)
 		{
 			for (unsigned int i = 0; i < SERVER_KIT_MAX_SERVER_ENDPOINTS; i++) {
 				serverFds[i] = -1;
@@ -182,6 +188,8 @@ namespace Core {
 				delete it->serverKitContext;
 				delete it->bgloop;
 			}
+			delete accessLog;
+			delete staticFileStat;
 
 			delete apiWorkingObjects.apiServer;
 			delete apiWorkingObjects.serverKitContext;
@@ -658,12 +666,25 @@ initializeNonPrivilegedWorkingObjects() {
 	UPDATE_TRACE_POINT();
 	wo->spawningKitFactory = boost::make_shared<SpawningKit::Factory>(wo->spawningKitConfig);
 	wo->appPool = boost::make_shared<Pool>(wo->spawningKitFactory, agentsOptions);
+	wo->appPool->setMetricsPublisher(wo->metrics.createPublisher());
 	wo->appPool->initialize();
 	wo->appPool->setMax(options.getInt("max_pool_size"));
 	wo->appPool->setMaxIdleTime(options.getInt("pool_idle_time") * 1000000ULL);
 	wo->appPool->enableSelfChecking(options.getBool("selfchecks"));
 	wo->appPool->abortLongRunningConnectionsCallback = abortLongRunningConnections;
 
+	UPDATE_TRACE_POINT();
+	if (options.has("access_log")) {
+		wo->accessLog = new Core::AccessLog(options.get("access_log"),
+			options.getULL("access_log_rotate_size", false, 0));
+	}
+	if (options.has("static_files_dir")) {
+		// Shared by all Controllers, so that a file is stat()ed at most
+		// once per throttle period no matter which thread serves it.
+		wo->staticFileStat = new CachedFileStat();
+		wo->staticFileStat->enableChangeNotifications();
+	}
+
 	UPDATE_TRACE_POINT();
 	unsigned int nthreads = options.getInt("core_threads");
 	BackgroundEventLoop *firstLoop = NULL; // Avoid compiler warning
@@ -677,6 +698,8 @@ initializeNonPrivilegedWorkingObjects() {
 		} else {
 			two.bgloop = new BackgroundEventLoop(true, true);
 		}
+		two.bgloop->safe->setMaxCommandsPerIteration(
+			options.getUint("core_max_callbacks_per_iteration"));
 
 		UPDATE_TRACE_POINT();
 		two.serverKitContext = new ServerKit::Context(two.bgloop->safe,
@@ -686,16 +709,27 @@ initializeNonPrivilegedWorkingObjects() {
 			options.get("data_buffer_dir");
 		two.serverKitContext->defaultFileBufferedChannelConfig.threshold =
 			options.getUint("file_buffer_threshold");
+		two.serverKitContext->fileBufferedChannelMemoryBudget =
+			options.getUint("file_buffer_memory_budget");
 
 		UPDATE_TRACE_POINT();
 		two.controller = new Core::Controller(two.serverKitContext, agentsOptions, i + 1);
 		two.controller->minSpareClients = 128;
 		two.controller->clientFreelistLimit = 1024;
+		two.controller->clientHeaderTimeout = options.getUint("client_header_timeout");
+		two.controller->clientBodyTimeout = options.getUint("client_body_timeout");
+		two.controller->clientKeepAliveTimeout = options.getUint("client_keepalive_timeout");
 		two.controller->resourceLocator = &wo->resourceLocator;
 		two.controller->appPool = wo->appPool;
 		two.controller->unionStationContext = wo->unionStationContext;
 		two.controller->shutdownFinishCallback = controllerShutdownFinished;
 		two.controller->initialize();
+		two.controller->setAccessLog(wo->accessLog);
+		two.controller->setMetricsPublisher(wo->metrics.createPublisher());
+		if (wo->staticFileStat != NULL) {
+			two.controller->enableStaticFiles(options.get("static_files_dir"),
+				wo->staticFileStat);
+		}
 		wo->shutdownCounter.fetch_add(1, boost::memory_order_relaxed);
 
 		wo->threadWorkingObjects.push_back(two);
@@ -732,6 +766,7 @@ initializeNonPrivilegedWorkingObjects() {
 		}
 		awo->apiServer->apiAccountDatabase = &wo->apiAccountDatabase;
 		awo->apiServer->appPool = wo->appPool;
+		awo->apiServer->metricsRegistry = &wo->metrics;
 		awo->apiServer->instanceDir = options.get("instance_dir", false);
 		awo->apiServer->fdPassingPassword = options.get("watchdog_fd_passing_password", false);
 		awo->apiServer->exitEvent = &wo->exitEvent;
@@ -1036,6 +1071,10 @@ cleanup() {
 		delete two->controller;
 		two->controller = NULL;
 	}
+	delete wo->accessLog;
+	wo->accessLog = NULL;
+	delete wo->staticFileStat;
+	wo->staticFileStat = NULL;
 	if (wo->prestarterThread != NULL) {
 		wo->prestarterThread->interrupt_and_join();
 		delete wo->prestarterThread;
@@ -1138,6 +1177,9 @@ preinitialize(VariantMap &options) {
 	if (options.has("core_file_descriptor_log_file")) {
 		options.set("file_descriptor_log_file", options.get("core_file_descriptor_log_file"));
 	}
+	if (options.has("core_async_logging")) {
+		options.setBool("async_logging", options.getBool("core_async_logging"));
+	}
 }
 
 static string
@@ -1182,6 +1224,9 @@ setAgentsOptionsDefaults() {
 	options.setDefaultInt("min_instances", 1);
 	options.setDefaultInt("max_preloader_idle_time", DEFAULT_MAX_PRELOADER_IDLE_TIME);
 	options.setDefaultUint("max_request_queue_size", DEFAULT_MAX_REQUEST_QUEUE_SIZE);
+	options.setDefaultUint("max_request_queue_time", 0);
+	options.setDefaultUint("target_latency", 0);
+	options.setDefaultUint("request_timing_sample_rate", 0);
 	options.setDefaultUint("stat_throttle_rate", DEFAULT_STAT_THROTTLE_RATE);
 	options.setDefault("server_software", SERVER_TOKEN_NAME "/" PASSENGER_VERSION);
 	options.setDefaultBool("show_version_in_header", true);
@@ -1190,11 +1235,26 @@ setAgentsOptionsDefaults() {
 	options.setDefaultBool("turbocaching", true);
 	options.setDefault("data_buffer_dir", getSystemTempDir());
 	options.setDefaultUint("file_buffer_threshold", DEFAULT_FILE_BUFFERED_CHANNEL_THRESHOLD);
+	options.setDefaultUint("file_buffer_memory_budget", 0);
 	options.setDefaultInt("response_buffer_high_watermark", DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK);
 	options.setDefaultBool("selfchecks", false);
 	options.setDefaultBool("core_graceful_exit", true);
 	options.setDefaultInt("core_threads", boost::thread::hardware_concurrency());
 	options.setDefaultBool("core_cpu_affine", false);
+	options.setDefaultUint("core_max_callbacks_per_iteration", 0);
+	if (options.get("integration_mode") == "standalone"
+	 && options.get("standalone_engine") == "builtin")
+	{
+		// Clients connect to us directly, so protect ourselves against
+		// idle and slow clients. Otherwise the web server does that.
+		options.setDefaultUint("client_header_timeout", DEFAULT_CLIENT_HEADER_TIMEOUT);
+		options.setDefaultUint("client_body_timeout", DEFAULT_CLIENT_BODY_TIMEOUT);
+		options.setDefaultUint("client_keepalive_timeout", DEFAULT_CLIENT_KEEPALIVE_TIMEOUT);
+	} else {
+		options.setDefaultUint("client_header_timeout", 0);
+		options.setDefaultUint("client_body_timeout", 0);
+		options.setDefaultUint("client_keepalive_timeout", 0);
+	}
 	options.setDefault("friendly_error_pages", "auto");
 	options.setDefaultBool("rolling_restarts", false);
 	options.setDefaultBool("resist_deployment_errors", false);
@@ -1235,6 +1295,11 @@ sanityCheckOptions() {
 			"when in multi-app mode.\n");
 		ok = false;
 	}
+	if (options.getBool("multi_app") && options.has("static_files_dir")) {
+		fprintf(stderr, "ERROR: you may not specify a static files directory "
+			"when in multi-app mode.\n");
+		ok = false;
+	}
 	if (!options.getBool("multi_app") && options.has("app_type")) {
 		PassengerAppType appType = getAppType(options.get("app_type"));
 		if (appType == PAT_NONE || appType == PAT_ERROR) {
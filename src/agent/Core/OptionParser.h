@@ -158,6 +158,38 @@ coreUsage() {
 	printf("      --max-request-queue-size NUMBER\n");
 	printf("                            Specify request queue size. Default: %d\n",
 		DEFAULT_MAX_REQUEST_QUEUE_SIZE);
+	printf("      --max-request-queue-time SECONDS\n");
+	printf("                            Reject requests that have been waiting in the\n");
+	printf("                            request queue for longer than the given time.\n");
+	printf("                            Default: 0 (unlimited)\n");
+	printf("      --request-timing-sample-rate N\n");
+	printf("                            Record per-phase timings for 1 in N requests,\n");
+	printf("                            and measure event loop lag. Default: 0 (disabled)\n");
+	printf("      --target-latency MSEC Adapt the number of concurrent requests per\n");
+	printf("                            process so that request latency stays below\n");
+	printf("                            the given time, and reject requests early\n");
+	printf("                            when it doesn't. Default: 0 (disabled)\n");
+	printf("      --request-queue-deadline-header NAME\n");
+	printf("                            Read the number of milliseconds that a client\n");
+	printf("                            is willing to wait in the request queue from\n");
+	printf("                            the given request header\n");
+	printf("      --client-header-timeout SECONDS\n");
+	printf("                            Close the connection if a client takes longer\n");
+	printf("                            than this to send the request header. Default:\n");
+	printf("                            %d in builtin Standalone mode, 0 (disabled)\n",
+		DEFAULT_CLIENT_HEADER_TIMEOUT);
+	printf("                            otherwise\n");
+	printf("      --client-body-timeout SECONDS\n");
+	printf("                            Close the connection if a client sends no\n");
+	printf("                            request body data for this long. Default: %d\n",
+		DEFAULT_CLIENT_BODY_TIMEOUT);
+	printf("                            in builtin Standalone mode, 0 (disabled)\n");
+	printf("                            otherwise\n");
+	printf("      --client-keepalive-timeout SECONDS\n");
+	printf("                            Close keep-alive connections that are idle for\n");
+	printf("                            this long. Default: %d in builtin Standalone\n",
+		DEFAULT_CLIENT_KEEPALIVE_TIMEOUT);
+	printf("                            mode, 0 (disabled) otherwise\n");
 	printf("      --sticky-sessions     Enable sticky sessions\n");
 	printf("      --sticky-sessions-cookie-name NAME\n");
 	printf("                            Cookie name to use for sticky sessions.\n");
@@ -166,6 +198,25 @@ coreUsage() {
 	printf("                            Vary the turbocache by the cookie of the given name\n");
 	printf("      --disable-turbocaching\n");
 	printf("                            Disable turbocaching\n");
+	printf("      --response-compression\n");
+	printf("                            Compress responses with gzip or deflate if the\n");
+	printf("                            client accepts it\n");
+	printf("      --response-compression-level LEVEL\n");
+	printf("                            zlib compression level (1-9). Default: %d\n",
+		DEFAULT_RESPONSE_COMPRESSION_LEVEL);
+	printf("      --response-compression-min-size BYTES\n");
+	printf("                            Do not compress responses smaller than this.\n");
+	printf("                            Default: %d\n", DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE);
+	printf("      --response-compression-types LIST\n");
+	printf("                            Comma-separated content types to compress.\n");
+	printf("                            'type/*' matches all subtypes. Default: text/html,\n");
+	printf("                            text/css, JavaScript, JSON, XML and SVG\n");
+	printf("      --static-files-dir PATH\n");
+	printf("                            Serve files in the given directory directly,\n");
+	printf("                            without involving the application (single-app\n");
+	printf("                            mode only)\n");
+	printf("      --static-files-gzip   Serve FILE.gz instead of a static file to clients\n");
+	printf("                            that accept gzip\n");
 	printf("      --no-abort-websockets-on-process-shutdown\n");
 	printf("                            Do not abort WebSocket connections on process\n");
 	printf("                            shutdown or restart\n");
@@ -174,6 +225,15 @@ coreUsage() {
 	printf("      --log-file PATH       Log to the given file.\n");
 	printf("      --log-level LEVEL     Logging level. Default: %d\n", DEFAULT_LOG_LEVEL);
 	printf("      --fd-log-file PATH    Log file descriptor activity to the given file.\n");
+	printf("      --access-log PATH     Log requests to the given file or FIFO\n");
+	printf("      --access-log-format FORMAT\n");
+	printf("                            Access log format. Default:\n");
+	printf("                            '%s'\n", DEFAULT_ACCESS_LOG_FORMAT);
+	printf("      --access-log-rotate-size BYTES\n");
+	printf("                            Rotate the access log once it grows beyond this\n");
+	printf("                            size. Default: 0 (never)\n");
+	printf("      --async-logging       Write non-error log messages from a background\n");
+	printf("                            thread\n");
 	printf("      --stat-throttle-rate SECONDS\n");
 	printf("                            Throttle filesystem restart.txt checks to at most\n");
 	printf("                            once per given seconds. Default: %d\n", DEFAULT_STAT_THROTTLE_RATE);
@@ -195,6 +255,10 @@ coreUsage() {
 	printf("                            Default: number of CPU cores (%d)\n",
 		boost::thread::hardware_concurrency());
 	printf("      --cpu-affine          Enable per-thread CPU affinity (Linux only)\n");
+	printf("      --max-callbacks-per-iteration NUMBER\n");
+	printf("                            Maximum number of callbacks from other threads\n");
+	printf("                            that an event loop runs before handling I/O\n");
+	printf("                            again. Default: 0 (unlimited)\n");
 	printf("      --core-file-descriptor-ulimit NUMBER\n");
 	printf("                            Set custom file descriptor ulimit for the core\n");
 	printf("  -h, --help                Show this help\n");
@@ -339,6 +403,27 @@ parseCoreOption(int argc, const char *argv[], int &i, VariantMap &options) {
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--max-request-queue-size")) {
 		options.setInt("max_request_queue_size", atoi(argv[i + 1]));
 		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--max-request-queue-time")) {
+		options.setInt("max_request_queue_time", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--request-timing-sample-rate")) {
+		options.setInt("request_timing_sample_rate", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--target-latency")) {
+		options.setInt("target_latency", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--request-queue-deadline-header")) {
+		options.set("request_queue_deadline_header", argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--client-header-timeout")) {
+		options.setUint("client_header_timeout", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--client-body-timeout")) {
+		options.setUint("client_body_timeout", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--client-keepalive-timeout")) {
+		options.setUint("client_keepalive_timeout", atoi(argv[i + 1]));
+		i += 2;
 	} else if (p.isFlag(argv[i], '\0', "--sticky-sessions")) {
 		options.setBool("sticky_sessions", true);
 		i++;
@@ -351,6 +436,24 @@ parseCoreOption(int argc, const char *argv[], int &i, VariantMap &options) {
 	} else if (p.isFlag(argv[i], '\0', "--disable-turbocaching")) {
 		options.setBool("turbocaching", false);
 		i++;
+	} else if (p.isFlag(argv[i], '\0', "--response-compression")) {
+		options.setBool("response_compression", true);
+		i++;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--response-compression-level")) {
+		options.setInt("response_compression_level", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--response-compression-min-size")) {
+		options.setUint("response_compression_min_size", atoi(argv[i + 1]));
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--response-compression-types")) {
+		options.set("response_compression_types", argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--static-files-dir")) {
+		options.set("static_files_dir", argv[i + 1]);
+		i += 2;
+	} else if (p.isFlag(argv[i], '\0', "--static-files-gzip")) {
+		options.setBool("static_files_gzip", true);
+		i++;
 	} else if (p.isFlag(argv[i], '\0', "--no-abort-websockets-on-process-shutdown")) {
 		options.setBool("abort_websockets_on_process_shutdown", false);
 		i++;
@@ -393,6 +496,19 @@ parseCoreOption(int argc, const char *argv[], int &i, VariantMap &options) {
 		// the Watchdog, we don't want to affect the Watchdog's own log file.
 		options.set("core_file_descriptor_log_file", argv[i + 1]);
 		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--access-log")) {
+		options.set("access_log", argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--access-log-format")) {
+		options.set("access_log_format", argv[i + 1]);
+		i += 2;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--access-log-rotate-size")) {
+		options.setULL("access_log_rotate_size", atoll(argv[i + 1]));
+		i += 2;
+	} else if (p.isFlag(argv[i], '\0', "--async-logging")) {
+		// We do not set async_logging for the same reason.
+		options.setBool("core_async_logging", true);
+		i++;
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--stat-throttle-rate")) {
 		options.setInt("stat_throttle_rate", atoi(argv[i + 1]));
 		i += 2;
@@ -417,6 +533,9 @@ parseCoreOption(int argc, const char *argv[], int &i, VariantMap &options) {
 	} else if (p.isFlag(argv[i], '\0', "--cpu-affine")) {
 		options.setBool("core_cpu_affine", true);
 		i++;
+	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--max-callbacks-per-iteration")) {
+		options.setUint("core_max_callbacks_per_iteration", atoi(argv[i + 1]));
+		i += 2;
 	} else if (p.isValueFlag(argc, i, argv[i], '\0', "--core-file-descriptor-ulimit")) {
 		options.setUint("core_file_descriptor_ulimit", atoi(argv[i + 1]));
 		i += 2;
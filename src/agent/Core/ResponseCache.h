@@ -34,6 +34,7 @@
 #include <ServerKit/http_parser.h>
 #include <ServerKit/CookieUtils.h>
 #include <StaticString.h>
+#include <Core/ResponseCompression.h>
 #include <Utils/DateParsing.h>
 #include <Utils/StrIntUtils.h>
 
@@ -71,6 +72,7 @@ public:
 	struct Body {
 		unsigned short httpHeaderSize;
 		unsigned short httpBodySize;
+		unsigned short httpStatusCode;
 		time_t expiryDate;
 		char key[MAX_KEY_LENGTH];
 		char httpHeaderData[MAX_HEADER_SIZE];
@@ -80,6 +82,7 @@ public:
 		Body()
 			: httpHeaderSize(0),
 			  httpBodySize(0),
+			  httpStatusCode(0),
 			  expiryDate(0)
 		{
 			key[0] = httpHeaderData[0] = httpBodyData[0] = '\0';
@@ -125,19 +128,6 @@ public:
 	};
 
 private:
-	HashedStaticString HOST;
-	HashedStaticString CACHE_CONTROL;
-	HashedStaticString PRAGMA_CONST;
-	HashedStaticString AUTHORIZATION;
-	HashedStaticString VARY;
-	HashedStaticString WWW_AUTHENTICATE;
-	HashedStaticString X_SENDFILE;
-	HashedStaticString X_ACCEL_REDIRECT;
-	HashedStaticString EXPIRES;
-	HashedStaticString LAST_MODIFIED;
-	HashedStaticString LOCATION;
-	HashedStaticString CONTENT_LOCATION;
-	HashedStaticString COOKIE;
 	HashedStaticString PASSENGER_VARY_TURBOCACHE_BY_COOKIE;
 
 	unsigned int fetches, hits, stores, storeSuccesses;
@@ -151,6 +141,7 @@ private:
 	{
 		unsigned int size =
 			1  // protocol flag
+			+ 1  // content coding
 			+ ((host != NULL) ? host->size : 0)
 			+ 1  // '\n'
 			+ path.size()
@@ -162,7 +153,12 @@ private:
 		}
 	}
 
-	void generateKey(bool https, const StaticString &path,
+	/**
+	 * Every content coding that a response may be compressed with has its
+	 * own key, so that the compressed and uncompressed variants of a
+	 * response are cached separately.
+	 */
+	void generateKey(bool https, unsigned int encoding, const StaticString &path,
 		const LString * restrict host,
 		const LString * restrict varyCookie,
 		char * restrict output,
@@ -177,6 +173,8 @@ private:
 		} else {
 			pos = appendData(pos, end, "H", 1);
 		}
+		*pos = '0' + encoding;
+		pos++;
 
 		if (host != NULL) {
 			part = host->start;
@@ -331,7 +329,7 @@ private:
 		}
 	}
 
-	void invalidateLocation(Request *req, const HashedStaticString &header) {
+	void invalidateLocation(Request *req, ServerKit::KnownHeader header) {
 		const LString *value = req->appResponse.headers.lookup(header);
 		if (value == NULL || value->size == 0) {
 			return;
@@ -400,29 +398,18 @@ private:
 		}
 
 		char *key = (char *) psg_pnalloc(req->pool, keySize);
-		generateKey(https, path, req->host, req->varyCookie, key, keySize);
-
-		Entry entry(lookup(StaticString(key, keySize)));
-		if (entry.valid()) {
-			entry.header->valid = false;
+		for (unsigned int i = 0; i < ResponseCompressor::ENCODING_COUNT; i++) {
+			generateKey(https, i, path, req->host, req->varyCookie, key, keySize);
+			Entry entry(lookup(StaticString(key, keySize)));
+			if (entry.valid()) {
+				entry.header->valid = false;
+			}
 		}
 	}
 
 public:
 	ResponseCache()
-		: CACHE_CONTROL("cache-control"),
-		  PRAGMA_CONST("pragma"),
-		  AUTHORIZATION("authorization"),
-		  VARY("vary"),
-		  WWW_AUTHENTICATE("www-authenticate"),
-		  X_SENDFILE("x-sendfile"),
-		  X_ACCEL_REDIRECT("x-accel-redirect"),
-		  EXPIRES("expires"),
-		  LAST_MODIFIED("last-modified"),
-		  LOCATION("location"),
-		  CONTENT_LOCATION("content-location"),
-		  COOKIE("cookie"),
-		  PASSENGER_VARY_TURBOCACHE_BY_COOKIE("!~PASSENGER_VARY_TURBOCACHE_COOKIE"),
+		: PASSENGER_VARY_TURBOCACHE_BY_COOKIE("!~PASSENGER_VARY_TURBOCACHE_COOKIE"),
 		  fetches(0),
 		  hits(0),
 		  stores(0),
@@ -491,16 +478,17 @@ public:
 			return false;
 		}
 
-		LString *varyCookieName = req->secureHeaders.lookup(PASSENGER_VARY_TURBOCACHE_BY_COOKIE);
+		const LString *varyCookieName = req->lookupSecureHeader(PASSENGER_VARY_TURBOCACHE_BY_COOKIE);
 		if (varyCookieName == NULL && !controller->defaultVaryTurbocacheByCookie.empty()) {
-			varyCookieName = (LString *) psg_palloc(req->pool, sizeof(LString));
-			psg_lstr_init(varyCookieName);
-			psg_lstr_append(varyCookieName, req->pool,
+			LString *defaultVaryCookieName = (LString *) psg_palloc(req->pool, sizeof(LString));
+			psg_lstr_init(defaultVaryCookieName);
+			psg_lstr_append(defaultVaryCookieName, req->pool,
 				controller->defaultVaryTurbocacheByCookie.data(),
 				controller->defaultVaryTurbocacheByCookie.size());
+			varyCookieName = defaultVaryCookieName;
 		}
 		if (varyCookieName != NULL) {
-			LString *cookieHeader = req->headers.lookup(COOKIE);
+			LString *cookieHeader = req->headers.lookup(ServerKit::KH_COOKIE);
 			if (cookieHeader != NULL) {
 				req->varyCookie = ServerKit::findCookie(req->pool, cookieHeader, varyCookieName);
 			}
@@ -514,16 +502,17 @@ public:
 			return false;
 		}
 
-		req->cacheControl = req->headers.lookup(CACHE_CONTROL);
+		req->cacheControl = req->headers.lookup(ServerKit::KH_CACHE_CONTROL);
 		if (req->cacheControl == NULL) {
 			// hasPragmaHeader is only used by requestAllowsFetching(),
 			// so if there is no Cache-Control header then it's not
 			// necessary to check for the Pragma header.
-			req->hasPragmaHeader = req->headers.lookup(PRAGMA_CONST) != NULL;
+			req->hasPragmaHeader = req->headers.lookup(ServerKit::KH_PRAGMA) != NULL;
 		}
 
 		char *key = (char *) psg_pnalloc(req->pool, size);
-		generateKey(req->https, StaticString(req->path.start->data, req->path.size),
+		generateKey(req->https, req->acceptedEncoding,
+			StaticString(req->path.start->data, req->path.size),
 			req->host, req->varyCookie, key, size);
 		req->cacheKey = HashedStaticString(key, size);
 		return true;
@@ -578,7 +567,7 @@ public:
 
 		ServerKit::HeaderTable &respHeaders = req->appResponse.headers;
 
-		req->appResponse.cacheControl = respHeaders.lookup(CACHE_CONTROL);
+		req->appResponse.cacheControl = respHeaders.lookup(ServerKit::KH_CACHE_CONTROL);
 		if (req->appResponse.cacheControl != NULL && req->appResponse.cacheControl->size > 0) {
 			req->appResponse.cacheControl = psg_lstr_make_contiguous(
 				req->appResponse.cacheControl,
@@ -594,22 +583,22 @@ public:
 			}
 		}
 
-		if (req->headers.lookup(AUTHORIZATION) != NULL
-		 || respHeaders.lookup(VARY) != NULL
-		 || respHeaders.lookup(WWW_AUTHENTICATE) != NULL
-		 || respHeaders.lookup(X_SENDFILE) != NULL
-		 || respHeaders.lookup(X_ACCEL_REDIRECT) != NULL)
+		if (req->headers.lookup(ServerKit::KH_AUTHORIZATION) != NULL
+		 || respHeaders.lookup(ServerKit::KH_VARY) != NULL
+		 || respHeaders.lookup(ServerKit::KH_WWW_AUTHENTICATE) != NULL
+		 || respHeaders.lookup(ServerKit::KH_X_SENDFILE) != NULL
+		 || respHeaders.lookup(ServerKit::KH_X_ACCEL_REDIRECT) != NULL)
 		{
 			return false;
 		}
 
-		req->appResponse.expiresHeader = respHeaders.lookup(EXPIRES);
+		req->appResponse.expiresHeader = respHeaders.lookup(ServerKit::KH_EXPIRES);
 		if (req->appResponse.expiresHeader == NULL) {
 			// lastModifiedHeader is only used in determineExpiryDate(),
 			// and only if expiresHeader is not present, and Cache-Control
 			// does not contain max-age.
 			req->appResponse.lastModifiedHeader =
-				respHeaders.lookup(LAST_MODIFIED);
+				respHeaders.lookup(ServerKit::KH_LAST_MODIFIED);
 			if (req->appResponse.lastModifiedHeader != NULL) {
 				req->appResponse.lastModifiedHeader =
 					psg_lstr_make_contiguous(req->appResponse.lastModifiedHeader,
@@ -657,6 +646,7 @@ public:
 		entry.body->expiryDate = expiryDate;
 		entry.body->httpHeaderSize = headerSize;
 		entry.body->httpBodySize   = bodySize;
+		entry.body->httpStatusCode = req->appResponse.statusCode;
 		storeSuccesses++;
 		return entry;
 	}
@@ -670,13 +660,20 @@ public:
 
 	// @pre requestAllowsInvalidating()
 	void invalidate(Request *req) {
-		Entry entry(lookup(req->cacheKey));
-		if (entry.valid()) {
-			entry.header->valid = false;
+		// Invalidate the variants for all content codings. The content
+		// coding is the second byte of the key; see generateKey().
+		char *key = (char *) psg_pnalloc(req->pool, req->cacheKey.size());
+		memcpy(key, req->cacheKey.data(), req->cacheKey.size());
+		for (unsigned int i = 0; i < ResponseCompressor::ENCODING_COUNT; i++) {
+			key[1] = '0' + i;
+			Entry entry(lookup(StaticString(key, req->cacheKey.size())));
+			if (entry.valid()) {
+				entry.header->valid = false;
+			}
 		}
 
-		invalidateLocation(req, LOCATION);
-		invalidateLocation(req, CONTENT_LOCATION);
+		invalidateLocation(req, ServerKit::KH_LOCATION);
+		invalidateLocation(req, ServerKit::KH_CONTENT_LOCATION);
 	}
 
 
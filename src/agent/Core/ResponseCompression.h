@@ -0,0 +1,471 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_RESPONSE_COMPRESSION_H_
+#define _PASSENGER_RESPONSE_COMPRESSION_H_
+
+#include <boost/noncopyable.hpp>
+#include <oxt/macros.hpp>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <zlib.h>
+#include <Constants.h>
+#include <Exceptions.h>
+#include <StaticString.h>
+#include <DataStructures/LString.h>
+#include <MemoryKit/palloc.h>
+#include <Utils/StrIntUtils.h>
+#include <ServerKit/HeaderTable.h>
+#include <Core/Controller/AppResponse.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * A reusable zlib deflate stream that produces either the `gzip` or the
+ * `deflate` (zlib-wrapped, as RFC 7230 specifies) HTTP content coding.
+ *
+ * Setting up a deflate stream allocates about 256 KB, so compressors are
+ * meant to be recycled between responses with `reset()`, which reuses that
+ * memory as long as the encoding and compression level stay the same.
+ *
+ * This class is not thread-safe.
+ */
+class ResponseCompressor: public boost::noncopyable {
+public:
+	enum Encoding {
+		IDENTITY,
+		GZIP,
+		DEFLATE
+	};
+
+	static const unsigned int ENCODING_COUNT = 3;
+
+private:
+	z_stream stream;
+	Encoding encoding;
+	int level;
+
+	void end() {
+		if (encoding != IDENTITY) {
+			deflateEnd(&stream);
+			encoding = IDENTITY;
+		}
+	}
+
+public:
+	ResponseCompressor()
+		: encoding(IDENTITY),
+		  level(0)
+		{ }
+
+	~ResponseCompressor() {
+		end();
+	}
+
+	/**
+	 * Prepares the compressor for a new response.
+	 *
+	 * @throws std::bad_alloc
+	 */
+	void reset(Encoding newEncoding, int newLevel) {
+		assert(newEncoding != IDENTITY);
+		if (encoding == newEncoding && level == newLevel) {
+			deflateReset(&stream);
+			return;
+		}
+
+		end();
+		memset(&stream, 0, sizeof(stream));
+		// Adding 16 to the window bits makes zlib write a gzip header and trailer.
+		int ret = deflateInit2(&stream, newLevel, Z_DEFLATED,
+			(newEncoding == GZIP) ? 15 + 16 : 15,
+			8, Z_DEFAULT_STRATEGY);
+		if (ret != Z_OK) {
+			throw std::bad_alloc();
+		}
+		encoding = newEncoding;
+		level = newLevel;
+	}
+
+	Encoding getEncoding() const {
+		return encoding;
+	}
+
+	/**
+	 * Compresses data from `input` into `output`, which has room for
+	 * `outputSize` bytes. `input` and `inputSize` are advanced past the data
+	 * that has been consumed. Returns the number of bytes written to `output`.
+	 *
+	 * `flush` is a zlib flush mode: Z_NO_FLUSH lets zlib hold on to data for
+	 * better compression, Z_SYNC_FLUSH makes all data consumed so far
+	 * decompressible by the client, and Z_FINISH ends the stream.
+	 *
+	 * `done` is set to false if there is more output pending, in which case
+	 * this method must be called again with a fresh output buffer.
+	 */
+	size_t compress(const char *&input, size_t &inputSize, char *output,
+		size_t outputSize, int flush, bool &done)
+	{
+		assert(encoding != IDENTITY);
+		stream.next_in   = (Bytef *) input;
+		stream.avail_in  = (uInt) inputSize;
+		stream.next_out  = (Bytef *) output;
+		stream.avail_out = (uInt) outputSize;
+
+		int ret = deflate(&stream, flush);
+		assert(ret != Z_STREAM_ERROR);
+
+		input = (const char *) stream.next_in;
+		inputSize = stream.avail_in;
+		if (flush == Z_FINISH) {
+			done = ret == Z_STREAM_END;
+		} else {
+			done = stream.avail_in == 0 && stream.avail_out != 0;
+		}
+		return outputSize - stream.avail_out;
+	}
+
+	static const char *getEncodingName(Encoding encoding) {
+		switch (encoding) {
+		case GZIP:
+			return "gzip";
+		case DEFLATE:
+			return "deflate";
+		default:
+			return "identity";
+		}
+	}
+};
+
+
+/**
+ * Decides which app responses the Core compresses, and with which content
+ * coding:
+ *
+ *  - The client must accept gzip or deflate (`Accept-Encoding`).
+ *  - The response must have a body, must not already have a
+ *    `Content-Encoding`, must not be a partial response, and must not
+ *    forbid transformations with `Cache-Control: no-transform`.
+ *  - Its `Content-Type` must be in the configured list of types.
+ *  - If its size is known, it must be at least `minSize` bytes.
+ *
+ * The negotiated encoding is determined when the request begins, because
+ * it is part of the turbocache key: the turbocache stores a separate
+ * variant for every encoding.
+ *
+ * Relevant RFCs:
+ * https://tools.ietf.org/html/rfc7231#section-5.3.4    Accept-Encoding
+ * https://tools.ietf.org/html/rfc7232#section-2.1      Weak and strong validators
+ */
+template<typename Request>
+class ResponseCompression {
+private:
+	bool enabled;
+	int level;
+	unsigned int minSize;
+	// Lowercase media types. An entry that ends with "/*" matches
+	// all subtypes.
+	vector<string> types;
+
+	static bool isSpace(char ch) {
+		return ch == ' ' || ch == '\t';
+	}
+
+	static StaticString trim(const char *begin, const char *end) {
+		while (begin < end && isSpace(*begin)) {
+			begin++;
+		}
+		while (end > begin && isSpace(end[-1])) {
+			end--;
+		}
+		return StaticString(begin, end - begin);
+	}
+
+	static bool equalsIgnoreCase(const StaticString &a, const StaticString &b) {
+		if (a.size() != b.size()) {
+			return false;
+		}
+		for (string::size_type i = 0; i < a.size(); i++) {
+			if (tolower((unsigned char) a[i]) != tolower((unsigned char) b[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Parses the parameters of an Accept-Encoding element, and returns
+	 * whether its quality value is non-zero.
+	 */
+	static bool qualityIsNonZero(const char *params, const char *end) {
+		while (params < end) {
+			const char *paramEnd = (const char *) memchr(params, ';', end - params);
+			if (paramEnd == NULL) {
+				paramEnd = end;
+			}
+
+			StaticString param = trim(params, paramEnd);
+			if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q')) {
+				StaticString value = trim(param.data() + 1, param.data() + param.size());
+				if (!value.empty() && value[0] == '=') {
+					value = trim(value.data() + 1, value.data() + value.size());
+					for (string::size_type i = 0; i < value.size(); i++) {
+						if (value[i] >= '1' && value[i] <= '9') {
+							return true;
+						}
+					}
+					return false;
+				}
+			}
+			params = paramEnd + 1;
+		}
+		return true;
+	}
+
+	bool contentTypeAllowed(const LString *contentType, psg_pool_t *pool) const {
+		if (contentType == NULL || contentType->size == 0) {
+			return false;
+		}
+		contentType = psg_lstr_make_contiguous(contentType, pool);
+		return contentTypeAllowed(StaticString(contentType->start->data,
+			contentType->size));
+	}
+
+	bool forbidsTransformation(const LString *cacheControl, psg_pool_t *pool) const {
+		if (cacheControl == NULL || cacheControl->size == 0) {
+			return false;
+		}
+		cacheControl = psg_lstr_make_contiguous(cacheControl, pool);
+		return StaticString(cacheControl->start->data, cacheControl->size)
+			.find(P_STATIC_STRING("no-transform")) != string::npos;
+	}
+
+public:
+	ResponseCompression(bool _enabled = false,
+		int _level = DEFAULT_RESPONSE_COMPRESSION_LEVEL,
+		unsigned int _minSize = DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE,
+		const StaticString &_types = DEFAULT_RESPONSE_COMPRESSION_TYPES)
+		: enabled(_enabled),
+		  level(_level),
+		  minSize(_minSize)
+	{
+		if (level < 1 || level > 9) {
+			throw ArgumentException("The response compression level must be "
+				"between 1 and 9");
+		}
+
+		vector<string> list;
+		split(_types, ',', list);
+		for (vector<string>::const_iterator it = list.begin(); it != list.end(); it++) {
+			StaticString type = trim(it->data(), it->data() + it->size());
+			if (!type.empty()) {
+				string lowercaseType(type.size(), '\0');
+				convertLowerCase((const unsigned char *) type.data(),
+					(unsigned char *) &lowercaseType[0], type.size());
+				types.push_back(lowercaseType);
+			}
+		}
+	}
+
+	bool isEnabled() const {
+		return enabled;
+	}
+
+	int getLevel() const {
+		return level;
+	}
+
+	unsigned int getMinSize() const {
+		return minSize;
+	}
+
+	/**
+	 * Returns the content coding that a client with the given Accept-Encoding
+	 * header value prefers, out of the ones that we support. Prefers gzip if
+	 * the client accepts both with the same quality, because some clients
+	 * mistake deflate for raw deflate data.
+	 */
+	static ResponseCompressor::Encoding negotiate(const StaticString &acceptEncoding) {
+		const char *pos = acceptEncoding.data();
+		const char *end = acceptEncoding.data() + acceptEncoding.size();
+		// -1: not mentioned, 0: refused, 1: accepted
+		int gzip = -1, deflate = -1, any = -1;
+
+		while (pos < end) {
+			const char *elementEnd = (const char *) memchr(pos, ',', end - pos);
+			if (elementEnd == NULL) {
+				elementEnd = end;
+			}
+
+			const char *paramsBegin = (const char *) memchr(pos, ';', elementEnd - pos);
+			if (paramsBegin == NULL) {
+				paramsBegin = elementEnd;
+			}
+			StaticString coding = trim(pos, paramsBegin);
+			int accepted = qualityIsNonZero(paramsBegin, elementEnd) ? 1 : 0;
+
+			if (equalsIgnoreCase(coding, P_STATIC_STRING("gzip"))
+			 || equalsIgnoreCase(coding, P_STATIC_STRING("x-gzip")))
+			{
+				gzip = accepted;
+			} else if (equalsIgnoreCase(coding, P_STATIC_STRING("deflate"))) {
+				deflate = accepted;
+			} else if (coding == P_STATIC_STRING("*")) {
+				any = accepted;
+			}
+
+			pos = elementEnd + 1;
+		}
+
+		if (gzip == 1 || (gzip == -1 && any == 1)) {
+			return ResponseCompressor::GZIP;
+		} else if (deflate == 1 || (deflate == -1 && any == 1)) {
+			return ResponseCompressor::DEFLATE;
+		} else {
+			return ResponseCompressor::IDENTITY;
+		}
+	}
+
+	/**
+	 * Returns whether the given Content-Type header value is in the list
+	 * of compressible types. Parameters such as `charset` are ignored.
+	 */
+	bool contentTypeAllowed(const StaticString &contentType) const {
+		const char *end = (const char *) memchr(contentType.data(), ';',
+			contentType.size());
+		if (end == NULL) {
+			end = contentType.data() + contentType.size();
+		}
+		StaticString mediaType = trim(contentType.data(), end);
+
+		vector<string>::const_iterator it, typesEnd = types.end();
+		for (it = types.begin(); it != typesEnd; it++) {
+			const string &type = *it;
+			if (type.size() >= 2 && type[type.size() - 2] == '/' && type[type.size() - 1] == '*') {
+				if (mediaType.size() > type.size() - 1
+				 && equalsIgnoreCase(mediaType.substr(0, type.size() - 1),
+					StaticString(type.data(), type.size() - 1)))
+				{
+					return true;
+				}
+			} else if (equalsIgnoreCase(mediaType, type)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * Determines `req->acceptedEncoding` from the request headers. Call this
+	 * before any turbocache operations.
+	 */
+	void prepareRequest(Request *req) const {
+		const LString *value;
+
+		if (!enabled || (value = req->headers.lookup(ServerKit::KH_ACCEPT_ENCODING)) == NULL
+		 || value->size == 0)
+		{
+			req->acceptedEncoding = ResponseCompressor::IDENTITY;
+		} else {
+			value = psg_lstr_make_contiguous(value, req->pool);
+			req->acceptedEncoding = negotiate(StaticString(value->start->data,
+				value->size));
+		}
+	}
+
+	/**
+	 * Returns whether the app response, of which the headers have been
+	 * parsed, should be compressed with `req->acceptedEncoding`.
+	 *
+	 * Responses to requests with the dechunk flag are never compressed:
+	 * the web server in front of us expects an unchunked body, while a
+	 * compressed body of a keep-alive response must be chunked. That web
+	 * server can compress the response itself.
+	 */
+	bool responseAllowsCompression(const Request *req) const {
+		const Core::AppResponse *resp = &req->appResponse;
+
+		if (req->acceptedEncoding == ResponseCompressor::IDENTITY
+		 || req->dechunkResponse
+		 || !resp->hasBody()
+		 || resp->statusCode == 206)
+		{
+			return false;
+		}
+		if (resp->bodyType == Core::AppResponse::RBT_CONTENT_LENGTH
+		 && resp->aux.bodyInfo.contentLength < minSize)
+		{
+			return false;
+		}
+
+		const ServerKit::HeaderTable &headers = resp->headers;
+		const LString *contentEncoding = headers.lookup(ServerKit::KH_CONTENT_ENCODING);
+		if ((contentEncoding != NULL && contentEncoding->size > 0)
+		 || headers.lookup(ServerKit::KH_CONTENT_RANGE) != NULL)
+		{
+			return false;
+		}
+		return contentTypeAllowed(headers.lookup(ServerKit::KH_CONTENT_TYPE), req->pool)
+			&& !forbidsTransformation(headers.lookup(ServerKit::KH_CACHE_CONTROL), req->pool);
+	}
+
+	/**
+	 * Adjusts the app response headers for the compressed body: sets
+	 * Content-Encoding, adds Accept-Encoding to Vary, and weakens a strong
+	 * ETag because the compressed body is not byte-for-byte identical to
+	 * the app's.
+	 *
+	 * @pre responseAllowsCompression(req)
+	 */
+	void prepareResponseHeaders(Request *req) const {
+		ServerKit::HeaderTable &headers = req->appResponse.headers;
+
+		headers.insert(req->pool, P_STATIC_STRING("Content-Encoding"),
+			ResponseCompressor::getEncodingName(
+				(ResponseCompressor::Encoding) req->acceptedEncoding));
+		// HeaderTable joins this with an existing Vary header, if any.
+		headers.insert(req->pool, P_STATIC_STRING("Vary"),
+			P_STATIC_STRING("Accept-Encoding"));
+
+		LString *etag = headers.lookup(ServerKit::KH_ETAG);
+		if (etag != NULL && etag->size > 0 && psg_lstr_first_byte(etag) == '"') {
+			LString weakEtag;
+			psg_lstr_init(&weakEtag);
+			psg_lstr_append(&weakEtag, req->pool, "W/", 2);
+			psg_lstr_move_and_append(etag, req->pool, &weakEtag);
+			*etag = weakEtag;
+		}
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_RESPONSE_COMPRESSION_H_ */
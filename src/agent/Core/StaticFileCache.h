@@ -0,0 +1,649 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_STATIC_FILE_CACHE_H_
+#define _PASSENGER_STATIC_FILE_CACHE_H_
+
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <StaticString.h>
+#include <DataStructures/StringKeyTable.h>
+#include <Exceptions.h>
+#include <Utils.h>
+#include <Utils/CachedFileStat.hpp>
+#include <Utils/DateParsing.h>
+#include <Utils/IOUtils.h>
+#include <Utils/StrIntUtils.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * Maps request paths to files in a document root, such as an application's
+ * `public` directory, and keeps those files open. This way, serving a
+ * static file involves no open() and fstat() calls, only the data transfer
+ * itself.
+ *
+ * Request paths are mapped like the web server modules do:
+ *
+ *  - A path that refers to a regular file maps to that file.
+ *  - A path that refers to a directory maps to its `index.html`. If the
+ *    path doesn't end with a slash, the client should be redirected to
+ *    the path with a slash instead, so that relative links work.
+ *  - Otherwise, a path maps to `<path>.html` (Rails page caching).
+ *
+ * Paths that contain `..` segments or encoded NUL bytes never map to
+ * a file. Neither do paths longer than StringKeyTable allows, or files
+ * that are symlinks to somewhere outside the document root.
+ *
+ * Every lookup stat()s the candidate files through the given CachedFileStat,
+ * so that a changed file is noticed within the throttle rate, or right away
+ * if the CachedFileStat has change notifications enabled. A file that has
+ * changed is reopened. A File object stays valid, and its file descriptor
+ * open, for as long as someone references it, so a request that is still
+ * sending a file that has been replaced keeps sending the old contents.
+ *
+ * This class is not thread-safe. The CachedFileStat may be shared between
+ * threads.
+ */
+class StaticFileCache: public boost::noncopyable {
+public:
+	static const unsigned int DEFAULT_MAX_ENTRIES = 1024;
+
+	struct File: public boost::noncopyable {
+		string filename;
+		int fd;
+		boost::uint64_t size;
+		time_t mtime;
+		dev_t dev;
+		ino_t ino;
+		StaticString contentType;
+		unsigned int etagSize;
+		unsigned int lastModifiedSize;
+		// Strong validator based on the modification time and size,
+		// in the same format as Nginx's.
+		char etag[2 * sizeof(boost::uint64_t) * 2 + sizeof("\"-\"")];
+		char lastModified[sizeof("Sun, 06 Nov 1994 08:49:37 GMT")];
+
+		File()
+			: fd(-1)
+			{ }
+
+		~File() {
+			if (fd != -1) {
+				safelyClose(fd, true);
+			}
+		}
+
+		StaticString getEtag() const {
+			return StaticString(etag, etagSize);
+		}
+
+		StaticString getLastModified() const {
+			return StaticString(lastModified, lastModifiedSize);
+		}
+
+		bool matches(const struct stat &buf) const {
+			return (boost::uint64_t) buf.st_size == size
+				&& buf.st_mtime == mtime
+				&& buf.st_ino == ino
+				&& buf.st_dev == dev;
+		}
+	};
+
+	typedef boost::shared_ptr<File> FilePtr;
+
+	enum RangeResult {
+		// There is no (usable) Range header; send the entire file.
+		NO_RANGE,
+		SATISFIABLE_RANGE,
+		UNSATISFIABLE_RANGE
+	};
+
+private:
+	struct ContentType {
+		const char *extension;
+		const char *type;
+	};
+
+	string documentRoot;
+	// The document root with all symlinks resolved. Determined on first use.
+	string canonicalDocumentRoot;
+	CachedFileStat *cstat;
+	unsigned int throttleRate;
+	unsigned int maxEntries;
+	StringKeyTable<FilePtr> files;
+
+	static int decodeHexDigit(char ch) {
+		if (ch >= '0' && ch <= '9') {
+			return ch - '0';
+		} else if (ch >= 'a' && ch <= 'f') {
+			return ch - 'a' + 10;
+		} else if (ch >= 'A' && ch <= 'F') {
+			return ch - 'A' + 10;
+		} else {
+			return -1;
+		}
+	}
+
+	/**
+	 * Percent-decodes `path` and appends it to `filename`. Returns false
+	 * if the path is not a safe path within the document root.
+	 */
+	static bool appendDecodedPath(string &filename, const StaticString &path) {
+		if (path.empty() || path[0] != '/') {
+			return false;
+		}
+
+		string::size_type segmentBegin = filename.size() + 1;
+		const char *pos = path.data();
+		const char *end = path.data() + path.size();
+
+		while (pos < end) {
+			char ch = *pos;
+			if (ch == '%') {
+				int high, low;
+				if (end - pos < 3
+				 || (high = decodeHexDigit(pos[1])) == -1
+				 || (low = decodeHexDigit(pos[2])) == -1)
+				{
+					return false;
+				}
+				ch = (char) (high * 16 + low);
+				pos += 3;
+			} else {
+				pos++;
+			}
+
+			if (ch == '\0') {
+				return false;
+			} else if (ch == '/') {
+				if (isDotDotSegment(filename, segmentBegin)) {
+					return false;
+				}
+				segmentBegin = filename.size() + 1;
+			}
+			filename.append(1, ch);
+		}
+		return !isDotDotSegment(filename, segmentBegin);
+	}
+
+	static bool isDotDotSegment(const string &filename, string::size_type begin) {
+		return filename.size() - begin == 2
+			&& filename[begin] == '.'
+			&& filename[begin + 1] == '.';
+	}
+
+	bool statRegularFile(const string &filename, struct stat &buf) {
+		return cstat->stat(filename, &buf, throttleRate) == 0 && S_ISREG(buf.st_mode);
+	}
+
+	FilePtr get(const string &filename, const struct stat &buf) {
+		if (filename.size() > 255) {
+			// Too long for StringKeyTable.
+			return FilePtr();
+		}
+
+		FilePtr *cached;
+		if (files.lookup(filename, &cached) && (*cached)->matches(buf)) {
+			return *cached;
+		}
+
+		FilePtr file;
+		string canonicalFilename;
+		if (resolveWithinDocumentRoot(filename, canonicalFilename)) {
+			file = open(canonicalFilename, filename);
+		}
+		if (file != NULL) {
+			if (files.size() >= maxEntries) {
+				// Files that are still being sent stay open until
+				// their requests are done with them.
+				files.clear();
+			}
+			files.insert(filename, file);
+		} else {
+			files.erase(filename);
+		}
+		return file;
+	}
+
+	/**
+	 * Resolves all symlinks in `filename`, and checks that the result
+	 * still lies within the document root.
+	 */
+	bool resolveWithinDocumentRoot(const string &filename, string &result) {
+		try {
+			if (canonicalDocumentRoot.empty()) {
+				canonicalDocumentRoot = canonicalizePath(documentRoot);
+			}
+			result = canonicalizePath(filename);
+		} catch (const FileSystemException &) {
+			return false;
+		}
+		return result.size() > canonicalDocumentRoot.size()
+			&& startsWith(result, canonicalDocumentRoot)
+			&& (result[canonicalDocumentRoot.size()] == '/'
+				|| canonicalDocumentRoot == "/");
+	}
+
+	/**
+	 * Opens `canonicalFilename`, which must not contain symlinks, and
+	 * registers it under `filename`.
+	 */
+	static FilePtr open(const string &canonicalFilename, const string &filename) {
+		FilePtr file(boost::make_shared<File>());
+		struct stat buf;
+
+		do {
+			// O_NOFOLLOW in case the file was replaced with a symlink
+			// after we resolved it.
+			file->fd = ::open(canonicalFilename.c_str(),
+				O_RDONLY | O_NONBLOCK | O_NOFOLLOW);
+		} while (file->fd == -1 && errno == EINTR);
+		if (file->fd == -1) {
+			return FilePtr();
+		}
+		if (fstat(file->fd, &buf) == -1 || !S_ISREG(buf.st_mode)) {
+			return FilePtr();
+		}
+
+		file->filename = filename;
+		file->size = buf.st_size;
+		file->mtime = buf.st_mtime;
+		file->dev = buf.st_dev;
+		file->ino = buf.st_ino;
+		file->contentType = getContentType(filename);
+		file->etagSize = snprintf(file->etag, sizeof(file->etag), "\"%llx-%llx\"",
+			(unsigned long long) file->mtime, (unsigned long long) file->size);
+
+		struct tm tm;
+		gmtime_r(&file->mtime, &tm);
+		file->lastModifiedSize = strftime(file->lastModified, sizeof(file->lastModified),
+			"%a, %d %b %Y %H:%M:%S GMT", &tm);
+		return file;
+	}
+
+	static bool isSpace(char ch) {
+		return ch == ' ' || ch == '\t';
+	}
+
+	static StaticString trim(const char *begin, const char *end) {
+		while (begin < end && isSpace(*begin)) {
+			begin++;
+		}
+		while (end > begin && isSpace(end[-1])) {
+			end--;
+		}
+		return StaticString(begin, end - begin);
+	}
+
+	static bool parseUint64(const StaticString &str, boost::uint64_t &result) {
+		if (str.empty() || str.size() > 18) {
+			return false;
+		}
+		result = 0;
+		for (string::size_type i = 0; i < str.size(); i++) {
+			if (str[i] < '0' || str[i] > '9') {
+				return false;
+			}
+			result = result * 10 + (str[i] - '0');
+		}
+		return true;
+	}
+
+	static StaticString removeWeakPrefix(const StaticString &etag) {
+		if (etag.size() >= 2 && etag[0] == 'W' && etag[1] == '/') {
+			return etag.substr(2);
+		} else {
+			return etag;
+		}
+	}
+
+public:
+	/**
+	 * @param documentRoot The directory to serve files from.
+	 * @param cstat Used to check whether files have changed. Must outlive
+	 *              this StaticFileCache.
+	 * @param throttleRate Throttle rate to pass to `cstat`.
+	 * @param maxEntries The maximum number of files to keep open.
+	 */
+	StaticFileCache(const StaticString &documentRoot, CachedFileStat *cstat,
+		unsigned int throttleRate, unsigned int maxEntries = DEFAULT_MAX_ENTRIES)
+		: documentRoot(documentRoot.data(), documentRoot.size()),
+		  cstat(cstat),
+		  throttleRate(throttleRate),
+		  maxEntries(maxEntries)
+	{
+		while (!this->documentRoot.empty()
+		 && this->documentRoot[this->documentRoot.size() - 1] == '/')
+		{
+			this->documentRoot.erase(this->documentRoot.size() - 1);
+		}
+	}
+
+	/**
+	 * Returns the file that the given request path (without query string)
+	 * maps to, or NULL if it doesn't map to a file.
+	 *
+	 * If the path refers to a directory with an `index.html`, but doesn't
+	 * end with a slash, then this returns NULL too, and sets
+	 * `*redirectToDirectory` (if non-NULL) to true.
+	 */
+	FilePtr lookup(const StaticString &path, bool *redirectToDirectory = NULL) {
+		string filename;
+		struct stat buf;
+		bool endsWithSlash = !path.empty() && path[path.size() - 1] == '/';
+
+		if (redirectToDirectory != NULL) {
+			*redirectToDirectory = false;
+		}
+
+		filename.reserve(documentRoot.size() + path.size() + sizeof("/index.html"));
+		filename.append(documentRoot);
+		if (!appendDecodedPath(filename, path)) {
+			return FilePtr();
+		}
+
+		if (cstat->stat(filename, &buf, throttleRate) == 0) {
+			if (S_ISREG(buf.st_mode)) {
+				return get(filename, buf);
+			} else if (!S_ISDIR(buf.st_mode)) {
+				return FilePtr();
+			}
+			if (filename[filename.size() - 1] != '/') {
+				filename.append(1, '/');
+			}
+			filename.append("index.html");
+			if (!endsWithSlash) {
+				if (redirectToDirectory != NULL) {
+					*redirectToDirectory = statRegularFile(filename, buf);
+				}
+				return FilePtr();
+			}
+		} else if (filename[filename.size() - 1] == '/') {
+			return FilePtr();
+		} else {
+			filename.append(".html");
+		}
+
+		if (statRegularFile(filename, buf)) {
+			return get(filename, buf);
+		} else {
+			return FilePtr();
+		}
+	}
+
+	/**
+	 * Returns the gzip-compressed copy of the given file (`<filename>.gz`),
+	 * or NULL if there is none.
+	 */
+	FilePtr lookupPrecompressed(const File &file) {
+		string filename;
+		struct stat buf;
+
+		filename.reserve(file.filename.size() + 3);
+		filename.append(file.filename);
+		filename.append(".gz");
+		if (statRegularFile(filename, buf)) {
+			return get(filename, buf);
+		} else {
+			return FilePtr();
+		}
+	}
+
+	const string &getDocumentRoot() const {
+		return documentRoot;
+	}
+
+	unsigned int size() const {
+		return files.size();
+	}
+
+	/**
+	 * Returns the content type to serve the given file with, based on its
+	 * extension. Files with unknown extensions are served as
+	 * `application/octet-stream`.
+	 */
+	static StaticString getContentType(const StaticString &filename) {
+		static const ContentType types[] = {
+			{ "html", "text/html" },
+			{ "htm", "text/html" },
+			{ "css", "text/css" },
+			{ "js", "application/javascript" },
+			{ "json", "application/json" },
+			{ "map", "application/json" },
+			{ "xml", "text/xml" },
+			{ "txt", "text/plain" },
+			{ "csv", "text/csv" },
+			{ "svg", "image/svg+xml" },
+			{ "svgz", "image/svg+xml" },
+			{ "png", "image/png" },
+			{ "jpg", "image/jpeg" },
+			{ "jpeg", "image/jpeg" },
+			{ "gif", "image/gif" },
+			{ "ico", "image/x-icon" },
+			{ "webp", "image/webp" },
+			{ "bmp", "image/bmp" },
+			{ "tif", "image/tiff" },
+			{ "tiff", "image/tiff" },
+			{ "woff", "application/font-woff" },
+			{ "woff2", "font/woff2" },
+			{ "ttf", "application/x-font-ttf" },
+			{ "otf", "font/opentype" },
+			{ "eot", "application/vnd.ms-fontobject" },
+			{ "pdf", "application/pdf" },
+			{ "zip", "application/zip" },
+			{ "gz", "application/gzip" },
+			{ "wasm", "application/wasm" },
+			{ "webmanifest", "application/manifest+json" },
+			{ "mp3", "audio/mpeg" },
+			{ "ogg", "audio/ogg" },
+			{ "wav", "audio/wav" },
+			{ "mp4", "video/mp4" },
+			{ "webm", "video/webm" },
+			{ NULL, NULL }
+		};
+
+		const char *end = filename.data() + filename.size();
+		const char *pos = end;
+		while (pos > filename.data() && pos[-1] != '.' && pos[-1] != '/') {
+			pos--;
+		}
+		if (pos == filename.data() || pos[-1] != '.') {
+			return P_STATIC_STRING("application/octet-stream");
+		}
+
+		StaticString extension(pos, end - pos);
+		for (const ContentType *type = types; type->extension != NULL; type++) {
+			StaticString candidate(type->extension);
+			if (candidate.size() != extension.size()) {
+				continue;
+			}
+			string::size_type i;
+			for (i = 0; i < extension.size(); i++) {
+				if (tolower((unsigned char) extension[i]) != candidate[i]) {
+					break;
+				}
+			}
+			if (i == extension.size()) {
+				return type->type;
+			}
+		}
+		return P_STATIC_STRING("application/octet-stream");
+	}
+
+	/**
+	 * Returns whether an If-None-Match header value matches the given ETag,
+	 * using the weak comparison function.
+	 */
+	static bool etagMatches(const StaticString &ifNoneMatch, const StaticString &etag) {
+		const char *pos = ifNoneMatch.data();
+		const char *end = ifNoneMatch.data() + ifNoneMatch.size();
+		StaticString weakEtag = removeWeakPrefix(etag);
+
+		while (pos < end) {
+			const char *itemEnd = (const char *) memchr(pos, ',', end - pos);
+			if (itemEnd == NULL) {
+				itemEnd = end;
+			}
+			StaticString item = trim(pos, itemEnd);
+			if (item == P_STATIC_STRING("*") || removeWeakPrefix(item) == weakEtag) {
+				return true;
+			}
+			pos = itemEnd + 1;
+		}
+		return false;
+	}
+
+	/**
+	 * Returns whether a file with the given modification time has been
+	 * modified since the time in an If-Modified-Since header value.
+	 * Invalid dates are treated as being in the past.
+	 */
+	static bool modifiedSince(const StaticString &ifModifiedSince, time_t mtime) {
+		struct tm tm;
+		int zone;
+		if (parseImfFixdate(ifModifiedSince.data(),
+			ifModifiedSince.data() + ifModifiedSince.size(), tm, zone))
+		{
+			return mtime > parsedDateToTimestamp(tm, zone);
+		} else {
+			return true;
+		}
+	}
+
+	/**
+	 * Returns whether an If-Range header value allows a range of the given
+	 * file to be sent. This requires an exact match with its ETag or
+	 * Last-Modified value.
+	 */
+	static bool ifRangeMatches(const StaticString &ifRange, const File &file) {
+		StaticString value = trim(ifRange.data(), ifRange.data() + ifRange.size());
+		return value == file.getEtag() || value == file.getLastModified();
+	}
+
+	/**
+	 * Parses a Range header value for a file of `size` bytes. Only single
+	 * byte ranges are supported; for other requests, including ones for
+	 * multiple ranges, the entire file should be sent. If a satisfiable
+	 * range is found, it is returned as [`begin`, `end`).
+	 */
+	static RangeResult parseRange(const StaticString &range, boost::uint64_t size,
+		boost::uint64_t &begin, boost::uint64_t &end)
+	{
+		StaticString value = trim(range.data(), range.data() + range.size());
+		if (value.size() < sizeof("bytes=") - 1
+		 || strncasecmp(value.data(), "bytes=", sizeof("bytes=") - 1) != 0
+		 || value.find(',') != string::npos)
+		{
+			return NO_RANGE;
+		}
+		value = value.substr(sizeof("bytes=") - 1);
+
+		string::size_type dash = value.find('-');
+		if (dash == string::npos) {
+			return NO_RANGE;
+		}
+		StaticString first = trim(value.data(), value.data() + dash);
+		StaticString last = trim(value.data() + dash + 1, value.data() + value.size());
+		boost::uint64_t firstPos, lastPos;
+
+		if (first.empty()) {
+			// Suffix range: the last N bytes.
+			if (!parseUint64(last, lastPos)) {
+				return NO_RANGE;
+			}
+			if (lastPos == 0 || size == 0) {
+				return UNSATISFIABLE_RANGE;
+			}
+			begin = (lastPos < size) ? size - lastPos : 0;
+			end = size;
+			return SATISFIABLE_RANGE;
+		}
+
+		if (!parseUint64(first, firstPos)) {
+			return NO_RANGE;
+		}
+		if (last.empty()) {
+			lastPos = size;
+		} else if (!parseUint64(last, lastPos) || lastPos < firstPos) {
+			return NO_RANGE;
+		} else {
+			lastPos = std::min<boost::uint64_t>(lastPos + 1, size);
+		}
+		if (firstPos >= size) {
+			return UNSATISFIABLE_RANGE;
+		}
+		begin = firstPos;
+		end = lastPos;
+		return SATISFIABLE_RANGE;
+	}
+
+	/**
+	 * Returns whether the given request path refers to an asset with a
+	 * digest in its name, as generated by the Rails asset pipeline. These
+	 * never change, so they may be cached forever.
+	 */
+	static bool isFingerprintedAsset(const StaticString &path) {
+		if (!startsWith(path, P_STATIC_STRING("/assets/"))) {
+			return false;
+		}
+
+		const char *end = path.data() + path.size();
+		const char *pos = path.data() + path.size();
+		while (pos[-1] != '/') {
+			pos--;
+		}
+		while ((pos = (const char *) memchr(pos, '-', end - pos)) != NULL) {
+			pos++;
+			const char *digest = pos;
+			while (pos < end && decodeHexDigit(*pos) != -1) {
+				pos++;
+			}
+			if ((pos - digest == 32 || pos - digest == 64) && pos < end && *pos == '.') {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_STATIC_FILE_CACHE_H_ */
@@ -215,7 +215,7 @@ struct Authorization {
 template<typename Request>
 inline bool
 parseBasicAuthHeader(Request *req, string &username, string &password) {
-	const LString *auth = req->headers.lookup("authorization");
+	const LString *auth = req->headers.lookup(ServerKit::KH_AUTHORIZATION);
 
 	if (auth == NULL || auth->size <= 6 || !psg_lstr_cmp(auth, "Basic ", 6)) {
 		return false;
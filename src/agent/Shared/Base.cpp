@@ -884,6 +884,10 @@ abortHandler(int signo, siginfo_t *info, void *ctx) {
 	emergencyPipe1[0] = emergencyPipe1[1] = -1;
 	emergencyPipe2[0] = emergencyPipe2[1] = -1;
 
+	// Write out log messages that were buffered by the asynchronous
+	// logger, so that they end up in the log before the crash report.
+	_flushAsyncLoggingForCrash();
+
 	/* We want to dump the entire crash log to both stderr and a log file.
 	 * We use 'tee' for this.
 	 */
@@ -1602,6 +1606,10 @@ initializeAgentOptions(const char *processName, VariantMap &options,
 		}
 		setLogFile(logFile);
 	}
+	if (options.getBool("async_logging", false, false) && !startAsyncLogging()) {
+		P_WARN("Cannot start the asynchronous log writer thread; "
+			"logging synchronously instead");
+	}
 
 	if (options.has("file_descriptor_log_file")) {
 		logFile = options.get("file_descriptor_log_file");
@@ -1643,6 +1651,7 @@ initializeAgentOptions(const char *processName, VariantMap &options,
 
 void
 shutdownAgent(VariantMap *agentOptions) {
+	stopAsyncLogging();
 	delete agentOptions;
 	oxt::shutdown();
 }
@@ -60,6 +60,7 @@ bucket_destroy(void *data) {
 static apr_status_t
 bucket_read(apr_bucket *bucket, const char **str, apr_size_t *len, apr_read_type_e block) {
 	char *buf;
+	apr_size_t size;
 	ssize_t ret;
 	BucketData *data;
 
@@ -92,14 +93,27 @@ bucket_read(apr_bucket *bucket, const char **str, apr_size_t *len, apr_read_type
 		return APR_ENOMEM;
 	}
 
-	do {
-		ret = read(data->state->connection, buf, APR_BUCKET_BUFF_SIZE);
-	} while (ret == -1 && errno == EINTR);
+	size = APR_BUCKET_BUFF_SIZE;
+	if (data->state->bytesRemaining >= 0 && data->state->bytesRemaining < (apr_off_t) size) {
+		size = (apr_size_t) data->state->bytesRemaining;
+	}
+
+	if (size == 0) {
+		// The response has been fully read; leave the connection alone.
+		ret = 0;
+	} else {
+		do {
+			ret = read(data->state->connection, buf, size);
+		} while (ret == -1 && errno == EINTR);
+	}
 
 	if (ret > 0) {
 		apr_bucket_heap *h;
 
 		data->state->bytesRead += ret;
+		if (data->state->bytesRemaining > 0) {
+			data->state->bytesRemaining -= ret;
+		}
 
 		*str = buf;
 		*len = ret;
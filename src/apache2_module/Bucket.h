@@ -52,6 +52,14 @@ struct PassengerBucketState {
 	 */
 	int errorCode;
 
+	/** The number of bytes that may still be read from the underlying
+	 * file descriptor, or -1 if data should be read until EOF. Once this
+	 * drops to 0 the PassengerBucket is completed without reading from the
+	 * file descriptor again, so that the connection with the Passenger core
+	 * can be reused for the next request.
+	 */
+	apr_off_t bytesRemaining;
+
 	/** Connection to the Passenger core. */
 	FileDescriptor connection;
 
@@ -59,6 +67,7 @@ struct PassengerBucketState {
 		bytesRead  = 0;
 		completed  = false;
 		errorCode  = 0;
+		bytesRemaining = -1;
 		connection = conn;
 	}
 };
@@ -81,6 +90,8 @@ typedef boost::shared_ptr<PassengerBucketState> PassengerBucketStatePtr;
  *   this connection will be closed.
  * - It ignores the APR_NONBLOCK_READ flag because that's known to cause
  *   strange I/O problems.
+ * - It can stop at a known response length instead of at EOF, which allows
+ *   keep-alive connections with the Passenger core.
  * - It can store its current state in a PassengerBucketState data structure.
  */
 apr_bucket *passenger_bucket_create(const PassengerBucketStatePtr &state,
@@ -298,6 +298,8 @@ DEFINE_SERVER_INT_CONFIG_SETTER(cmd_passenger_max_pool_size, maxPoolSize, unsign
 DEFINE_SERVER_INT_CONFIG_SETTER(cmd_passenger_pool_idle_time, poolIdleTime, unsigned int, 0)
 DEFINE_SERVER_INT_CONFIG_SETTER(cmd_passenger_response_buffer_high_watermark, responseBufferHighWatermark, unsigned int, 0)
 DEFINE_SERVER_INT_CONFIG_SETTER(cmd_passenger_stat_throttle_rate, statThrottleRate, unsigned int, 0)
+DEFINE_SERVER_BOOLEAN_CONFIG_SETTER(cmd_passenger_file_change_notifications, fileChangeNotifications)
+DEFINE_SERVER_INT_CONFIG_SETTER(cmd_passenger_core_keepalive, coreKeepalive, unsigned int, 0)
 DEFINE_SERVER_BOOLEAN_CONFIG_SETTER(cmd_passenger_user_switching, userSwitching)
 DEFINE_SERVER_STR_CONFIG_SETTER(cmd_passenger_default_user, defaultUser)
 DEFINE_SERVER_STR_CONFIG_SETTER(cmd_passenger_default_group, defaultGroup)
@@ -531,6 +533,16 @@ const command_rec passenger_commands[] = {
 		NULL,
 		RSRC_CONF,
 		"Limit the number of stat calls to once per given seconds."),
+	AP_INIT_FLAG("PassengerFileChangeNotifications",
+		(FlagFunc) cmd_passenger_file_change_notifications,
+		NULL,
+		RSRC_CONF,
+		"Whether to notice file changes through inotify instead of throttled stat calls."),
+	AP_INIT_TAKE1("PassengerCoreKeepalive",
+		(Take1Func) cmd_passenger_core_keepalive,
+		NULL,
+		RSRC_CONF,
+		"The maximum number of idle connections to the Passenger core to keep per Apache process."),
 	AP_INIT_TAKE1("UnionStationGatewayAddress",
 		(Take1Func) cmd_union_station_gateway_address,
 		NULL,
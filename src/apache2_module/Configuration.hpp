@@ -30,6 +30,7 @@
 #include <Constants.h>
 #include <Utils.h>
 #include <Utils/VariantMap.h>
+#include "CoreConnectionPool.h"
 
 /* The APR headers must come after the Passenger headers. See Hooks.cpp
  * to learn why.
@@ -183,6 +184,14 @@ struct ServerConfig {
 
 	unsigned int statThrottleRate;
 
+	/** Whether to notice file changes through inotify instead of
+	 * throttled stat() calls. See CachedFileStat. */
+	bool fileChangeNotifications;
+
+	/** The maximum number of idle keep-alive connections to the Passenger
+	 * core that each Apache process keeps. 0 disables keep-alive. */
+	unsigned int coreKeepalive;
+
 	/** Whether user switching support is enabled. */
 	bool userSwitching;
 
@@ -222,6 +231,8 @@ struct ServerConfig {
 		poolIdleTime       = DEFAULT_POOL_IDLE_TIME;
 		responseBufferHighWatermark = DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK;
 		statThrottleRate   = DEFAULT_STAT_THROTTLE_RATE;
+		fileChangeNotifications = false;
+		coreKeepalive      = CoreConnectionPool::DEFAULT_MAX_SIZE;
 		userSwitching      = true;
 		disableSecurityUpdateCheck = false;
 		securityUpdateCheckProxy = string();
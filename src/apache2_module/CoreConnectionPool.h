@@ -0,0 +1,164 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_APACHE2_MODULE_CORE_CONNECTION_POOL_H_
+#define _PASSENGER_APACHE2_MODULE_CORE_CONNECTION_POOL_H_
+
+#include <boost/thread.hpp>
+#include <vector>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <FileDescriptor.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * A per-process pool of idle keep-alive connections to the Passenger core,
+ * so that Apache worker threads don't have to set up a new connection for
+ * every request. Connections are reused in LIFO order so that the most
+ * recently used ones, which are least likely to have been closed by the
+ * core, are tried first. At most `maxSize` idle connections are kept;
+ * a max size of 0 disables pooling.
+ *
+ * This class is thread-safe.
+ */
+class CoreConnectionPool {
+public:
+	/** The default value of `PassengerCoreKeepalive`. */
+	static const unsigned int DEFAULT_MAX_SIZE = 32;
+
+private:
+	mutable boost::mutex syncher;
+	vector<FileDescriptor> connections;
+	unsigned int maxSize;
+
+	/**
+	 * The core never sends anything on an idle connection, so if it's
+	 * readable then the core has closed it (or is about to).
+	 */
+	static bool connectionIsAlive(const FileDescriptor &conn) {
+		char buf;
+		ssize_t ret;
+
+		do {
+			ret = recv(conn, &buf, 1, MSG_PEEK | MSG_DONTWAIT);
+		} while (ret == -1 && errno == EINTR);
+		return ret == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+
+public:
+	/**
+	 * Checks, without blocking and without consuming anything, whether the
+	 * core has already closed a connection that the request has been sent
+	 * over. This happens when a pooled connection is closed by the core
+	 * just as we reuse it, in which case the core hasn't seen the request.
+	 * Returns false if the core hasn't responded yet.
+	 */
+	static bool closedBeforeResponse(const FileDescriptor &conn) {
+		char buf;
+		ssize_t ret;
+
+		do {
+			ret = recv(conn, &buf, 1, MSG_PEEK | MSG_DONTWAIT);
+		} while (ret == -1 && errno == EINTR);
+		return ret == 0 || (ret == -1 && errno == ECONNRESET);
+	}
+
+	CoreConnectionPool(unsigned int _maxSize = 0)
+		: maxSize(_maxSize)
+		{ }
+
+	void setMaxSize(unsigned int value) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		maxSize = value;
+		if (connections.size() > maxSize) {
+			connections.resize(maxSize);
+		}
+	}
+
+	bool isEnabled() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return maxSize > 0;
+	}
+
+	/**
+	 * Takes an idle connection out of the pool. Returns whether one was
+	 * available. Connections that the core has closed in the mean time
+	 * are discarded.
+	 */
+	bool checkout(FileDescriptor &result) {
+		FileDescriptor conn;
+
+		while (true) {
+			{
+				boost::lock_guard<boost::mutex> l(syncher);
+				if (connections.empty()) {
+					return false;
+				}
+				conn = connections.back();
+				connections.pop_back();
+			}
+
+			// Check liveness outside the lock. The FileDescriptor
+			// destructor closes dead connections.
+			if (connectionIsAlive(conn)) {
+				result = conn;
+				return true;
+			}
+		}
+	}
+
+	/**
+	 * Puts a connection back into the pool. The caller must only do this
+	 * if the response on this connection has been read completely and
+	 * the core hasn't indicated that it will close the connection.
+	 * If the pool is full then the connection is closed.
+	 */
+	void checkin(const FileDescriptor &conn) {
+		boost::lock_guard<boost::mutex> l(syncher);
+		if (connections.size() < maxSize) {
+			connections.push_back(conn);
+		}
+	}
+
+	void clear() {
+		boost::lock_guard<boost::mutex> l(syncher);
+		connections.clear();
+	}
+
+	unsigned int getIdleCount() const {
+		boost::lock_guard<boost::mutex> l(syncher);
+		return connections.size();
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_APACHE2_MODULE_CORE_CONNECTION_POOL_H_ */
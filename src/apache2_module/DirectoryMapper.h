@@ -73,7 +73,6 @@ private:
 	DirConfig *config;
 	request_rec *r;
 	CachedFileStat *cstat;
-	boost::mutex *cstatMutex;
 	const char *baseURI;
 	string publicDir;
 	string appRoot;
@@ -144,7 +143,7 @@ private:
 		}
 
 		UPDATE_TRACE_POINT();
-		AppTypeDetector detector(cstat, cstatMutex, throttleRate);
+		AppTypeDetector detector(cstat, NULL, throttleRate);
 		PassengerAppType appType;
 		string appRoot;
 		if (config->appType == NULL) {
@@ -175,19 +174,17 @@ public:
 	/**
 	 * Create a new DirectoryMapper object.
 	 *
-	 * @param cstat A CachedFileStat object used for statting files.
-	 * @param cstatMutex A mutex for locking CachedFileStat, making its
-	 *                   usage thread-safe.
+	 * @param cstat A CachedFileStat object used for statting files. It is
+	 *              thread-safe, so it can be shared between request threads.
 	 * @param throttleRate A throttling rate for cstat.
 	 * @warning Do not use this object after the destruction of <tt>r</tt>,
 	 *          <tt>config</tt> or <tt>cstat</tt>.
 	 */
 	DirectoryMapper(request_rec *r, DirConfig *config, CachedFileStat *cstat,
-	                boost::mutex *cstatMutex, unsigned int throttleRate) {
+	                unsigned int throttleRate) {
 		this->r = r;
 		this->config = config;
 		this->cstat = cstat;
-		this->cstatMutex = cstatMutex;
 		this->throttleRate = throttleRate;
 		appType = PAT_NONE;
 		baseURI = NULL;
@@ -54,6 +54,7 @@
 #include "Bucket.h"
 #include "Configuration.hpp"
 #include "DirectoryMapper.h"
+#include "CoreConnectionPool.h"
 #include <modp_b64.h>
 #include <Utils.h>
 #include <Utils/IOUtils.h>
@@ -225,7 +226,7 @@ private:
 	Threeway m_hasModRewrite, m_hasModDir, m_hasModAutoIndex, m_hasModXsendfile;
 	CachedFileStat cstat;
 	WatchdogLauncher watchdogLauncher;
-	boost::mutex cstatMutex;
+	CoreConnectionPool coreConnectionPool;
 
 	inline DirConfig *getDirConfig(request_rec *r) {
 		return (DirConfig *) ap_get_module_config(r->per_dir_config, &passenger_module);
@@ -314,6 +315,98 @@ private:
 		return conn;
 	}
 
+	/**
+	 * Sends the request headers to the Passenger core over a pooled
+	 * connection if one is available, or over a new connection otherwise.
+	 * The core may have closed a pooled connection in the mean time (e.g.
+	 * because it was restarted), in which case we retry with the next
+	 * connection. Nothing has been sent to the core yet at that point, so
+	 * this is always safe.
+	 *
+	 * Sets `reused` to whether the returned connection came from the pool.
+	 */
+	FileDescriptor sendRequestHeaders(const string &headers, bool &reused) {
+		TRACE_POINT();
+		FileDescriptor conn;
+
+		reused = true;
+		while (coreConnectionPool.checkout(conn)) {
+			try {
+				writeExact(conn, headers);
+				return conn;
+			} catch (const SystemException &e) {
+				if (e.code() != EPIPE && e.code() != ECONNRESET) {
+					throw;
+				}
+				P_DEBUG("Pooled connection to the Passenger core was closed; "
+					"retrying with another connection");
+			}
+		}
+
+		UPDATE_TRACE_POINT();
+		reused = false;
+		conn = connectToCore();
+		writeExact(conn, headers);
+		return conn;
+	}
+
+	/**
+	 * Returns whether the request may be sent to the core a second time
+	 * without side effects.
+	 */
+	static bool isSafeMethod(request_rec *r) {
+		return r->method_number == M_GET
+			|| r->method_number == M_OPTIONS
+			|| r->method_number == M_TRACE;
+	}
+
+	/**
+	 * Returns the length of the response body, or -1 if it can only be
+	 * determined by reading until EOF.
+	 */
+	static apr_off_t getResponseBodyLength(request_rec *r) {
+		if (r->header_only || r->status == HTTP_NO_CONTENT
+		 || r->status == HTTP_NOT_MODIFIED)
+		{
+			return 0;
+		}
+
+		const char *value = apr_table_get(r->headers_out, "Content-Length");
+		if (value == NULL) {
+			value = apr_table_get(r->err_headers_out, "Content-Length");
+		}
+		if (value == NULL) {
+			return -1;
+		}
+
+		apr_off_t result;
+		char *end;
+		if (apr_strtoff(&result, value, &end, 10) != APR_SUCCESS
+		 || end == value || *end != '\0' || result < 0)
+		{
+			return -1;
+		}
+		return result;
+	}
+
+	/**
+	 * Returns the number of bytes in the buckets that the header scanner
+	 * has read ahead, i.e. the part of the response body that is already
+	 * buffered in front of the PassengerBucket.
+	 */
+	static apr_off_t getBufferedBodyLength(apr_bucket_brigade *bb) {
+		apr_off_t result = 0;
+		apr_bucket *b;
+
+		for (b = APR_BRIGADE_FIRST(bb); b != APR_BRIGADE_SENTINEL(bb); b = APR_BUCKET_NEXT(b)) {
+			if (b->length == (apr_size_t) -1) {
+				break;
+			}
+			result += b->length;
+		}
+		return result;
+	}
+
 	bool hasModRewrite() {
 		if (m_hasModRewrite == UNKNOWN) {
 			if (ap_find_linked_module("mod_rewrite.c")) {
@@ -388,7 +481,7 @@ private:
 	bool prepareRequest(request_rec *r, DirConfig *config, const char *filename, bool coreModuleWillBeRun = false) {
 		TRACE_POINT();
 
-		DirectoryMapper mapper(r, config, &cstat, &cstatMutex, serverConfig.statThrottleRate);
+		DirectoryMapper mapper(r, config, &cstat, serverConfig.statThrottleRate);
 		try {
 			if (mapper.getApplicationType() == PAT_NONE) {
 				// (B) is not true.
@@ -579,14 +672,30 @@ private:
 
 			int ret;
 			bool bodyIsChunked = false;
+			bool keepAlive = false;
 
-			string headers = constructRequestHeaders(r, mapper, bodyIsChunked);
-			FileDescriptor conn = connectToCore();
-			writeExact(conn, headers);
-			headers.clear();
+			bool reused;
+			string headers = constructRequestHeaders(r, mapper, bodyIsChunked, keepAlive);
+			FileDescriptor conn = sendRequestHeaders(headers, reused);
 			if (expectingBody) {
-				sendRequestBody(conn, r, bodyIsChunked);
+				if (!sendRequestBody(conn, r, bodyIsChunked)) {
+					keepAlive = false;
+				}
+			} else if (reused && isSafeMethod(r)
+				&& CoreConnectionPool::closedBeforeResponse(conn))
+			{
+				// The core closed the pooled connection just as we sent the
+				// request on it, so it most likely never processed the request.
+				// Retry once on a fresh connection. We can't do this for
+				// requests with a body, because that has been consumed already,
+				// nor for requests that may not be repeated.
+				UPDATE_TRACE_POINT();
+				P_DEBUG("Pooled connection to the Passenger core was closed "
+					"before a response was received; retrying with a new connection");
+				conn = connectToCore();
+				writeExact(conn, headers);
 			}
+			headers.clear();
 
 
 			/********** Step 4: forwarding the response from the Passenger core
@@ -624,10 +733,32 @@ private:
 			// into error_headers_out (mostly) as well as headers_out.
 			ret = ap_scan_script_header_err_brigade(r, bb, backendData);
 
-			// The PassengerAgent sets the Connection: close header because it wants
-			// the bb connection closed, but because we fed everything to the
-			// ap_scan_script it will also be set in the response to the client and
-			// that breaks HTTP 1.1 keep-alive, so unset it.
+			if (keepAlive) {
+				// The core may still decide to close the connection, e.g. when
+				// the application didn't specify a response body length.
+				const char *connectionHeader = apr_table_get(r->headers_out, "Connection");
+				if (connectionHeader == NULL) {
+					connectionHeader = apr_table_get(r->err_headers_out, "Connection");
+				}
+				apr_off_t bodyLength = getResponseBodyLength(r);
+				if (ret != OK || bodyLength == -1 || r->status == HTTP_SWITCHING_PROTOCOLS
+				 || (connectionHeader != NULL && strcasecmp(connectionHeader, "close") == 0))
+				{
+					keepAlive = false;
+				} else {
+					bodyLength -= getBufferedBodyLength(bb);
+					if (bodyLength < 0) {
+						keepAlive = false;
+					} else {
+						bucketState->bytesRemaining = bodyLength;
+					}
+				}
+			}
+
+			// The PassengerAgent may set the Connection header for the bb connection,
+			// but because we fed everything to the ap_scan_script it will also be set
+			// in the response to the client and that breaks HTTP 1.1 keep-alive,
+			// so unset it.
 			apr_table_unset(r->err_headers_out, "Connection");
 			// It's undefined in which of the tables it ends up in, so unset on both.
 			apr_table_unset(r->headers_out, "Connection");
@@ -670,6 +801,11 @@ private:
 					return originalStatus;
 				} else if (ap_pass_brigade(r->output_filters, bb) == APR_SUCCESS) {
 					apr_brigade_cleanup(bb);
+					if (keepAlive && bucketState->bytesRemaining == 0
+					 && bucketState->errorCode == 0)
+					{
+						coreConnectionPool.checkin(conn);
+					}
 				}
 				return OK;
 			} else {
@@ -839,8 +975,12 @@ private:
 		}
 	}
 
+	/**
+	 * Sets `keepAlive` to whether the connection with the Passenger core
+	 * may be reused after this request, as far as the request is concerned.
+	 */
 	string constructRequestHeaders(request_rec *r, DirectoryMapper &mapper,
-		bool &bodyIsChunked)
+		bool &bodyIsChunked, bool &keepAlive)
 	{
 		const char *baseURI = mapper.getBaseURI();
 		DirConfig *config = getDirConfig(r);
@@ -913,8 +1053,13 @@ private:
 
 		if (connectionHeader != NULL && connectionUpgradeFlagSet(connectionHeader->val)) {
 			result.append("Connection: upgrade\r\n", sizeof("Connection: upgrade\r\n") - 1);
+			keepAlive = false;
+		} else if (coreConnectionPool.isEnabled()) {
+			// HTTP/1.1 connections are persistent by default.
+			keepAlive = true;
 		} else {
 			result.append("Connection: close\r\n", sizeof("Connection: close\r\n") - 1);
+			keepAlive = false;
 		}
 
 		if (transferEncodingHeader != NULL) {
@@ -1196,7 +1341,10 @@ private:
 		return bufsiz;
 	}
 
-	void sendRequestBody(const FileDescriptor &fd, request_rec *r, bool chunk) {
+	/**
+	 * Returns whether the entire request body has been sent.
+	 */
+	bool sendRequestBody(const FileDescriptor &fd, request_rec *r, bool chunk) {
 		TRACE_POINT();
 		char buf[1024 * 32];
 		apr_off_t len;
@@ -1221,11 +1369,12 @@ private:
 			if (chunk) {
 				writeExact(fd, "0\r\n\r\n");
 			}
+			return true;
 		} catch (const SystemException &e) {
 			if (e.code() == EPIPE || e.code() == ECONNRESET) {
 				// The Passenger core stopped reading the body, probably
 				// because the application already sent EOF.
-				return;
+				return false;
 			} else {
 				throw e;
 			}
@@ -1257,6 +1406,7 @@ public:
 		m_hasModDir = UNKNOWN;
 		m_hasModAutoIndex = UNKNOWN;
 		m_hasModXsendfile = UNKNOWN;
+		coreConnectionPool.setMaxSize(serverConfig.coreKeepalive);
 
 		P_DEBUG("Initializing Phusion Passenger...");
 		ap_add_version_component(pconf, SERVER_TOKEN_NAME "/" PASSENGER_VERSION);
@@ -1342,6 +1492,13 @@ public:
 
 	void childInit(apr_pool_t *pchild, server_rec *s) {
 		watchdogLauncher.detach();
+
+		// The inotify instance and its thread must belong to this
+		// process, which is why this isn't done before forking.
+		if (serverConfig.fileChangeNotifications && !cstat.enableChangeNotifications()) {
+			P_WARN("Cannot enable file change notifications; "
+				"falling back to PassengerStatThrottleRate");
+		}
 	}
 
 	int prepareRequestWhenInHighPerformanceMode(request_rec *r) {
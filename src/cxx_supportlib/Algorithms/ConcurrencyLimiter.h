@@ -0,0 +1,211 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_ALGORITHMS_CONCURRENCY_LIMITER_H_
+#define _PASSENGER_ALGORITHMS_CONCURRENCY_LIMITER_H_
+
+#include <oxt/macros.hpp>
+#include <algorithm>
+#include <Algorithms/MovingAverage.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * Calculates how many requests may be in flight at the same time, such that
+ * request latency stays below a target. This is an additive-increase/
+ * multiplicative-decrease (AIMD) limiter in the spirit of TCP congestion
+ * control, fed with the latencies of completed requests:
+ *
+ *  - While the smoothed latency is below the target and the limit is fully
+ *    utilized, the limit grows by 1 for every `limit` completed requests.
+ *  - Once the smoothed latency exceeds the target, the limit is multiplied
+ *    by the latency gradient `targetLatency / smoothedLatency`, clamped to
+ *    [0.5, 0.9]. This happens at most once per smoothed latency period,
+ *    so that the requests that were already in flight when latency started
+ *    to rise don't collapse the limit.
+ *
+ * The limit starts at, and never exceeds, the concurrency that the app is
+ * configured for (see `setConcurrency()`), so the limiter can only lower
+ * the concurrency. Apps with unlimited concurrency start at
+ * DEFAULT_INITIAL_LIMIT.
+ *
+ * Latencies and times are in microseconds. A target latency of 0 disables
+ * the limiter, in which case `getLimit()` returns `maxLimit`.
+ *
+ * This class is not thread-safe.
+ */
+class ConcurrencyLimiter {
+public:
+	static const unsigned int DEFAULT_INITIAL_LIMIT = 10;
+	static const unsigned int DEFAULT_MAX_LIMIT = 1000;
+
+private:
+	unsigned long long targetLatency;
+	double limit;
+	double initialLimit;
+	double minLimit;
+	double maxLimit;
+	double smoothedLatency;
+	unsigned long long lastDecreaseTime;
+	unsigned long long decreases;
+
+public:
+	ConcurrencyLimiter(unsigned long long _targetLatency = 0,
+		double _initialLimit = DEFAULT_INITIAL_LIMIT, double _minLimit = 1,
+		double _maxLimit = DEFAULT_MAX_LIMIT)
+		: targetLatency(_targetLatency),
+		  initialLimit(_initialLimit),
+		  minLimit(_minLimit),
+		  maxLimit(_maxLimit)
+	{
+		reset();
+	}
+
+	void reset() {
+		limit = initialLimit;
+		smoothedLatency = -1;
+		lastDecreaseTime = 0;
+		decreases = 0;
+	}
+
+	void setTargetLatency(unsigned long long value) {
+		if (targetLatency != value) {
+			targetLatency = value;
+			reset();
+		}
+	}
+
+	unsigned long long getTargetLatency() const {
+		return targetLatency;
+	}
+
+	/**
+	 * Sets the number of concurrent requests that the app is configured to
+	 * handle, or 0 if that is unlimited. The limit starts at this value and
+	 * is clamped to it.
+	 */
+	void setConcurrency(unsigned int value) {
+		double newInitialLimit, newMaxLimit;
+
+		if (value == 0) {
+			newInitialLimit = DEFAULT_INITIAL_LIMIT;
+			newMaxLimit = DEFAULT_MAX_LIMIT;
+		} else {
+			newInitialLimit = newMaxLimit = std::max<double>(value, minLimit);
+		}
+		if (newInitialLimit == initialLimit && newMaxLimit == maxLimit) {
+			return;
+		}
+
+		initialLimit = newInitialLimit;
+		maxLimit = newMaxLimit;
+		if (smoothedLatency < 0) {
+			// Nothing measured yet.
+			limit = initialLimit;
+		} else {
+			limit = std::min(limit, maxLimit);
+		}
+	}
+
+	bool isEnabled() const {
+		return targetLatency != 0;
+	}
+
+	/**
+	 * Feeds the latency of a completed request into the limiter. `inFlight`
+	 * is the number of requests that were in flight (including this one)
+	 * when it completed. Returns whether `getLimit()` has increased.
+	 */
+	bool update(unsigned long long latency, unsigned int inFlight, unsigned long long now) {
+		if (OXT_UNLIKELY(!isEnabled())) {
+			return false;
+		}
+
+		unsigned int oldLimit = getLimit();
+		// Give recent latencies enough weight to react within a few requests.
+		smoothedLatency = expMovingAverage(smoothedLatency, latency, 0.2);
+
+		if (smoothedLatency > targetLatency) {
+			if (now >= lastDecreaseTime + (unsigned long long) smoothedLatency) {
+				double gradient = targetLatency / smoothedLatency;
+				gradient = std::max(0.5, std::min(0.9, gradient));
+				limit = std::max(minLimit, limit * gradient);
+				lastDecreaseTime = now;
+				decreases++;
+			}
+		} else if (inFlight >= oldLimit) {
+			// Only grow if the limit is what's holding us back. Otherwise
+			// an idle app would accumulate a limit that it can't handle.
+			limit = std::min(maxLimit, limit + 1 / limit);
+		}
+
+		return getLimit() > oldLimit;
+	}
+
+	unsigned int getLimit() const {
+		if (isEnabled()) {
+			return (unsigned int) limit;
+		} else {
+			return (unsigned int) maxLimit;
+		}
+	}
+
+	/**
+	 * Whether the measured latency currently exceeds the target latency.
+	 */
+	bool isOverloaded() const {
+		return isEnabled() && smoothedLatency > targetLatency;
+	}
+
+	/**
+	 * Returns the smoothed latency, or -1 if no latencies have been recorded.
+	 */
+	double getSmoothedLatency() const {
+		return smoothedLatency;
+	}
+
+	unsigned long long getDecreases() const {
+		return decreases;
+	}
+
+	template<typename Stream>
+	void toXml(Stream &stream) const {
+		stream << "<target_latency>" << targetLatency << "</target_latency>";
+		stream << "<limit>" << getLimit() << "</limit>";
+		if (smoothedLatency >= 0) {
+			stream << "<smoothed_latency>" << (unsigned long long) smoothedLatency
+				<< "</smoothed_latency>";
+		}
+		stream << "<decreases>" << decreases << "</decreases>";
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_ALGORITHMS_CONCURRENCY_LIMITER_H_ */
@@ -0,0 +1,316 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_ALGORITHMS_HISTOGRAM_H_
+#define _PASSENGER_ALGORITHMS_HISTOGRAM_H_
+
+#include <oxt/macros.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/atomic.hpp>
+#include <cstring>
+
+namespace Passenger {
+
+using namespace std;
+
+class AtomicLogHistogram;
+
+
+/**
+ * A histogram of unsigned integer samples (typically durations in microseconds)
+ * with logarithmically sized buckets, in the style of HdrHistogram. Samples
+ * smaller than SUB_BUCKETS are counted exactly. Every power-of-two range
+ * [2^e, 2^(e+1)) above that is split into SUB_BUCKETS equally sized buckets,
+ * which gives a relative precision of 1/SUB_BUCKETS (12.5%) over the entire
+ * 64-bit range. Recording a sample only costs a count-leading-zeros
+ * instruction, a shift and a few increments.
+ *
+ * Histograms can be merged, so per-object histograms can be aggregated into
+ * totals without losing information.
+ *
+ * This class is not thread-safe.
+ */
+class LogHistogram {
+public:
+	static const unsigned int SUB_BUCKET_BITS = 3;
+	static const unsigned int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static const unsigned int NBUCKETS = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+private:
+	friend class AtomicLogHistogram;
+
+	boost::uint64_t buckets[NBUCKETS];
+	boost::uint64_t count;
+	boost::uint64_t sum;
+	boost::uint64_t max;
+
+public:
+	LogHistogram() {
+		reset();
+	}
+
+	static unsigned int bucketIndex(boost::uint64_t value) {
+		if (value < SUB_BUCKETS) {
+			return (unsigned int) value;
+		} else {
+			unsigned int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+			// (value >> shift) is in [SUB_BUCKETS, 2 * SUB_BUCKETS).
+			return shift * SUB_BUCKETS + (unsigned int) (value >> shift);
+		}
+	}
+
+	/**
+	 * Returns the largest value that falls into bucket `index`.
+	 */
+	static boost::uint64_t bucketUpperBound(unsigned int index) {
+		if (index < SUB_BUCKETS) {
+			return index;
+		} else {
+			unsigned int shift = index / SUB_BUCKETS - 1;
+			boost::uint64_t lowerBound = ((boost::uint64_t) (SUB_BUCKETS + index % SUB_BUCKETS))
+				<< shift;
+			return lowerBound + (((boost::uint64_t) 1) << shift) - 1;
+		}
+	}
+
+	void reset() {
+		memset(buckets, 0, sizeof(buckets));
+		count = 0;
+		sum = 0;
+		max = 0;
+	}
+
+	void record(boost::uint64_t value) {
+		buckets[bucketIndex(value)]++;
+		count++;
+		sum += value;
+		if (value > max) {
+			max = value;
+		}
+	}
+
+	void merge(const LogHistogram &other) {
+		for (unsigned int i = 0; i < NBUCKETS; i++) {
+			buckets[i] += other.buckets[i];
+		}
+		count += other.count;
+		sum += other.sum;
+		if (other.max > max) {
+			max = other.max;
+		}
+	}
+
+	boost::uint64_t getBucketCount(unsigned int index) const {
+		return buckets[index];
+	}
+
+	boost::uint64_t getCount() const {
+		return count;
+	}
+
+	boost::uint64_t getSum() const {
+		return sum;
+	}
+
+	boost::uint64_t getMax() const {
+		return max;
+	}
+
+	boost::uint64_t getMean() const {
+		if (count == 0) {
+			return 0;
+		} else {
+			return sum / count;
+		}
+	}
+
+	/**
+	 * Returns an upper bound for the given percentile (in the range [0, 100]),
+	 * i.e. the upper bound of the bucket that contains the sample at that
+	 * percentile, clamped to the largest recorded sample.
+	 */
+	boost::uint64_t getPercentile(double percentile) const {
+		if (count == 0) {
+			return 0;
+		}
+
+		boost::uint64_t threshold = (boost::uint64_t) (count * percentile / 100.0 + 0.5);
+		boost::uint64_t seen = 0;
+		if (threshold == 0) {
+			threshold = 1;
+		}
+		for (unsigned int i = 0; i < NBUCKETS; i++) {
+			seen += buckets[i];
+			if (seen >= threshold) {
+				boost::uint64_t bound = bucketUpperBound(i);
+				return (bound < max) ? bound : max;
+			}
+		}
+		return max;
+	}
+
+	/**
+	 * Writes the summary statistics as XML elements. The buckets themselves
+	 * are not written: there can be hundreds of them per histogram, and
+	 * the pool XML contains a histogram for every process.
+	 */
+	template<typename Stream>
+	void toXml(Stream &stream) const {
+		stream << "<count>" << count << "</count>";
+		stream << "<mean>" << getMean() << "</mean>";
+		stream << "<p50>" << getPercentile(50) << "</p50>";
+		stream << "<p90>" << getPercentile(90) << "</p90>";
+		stream << "<p99>" << getPercentile(99) << "</p99>";
+		stream << "<p999>" << getPercentile(99.9) << "</p999>";
+		stream << "<max>" << max << "</max>";
+	}
+};
+
+
+/**
+ * A LogHistogram that multiple threads can record samples into without a
+ * lock. Every counter is updated with a relaxed atomic operation, so a
+ * snapshot that is taken while samples are being recorded may be slightly
+ * inconsistent, e.g. its count may not match the sum of its buckets. That
+ * is fine for reporting.
+ *
+ * To keep objects that own one small, the buckets are only allocated
+ * when the first sample is recorded, and only samples smaller than
+ * 2^MAX_VALUE_BITS have their own bucket. Larger samples are counted in
+ * the last bucket, so percentiles never exceed 2^MAX_VALUE_BITS - 1, but
+ * they still contribute their exact value to the sum and the maximum.
+ */
+class AtomicLogHistogram {
+public:
+	// For durations in microseconds, that's about 19 hours.
+	static const unsigned int MAX_VALUE_BITS = 36;
+	static const unsigned int NBUCKETS = LogHistogram::SUB_BUCKETS
+		* (MAX_VALUE_BITS - LogHistogram::SUB_BUCKET_BITS + 1);
+
+private:
+	boost::atomic<boost::atomic<boost::uint64_t> *> buckets;
+	boost::atomic<boost::uint64_t> count;
+	boost::atomic<boost::uint64_t> sum;
+	boost::atomic<boost::uint64_t> max;
+
+	boost::atomic<boost::uint64_t> *getOrAllocateBuckets() {
+		boost::atomic<boost::uint64_t> *result = buckets.load(boost::memory_order_acquire);
+		if (OXT_UNLIKELY(result == NULL)) {
+			boost::atomic<boost::uint64_t> *newBuckets =
+				new boost::atomic<boost::uint64_t>[NBUCKETS];
+			for (unsigned int i = 0; i < NBUCKETS; i++) {
+				newBuckets[i].store(0, boost::memory_order_relaxed);
+			}
+			if (buckets.compare_exchange_strong(result, newBuckets,
+				boost::memory_order_acq_rel, boost::memory_order_acquire))
+			{
+				result = newBuckets;
+			} else {
+				// Another thread allocated them first.
+				delete[] newBuckets;
+			}
+		}
+		return result;
+	}
+
+public:
+	AtomicLogHistogram()
+		: buckets(NULL),
+		  count(0),
+		  sum(0),
+		  max(0)
+		{ }
+
+	~AtomicLogHistogram() {
+		delete[] buckets.load(boost::memory_order_relaxed);
+	}
+
+	static unsigned int bucketIndex(boost::uint64_t value) {
+		const boost::uint64_t largest = (((boost::uint64_t) 1) << MAX_VALUE_BITS) - 1;
+		return LogHistogram::bucketIndex((value < largest) ? value : largest);
+	}
+
+	void record(boost::uint64_t value) {
+		getOrAllocateBuckets()[bucketIndex(value)].fetch_add(1,
+			boost::memory_order_relaxed);
+		count.fetch_add(1, boost::memory_order_relaxed);
+		sum.fetch_add(value, boost::memory_order_relaxed);
+
+		boost::uint64_t currentMax = max.load(boost::memory_order_relaxed);
+		while (value > currentMax
+			&& !max.compare_exchange_weak(currentMax, value, boost::memory_order_relaxed))
+		{
+			// currentMax has been reloaded; try again.
+		}
+	}
+
+	/**
+	 * Whether any memory has been allocated for buckets. Only used by
+	 * unit tests.
+	 */
+	bool bucketsAllocated() const {
+		return buckets.load(boost::memory_order_acquire) != NULL;
+	}
+
+	boost::uint64_t getCount() const {
+		return count.load(boost::memory_order_relaxed);
+	}
+
+	/**
+	 * Adds the samples recorded so far to `target`. Use this to calculate
+	 * percentiles, or to aggregate multiple histograms into a total.
+	 */
+	void mergeInto(LogHistogram &target) const {
+		const boost::atomic<boost::uint64_t> *b = buckets.load(boost::memory_order_acquire);
+		if (b == NULL) {
+			return;
+		}
+		for (unsigned int i = 0; i < NBUCKETS; i++) {
+			target.buckets[i] += b[i].load(boost::memory_order_relaxed);
+		}
+		target.count += count.load(boost::memory_order_relaxed);
+		target.sum += sum.load(boost::memory_order_relaxed);
+		boost::uint64_t m = max.load(boost::memory_order_relaxed);
+		if (m > target.max) {
+			target.max = m;
+		}
+	}
+
+	LogHistogram snapshot() const {
+		LogHistogram result;
+		mergeInto(result);
+		return result;
+	}
+
+	template<typename Stream>
+	void toXml(Stream &stream) const {
+		snapshot().toXml(stream);
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_ALGORITHMS_HISTOGRAM_H_ */
@@ -41,11 +41,15 @@
 #define DEB_DEV_PACKAGE "passenger-dev"
 #define DEB_MAIN_PACKAGE "passenger"
 #define DEB_NGINX_PACKAGE "nginx-extras"
+#define DEFAULT_ACCESS_LOG_FORMAT "$remote_addr - $remote_user [$time_iso8601] \"$request_method $request_uri $server_protocol\" $status $request_time $queue_time $connect_time $app_pid $turbocache"
 #define DEFAULT_ANALYTICS_LOG_GROUP ""
 #define DEFAULT_ANALYTICS_LOG_PERMISSIONS "u=rwx,g=rx,o=rx"
 #define DEFAULT_ANALYTICS_LOG_USER "nobody"
 #define DEFAULT_APP_ENV "production"
 #define DEFAULT_APP_THREAD_COUNT 1
+#define DEFAULT_CLIENT_BODY_TIMEOUT 60
+#define DEFAULT_CLIENT_HEADER_TIMEOUT 60
+#define DEFAULT_CLIENT_KEEPALIVE_TIMEOUT 75
 #define DEFAULT_CONCURRENCY_MODEL "process"
 #define DEFAULT_FILE_BUFFERED_CHANNEL_THRESHOLD 131072
 #define DEFAULT_HTTP_SERVER_LISTEN_ADDRESS "tcp://127.0.0.1:3000"
@@ -60,6 +64,9 @@
 #define DEFAULT_POOL_IDLE_TIME 300
 #define DEFAULT_PYTHON "python"
 #define DEFAULT_RESPONSE_BUFFER_HIGH_WATERMARK 134217728
+#define DEFAULT_RESPONSE_COMPRESSION_LEVEL 6
+#define DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE 1024
+#define DEFAULT_RESPONSE_COMPRESSION_TYPES "text/html,text/plain,text/css,text/xml,text/javascript,application/javascript,application/x-javascript,application/json,application/xml,application/rss+xml,application/atom+xml,image/svg+xml"
 #define DEFAULT_RUBY "ruby"
 #define DEFAULT_SOCKET_BACKLOG 2048
 #define DEFAULT_SPAWN_METHOD "smart"
@@ -74,6 +81,7 @@
 #define FEEDBACK_FD 3
 #define FLYING_PASSENGER_NAME "Flying Passenger"
 #define GLOBAL_NAMESPACE_DIRNAME "passenger"
+#define LARGE_MBUF_CHUNK_SIZE 16384
 #define MESSAGE_SERVER_MAX_PASSWORD_SIZE 100
 #define MESSAGE_SERVER_MAX_USERNAME_SIZE 100
 #define PASSENGER_API_VERSION "0.3"
@@ -95,7 +103,9 @@
 #define SERVER_KIT_MAX_SERVER_ENDPOINTS 4
 #define SERVER_TOKEN_NAME "Phusion_Passenger"
 #define SHORT_PROGRAM_NAME "Passenger"
+#define SMALL_MBUF_CHUNK_SIZE 1024
 #define SUPPORT_URL "https://www.phusionpassenger.com/support"
 #define USER_NAMESPACE_DIRNAME ".passenger"
+#define XLARGE_MBUF_CHUNK_SIZE 65536
 
 #endif /* _PASSENGER_CONSTANTS_H_ */
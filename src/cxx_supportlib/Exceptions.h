@@ -416,6 +416,31 @@ public:
 	}
 };
 
+/**
+ * Indicates that a Pool::get() or Pool::asyncGet() request was denied because
+ * it could not be assigned a process before its queueing deadline.
+ */
+class RequestQueueTimeoutException: public GetAbortedException {
+private:
+	string msg;
+
+public:
+	RequestQueueTimeoutException(unsigned long long queueTime)
+		: GetAbortedException(oxt::tracable_exception::no_backtrace())
+		{
+			stringstream str;
+			str << "Request queue timeout (spent " << (queueTime / 1000) <<
+				" msec in the queue)";
+			msg = str.str();
+		}
+
+	virtual ~RequestQueueTimeoutException() throw() {}
+
+	virtual const char *what() const throw() {
+		return msg.c_str();
+	}
+};
+
 /**
  * Indicates that a specified argument is incorrect or violates a requirement.
  *
@@ -23,14 +23,18 @@
  *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  *  THE SOFTWARE.
  */
+#include <algorithm>
 #include <iomanip>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <oxt/macros.hpp>
 #include <Logging.h>
 #include <Constants.h>
 #include <StaticString.h>
@@ -52,6 +56,91 @@ static string fileDescriptorLogFile;
 
 #define TRUNCATE_LOGPATHS_TO_MAXCHARS 3 // set to 0 to disable truncation
 
+#ifdef OXT_THREAD_LOCAL_KEYWORD_SUPPORTED
+	// Formatting the date and time is relatively expensive, so every thread
+	// caches the formatted timestamp of the second it last logged in.
+	static __thread time_t cachedDateTimeSec = (time_t) -1;
+	static __thread char cachedDateTime[32];
+	static __thread unsigned int cachedDateTimeSize = 0;
+#endif
+
+
+/**
+ * A single-producer, single-consumer ring buffer in which a thread queues
+ * its log entries for the asynchronous log writer. The producer is the
+ * owner thread, which never blocks. The consumer is whoever holds
+ * `asyncLogMutex`. Only whole log entries are ever committed, so the
+ * consumer never writes a partial line.
+ */
+struct AsyncLogBuffer {
+	char *data;
+	unsigned int capacity; // Always a power of 2.
+	// Total number of bytes committed by the producer and the consumer,
+	// respectively. They wrap around, which is fine because only their
+	// difference matters.
+	boost::atomic<unsigned int> head;
+	boost::atomic<unsigned int> tail;
+	boost::atomic<unsigned int> dropped;
+	// Set when the owner thread exits. Buffers are never freed, so that
+	// the abort handler can walk the list without locking. Instead, an
+	// orphaned buffer is drained and then handed to the next new thread.
+	boost::atomic<bool> orphaned;
+	// Never changes after the buffer has been published.
+	AsyncLogBuffer *next;
+
+	AsyncLogBuffer(unsigned int _capacity)
+		: data((char *) malloc(_capacity)),
+		  capacity(_capacity),
+		  head(0),
+		  tail(0),
+		  dropped(0),
+		  orphaned(false),
+		  next(NULL)
+		{ }
+
+	~AsyncLogBuffer() {
+		free(data);
+	}
+
+	bool push(const char *str, unsigned int size) {
+		unsigned int h = head.load(boost::memory_order_relaxed);
+		unsigned int t = tail.load(boost::memory_order_acquire);
+		if (capacity - (h - t) < size) {
+			dropped.fetch_add(1, boost::memory_order_relaxed);
+			return false;
+		}
+
+		unsigned int pos = h & (capacity - 1);
+		unsigned int firstPart = std::min(size, capacity - pos);
+		memcpy(data + pos, str, firstPart);
+		memcpy(data, str + firstPart, size - firstPart);
+		head.store(h + size, boost::memory_order_release);
+		return true;
+	}
+
+	/** Only to be called by the consumer. */
+	bool empty() const {
+		return head.load(boost::memory_order_acquire) == tail.load(boost::memory_order_relaxed);
+	}
+};
+
+static void writeExactWithoutOXT(int fd, const char *str, unsigned int size);
+static void orphanAsyncLogBuffer(AsyncLogBuffer *buffer);
+
+static boost::atomic<bool> asyncLogging(false);
+static boost::atomic<unsigned long long> asyncLogDropped(0);
+static unsigned int asyncLogBufferSize = 0;
+static boost::thread_specific_ptr<AsyncLogBuffer> threadAsyncLogBuffer(orphanAsyncLogBuffer);
+
+// Protects the list of buffers and serializes the consumers.
+static boost::mutex asyncLogMutex;
+static boost::condition_variable asyncLogCond;
+// Only modified while holding `asyncLogMutex`. Nodes are only ever
+// prepended, so readers that don't lock see a consistent list.
+static boost::atomic<AsyncLogBuffer *> asyncLogBuffers(NULL);
+static boost::thread *asyncLogWriter = NULL;
+static bool asyncLogWriterQuit = false;
+
 
 void
 setLogLevel(int value) {
@@ -147,20 +236,49 @@ setFileDescriptorLogFile(const string &path, int *errcode) {
 	}
 }
 
+/**
+ * Formats the given time as "YYYY-MM-DD HH:MM:SS.", i.e. without the
+ * fraction of the second.
+ */
+static unsigned int
+formatDateTime(char *buf, unsigned int bufsize, time_t sec) {
+	struct tm the_tm;
+	int size;
+
+	localtime_r(&sec, &the_tm);
+	size = snprintf(buf, bufsize, "%d-%02d-%02d %02d:%02d:%02d.",
+		the_tm.tm_year + 1900, the_tm.tm_mon + 1, the_tm.tm_mday,
+		the_tm.tm_hour, the_tm.tm_min, the_tm.tm_sec);
+	return std::min<unsigned int>(std::max(size, 0), bufsize - 1);
+}
+
 void
 _prepareLogEntry(FastStringStream<> &sstream, const char *file, unsigned int line) {
-	struct tm the_tm;
-	char datetime_buf[32];
-	int datetime_size;
+	char datetime_buf[32 + 4];
+	unsigned int datetime_size;
+	unsigned int fraction;
 	struct timeval tv;
 
 	gettimeofday(&tv, NULL);
-	localtime_r(&tv.tv_sec, &the_tm);
-	datetime_size = snprintf(datetime_buf, sizeof(datetime_buf),
-		"%d-%02d-%02d %02d:%02d:%02d.%04llu",
-		the_tm.tm_year + 1900, the_tm.tm_mon + 1, the_tm.tm_mday,
-		the_tm.tm_hour, the_tm.tm_min, the_tm.tm_sec,
-		(unsigned long long) tv.tv_usec / 100);
+	#ifdef OXT_THREAD_LOCAL_KEYWORD_SUPPORTED
+		if (tv.tv_sec != cachedDateTimeSec) {
+			cachedDateTimeSize = formatDateTime(cachedDateTime,
+				sizeof(cachedDateTime), tv.tv_sec);
+			cachedDateTimeSec = tv.tv_sec;
+		}
+		memcpy(datetime_buf, cachedDateTime, cachedDateTimeSize);
+		datetime_size = cachedDateTimeSize;
+	#else
+		datetime_size = formatDateTime(datetime_buf, 32, tv.tv_sec);
+	#endif
+
+	// Append the fraction of the second with a resolution of 100 usec.
+	fraction = tv.tv_usec / 100;
+	datetime_buf[datetime_size++] = '0' + fraction / 1000;
+	datetime_buf[datetime_size++] = '0' + fraction / 100 % 10;
+	datetime_buf[datetime_size++] = '0' + fraction / 10 % 10;
+	datetime_buf[datetime_size++] = '0' + fraction % 10;
+
 	sstream <<
 		"[ " << StaticString(datetime_buf, datetime_size) <<
 		" " << std::dec << getpid() << "/" <<
@@ -220,6 +338,249 @@ _writeLogEntry(const char *str, unsigned int size) {
 	writeExactWithoutOXT(logFd, str, size);
 }
 
+/**
+ * Writes the log entries in the given buffer to the log file, as is.
+ * Only uses async-signal-safe calls, so that the abort handler can use it.
+ */
+static void
+writeAsyncLogBufferData(AsyncLogBuffer *buffer) {
+	unsigned int t = buffer->tail.load(boost::memory_order_relaxed);
+	unsigned int h = buffer->head.load(boost::memory_order_acquire);
+
+	if (h != t) {
+		unsigned int pos = t & (buffer->capacity - 1);
+		unsigned int size = h - t;
+		unsigned int firstPart = std::min(size, buffer->capacity - pos);
+		writeExactWithoutOXT(logFd, buffer->data + pos, firstPart);
+		if (firstPart < size) {
+			writeExactWithoutOXT(logFd, buffer->data, size - firstPart);
+		}
+		buffer->tail.store(h, boost::memory_order_release);
+	}
+}
+
+/**
+ * Writes everything in the given buffer to the log file, and logs how many
+ * entries were dropped. Must be called while holding `asyncLogMutex`.
+ */
+static void
+drainAsyncLogBuffer(AsyncLogBuffer *buffer) {
+	unsigned int dropped;
+
+	writeAsyncLogBufferData(buffer);
+	dropped = buffer->dropped.exchange(0, boost::memory_order_relaxed);
+	if (dropped > 0) {
+		FastStringStream<> stream;
+		_prepareLogEntry(stream, __FILE__, __LINE__);
+		stream << dropped << " log messages were dropped because the "
+			"asynchronous log buffer of a thread was full\n";
+		writeExactWithoutOXT(logFd, stream.data(), stream.size());
+	}
+}
+
+/**
+ * Drains all buffers. Must be called while holding `asyncLogMutex`.
+ */
+static void
+drainAsyncLogBuffers() {
+	AsyncLogBuffer *buffer = asyncLogBuffers.load(boost::memory_order_acquire);
+	while (buffer != NULL) {
+		drainAsyncLogBuffer(buffer);
+		buffer = buffer->next;
+	}
+}
+
+/**
+ * Returns a drained buffer of a thread that has exited, or NULL.
+ * Must be called while holding `asyncLogMutex`.
+ */
+static AsyncLogBuffer *
+reuseOrphanedAsyncLogBuffer() {
+	AsyncLogBuffer *buffer = asyncLogBuffers.load(boost::memory_order_acquire);
+	while (buffer != NULL) {
+		if (buffer->orphaned.load(boost::memory_order_acquire)) {
+			// The owner has stopped pushing, so this empties the buffer.
+			drainAsyncLogBuffer(buffer);
+			buffer->orphaned.store(false, boost::memory_order_relaxed);
+			return buffer;
+		}
+		buffer = buffer->next;
+	}
+	return NULL;
+}
+
+static void
+orphanAsyncLogBuffer(AsyncLogBuffer *buffer) {
+	buffer->orphaned.store(true, boost::memory_order_release);
+}
+
+static void
+asyncLogWriterMain() {
+	boost::unique_lock<boost::mutex> l(asyncLogMutex);
+	while (!asyncLogWriterQuit) {
+		drainAsyncLogBuffers();
+		asyncLogCond.timed_wait(l, boost::posix_time::milliseconds(10));
+	}
+	drainAsyncLogBuffers();
+}
+
+static void
+prepareAsyncLoggingForFork() {
+	// Make sure that no other thread holds the lock while forking.
+	asyncLogMutex.lock();
+}
+
+static void
+resumeAsyncLoggingInParent() {
+	asyncLogMutex.unlock();
+}
+
+static void
+disableAsyncLoggingInChild() {
+	// The writer thread doesn't exist in the child, so log synchronously.
+	// The buffered entries are the parent's to write.
+	AsyncLogBuffer *buffer = asyncLogBuffers.load(boost::memory_order_relaxed);
+	while (buffer != NULL) {
+		buffer->tail.store(buffer->head.load(boost::memory_order_relaxed),
+			boost::memory_order_relaxed);
+		buffer->dropped.store(0, boost::memory_order_relaxed);
+		buffer = buffer->next;
+	}
+	asyncLogging.store(false, boost::memory_order_relaxed);
+	asyncLogWriter = NULL;
+	asyncLogMutex.unlock();
+}
+
+static bool
+bufferLogEntry(const char *str, unsigned int size) {
+	AsyncLogBuffer *buffer = threadAsyncLogBuffer.get();
+	if (OXT_UNLIKELY(buffer == NULL)) {
+		boost::lock_guard<boost::mutex> l(asyncLogMutex);
+		if (asyncLogBufferSize == 0) {
+			return false;
+		}
+		buffer = reuseOrphanedAsyncLogBuffer();
+		if (buffer == NULL) {
+			buffer = new AsyncLogBuffer(asyncLogBufferSize);
+			buffer->next = asyncLogBuffers.load(boost::memory_order_relaxed);
+			asyncLogBuffers.store(buffer, boost::memory_order_release);
+		}
+		threadAsyncLogBuffer.reset(buffer);
+	}
+	if (!buffer->push(str, size)) {
+		asyncLogDropped.fetch_add(1, boost::memory_order_relaxed);
+	}
+
+	// stopAsyncLogging() may have done its final drain just before our
+	// push. It clears `asyncLogging` before draining, so if we still see
+	// it set, that drain (or the writer) will see our entry.
+	boost::atomic_thread_fence(boost::memory_order_seq_cst);
+	if (OXT_UNLIKELY(!asyncLogging.load(boost::memory_order_relaxed))) {
+		flushAsyncLogging();
+	}
+	return true;
+}
+
+void
+_writeLogEntry(int level, const char *str, unsigned int size) {
+	if (asyncLogging.load(boost::memory_order_relaxed)) {
+		if (level > LVL_ERROR && size <= asyncLogBufferSize / 4
+		 && bufferLogEntry(str, size))
+		{
+			return;
+		}
+		// Errors are written directly, because the process might be
+		// about to abort. Flush first so that they appear in order.
+		flushAsyncLogging();
+	}
+	writeExactWithoutOXT(logFd, str, size);
+}
+
+bool
+startAsyncLogging(unsigned int bufferSize) {
+	boost::lock_guard<boost::mutex> l(asyncLogMutex);
+	if (asyncLogWriter != NULL) {
+		return true;
+	}
+
+	// The buffer size must be a power of 2.
+	asyncLogBufferSize = 1024;
+	while (asyncLogBufferSize < bufferSize) {
+		asyncLogBufferSize *= 2;
+	}
+	asyncLogWriterQuit = false;
+
+	static bool forkHandlersInstalled = false;
+	if (!forkHandlersInstalled) {
+		pthread_atfork(prepareAsyncLoggingForFork, resumeAsyncLoggingInParent,
+			disableAsyncLoggingInChild);
+		forkHandlersInstalled = true;
+	}
+
+	// Signals must be handled by the main thread, not by us.
+	sigset_t set, oldSet;
+	sigfillset(&set);
+	pthread_sigmask(SIG_SETMASK, &set, &oldSet);
+	try {
+		asyncLogWriter = new boost::thread(asyncLogWriterMain);
+	} catch (const boost::thread_resource_error &) {
+		asyncLogWriter = NULL;
+	}
+	pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+
+	asyncLogging.store(asyncLogWriter != NULL, boost::memory_order_seq_cst);
+	return asyncLogWriter != NULL;
+}
+
+void
+stopAsyncLogging() {
+	boost::thread *writer;
+	{
+		boost::lock_guard<boost::mutex> l(asyncLogMutex);
+		if (asyncLogWriter == NULL) {
+			return;
+		}
+		asyncLogging.store(false, boost::memory_order_relaxed);
+		boost::atomic_thread_fence(boost::memory_order_seq_cst);
+		asyncLogWriterQuit = true;
+		asyncLogCond.notify_one();
+		writer = asyncLogWriter;
+		asyncLogWriter = NULL;
+	}
+	writer->join();
+	delete writer;
+	// Threads may still have been pushing while we stopped.
+	flushAsyncLogging();
+}
+
+bool
+asyncLoggingEnabled() {
+	return asyncLogging.load(boost::memory_order_relaxed);
+}
+
+void
+flushAsyncLogging() {
+	boost::lock_guard<boost::mutex> l(asyncLogMutex);
+	drainAsyncLogBuffers();
+}
+
+void
+_flushAsyncLoggingForCrash() {
+	// Called from the abort handler, so this must be async-signal-safe:
+	// no locks, no formatting, only write(). If the writer thread is
+	// draining at the same time, some entries may be written twice.
+	AsyncLogBuffer *buffer = asyncLogBuffers.load(boost::memory_order_acquire);
+	while (buffer != NULL) {
+		writeAsyncLogBufferData(buffer);
+		buffer = buffer->next;
+	}
+}
+
+unsigned long long
+getAsyncLoggingDroppedMessages() {
+	return asyncLogDropped.load(boost::memory_order_relaxed);
+}
+
 void
 _writeFileDescriptorLogEntry(const char *str, unsigned int size) {
 	writeExactWithoutOXT(fileDescriptorLog, str, size);
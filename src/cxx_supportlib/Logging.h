@@ -164,8 +164,50 @@ int getFileDescriptorLogFileFd();
  */
 bool setFileDescriptorLogFile(const string &path, int *errcode = NULL);
 
+/**
+ * Starts writing log entries asynchronously. From then on, log entries
+ * that are less severe than LVL_ERROR are queued in a per-thread buffer
+ * of (at least) `bufferSize` bytes, without taking any locks. A background
+ * thread writes them to the log file every few milliseconds. If a thread's
+ * buffer is full, its log entries are dropped and counted, and the number
+ * of dropped entries is logged once there's room again.
+ *
+ * Errors and critical errors are still written directly, after flushing
+ * the buffers, so that they are not lost if the process aborts.
+ *
+ * A child process created with fork() logs synchronously, because it
+ * doesn't have the background thread.
+ *
+ * Returns whether the background thread could be started.
+ * This method is thread-safe.
+ */
+bool startAsyncLogging(unsigned int bufferSize = 64 * 1024);
+
+/**
+ * Stops writing log entries asynchronously and flushes all buffers.
+ * This method is thread-safe.
+ */
+void stopAsyncLogging();
+
+bool asyncLoggingEnabled();
+
+/**
+ * Writes all buffered log entries to the log file.
+ * This method is thread-safe.
+ */
+void flushAsyncLogging();
+
+/**
+ * Returns the number of log entries that were dropped because
+ * a thread's buffer was full. This method is thread-safe.
+ */
+unsigned long long getAsyncLoggingDroppedMessages();
+
 void _prepareLogEntry(FastStringStream<> &sstream, const char *file, unsigned int line);
 void _writeLogEntry(const char *str, unsigned int size);
+void _writeLogEntry(int level, const char *str, unsigned int size);
+/** Async-signal-safe. Intended for the abort handler. */
+void _flushAsyncLoggingForCrash();
 void _writeFileDescriptorLogEntry(const char *str, unsigned int size);
 const char *_strdupFastStringStream(const FastStringStream<> &stream);
 
@@ -190,7 +232,7 @@ enum PassengerLogLevel {
 			Passenger::FastStringStream<> _ostream; \
 			Passenger::_prepareLogEntry(_ostream, file, line); \
 			_ostream << expr << "\n"; \
-			Passenger::_writeLogEntry(_ostream.data(), _ostream.size()); \
+			Passenger::_writeLogEntry((level), _ostream.data(), _ostream.size()); \
 		} \
 	} while (false)
 
@@ -200,7 +242,7 @@ enum PassengerLogLevel {
 			Passenger::FastStringStream<> _ostream; \
 			Passenger::_prepareLogEntry(_ostream, file, line); \
 			_ostream << expr << "\n"; \
-			Passenger::_writeLogEntry(_ostream.data(), _ostream.size()); \
+			Passenger::_writeLogEntry((level), _ostream.data(), _ostream.size()); \
 		} \
 	} while (false)
 
@@ -271,7 +313,7 @@ enum PassengerLogLevel {
 			if (hasFileDescriptorLogFile()) { \
 				Passenger::_writeFileDescriptorLogEntry(_ostream.data(), _ostream.size()); \
 			} else { \
-				Passenger::_writeLogEntry(_ostream.data(), _ostream.size()); \
+				Passenger::_writeLogEntry(Passenger::LVL_DEBUG, _ostream.data(), _ostream.size()); \
 			} \
 		} \
 	} while (false)
@@ -295,7 +337,7 @@ enum PassengerLogLevel {
 			if (hasFileDescriptorLogFile()) { \
 				Passenger::_writeFileDescriptorLogEntry(_ostream.data(), _ostream.size()); \
 			} else { \
-				Passenger::_writeLogEntry(_ostream.data(), _ostream.size()); \
+				Passenger::_writeLogEntry(Passenger::LVL_DEBUG, _ostream.data(), _ostream.size()); \
 			} \
 		} \
 	} while (false)
@@ -312,7 +354,7 @@ enum PassengerLogLevel {
 			if (hasFileDescriptorLogFile()) { \
 				Passenger::_writeFileDescriptorLogEntry(_ostream.data(), _ostream.size()); \
 			} else { \
-				Passenger::_writeLogEntry(_ostream.data(), _ostream.size()); \
+				Passenger::_writeLogEntry(Passenger::LVL_DEBUG, _ostream.data(), _ostream.size()); \
 			} \
 		} \
 	} while (false)
@@ -133,6 +133,10 @@ _mbuf_block_get(struct mbuf_pool *pool)
 		ASSERT_MBUF_BLOCK_PROPERTY(mbuf_block, mbuf_block->refcount == 0);
 
 		pool->nfree_mbuf_blockq--;
+		if (pool->nfree_mbuf_blockq < pool->nfree_low_watermark) {
+			pool->nfree_low_watermark = pool->nfree_mbuf_blockq;
+		}
+		pool->nget++;
 		STAILQ_REMOVE_HEAD(&pool->free_mbuf_blockq, next);
 		_mbuf_block_mark_as_active(pool, mbuf_block);
 		return mbuf_block;
@@ -142,6 +146,8 @@ _mbuf_block_get(struct mbuf_pool *pool)
 	if (OXT_UNLIKELY(buf == NULL)) {
 		return NULL;
 	}
+	pool->nget++;
+	pool->nmalloc++;
 
 	return _mbuf_block_init(pool, buf, pool->mbuf_block_offset);
 }
@@ -184,6 +190,8 @@ mbuf_block_new_standalone(struct mbuf_pool *pool, size_t size)
 	if (OXT_UNLIKELY(buf == NULL)) {
 		return NULL;
 	}
+	pool->nget++;
+	pool->nmalloc++;
 
 	mbuf_block = _mbuf_block_init(pool, buf, block_offset);
 	mbuf_block->start = buf;
@@ -280,6 +288,27 @@ mbuf_pool_init(struct mbuf_pool *pool)
 	#endif
 
 	pool->mbuf_block_offset = pool->mbuf_block_chunk_size - MBUF_BLOCK_HSIZE;
+	pool->smaller = NULL;
+	pool->larger = NULL;
+	pool->nfree_low_watermark = 0;
+	pool->nget = 0;
+	pool->nmalloc = 0;
+	pool->nfreed = 0;
+}
+
+/*
+ * Makes `smaller` and `larger` neighbouring size classes: pools whose
+ * mbuf_blocks have different chunk sizes, but that are otherwise used
+ * together. mbuf_get_with_size() and mbuf_get_at_least() move up to larger
+ * classes when a pool's mbuf_blocks are too small. Every mbuf_block returns
+ * to the free list of the pool that it was allocated from.
+ */
+void
+mbuf_pool_link_size_classes(struct mbuf_pool *smaller, struct mbuf_pool *larger)
+{
+	assert(smaller->mbuf_block_chunk_size < larger->mbuf_block_chunk_size);
+	smaller->larger = larger;
+	larger->smaller = smaller;
 }
 
 void
@@ -310,6 +339,38 @@ mbuf_pool_compact(struct mbuf_pool *pool)
 		pool->nfree_mbuf_blockq--;
 	}
 	assert(pool->nfree_mbuf_blockq == 0);
+	pool->nfree_low_watermark = 0;
+	pool->nfreed += count;
+
+	return count;
+}
+
+/*
+ * Releases part of the free list that was not needed since the previous
+ * call. Meant to be called periodically.
+ *
+ * The free list never dropped below its low watermark during that period,
+ * so that many mbuf_blocks were spare. We release half of them. Repeated
+ * calls let the free list converge on what the workload actually needs
+ * after a burst, while a steady workload keeps its free list.
+ *
+ * Returns the number of mbuf_blocks released.
+ */
+unsigned int
+mbuf_pool_trim(struct mbuf_pool *pool)
+{
+	unsigned int count = (pool->nfree_low_watermark + 1) / 2;
+	unsigned int i;
+
+	assert(pool->nfree_low_watermark <= pool->nfree_mbuf_blockq);
+	for (i = 0; i < count; i++) {
+		struct mbuf_block *mbuf_block = STAILQ_FIRST(&pool->free_mbuf_blockq);
+		mbuf_block_remove(&pool->free_mbuf_blockq, mbuf_block);
+		mbuf_block_free(mbuf_block);
+		pool->nfree_mbuf_blockq--;
+	}
+	pool->nfree_low_watermark = pool->nfree_mbuf_blockq;
+	pool->nfreed += count;
 
 	return count;
 }
@@ -382,9 +443,14 @@ mbuf_get(struct mbuf_pool *pool)
 mbuf
 mbuf_get_with_size(struct mbuf_pool *pool, size_t size)
 {
+	struct mbuf_pool *size_class = pool;
 	struct mbuf_block *block;
-	if (size <= mbuf_pool_data_size(pool)) {
-		block = mbuf_block_get(pool);
+
+	while (size > mbuf_pool_data_size(size_class) && size_class->larger != NULL) {
+		size_class = size_class->larger;
+	}
+	if (size <= mbuf_pool_data_size(size_class)) {
+		block = mbuf_block_get(size_class);
 	} else {
 		block = mbuf_block_new_standalone(pool, size);
 	}
@@ -396,6 +462,20 @@ mbuf_get_with_size(struct mbuf_pool *pool, size_t size)
 	return mbuf(block, 0, size, mbuf::just_created_t());
 }
 
+/*
+ * Like mbuf_get(), but from the smallest size class, starting at `pool`,
+ * whose mbuf_blocks can contain at least `size` bytes. Falls back to the
+ * largest class.
+ */
+mbuf
+mbuf_get_at_least(struct mbuf_pool *pool, size_t size)
+{
+	while (size > mbuf_pool_data_size(pool) && pool->larger != NULL) {
+		pool = pool->larger;
+	}
+	return mbuf_get(pool);
+}
+
 static void
 mbuf_block_print(struct mbuf_block *mbuf_block, std::ostream &stream)
 {
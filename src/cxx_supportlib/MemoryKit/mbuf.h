@@ -103,6 +103,18 @@ struct mbuf_pool {
 
 	size_t mbuf_block_chunk_size; /* mbuf_block chunk size - header + data (const) */
 	size_t mbuf_block_offset;     /* mbuf_block offset in chunk (const) */
+
+	/* Neighbouring size classes, see mbuf_pool_link_size_classes() (const) */
+	struct mbuf_pool *smaller;
+	struct mbuf_pool *larger;
+
+	/* Lowest nfree_mbuf_blockq since the last mbuf_pool_trim() */
+	boost::uint32_t nfree_low_watermark;
+
+	/* Statistics */
+	boost::uint64_t nget;         /* # mbuf_blocks handed out */
+	boost::uint64_t nmalloc;      /* # mbuf_blocks that had to be malloc()ed */
+	boost::uint64_t nfreed;       /* # free mbuf_blocks released by compact or trim */
 };
 
 #define MBUF_BLOCK_MAGIC      0xdeadbeef
@@ -118,6 +130,8 @@ void mbuf_pool_init(struct mbuf_pool *pool);
 void mbuf_pool_deinit(struct mbuf_pool *pool);
 size_t mbuf_pool_data_size(struct mbuf_pool *pool);
 unsigned int mbuf_pool_compact(struct mbuf_pool *pool);
+unsigned int mbuf_pool_trim(struct mbuf_pool *pool);
+void mbuf_pool_link_size_classes(struct mbuf_pool *smaller, struct mbuf_pool *larger);
 
 struct mbuf_block *mbuf_block_get(struct mbuf_pool *pool);
 void mbuf_block_put(struct mbuf_block *mbuf_block);
@@ -280,6 +294,7 @@ public:
 mbuf mbuf_block_subset(struct mbuf_block *mbuf_block, unsigned int start, unsigned int len);
 mbuf mbuf_get(struct mbuf_pool *pool);
 mbuf mbuf_get_with_size(struct mbuf_pool *pool, size_t size);
+mbuf mbuf_get_at_least(struct mbuf_pool *pool, size_t size);
 
 
 } // namespace MemoryKit
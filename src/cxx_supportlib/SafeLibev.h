@@ -31,6 +31,7 @@
 #include <list>
 #include <memory>
 #include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
@@ -46,6 +47,13 @@ using namespace boost;
 
 /**
  * Class for thread-safely using libev.
+ *
+ * Commands scheduled with runLater() are passed to the event loop thread
+ * through an intrusive, lock-free multi-producer single-consumer queue
+ * (Dmitry Vyukov's algorithm), so that many threads can schedule commands
+ * without contending on a lock. Producers only wake up the event loop if
+ * it isn't already about to run commands, so a burst of runLater() calls
+ * results in a single ev_async_send() and a single loop iteration.
  */
 class SafeLibev {
 private:
@@ -55,16 +63,40 @@ private:
 
 	typedef boost::function<void ()> Callback;
 
+	enum CommandState {
+		CS_PENDING,
+		CS_STARTED,
+		CS_CANCELED
+	};
+
 	struct Command {
+		boost::atomic<Command *> next;
 		Callback callback;
-		unsigned int id: 31;
-		bool canceled: 1;
+		unsigned int id;
+		/**
+		 * Whether the command has been started or cancelled. The event loop
+		 * thread and cancelCommand() race to change it from CS_PENDING.
+		 */
+		boost::atomic<int> state;
+
+		Command()
+			: next(NULL),
+			  id(0),
+			  state(CS_PENDING)
+			{ }
 
 		Command(unsigned int _id, const Callback &_callback)
-			: callback(_callback),
+			: next(NULL),
+			  callback(_callback),
 			  id(_id),
-			  canceled(false)
+			  state(CS_PENDING)
 			{ }
+
+		bool transition(int to) {
+			int expected = CS_PENDING;
+			return state.compare_exchange_strong(expected, to,
+				boost::memory_order_acq_rel);
+		}
 	};
 
 	struct ev_loop *loop;
@@ -73,8 +105,27 @@ private:
 
 	boost::mutex syncher;
 	boost::condition_variable cond;
-	vector<Command> commands;
-	unsigned int nextCommandId;
+	boost::atomic<unsigned int> nextCommandId;
+
+	/** Producers push to the head. */
+	boost::atomic<Command *> queueHead;
+	/** The event loop thread pops from the tail. */
+	Command *queueTail;
+	Command queueStub;
+	/** Whether an ev_async_send() is in flight that hasn't been handled yet. */
+	boost::atomic<bool> wakeupPending;
+
+	/**
+	 * Commands that have been popped from the queue but haven't been run yet,
+	 * and the batch of commands that the event loop thread is currently
+	 * running. Protected by `syncher`, which also makes sure that only one
+	 * thread at a time pops from the queue. The commands in the running batch
+	 * are only deleted once the whole batch is done.
+	 */
+	vector<Command *> commands;
+	vector<Command *> *runningCommands;
+	/** The maximum number of commands to run per event loop iteration. 0 means unlimited. */
+	unsigned int maxCommandsPerIteration;
 
 	static void asyncHandler(EV_P_ ev_async *w, int revents) {
 		SafeLibev *self = (SafeLibev *) w->data;
@@ -86,18 +137,138 @@ private:
 		(*callback)();
 	}
 
+	void pushCommand(Command *command) {
+		command->next.store(NULL, boost::memory_order_relaxed);
+		Command *prev = queueHead.exchange(command, boost::memory_order_acq_rel);
+		// Between the exchange and this store, the consumer cannot see
+		// `command` nor anything pushed after it yet.
+		prev->next.store(command, boost::memory_order_release);
+	}
+
+	/**
+	 * Pops the oldest command from the queue. Returns NULL if the queue is
+	 * empty, or if the oldest command is still being pushed; in the latter
+	 * case the producer will wake us up once it's done.
+	 */
+	Command *popCommand() {
+		Command *tail = queueTail;
+		Command *next = tail->next.load(boost::memory_order_acquire);
+		if (tail == &queueStub) {
+			if (next == NULL) {
+				return NULL;
+			}
+			queueTail = next;
+			tail = next;
+			next = next->next.load(boost::memory_order_acquire);
+		}
+		if (next != NULL) {
+			queueTail = next;
+			return tail;
+		}
+		if (tail != queueHead.load(boost::memory_order_acquire)) {
+			return NULL;
+		}
+		pushCommand(&queueStub);
+		next = tail->next.load(boost::memory_order_acquire);
+		if (next != NULL) {
+			queueTail = next;
+			return tail;
+		} else {
+			return NULL;
+		}
+	}
+
+	/** Must be called with `syncher` locked, except from the destructor. */
+	void drainQueue() {
+		Command *command;
+		while ((command = popCommand()) != NULL) {
+			commands.push_back(command);
+		}
+	}
+
+	void wakeup() {
+		if (!wakeupPending.exchange(true, boost::memory_order_seq_cst)) {
+			ev_async_send(loop, &async);
+		}
+	}
+
+	unsigned int schedule(const Callback &callback) {
+		unsigned int id = nextCommandId.fetch_add(1, boost::memory_order_relaxed)
+			% MAX_COMMAND_ID + 1;
+		pushCommand(new Command(id, callback));
+		wakeup();
+		return id;
+	}
+
 	void runCommands() {
-		boost::unique_lock<boost::mutex> l(syncher);
-		vector<Command> commands = this->commands;
-		this->commands.clear();
-		l.unlock();
+		// Must be cleared before draining: a producer that pushes after this
+		// point will send a new wakeup, one that pushed before is drained now.
+		wakeupPending.store(false, boost::memory_order_seq_cst);
 
-		vector<Command>::const_iterator it, end = commands.end();
+		vector<Command *> batch;
+		unsigned int count;
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			drainQueue();
+			batch.swap(commands);
+			runningCommands = &batch;
+		}
+		count = batch.size();
+		if (maxCommandsPerIteration != 0 && count > maxCommandsPerIteration) {
+			count = maxCommandsPerIteration;
+		}
+
+		for (unsigned int i = 0; i < count; i++) {
+			Command *command = batch[i];
+			if (command->transition(CS_STARTED)) {
+				try {
+					command->callback();
+				} catch (...) {
+					finishBatch(batch, i + 1);
+					throw;
+				}
+			}
+		}
+		finishBatch(batch, count);
+	}
+
+	/**
+	 * Deletes the first `end` commands in `batch`, which have been run or
+	 * cancelled. The others are put back in front of any commands that were
+	 * popped in the meantime, and are run in the next event loop iteration.
+	 */
+	void finishBatch(vector<Command *> &batch, unsigned int end) {
+		bool remainder;
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			runningCommands = NULL;
+			deleteCommands(batch, 0, end);
+			remainder = !batch.empty();
+			if (remainder) {
+				commands.insert(commands.begin(), batch.begin(), batch.end());
+			}
+		}
+		if (remainder) {
+			wakeupPending.store(true, boost::memory_order_seq_cst);
+			ev_async_send(loop, &async);
+		}
+	}
+
+	static void deleteCommands(vector<Command *> &batch, unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; i++) {
+			delete batch[i];
+		}
+		batch.erase(batch.begin() + begin, batch.begin() + end);
+	}
+
+	static bool cancelCommandIn(vector<Command *> &commands, unsigned int id) {
+		vector<Command *>::iterator it, end = commands.end();
 		for (it = commands.begin(); it != end; it++) {
-			if (!it->canceled) {
-				it->callback();
+			if ((*it)->id == id) {
+				return (*it)->transition(CS_CANCELED);
 			}
 		}
+		return false;
 	}
 
 	template<typename Watcher>
@@ -124,20 +295,24 @@ private:
 		cond.notify_all();
 	}
 
-	void incNextCommandId() {
-		if (nextCommandId == MAX_COMMAND_ID) {
-			nextCommandId = 1;
-		} else {
-			nextCommandId++;
+	void waitUntilDone(boost::unique_lock<boost::mutex> &l, bool *done) {
+		while (!*done) {
+			cond.wait(l);
 		}
 	}
 
 public:
 	/** SafeLibev takes over ownership of the loop object. */
-	SafeLibev(struct ev_loop *loop) {
+	SafeLibev(struct ev_loop *loop)
+		: nextCommandId(0),
+		  queueHead(&queueStub),
+		  queueTail(&queueStub),
+		  wakeupPending(false),
+		  runningCommands(NULL),
+		  maxCommandsPerIteration(0)
+	{
 		this->loop = loop;
 		loopThread = pthread_self();
-		nextCommandId = 1;
 
 		ev_async_init(&async, asyncHandler);
 		ev_set_priority(&async, EV_MAXPRI);
@@ -151,6 +326,9 @@ public:
 		P_LOG_FILE_DESCRIPTOR_CLOSE(ev_loop_get_pipe(loop, 1));
 		P_LOG_FILE_DESCRIPTOR_CLOSE(ev_backend_fd(loop));
 		ev_loop_destroy(loop);
+
+		drainQueue();
+		deleteCommands(commands, 0, commands.size());
 	}
 
 	void destroy() {
@@ -186,6 +364,17 @@ public:
 		#endif
 	}
 
+	/**
+	 * Limits the number of runLater() callbacks that are run per event loop
+	 * iteration, so that a flood of callbacks cannot starve I/O watchers.
+	 * The remaining callbacks are run in the next iteration. 0 (the default)
+	 * means unlimited. May only be called from the event loop thread, or
+	 * before the event loop is started.
+	 */
+	void setMaxCommandsPerIteration(unsigned int value) {
+		maxCommandsPerIteration = value;
+	}
+
 	template<typename Watcher>
 	void start(Watcher &watcher) {
 		if (onEventLoopThread()) {
@@ -194,14 +383,9 @@ public:
 		} else {
 			boost::unique_lock<boost::mutex> l(syncher);
 			bool done = false;
-			commands.push_back(Command(nextCommandId,
-				boost::bind(&SafeLibev::startWatcherAndNotify<Watcher>,
-					this, &watcher, &done)));
-			incNextCommandId();
-			ev_async_send(loop, &async);
-			while (!done) {
-				cond.wait(l);
-			}
+			schedule(boost::bind(&SafeLibev::startWatcherAndNotify<Watcher>,
+				this, &watcher, &done));
+			waitUntilDone(l, &done);
 		}
 	}
 
@@ -212,14 +396,9 @@ public:
 		} else {
 			boost::unique_lock<boost::mutex> l(syncher);
 			bool done = false;
-			commands.push_back(Command(nextCommandId,
-				boost::bind(&SafeLibev::stopWatcherAndNotify<Watcher>,
-					this, &watcher, &done)));
-			incNextCommandId();
-			ev_async_send(loop, &async);
-			while (!done) {
-				cond.wait(l);
-			}
+			schedule(boost::bind(&SafeLibev::stopWatcherAndNotify<Watcher>,
+				this, &watcher, &done));
+			waitUntilDone(l, &done);
 		}
 	}
 
@@ -236,14 +415,9 @@ public:
 		assert(callback != NULL);
 		boost::unique_lock<boost::mutex> l(syncher);
 		bool done = false;
-		commands.push_back(Command(nextCommandId,
-			boost::bind(&SafeLibev::runAndNotify, this,
-				&callback, &done)));
-		incNextCommandId();
-		ev_async_send(loop, &async);
-		while (!done) {
-			cond.wait(l);
-		}
+		schedule(boost::bind(&SafeLibev::runAndNotify, this,
+			&callback, &done));
+		waitUntilDone(l, &done);
 	}
 
 	/** Run a callback after a certain timeout. */
@@ -262,17 +436,14 @@ public:
 		}
 	}
 
+	/**
+	 * Schedules a callback to be run in the event loop thread. Thread-safe
+	 * and lock-free. Callbacks are run in the order in which they were
+	 * scheduled. Returns an ID that can be passed to cancelCommand().
+	 */
 	unsigned int runLater(const Callback &callback) {
 		assert(callback != NULL);
-		unsigned int result;
-		{
-			boost::unique_lock<boost::mutex> l(syncher);
-			commands.push_back(Command(nextCommandId, callback));
-			result = nextCommandId;
-			incNextCommandId();
-		}
-		ev_async_send(loop, &async);
-		return result;
+		return schedule(callback);
 	}
 
 	/**
@@ -281,23 +452,20 @@ public:
 	 * That is, a return value of true guarantees that the callback will not be called
 	 * in the future, while a return value of false means that the callback has already
 	 * been called or is currently being called.
+	 *
+	 * May be called from any thread, and never waits for the event loop.
 	 */
 	bool cancelCommand(unsigned int id) {
 		if (id == 0) {
 			return false;
 		}
 
-		boost::unique_lock<boost::mutex> l(syncher);
-		// TODO: we can do a binary search because the command ID
-		// is monotically increasing except on overflow.
-		vector<Command>::iterator it, end = commands.end();
-		for (it = commands.begin(); it != end; it++) {
-			if (it->id == id) {
-				it->canceled = true;
-				return true;
-			}
+		boost::lock_guard<boost::mutex> l(syncher);
+		if (runningCommands != NULL && cancelCommandIn(*runningCommands, id)) {
+			return true;
 		}
-		return false;
+		drainQueue();
+		return cancelCommandIn(commands, id);
 	}
 };
 
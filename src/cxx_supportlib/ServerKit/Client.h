@@ -32,6 +32,7 @@
 #include <ServerKit/Hooks.h>
 #include <ServerKit/FdSourceChannel.h>
 #include <ServerKit/FileBufferedFdSinkChannel.h>
+#include <ServerKit/TimerWheel.h>
 
 namespace Passenger {
 namespace ServerKit {
@@ -87,6 +88,8 @@ public:
 	Hooks hooks;
 	FdSourceChannel input;
 	FileBufferedFdSinkChannel output;
+	/** Armed in the server's TimerWheel while a client timeout applies. */
+	TimerWheelEntry timeoutTimer;
 
 	BaseClient(void *_server)
 		: server(_server),
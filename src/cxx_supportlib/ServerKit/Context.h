@@ -27,6 +27,7 @@
 #define _PASSENGER_SERVER_KIT_CONTEXT_H_
 
 #include <boost/make_shared.hpp>
+#include <boost/cstdint.hpp>
 #include <string>
 #include <cstddef>
 #include <jsoncpp/json.h>
@@ -44,67 +45,184 @@ namespace Passenger {
 namespace ServerKit {
 
 
+class FileBufferedChannel;
+
 struct FileBufferedChannelConfig {
 	string bufferDir;
 	unsigned int threshold;
 	unsigned int delayInFileModeSwitching;
 	unsigned int maxDiskChunkReadSize;
+	/** Maximum number of in-memory buffers that the mover writes with a single I/O operation. */
+	unsigned int maxWriteBatchSize;
 	bool autoTruncateFile;
 	bool autoStartMover;
+	/** Read the next chunk from disk while the current one is being consumed. */
+	bool readAhead;
 
 	FileBufferedChannelConfig()
 		: bufferDir("/tmp"),
 		  threshold(DEFAULT_FILE_BUFFERED_CHANNEL_THRESHOLD),
 		  delayInFileModeSwitching(0),
 		  maxDiskChunkReadSize(0),
+		  maxWriteBatchSize(16),
 		  autoTruncateFile(true),
-		  autoStartMover(true)
+		  autoStartMover(true),
+		  readAhead(true)
+		{ }
+};
+
+/**
+ * Memory that all FileBufferedChannels in a Context use for buffering.
+ * Maintained by FileBufferedChannel.
+ */
+struct FileBufferedChannelMemoryUsage {
+	/** Number of bytes buffered in memory, by all channels. */
+	boost::uint64_t bytesBuffered;
+	/** The part of `bytesBuffered` that belongs to channels in the in-memory mode. */
+	boost::uint64_t inMemoryModeBytesBuffered;
+	/**
+	 * Linked list of channels in the in-memory mode that buffer at least
+	 * one byte, most recently added first.
+	 */
+	FileBufferedChannel *inMemoryModeChannels;
+	/** Number of times that a channel switched to the in-file mode. */
+	boost::uint64_t spills;
+	/** The part of `spills` that was caused by exceeding the memory budget. */
+	boost::uint64_t budgetSpills;
+
+	FileBufferedChannelMemoryUsage()
+		: bytesBuffered(0),
+		  inMemoryModeBytesBuffered(0),
+		  inMemoryModeChannels(NULL),
+		  spills(0),
+		  budgetSpills(0)
 		{ }
 };
 
 class Context {
 private:
+	ev_tstamp lastMbufPoolTrimTime;
+
 	void initialize() {
+		small_mbuf_pool.mbuf_block_chunk_size = SMALL_MBUF_CHUNK_SIZE;
 		mbuf_pool.mbuf_block_chunk_size = DEFAULT_MBUF_CHUNK_SIZE;
+		large_mbuf_pool.mbuf_block_chunk_size = LARGE_MBUF_CHUNK_SIZE;
+		xlarge_mbuf_pool.mbuf_block_chunk_size = XLARGE_MBUF_CHUNK_SIZE;
+		MemoryKit::mbuf_pool_init(&small_mbuf_pool);
 		MemoryKit::mbuf_pool_init(&mbuf_pool);
+		MemoryKit::mbuf_pool_init(&large_mbuf_pool);
+		MemoryKit::mbuf_pool_init(&xlarge_mbuf_pool);
+		MemoryKit::mbuf_pool_link_size_classes(&small_mbuf_pool, &mbuf_pool);
+		MemoryKit::mbuf_pool_link_size_classes(&mbuf_pool, &large_mbuf_pool);
+		MemoryKit::mbuf_pool_link_size_classes(&large_mbuf_pool, &xlarge_mbuf_pool);
+		lastMbufPoolTrimTime = 0;
+	}
+
+	static Json::Value inspectMbufPoolAsJson(const struct MemoryKit::mbuf_pool &pool) {
+		Json::Value doc;
+		doc["free_blocks"] = (Json::UInt) pool.nfree_mbuf_blockq;
+		doc["active_blocks"] = (Json::UInt) pool.nactive_mbuf_blockq;
+		doc["chunk_size"] = (Json::UInt) pool.mbuf_block_chunk_size;
+		doc["offset"] = (Json::UInt) pool.mbuf_block_offset;
+		doc["spare_memory"] = byteSizeToJson(pool.nfree_mbuf_blockq
+			* pool.mbuf_block_chunk_size);
+		doc["active_memory"] = byteSizeToJson(pool.nactive_mbuf_blockq
+			* pool.mbuf_block_chunk_size);
+		doc["gets"] = (Json::UInt64) pool.nget;
+		doc["mallocs"] = (Json::UInt64) pool.nmalloc;
+		doc["freed"] = (Json::UInt64) pool.nfreed;
+		return doc;
 	}
 
 public:
 	SafeLibevPtr libev;
 	struct uv_loop_s *libuv;
+	/**
+	 * mbuf size classes. `mbuf_pool` is the default one; the others are
+	 * linked to it, so that MemoryKit::mbuf_get_at_least() and
+	 * MemoryKit::mbuf_get_with_size() can move between them.
+	 */
+	struct MemoryKit::mbuf_pool small_mbuf_pool;
 	struct MemoryKit::mbuf_pool mbuf_pool;
+	struct MemoryKit::mbuf_pool large_mbuf_pool;
+	struct MemoryKit::mbuf_pool xlarge_mbuf_pool;
 	string secureModePassword;
 	FileBufferedChannelConfig defaultFileBufferedChannelConfig;
+	/**
+	 * If non-zero, the FileBufferedChannels in this context share a memory
+	 * budget instead of switching to the in-file mode once they individually
+	 * pass their threshold. They keep buffering in memory until together they
+	 * use more than this many bytes. Then the channels that buffer the most
+	 * switch to the in-file mode, until usage is 1/8th below the budget.
+	 */
+	unsigned int fileBufferedChannelMemoryBudget;
+	FileBufferedChannelMemoryUsage fileBufferedChannelMemoryUsage;
 
 	Context(const SafeLibevPtr &_libev, struct uv_loop_s *_libuv)
 		: libev(_libev),
-		  libuv(_libuv)
+		  libuv(_libuv),
+		  fileBufferedChannelMemoryBudget(0)
 	{
 		initialize();
 	}
 
 	Context(struct ev_loop *loop)
-		: libev(boost::make_shared<SafeLibev>(loop))
+		: libev(boost::make_shared<SafeLibev>(loop)),
+		  fileBufferedChannelMemoryBudget(0)
 	{
 		initialize();
 	}
 
 	~Context() {
+		MemoryKit::mbuf_pool_deinit(&small_mbuf_pool);
 		MemoryKit::mbuf_pool_deinit(&mbuf_pool);
+		MemoryKit::mbuf_pool_deinit(&large_mbuf_pool);
+		MemoryKit::mbuf_pool_deinit(&xlarge_mbuf_pool);
+	}
+
+	/** Releases all free mbuf_blocks of all size classes. */
+	unsigned int compactMbufPools() {
+		struct MemoryKit::mbuf_pool *pool;
+		unsigned int count = 0;
+
+		for (pool = &small_mbuf_pool; pool != NULL; pool = pool->larger) {
+			count += MemoryKit::mbuf_pool_compact(pool);
+		}
+		return count;
+	}
+
+	/**
+	 * Releases the mbuf_blocks that all size classes did not need lately;
+	 * see MemoryKit::mbuf_pool_trim(). Servers call this from their
+	 * statistics update timer. Because several servers may share a context,
+	 * calls within 4 seconds of the previous trim are ignored.
+	 *
+	 * Returns the number of mbuf_blocks released.
+	 */
+	unsigned int trimMbufPools(ev_tstamp now) {
+		struct MemoryKit::mbuf_pool *pool;
+		unsigned int count = 0;
+
+		if (now - lastMbufPoolTrimTime < 4) {
+			return 0;
+		}
+		lastMbufPoolTrimTime = now;
+		for (pool = &small_mbuf_pool; pool != NULL; pool = pool->larger) {
+			count += MemoryKit::mbuf_pool_trim(pool);
+		}
+		return count;
 	}
 
 	Json::Value inspectStateAsJson() const {
 		Json::Value doc;
-		Json::Value mbufDoc;
-
-		mbufDoc["free_blocks"] = (Json::UInt) mbuf_pool.nfree_mbuf_blockq;
-		mbufDoc["active_blocks"] = (Json::UInt) mbuf_pool.nactive_mbuf_blockq;
-		mbufDoc["chunk_size"] = (Json::UInt) mbuf_pool.mbuf_block_chunk_size;
-		mbufDoc["offset"] = (Json::UInt) mbuf_pool.mbuf_block_offset;
-		mbufDoc["spare_memory"] = byteSizeToJson(mbuf_pool.nfree_mbuf_blockq
-			* mbuf_pool.mbuf_block_chunk_size);
-		mbufDoc["active_memory"] = byteSizeToJson(mbuf_pool.nactive_mbuf_blockq
-			* mbuf_pool.mbuf_block_chunk_size);
+		Json::Value mbufDoc = inspectMbufPoolAsJson(mbuf_pool);
+		Json::Value sizeClassesDoc(Json::arrayValue);
+		const struct MemoryKit::mbuf_pool *pool;
+
+		for (pool = &small_mbuf_pool; pool != NULL; pool = pool->larger) {
+			sizeClassesDoc.append(inspectMbufPoolAsJson(*pool));
+		}
+		mbufDoc["size_classes"] = sizeClassesDoc;
 		#ifdef MBUF_ENABLE_DEBUGGING
 			struct MemoryKit::active_mbuf_block_list *list =
 				const_cast<struct MemoryKit::active_mbuf_block_list *>(
@@ -128,6 +246,18 @@ public:
 
 		doc["mbuf_pool"] = mbufDoc;
 
+		const FileBufferedChannelMemoryUsage &usage = fileBufferedChannelMemoryUsage;
+		Json::Value fileBuffersDoc;
+		if (fileBufferedChannelMemoryBudget > 0) {
+			fileBuffersDoc["memory_budget"] = byteSizeToJson(fileBufferedChannelMemoryBudget);
+		}
+		fileBuffersDoc["bytes_buffered"] = byteSizeToJson(usage.bytesBuffered);
+		fileBuffersDoc["in_memory_mode_bytes_buffered"] = byteSizeToJson(
+			usage.inMemoryModeBytesBuffered);
+		fileBuffersDoc["spills"] = (Json::UInt64) usage.spills;
+		fileBuffersDoc["budget_spills"] = (Json::UInt64) usage.budgetSpills;
+		doc["file_buffers"] = fileBuffersDoc;
+
 		return doc;
 	}
 };
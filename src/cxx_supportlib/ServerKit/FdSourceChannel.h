@@ -29,7 +29,9 @@
 #include <oxt/macros.hpp>
 #include <boost/move/move.hpp>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <cstring>
 #include <ev.h>
 #include <jsoncpp/json.h>
 #include <MemoryKit/mbuf.h>
@@ -42,10 +44,37 @@ namespace ServerKit {
 using namespace oxt;
 
 
+/**
+ * A Channel that reads from a file descriptor whenever it is readable.
+ *
+ * Reads are adaptive. As long as reads return less than a few KB, data is
+ * read into a buffer on the stack and copied into an mbuf of the smallest
+ * size class that fits, so that idle connections do not pin any mbuf_block.
+ * Once a read fills the stack buffer, the peer is sending in bulk and we
+ * readv() directly into one or more mbufs. Every bulk read that fills all
+ * of them grows the next read, first by moving to a larger size class and
+ * then by reading into more mbufs at once. A bulk read that returns much
+ * less shrinks the next one. A bulk read that does not fill all mbufs means
+ * that the socket has been drained, so the next read uses the stack again.
+ */
 class FdSourceChannel: protected Channel {
+public:
+	static const unsigned int MAX_READV_BUFFERS = 4;
+
 private:
 	ev_io watcher;
-	MemoryKit::mbuf buffer;
+	/**
+	 * Buffers that were read, but not yet fed because the channel stopped
+	 * accepting input while we were feeding them.
+	 */
+	MemoryKit::mbuf pendingBuffers[MAX_READV_BUFFERS];
+	unsigned int pendingBuffersStart: 8;
+	unsigned int pendingBuffersEnd: 8;
+	/** The number of mbufs that the next bulk read reads into. */
+	unsigned int readvBufferCount: 8;
+	bool readingInBulk: 1;
+	/** The mbuf size class that bulk reads read into. */
+	struct MemoryKit::mbuf_pool *readPool;
 
 	static void _onReadable(EV_P_ ev_io *io, int revents) {
 		static_cast<FdSourceChannel *>(io->data)->onReadable(io, revents);
@@ -58,83 +87,202 @@ private:
 
 	void onReadableWithoutRefGuard() {
 		unsigned int generation = this->generation;
-		unsigned int i, origBufferSize;
+		unsigned int i;
 		bool done = false;
 		ssize_t ret;
 		int e;
 
+		if (!feedPendingBuffers()) {
+			// Callback deinitialized this object.
+			return;
+		}
 		if (!acceptingInput()) {
-			ev_io_stop(ctx->libev->getLoop(), &watcher);
-			if (mayAcceptInputLater()) {
-				consumedCallback = onChannelConsumed;
-			}
+			waitUntilConsumed();
 			return;
 		}
 
 		for (i = 0; i < burstReadCount && !done; i++) {
-			if (buffer.empty()) {
-				buffer = MemoryKit::mbuf_get(&ctx->mbuf_pool);
+			if (readingInBulk) {
+				ret = readIntoMbufs();
+			} else {
+				ret = readIntoStackBuffer();
 			}
-
-			origBufferSize = buffer.size();
-			do {
-				ret = ::read(watcher.fd, buffer.start, buffer.size());
-			} while (OXT_UNLIKELY(ret == -1 && errno == EINTR));
 			if (ret > 0) {
-				MemoryKit::mbuf buffer2(buffer, 0, ret);
-				if (size_t(ret) == size_t(buffer.size())) {
-					// Unref mbuf_block
-					buffer = MemoryKit::mbuf();
-				} else {
-					buffer = MemoryKit::mbuf(buffer, ret);
-				}
-				feedWithoutRefGuard(boost::move(buffer2));
-				if (generation != this->generation) {
-					// Callback deinitialized this object.
+				if (!feedPendingBuffers()) {
 					return;
 				}
-
 				if (!acceptingInput()) {
 					done = true;
-					ev_io_stop(ctx->libev->getLoop(), &watcher);
-					if (mayAcceptInputLater()) {
-						consumedCallback = onChannelConsumed;
-					}
+					waitUntilConsumed();
 				} else {
-					// If we were unable to fill the entire buffer, then it's likely that
+					// If the read did not fill all buffers, then it's likely that
 					// the client is slow and that the next read() will fail with
 					// EAGAIN, so we stop looping and return to the event loop poller.
-					done = (size_t) ret < origBufferSize;
+					done = !readingInBulk;
 				}
 
 			} else if (ret == 0) {
 				done = true;
 				ev_io_stop(ctx->libev->getLoop(), &watcher);
-				buffer = MemoryKit::mbuf();
 				feedWithoutRefGuard(MemoryKit::mbuf());
 
 			} else {
 				e = errno;
 				done = true;
-				buffer = MemoryKit::mbuf();
 				if (e != EAGAIN && e != EWOULDBLOCK) {
 					ev_io_stop(ctx->libev->getLoop(), &watcher);
 					feedError(e);
 				}
 			}
+
+			if (generation != this->generation) {
+				// Callback deinitialized this object.
+				return;
+			}
+		}
+	}
+
+	ssize_t readIntoStackBuffer() {
+		// Exactly fits in an mbuf of the default size class.
+		char buffer[DEFAULT_MBUF_CHUNK_SIZE - sizeof(struct MemoryKit::mbuf_block)];
+		ssize_t ret;
+
+		do {
+			ret = ::read(watcher.fd, buffer, sizeof(buffer));
+		} while (OXT_UNLIKELY(ret == -1 && errno == EINTR));
+		if (ret > 0) {
+			pendingBuffers[0] = MemoryKit::mbuf_get_with_size(&ctx->small_mbuf_pool, ret);
+			memcpy(pendingBuffers[0].start, buffer, ret);
+			pendingBuffersStart = 0;
+			pendingBuffersEnd = 1;
+			readingInBulk = (size_t) ret == sizeof(buffer);
+		}
+		return ret;
+	}
+
+	ssize_t readIntoMbufs() {
+		struct iovec iov[MAX_READV_BUFFERS];
+		unsigned int i, count = readvBufferCount;
+		size_t capacity = 0, remaining;
+		ssize_t ret;
+
+		for (i = 0; i < count; i++) {
+			pendingBuffers[i] = MemoryKit::mbuf_get(readPool);
+			iov[i].iov_base = pendingBuffers[i].start;
+			iov[i].iov_len = pendingBuffers[i].size();
+			capacity += pendingBuffers[i].size();
+		}
+
+		do {
+			ret = ::readv(watcher.fd, iov, count);
+		} while (OXT_UNLIKELY(ret == -1 && errno == EINTR));
+
+		if (ret > 0) {
+			remaining = ret;
+			for (i = 0; i < count && remaining > 0; i++) {
+				if (remaining < pendingBuffers[i].size()) {
+					pendingBuffers[i] = MemoryKit::mbuf(pendingBuffers[i], 0, remaining);
+				}
+				remaining -= pendingBuffers[i].size();
+			}
+			pendingBuffersStart = 0;
+			pendingBuffersEnd = i;
+			adjustBulkReadSize(ret, capacity);
+		} else {
+			i = 0;
+		}
+		// Return unused mbuf_blocks to the free list.
+		for (; i < count; i++) {
+			pendingBuffers[i] = MemoryKit::mbuf();
+		}
+		return ret;
+	}
+
+	/**
+	 * Grows the next bulk read if this one filled all buffers, shrinks it if
+	 * this one returned less than a quarter of their capacity, and goes back
+	 * to reading into the stack buffer if it did not fill all buffers.
+	 */
+	void adjustBulkReadSize(size_t bytesRead, size_t capacity) {
+		if (bytesRead == capacity) {
+			if (readPool->larger != NULL) {
+				readPool = readPool->larger;
+			} else if (readvBufferCount < MAX_READV_BUFFERS) {
+				readvBufferCount *= 2;
+			}
+		} else {
+			readingInBulk = false;
+			if (bytesRead <= capacity / 4) {
+				if (readvBufferCount > 1) {
+					readvBufferCount /= 2;
+				} else if (readPool != &ctx->mbuf_pool) {
+					readPool = readPool->smaller;
+				}
+			}
+		}
+	}
+
+	/**
+	 * Feeds the buffers that the last read produced, until the channel stops
+	 * accepting input. Returns false if a callback deinitialized this object.
+	 */
+	bool feedPendingBuffers() {
+		unsigned int generation = this->generation;
+
+		while (pendingBuffersStart < pendingBuffersEnd && acceptingInput()) {
+			MemoryKit::mbuf buffer(boost::move(pendingBuffers[pendingBuffersStart]));
+			pendingBuffersStart++;
+			feedWithoutRefGuard(boost::move(buffer));
+			if (generation != this->generation) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool hasPendingBuffers() const {
+		return pendingBuffersStart < pendingBuffersEnd;
+	}
+
+	void waitUntilConsumed() {
+		ev_io_stop(ctx->libev->getLoop(), &watcher);
+		if (mayAcceptInputLater()) {
+			consumedCallback = onChannelConsumed;
 		}
 	}
 
+	void clearPendingBuffers() {
+		for (unsigned int i = pendingBuffersStart; i < pendingBuffersEnd; i++) {
+			pendingBuffers[i] = MemoryKit::mbuf();
+		}
+		pendingBuffersStart = 0;
+		pendingBuffersEnd = 0;
+	}
+
+	void resetReadSize() {
+		readvBufferCount = 1;
+		readingInBulk = false;
+		readPool = (ctx != NULL) ? &ctx->mbuf_pool : NULL;
+	}
+
 	static void onChannelConsumed(Channel *channel, unsigned int size) {
 		FdSourceChannel *self = static_cast<FdSourceChannel *>(channel);
 		self->consumedCallback = NULL;
 		if (self->acceptingInput()) {
 			ev_io_start(self->ctx->libev->getLoop(), &self->watcher);
+			if (self->hasPendingBuffers()) {
+				// Feed them in the next event loop iteration, even if
+				// the fd doesn't become readable.
+				ev_feed_event(self->ctx->libev->getLoop(), &self->watcher, EV_READ);
+			}
 		}
 	}
 
 	void initialize() {
 		burstReadCount = 1;
+		pendingBuffersStart = 0;
+		pendingBuffersEnd = 0;
+		resetReadSize();
 		watcher.active = false;
 		watcher.fd = -1;
 		watcher.data = this;
@@ -163,15 +311,17 @@ public:
 	OXT_FORCE_INLINE
 	void setContext(Context *context) {
 		Channel::setContext(context);
+		resetReadSize();
 	}
 
 	void reinitialize(int fd) {
 		Channel::reinitialize();
+		resetReadSize();
 		ev_io_init(&watcher, _onReadable, fd, EV_READ);
 	}
 
 	void deinitialize() {
-		buffer = MemoryKit::mbuf();
+		clearPendingBuffers();
 		if (ev_is_active(&watcher)) {
 			ev_io_stop(ctx->libev->getLoop(), &watcher);
 		}
@@ -241,6 +391,12 @@ public:
 		Json::Value doc = Channel::inspectAsJson();
 		doc["initialized"] = watcher.fd != -1;
 		doc["io_watcher_active"] = (bool) watcher.active;
+		doc["reading_in_bulk"] = readingInBulk;
+		if (readingInBulk) {
+			doc["read_size"] = (Json::UInt) (readvBufferCount
+				* MemoryKit::mbuf_pool_data_size(readPool));
+		}
+		doc["pending_buffers"] = pendingBuffersEnd - pendingBuffersStart;
 		return doc;
 	}
 };
@@ -41,6 +41,7 @@
 #include <utility>
 #include <string>
 #include <deque>
+#include <vector>
 #include <Logging.h>
 #include <ServerKit/Context.h>
 #include <ServerKit/Errors.h>
@@ -79,6 +80,12 @@ using namespace std;
  * FileBufferedChannel operates by default in the in-memory mode. All data is buffered
  * in memory. Beyond a threshold (determined by `passedThreshold()`), it switches
  * to in-file mode.
+ *
+ * If the Context has a memory budget (`Context::fileBufferedChannelMemoryBudget`),
+ * then the threshold only applies in the in-file mode. Channels in the in-memory
+ * mode keep buffering in memory until all channels in the Context together exceed
+ * the budget. Then the channels that buffer the most data switch to the in-file mode,
+ * even if they're not the channel that is being fed.
  */
 class FileBufferedChannel: protected Channel {
 public:
@@ -201,6 +208,8 @@ public:
 	static const unsigned int MAX_MEMORY_BUFFERING = 4294967295u;
 	// `nbuffers` is 27-bit. This is 2^27-1.
 	static const unsigned int MAX_BUFFERS = 134217727;
+	// Upper bound for `config->maxWriteBatchSize`. Well below IOV_MAX.
+	static const unsigned int MAX_WRITE_BATCH_SIZE = 64;
 
 
 private:
@@ -342,6 +351,20 @@ private:
 		 */
 		ReadContext *readRequest;
 
+		/**
+		 * A read of the next chunk, started while the reader waits for the
+		 * underlying channel to consume the previous chunk. This way the disk
+		 * read overlaps with the consumer writing the previous chunk to its
+		 * socket. The reader picks up this request instead of starting a new
+		 * read once the channel has become idle.
+		 *
+		 * @invariant
+		 *     if readAheadRequest != NULL:
+		 *         readerState == RS_WAITING_FOR_CHANNEL_IDLE
+		 *         written > 0
+		 */
+		ReadContext *readAheadRequest;
+
 
 		/***** Writer state *****/
 
@@ -378,6 +401,7 @@ private:
 			: libuv(_libuv),
 			  fd(-1),
 			  readRequest(NULL),
+			  readAheadRequest(NULL),
 			  writerState(WS_INACTIVE),
 			  writerRequest(NULL),
 			  readOffset(0),
@@ -386,6 +410,7 @@ private:
 
 		~InFileMode() {
 			P_ASSERT_EQ(readRequest, 0);
+			P_ASSERT_EQ(readAheadRequest, 0);
 			P_ASSERT_EQ(writerRequest, 0);
 			if (fd != -1) {
 				closeFdInBackground();
@@ -453,6 +478,21 @@ private:
 	 */
 	boost::shared_ptr<InFileMode> inFileMode;
 
+	/**
+	 * The values of `bytesBuffered` and of the in-memory mode part of it, as
+	 * last accounted for in `ctx->fileBufferedChannelMemoryUsage`.
+	 */
+	boost::uint32_t accountedBytesBuffered;
+	boost::uint32_t accountedInMemoryModeBytesBuffered;
+	/**
+	 * Links in `ctx->fileBufferedChannelMemoryUsage.inMemoryModeChannels`.
+	 *
+	 * @invariant
+	 *     (accountedInMemoryModeBytesBuffered > 0) == (this is in the list)
+	 */
+	FileBufferedChannel *prevInMemoryModeChannel;
+	FileBufferedChannel *nextInMemoryModeChannel;
+
 
 	/***** Buffer manipulation *****/
 
@@ -467,6 +507,9 @@ private:
 			// a conditional here improves performance slightly.
 			moreBuffers.clear();
 		}
+		if (accountedBytesBuffered != 0) {
+			updateMemoryUsage();
+		}
 		if (mayCallCallbacks && oldNbuffers != 0) {
 			callBuffersFlushedCallback();
 		}
@@ -482,6 +525,7 @@ private:
 		}
 		nbuffers++;
 		bytesBuffered += buffer.size();
+		updateMemoryUsage();
 		FBC_DEBUG("pushBuffer() completed: nbuffers = " << nbuffers << ", bytesBuffered = " << bytesBuffered);
 	}
 
@@ -489,6 +533,7 @@ private:
 		assert(bytesBuffered >= firstBuffer.size());
 		bytesBuffered -= firstBuffer.size();
 		nbuffers--;
+		updateMemoryUsage();
 		FBC_DEBUG("popBuffer() completed: nbuffers = " << nbuffers << ", bytesBuffered = " << bytesBuffered);
 		if (moreBuffers.empty()) {
 			firstBuffer = MemoryKit::mbuf();
@@ -526,6 +571,83 @@ private:
 		}
 	}
 
+	/***** Memory budget *****/
+
+	/**
+	 * Brings this channel's share in `ctx->fileBufferedChannelMemoryUsage` up to date.
+	 * Must be called after `bytesBuffered` or `mode` changes.
+	 */
+	void updateMemoryUsage() {
+		FileBufferedChannelMemoryUsage &usage = ctx->fileBufferedChannelMemoryUsage;
+		boost::uint32_t inMemoryModeBytesBuffered =
+			(mode == IN_MEMORY_MODE) ? bytesBuffered : 0;
+
+		usage.bytesBuffered -= accountedBytesBuffered;
+		usage.bytesBuffered += bytesBuffered;
+		usage.inMemoryModeBytesBuffered -= accountedInMemoryModeBytesBuffered;
+		usage.inMemoryModeBytesBuffered += inMemoryModeBytesBuffered;
+
+		if (accountedInMemoryModeBytesBuffered == 0 && inMemoryModeBytesBuffered > 0) {
+			prevInMemoryModeChannel = NULL;
+			nextInMemoryModeChannel = usage.inMemoryModeChannels;
+			if (nextInMemoryModeChannel != NULL) {
+				nextInMemoryModeChannel->prevInMemoryModeChannel = this;
+			}
+			usage.inMemoryModeChannels = this;
+		} else if (accountedInMemoryModeBytesBuffered > 0 && inMemoryModeBytesBuffered == 0) {
+			if (prevInMemoryModeChannel == NULL) {
+				usage.inMemoryModeChannels = nextInMemoryModeChannel;
+			} else {
+				prevInMemoryModeChannel->nextInMemoryModeChannel = nextInMemoryModeChannel;
+			}
+			if (nextInMemoryModeChannel != NULL) {
+				nextInMemoryModeChannel->prevInMemoryModeChannel = prevInMemoryModeChannel;
+			}
+			prevInMemoryModeChannel = nextInMemoryModeChannel = NULL;
+		}
+
+		accountedBytesBuffered = bytesBuffered;
+		accountedInMemoryModeBytesBuffered = inMemoryModeBytesBuffered;
+	}
+
+	bool memoryBudgetExceeded() const {
+		return ctx->fileBufferedChannelMemoryBudget > 0
+			&& ctx->fileBufferedChannelMemoryUsage.inMemoryModeBytesBuffered
+				> ctx->fileBufferedChannelMemoryBudget;
+	}
+
+	/**
+	 * Switches the channels that buffer the most data to the in-file mode,
+	 * until the channels in the in-memory mode use 1/8th less than the budget.
+	 * Of channels that buffer the same amount, the one that started buffering
+	 * first is switched first.
+	 *
+	 * Switching doesn't call any callbacks, so this may also switch channels
+	 * that are in the middle of feeding.
+	 */
+	void enforceMemoryBudget() {
+		FileBufferedChannelMemoryUsage &usage = ctx->fileBufferedChannelMemoryUsage;
+		boost::uint64_t lowWatermark = ctx->fileBufferedChannelMemoryBudget
+			- ctx->fileBufferedChannelMemoryBudget / 8;
+
+		while (usage.inMemoryModeBytesBuffered > lowWatermark) {
+			FileBufferedChannel *channel = usage.inMemoryModeChannels;
+			FileBufferedChannel *largest = channel;
+
+			while (channel != NULL) {
+				if (channel->bytesBuffered >= largest->bytesBuffered) {
+					largest = channel;
+				}
+				channel = channel->nextInMemoryModeChannel;
+			}
+
+			FBC_DEBUG("Memory budget exceeded: switching " << (void *) largest <<
+				" (" << largest->bytesBuffered << " bytes buffered) to in-file mode");
+			usage.budgetSpills++;
+			largest->switchToInFileMode();
+		}
+	}
+
 	void callBuffersFlushedCallback() {
 		if (buffersFlushedCallback != NULL) {
 			FBC_DEBUG("Calling buffersFlushedCallback");
@@ -705,6 +827,7 @@ private:
 		} else {
 			FBC_DEBUG("Reader: underlying channel ended while waiting for it to become idle");
 		}
+		cancelReader();
 		terminateReaderBecauseOfEOF();
 	}
 
@@ -714,32 +837,51 @@ private:
 		// Smart pointer to keep fd open until libuv operation
 		// is finished.
 		boost::shared_ptr<InFileMode> inFileMode;
+		// Whether this is `inFileMode->readAheadRequest`.
+		bool readAhead;
+		// Whether the libuv operation has finished. Only used for
+		// read-ahead requests.
+		bool done;
 
 		ReadContext(FileBufferedChannel *self)
-			: FileIOContext(self)
+			: FileIOContext(self),
+			  readAhead(false),
+			  done(false)
 			{ }
 	};
 
 	void readNextChunkFromFile() {
 		assert(inFileMode->written > 0);
+		verifyInvariants();
+		if (inFileMode->readAheadRequest != NULL) {
+			useReadAheadRequest();
+			return;
+		}
+
+		ReadContext *readContext = startReadingChunk(false);
+		readerState = RS_READING_FROM_FILE;
+		inFileMode->readRequest = readContext;
+		verifyInvariants();
+	}
+
+	ReadContext *startReadingChunk(bool readAhead) {
 		size_t size = std::min<size_t>(inFileMode->written,
 			mbuf_pool_data_size(&ctx->mbuf_pool));
 		if (config->maxDiskChunkReadSize > 0 && size > config->maxDiskChunkReadSize) {
 			size = config->maxDiskChunkReadSize;
 		}
-		FBC_DEBUG("Reader: reading next chunk from file, " << size << " bytes");
-		verifyInvariants();
+		FBC_DEBUG("Reader: " << (readAhead ? "reading ahead" : "reading") <<
+			" next chunk from file, " << size << " bytes");
 		ReadContext *readContext = new ReadContext(this);
 		readContext->buffer = MemoryKit::mbuf_get(&ctx->mbuf_pool);
 		readContext->inFileMode = inFileMode;
 		readContext->uvBuffer = uv_buf_init(readContext->buffer.start, size);
-		readerState = RS_READING_FROM_FILE;
-		inFileMode->readRequest = readContext;
+		readContext->readAhead = readAhead;
 
 		uv_fs_read(ctx->libuv, &readContext->req, inFileMode->fd,
 			&readContext->uvBuffer, 1, inFileMode->readOffset,
 			_nextChunkDoneReading);
-		verifyInvariants();
+		return readContext;
 	}
 
 	static void _nextChunkDoneReading(uv_fs_t *req) {
@@ -750,7 +892,55 @@ private:
 			return;
 		}
 
-		readContext->self->nextChunkDoneReading(readContext);
+		if (readContext->readAhead) {
+			readContext->self->readAheadDone(readContext);
+		} else {
+			readContext->self->nextChunkDoneReading(readContext);
+		}
+	}
+
+	void readAheadIfPossible() {
+		P_ASSERT_EQ(readerState, RS_WAITING_FOR_CHANNEL_IDLE);
+		P_ASSERT_EQ(inFileMode->readAheadRequest, 0);
+		if (config->readAhead && inFileMode->written > 0) {
+			inFileMode->readAheadRequest = startReadingChunk(true);
+			verifyInvariants();
+		}
+	}
+
+	void readAheadDone(ReadContext *readContext) {
+		FBC_DEBUG("Reader: done reading ahead");
+		P_ASSERT_EQ(inFileMode->readAheadRequest, readContext);
+		// The result is processed by `nextChunkDoneReading()` once the
+		// reader gets to it.
+		readContext->done = true;
+	}
+
+	void useReadAheadRequest() {
+		ReadContext *readContext = inFileMode->readAheadRequest;
+		inFileMode->readAheadRequest = NULL;
+		readContext->readAhead = false;
+		readerState = RS_READING_FROM_FILE;
+		inFileMode->readRequest = readContext;
+		verifyInvariants();
+
+		if (readContext->done) {
+			FBC_DEBUG("Reader: next chunk has already been read ahead");
+			nextChunkDoneReading(readContext);
+		} else {
+			FBC_DEBUG("Reader: waiting for read-ahead of next chunk to finish");
+		}
+	}
+
+	void cancelReadAhead() {
+		ReadContext *readContext = inFileMode->readAheadRequest;
+		inFileMode->readAheadRequest = NULL;
+		if (readContext->done) {
+			// Its callback has already been called.
+			delete readContext;
+		} else {
+			readContext->cancel();
+		}
 	}
 
 	void nextChunkDoneReading(ReadContext *readContext) {
@@ -787,6 +977,7 @@ private:
 				readNext();
 			} else if (mayAcceptInputLater()) {
 				readNextWhenChannelIdle();
+				readAheadIfPossible();
 			} else {
 				FBC_DEBUG("Reader: data callback no longer accepts further data");
 				terminateReaderBecauseOfEOF();
@@ -836,6 +1027,8 @@ private:
 
 		FBC_DEBUG("Switching to in-file mode");
 		mode = IN_FILE_MODE;
+		updateMemoryUsage();
+		ctx->fileBufferedChannelMemoryUsage.spills++;
 		inFileMode = boost::make_shared<InFileMode>(ctx->libuv);
 		createBufferFile();
 	}
@@ -1059,12 +1252,18 @@ private:
 		// Smart pointer to keep fd open until libuv operation
 		// is finished.
 		boost::shared_ptr<InFileMode> inFileMode;
-		MemoryKit::mbuf buffer;
-		uv_buf_t uvBuffer;
+		// The buffers at the front of the queue that are being moved.
+		// They are written with a single I/O operation, so that moving
+		// many small buffers doesn't cost a thread pool round trip each.
+		vector<MemoryKit::mbuf> buffers;
+		vector<uv_buf_t> uvBuffers;
+		size_t size;
 		size_t written;
 
 		MoveContext(FileBufferedChannel *self)
-			: FileIOContext(self)
+			: FileIOContext(self),
+			  size(0),
+			  written(0)
 			{ }
 	};
 
@@ -1083,28 +1282,69 @@ private:
 			return;
 		}
 
-		FBC_DEBUG("Writer: moving next buffer to file: " <<
-			peekBuffer().size() << " bytes");
-
 		MoveContext *moveContext = new MoveContext(this);
 		moveContext->inFileMode = inFileMode;
-		moveContext->buffer = peekBuffer();
-		moveContext->written = 0;
-		moveContext->uvBuffer = uv_buf_init(moveContext->buffer.start,
-			moveContext->buffer.size());
+		collectBuffersToMove(moveContext);
+		FBC_DEBUG("Writer: moving next " << moveContext->buffers.size() <<
+			" buffer(s) to file: " << moveContext->size << " bytes");
 
 		inFileMode->writerState = WS_MOVING;
 		inFileMode->writerRequest = moveContext;
+		writeBuffersToFile(moveContext);
+		verifyInvariants();
+	}
+
+	void collectBuffersToMove(MoveContext *moveContext) {
+		unsigned int count = config->maxWriteBatchSize;
+		deque<MemoryKit::mbuf>::const_iterator it = moreBuffers.begin();
+
+		if (count > MAX_WRITE_BATCH_SIZE) {
+			count = MAX_WRITE_BATCH_SIZE;
+		} else if (count == 0) {
+			count = 1;
+		}
+		if (count > nbuffers) {
+			count = nbuffers;
+		}
+
+		moveContext->buffers.reserve(count);
+		moveContext->buffers.push_back(firstBuffer);
+		moveContext->size = firstBuffer.size();
+		while (moveContext->buffers.size() < count && !it->empty()) {
+			moveContext->buffers.push_back(*it);
+			moveContext->size += it->size();
+			it++;
+		}
+	}
+
+	/**
+	 * Writes the part of the buffers in `moveContext` that hasn't been
+	 * written yet.
+	 */
+	void writeBuffersToFile(MoveContext *moveContext) {
+		size_t skip = moveContext->written;
+		vector<MemoryKit::mbuf>::const_iterator it, end = moveContext->buffers.end();
+
+		moveContext->uvBuffers.clear();
+		for (it = moveContext->buffers.begin(); it != end; it++) {
+			if (skip >= it->size()) {
+				skip -= it->size();
+			} else {
+				moveContext->uvBuffers.push_back(uv_buf_init(it->start + skip,
+					it->size() - skip));
+				skip = 0;
+			}
+		}
+
 		int result = uv_fs_write(ctx->libuv, &moveContext->req, inFileMode->fd,
-			&moveContext->uvBuffer, 1,
-			inFileMode->readOffset + inFileMode->written,
+			&moveContext->uvBuffers[0], moveContext->uvBuffers.size(),
+			inFileMode->readOffset + inFileMode->written + moveContext->written,
 			_bufferWrittenToFile);
 		if (result != 0) {
 			moveContext->req.result = result;
 			ctx->libev->runLater(boost::bind(_bufferWrittenToFile,
 				&moveContext->req));
 		}
-		verifyInvariants();
 	}
 
 	static void _bufferWrittenToFile(uv_fs_t *req) {
@@ -1126,18 +1366,23 @@ private:
 
 		if (moveContext->req.result >= 0) {
 			moveContext->written += moveContext->req.result;
-			assert(moveContext->written <= moveContext->buffer.size());
+			assert(moveContext->written <= moveContext->size);
 
-			if (moveContext->written == moveContext->buffer.size()) {
-				// Write completed. Proceed with next buffer.
+			if (moveContext->written == moveContext->size) {
+				// Write completed. Proceed with next buffers.
 				RefGuard guard(hooks, this, __FILE__, __LINE__);
 				unsigned int generation = this->generation;
+				unsigned int i;
 
 				FBC_DEBUG("Writer: move complete");
-				assert(peekBuffer().size() == moveContext->buffer.size());
-				inFileMode->written += moveContext->buffer.size();
+				inFileMode->written += moveContext->size;
 
-				popBuffer();
+				// Only popping the last buffer can call buffersFlushedCallback.
+				for (i = 0; i < moveContext->buffers.size(); i++) {
+					assert(peekBuffer().start == moveContext->buffers[i].start);
+					assert(peekBuffer().size() == moveContext->buffers[i].size());
+					popBuffer();
+				}
 				if (generation != this->generation || mode >= ERROR) {
 					// buffersFlushedCallback deinitialized this object, or callback
 					// called a method that encountered an error.
@@ -1150,19 +1395,8 @@ private:
 				moveNextBufferToFile();
 			} else {
 				FBC_DEBUG("Writer: move incomplete, proceeding " <<
-					"with writing rest of buffer");
-				moveContext->uvBuffer = uv_buf_init(
-					moveContext->buffer.start + moveContext->written,
-					moveContext->buffer.size() - moveContext->written);
-				int result = uv_fs_write(ctx->libuv, &moveContext->req,
-					inFileMode->fd, &moveContext->uvBuffer, 1,
-					inFileMode->readOffset + inFileMode->written,
-					_bufferWrittenToFile);
-				if (result != 0) {
-					moveContext->req.result = result;
-					ctx->libev->runLater(boost::bind(_bufferWrittenToFile,
-						&moveContext->req));
-				}
+					"with writing rest of buffers");
+				writeBuffersToFile(moveContext);
 				verifyInvariants();
 			}
 		} else {
@@ -1195,10 +1429,12 @@ private:
 		if (acceptingInput()) {
 			FBC_DEBUG("Feeding error");
 			mode = ERROR;
+			updateMemoryUsage();
 			Channel::feedError(errcode);
 		} else {
 			FBC_DEBUG("Waiting until underlying channel becomes idle for error feeding");
 			mode = ERROR_WAITING;
+			updateMemoryUsage();
 		}
 	}
 
@@ -1220,7 +1456,11 @@ private:
 		switch (readerState) {
 		case RS_FEEDING:
 		case RS_FEEDING_EOF:
+			break;
 		case RS_WAITING_FOR_CHANNEL_IDLE:
+			if (mode == IN_FILE_MODE && inFileMode->readAheadRequest != NULL) {
+				cancelReadAhead();
+			}
 			break;
 		case RS_READING_FROM_FILE:
 			inFileMode->readRequest->cancel();
@@ -1309,6 +1549,11 @@ private:
 				break;
 			}
 
+			if (mode == IN_FILE_MODE && inFileMode->readAheadRequest != NULL) {
+				P_ASSERT_EQ(readerState, RS_WAITING_FOR_CHANNEL_IDLE);
+				assert(inFileMode->written > 0);
+			}
+
 			assert((errcode == 0) == (mode < ERROR));
 			assert((inFileMode != NULL) == (mode == IN_FILE_MODE));
 		#endif
@@ -1362,6 +1607,10 @@ public:
 		  errcode(0),
 		  bytesBuffered(0),
 		  inFileMode(),
+		  accountedBytesBuffered(0),
+		  accountedInMemoryModeBytesBuffered(0),
+		  prevInMemoryModeChannel(NULL),
+		  nextInMemoryModeChannel(NULL),
 		  buffersFlushedCallback(NULL),
 		  dataFlushedCallback(NULL)
 	{
@@ -1377,6 +1626,10 @@ public:
 		  errcode(0),
 		  bytesBuffered(0),
 		  inFileMode(),
+		  accountedBytesBuffered(0),
+		  accountedInMemoryModeBytesBuffered(0),
+		  prevInMemoryModeChannel(NULL),
+		  nextInMemoryModeChannel(NULL),
 		  buffersFlushedCallback(NULL),
 		  dataFlushedCallback(NULL)
 	{
@@ -1388,6 +1641,10 @@ public:
 		if (mode == IN_FILE_MODE) {
 			cancelWriter();
 		}
+		if (accountedBytesBuffered != 0) {
+			bytesBuffered = 0;
+			updateMemoryUsage();
+		}
 	}
 
 	// May only be called right after construction.
@@ -1421,6 +1678,8 @@ public:
 		pushBuffer(buffer);
 		if (mode == IN_MEMORY_MODE && passedThreshold()) {
 			switchToInFileMode();
+		} else if (mode == IN_MEMORY_MODE && memoryBudgetExceeded()) {
+			enforceMemoryBudget();
 		} else if (mode == IN_FILE_MODE
 		        && inFileMode->writerState == WS_INACTIVE
 		        && config->autoStartMover)
@@ -1539,6 +1798,10 @@ public:
 	}
 
 	bool passedThreshold() const {
+		if (mode == IN_MEMORY_MODE && ctx->fileBufferedChannelMemoryBudget > 0) {
+			// The memory budget decides when to switch to the in-file mode.
+			return false;
+		}
 		return bytesBuffered >= config->threshold;
 	}
 
@@ -1594,6 +1857,9 @@ public:
 			doc["writer_state"] = getWriterStateString();
 			doc["read_offset"] = byteSizeToJson(inFileMode->readOffset);
 			doc["written"] = signedByteSizeToJson(inFileMode->written);
+			if (inFileMode->readAheadRequest != NULL) {
+				doc["reading_ahead"] = true;
+			}
 			break;
 		case ERROR:
 			doc["mode"] = "ERROR";
@@ -33,6 +33,7 @@
 #include <DataStructures/LString.h>
 #include <DataStructures/HashedStaticString.h>
 #include <StaticString.h>
+#include <ServerKit/KnownHeaders.h>
 
 namespace Passenger {
 namespace ServerKit {
@@ -40,9 +41,6 @@ namespace ServerKit {
 using namespace std;
 
 
-extern const HashedStaticString HTTP_COOKIE;
-extern const HashedStaticString HTTP_SET_COOKIE;
-
 struct Header {
 	/** Downcased version of the key, for case-insensitive lookup. */
 	LString key;
@@ -70,6 +68,18 @@ struct Header {
  * The hash table never shrinks in size, even after clear(), unless you explicitly call
  * compact(). This allows you to reuse hash table memory over multiple requests.
  *
+ * Tables of up to INLINE_SIZE cells are stored inside the HeaderTable object itself
+ * instead of in a separate heap allocation. A typical request has fewer than 24
+ * headers, so its table is found without an extra pointer dereference, and lives
+ * right next to the rest of the request object. Probing compares hashes before
+ * comparing keys, so that the key's LString parts are only looked at when the
+ * header is most likely the right one.
+ *
+ * Headers in KnownHeaders.h are also indexed by their KnownHeader ID: upon
+ * insertion, the header's hash is mapped to an ID with a perfect hash function,
+ * and the index of its cell is stored in a small per-ID array. Looking up a known
+ * header by ID is therefore just array indexing, without hashing or probing.
+ *
  * This implementation is based on https://github.com/preshing/CompareIntegerMaps.
  * See also http://preshing.com/20130107/this-hash-table-is-faster-than-a-judy-array
  */
@@ -81,6 +91,7 @@ public:
 
 	static const unsigned int MAX_KEY_LENGTH = 65535;
 	static const unsigned int DEFAULT_SIZE = 64;
+	static const unsigned int INLINE_SIZE = 32;
 
 	struct Cell {
 		Header *header;
@@ -90,6 +101,23 @@ private:
 	Cell *m_cells;
 	boost::uint16_t m_arraySize;
 	boost::uint16_t m_population;
+	Cell m_inlineCells[INLINE_SIZE];
+	/** For each KnownHeader: 1 + the index of its cell, or 0 if not present. */
+	boost::uint16_t m_knownCells[KNOWN_HEADER_COUNT];
+
+	Cell *allocateCells(unsigned int size) {
+		if (size <= INLINE_SIZE) {
+			return m_inlineCells;
+		} else {
+			return new Cell[size];
+		}
+	}
+
+	void freeCells(Cell *cells) {
+		if (cells != m_inlineCells) {
+			delete[] cells;
+		}
+	}
 
 	bool shouldRepopulateOnInsert() const {
 		return (m_population + 1) * 4 >= m_arraySize * 3;
@@ -112,15 +140,34 @@ private:
 	}
 
 	OXT_FORCE_INLINE
-	static bool isCookieHeader(const Header *header) {
-		return header->hash == HTTP_COOKIE.hash()
-			&& psg_lstr_cmp(&header->key, HTTP_COOKIE);
+	static KnownHeader getKnownHeader(const Header *header) {
+		KnownHeader id = lookupKnownHeader(header->hash);
+		if (id != KH_NONE && psg_lstr_cmp(&header->key, getKnownHeaderName(id))) {
+			return id;
+		} else {
+			return KH_NONE;
+		}
 	}
 
+	/**
+	 * Called when the header in the cell at `oldIndex` moves to `newIndex`.
+	 * A hash match is enough here: the header at `oldIndex` can only be
+	 * the one that the slot refers to.
+	 */
 	OXT_FORCE_INLINE
-	static bool isSetCookieHeader(const Header *header) {
-		return header->hash == HTTP_SET_COOKIE.hash()
-			&& psg_lstr_cmp(&header->key, HTTP_SET_COOKIE);
+	void moveKnownCell(const Header *header, unsigned int oldIndex, unsigned int newIndex) {
+		KnownHeader id = lookupKnownHeader(header->hash);
+		if (id != KH_NONE && m_knownCells[id] == oldIndex + 1) {
+			m_knownCells[id] = newIndex + 1;
+		}
+	}
+
+	OXT_FORCE_INLINE
+	void forgetKnownCell(const Cell *cell) {
+		KnownHeader id = lookupKnownHeader(cell->header->hash);
+		if (id != KH_NONE && m_knownCells[id] == cell - m_cells + 1) {
+			m_knownCells[id] = 0;
+		}
 	}
 
 	void repopulate(unsigned int desiredSize) {
@@ -130,10 +177,21 @@ private:
 		// Get start/end pointers of old array
 		Cell *oldCells = m_cells;
 		Cell *end = m_cells + m_arraySize;
+		Cell inlineCellsCopy[INLINE_SIZE];
+		boost::uint16_t oldKnownCells[KNOWN_HEADER_COUNT];
+
+		memcpy(oldKnownCells, m_knownCells, sizeof(m_knownCells));
+		memset(m_knownCells, 0, sizeof(m_knownCells));
+		if (oldCells == m_inlineCells) {
+			// The new array may be the inline array too.
+			memcpy(inlineCellsCopy, m_inlineCells, sizeof(Cell) * m_arraySize);
+			oldCells = inlineCellsCopy;
+			end = inlineCellsCopy + m_arraySize;
+		}
 
 		// Allocate new array
 		m_arraySize = desiredSize;
-		m_cells = new Cell[m_arraySize];
+		m_cells = allocateCells(m_arraySize);
 		memset(m_cells, 0, sizeof(Cell) * m_arraySize);
 
 		if (oldCells == NULL) {
@@ -149,6 +207,10 @@ private:
 					if (cellIsEmpty(newCell)) {
 						// Insert here
 						*newCell = *oldCell;
+						KnownHeader id = lookupKnownHeader(oldCell->header->hash);
+						if (id != KH_NONE && oldKnownCells[id] == oldCell - oldCells + 1) {
+							m_knownCells[id] = newCell - m_cells + 1;
+						}
 						break;
 					} else {
 						newCell = PHT_CIRCULAR_NEXT(newCell);
@@ -158,14 +220,21 @@ private:
 		}
 
 		// Delete old array
-		delete[] oldCells;
+		if (oldCells != inlineCellsCopy) {
+			freeCells(oldCells);
+		}
 	}
 
 	void copyFrom(const HeaderTable &other) {
 		m_arraySize  = other.m_arraySize;
 		m_population = other.m_population;
-		m_cells      = new Cell[other.m_arraySize];
-		memcpy(m_cells, other.m_cells, other.m_arraySize * sizeof(Cell));
+		memcpy(m_knownCells, other.m_knownCells, sizeof(m_knownCells));
+		if (other.m_cells == NULL) {
+			m_cells = NULL;
+		} else {
+			m_cells = allocateCells(other.m_arraySize);
+			memcpy(m_cells, other.m_cells, other.m_arraySize * sizeof(Cell));
+		}
 	}
 
 public:
@@ -179,12 +248,14 @@ public:
 	}
 
 	~HeaderTable() {
-		delete[] m_cells;
+		freeCells(m_cells);
 	}
 
 	HeaderTable &operator=(const HeaderTable &other) {
-		delete[] m_cells;
-		copyFrom(other);
+		if (&other != this) {
+			freeCells(m_cells);
+			copyFrom(other);
+		}
 		return *this;
 	}
 
@@ -195,10 +266,11 @@ public:
 		if (initialSize == 0) {
 			m_cells = NULL;
 		} else {
-			m_cells = new Cell[m_arraySize];
+			m_cells = allocateCells(m_arraySize);
 			memset(m_cells, 0, sizeof(Cell) * m_arraySize);
 		}
 		m_population = 0;
+		memset(m_knownCells, 0, sizeof(m_knownCells));
 	}
 
 	const Cell *lookupCell(const HashedStaticString &key) const {
@@ -209,12 +281,13 @@ public:
 			return NULL;
 		}
 
-		const Cell *cell = PHT_FIRST_CELL(key.hash());
+		const boost::uint32_t hash = key.hash();
+		const Cell *cell = PHT_FIRST_CELL(hash);
 		while (true) {
 			if (cellIsEmpty(cell)) {
 				// Empty cell found.
 				return NULL;
-			} else if (psg_lstr_cmp(&cell->header->key, key)) {
+			} else if (cell->header->hash == hash && psg_lstr_cmp(&cell->header->key, key)) {
 				// Non-empty cell found.
 				return cell;
 			} else {
@@ -253,6 +326,46 @@ public:
 		return const_cast<LString *>(static_cast<const HeaderTable *>(this)->lookup(key));
 	}
 
+	OXT_FORCE_INLINE
+	const Cell *lookupCell(KnownHeader id) const {
+		assert(id < KNOWN_HEADER_COUNT);
+		if (m_knownCells[id] != 0) {
+			return &m_cells[m_knownCells[id] - 1];
+		} else {
+			return NULL;
+		}
+	}
+
+	OXT_FORCE_INLINE
+	Cell *lookupCell(KnownHeader id) {
+		return const_cast<Cell *>(static_cast<const HeaderTable *>(this)->lookupCell(id));
+	}
+
+	OXT_FORCE_INLINE
+	Header *lookupHeader(KnownHeader id) const {
+		const Cell *cell = lookupCell(id);
+		if (cell != NULL) {
+			return cell->header;
+		} else {
+			return NULL;
+		}
+	}
+
+	OXT_FORCE_INLINE
+	const LString *lookup(KnownHeader id) const {
+		const Cell * const cell = lookupCell(id);
+		if (cell != NULL) {
+			return &cell->header->val;
+		} else {
+			return NULL;
+		}
+	}
+
+	OXT_FORCE_INLINE
+	LString *lookup(KnownHeader id) {
+		return const_cast<LString *>(static_cast<const HeaderTable *>(this)->lookup(id));
+	}
+
 	/**
 	 * HeaderTable takes over ownership of `header`. But you must ensure that the pool
 	 * that the header was allocated from is not destroyed before the HeaderTable
@@ -279,13 +392,20 @@ public:
 					m_population++;
 
 					cell->header = header;
+					KnownHeader id = getKnownHeader(header);
+					if (id != KH_NONE) {
+						m_knownCells[id] = cell - m_cells + 1;
+					}
 					*headerPtr = NULL;
 					return;
-				} else if (psg_lstr_cmp(&cell->header->key, &header->key)) {
+				} else if (cell->header->hash == header->hash
+					&& psg_lstr_cmp(&cell->header->key, &header->key))
+				{
 					// Cell matches, so merge value into header.
-					if (isCookieHeader(header)) {
+					boost::uint16_t index = cell - m_cells + 1;
+					if (m_knownCells[KH_COOKIE] == index) {
 						psg_lstr_append(&cell->header->val, pool, ";", 1);
-					} else if (isSetCookieHeader(header)) {
+					} else if (m_knownCells[KH_SET_COOKIE] == index) {
 						psg_lstr_append(&cell->header->val, pool, "\n", 1);
 					} else {
 						psg_lstr_append(&cell->header->val, pool, ",", 1);
@@ -329,6 +449,8 @@ public:
 		assert(cell >= m_cells && cell - m_cells < m_arraySize);
 		assert(!cellIsEmpty(cell));
 
+		forgetKnownCell(cell);
+
 		// Remove this cell by shuffling neighboring cells so there are no gaps in anyone's probe chain
 		Cell *neighbor = PHT_CIRCULAR_NEXT(cell);
 		while (true) {
@@ -358,6 +480,7 @@ public:
 					psg_lstr_deinit(&cell->header->val);
 				}
 				*cell = *neighbor;
+				moveKnownCell(cell->header, neighbor - m_cells, cell - m_cells);
 				cell = neighbor;
 				neighbor->header = NULL;
 			}
@@ -372,19 +495,28 @@ public:
 		}
 	}
 
+	void erase(KnownHeader id) {
+		Cell *cell = lookupCell(id);
+		if (cell != NULL) {
+			erase(cell);
+		}
+	}
+
 	/** Does not resize the array. */
 	void clear() {
 		if (m_cells != NULL && m_population != 0) {
 			memset(m_cells, 0, sizeof(Cell) * m_arraySize);
+			memset(m_knownCells, 0, sizeof(m_knownCells));
 		}
 		m_population = 0;
 	}
 
 	void freeMemory() {
-		delete[] m_cells;
+		freeCells(m_cells);
 		m_cells = NULL;
 		m_arraySize  = 0;
 		m_population = 0;
+		memset(m_knownCells, 0, sizeof(m_knownCells));
 	}
 
 	void compact() {
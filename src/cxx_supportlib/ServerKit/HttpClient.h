@@ -27,6 +27,7 @@
 #define _PASSENGER_SERVER_KIT_HTTP_CLIENT_H_
 
 #include <psg_sysqueue.h>
+#include <MemoryKit/mbuf.h>
 #include <ServerKit/Client.h>
 #include <ServerKit/HttpRequest.h>
 
@@ -49,10 +50,26 @@ public:
 	Request *currentRequest;
 	unsigned int requestsBegun;
 
+	/**
+	 * Responses to pipelined requests that HttpServer has served but not yet
+	 * passed to `output`, so that they can be written together. Only used
+	 * while `outputCorked` is set. See HttpServer::writeResponse().
+	 */
+	MemoryKit::mbuf corkedOutput;
+	unsigned int corkedOutputSize;
+	unsigned int corkedResponses;
+	bool outputCorked;
+	/** Whether more data followed the current request's header in the input buffer. */
+	bool moreRequestsBuffered;
+
 	BaseHttpClient(void *server)
 		: BaseClient(server),
 		  currentRequest(NULL),
-		  requestsBegun(0)
+		  requestsBegun(0),
+		  corkedOutputSize(0),
+		  corkedResponses(0),
+		  outputCorked(false),
+		  moreRequestsBuffered(false)
 		{ }
 };
 
@@ -141,6 +141,13 @@ public:
 	} aux;
 	boost::uint64_t bodyAlreadyRead;
 
+	/**
+	 * The status code of the response, or 0 if not known. Set by
+	 * HttpServer::writeSimpleResponse(). Subclasses that write responses
+	 * in other ways are responsible for setting it themselves.
+	 */
+	boost::uint16_t responseStatus;
+
 	ev_tstamp lastDataReceiveTime;
 	ev_tstamp lastDataSendTime;
 
@@ -176,7 +183,8 @@ public:
 		  pool(NULL),
 		  headers(16),
 		  secureHeaders(32),
-		  bodyAlreadyRead(0)
+		  bodyAlreadyRead(0),
+		  responseStatus(0)
 	{
 		psg_lstr_init(&path);
 		aux.bodyInfo.contentLength = 0; // Sets the entire union to 0.
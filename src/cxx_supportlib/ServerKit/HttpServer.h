@@ -69,7 +69,36 @@ public:
 
 	FreeRequestList freeRequests;
 	unsigned int freeRequestCount, requestFreelistLimit;
+	/**
+	 * Client timeouts, in seconds. 0 means no timeout.
+	 *
+	 *  - clientHeaderTimeout: the maximum time that a client may take to send
+	 *    the request header, counting from when the connection was accepted,
+	 *    or from the first byte of a keep-alive request.
+	 *  - clientBodyTimeout: the maximum time between two reads of the request
+	 *    body. Does not apply while we are not reading because the request
+	 *    body channel is busy.
+	 *  - clientKeepAliveTimeout: the maximum time that a keep-alive
+	 *    connection may be idle between two requests.
+	 *
+	 * They are all off by default. The Core turns them on in builtin
+	 * Standalone mode, where clients connect to it directly. Behind a web
+	 * server they stay off by default: the Apache module keeps idle
+	 * connections to the Core in a pool (CoreConnectionPool), and reusing a
+	 * connection just as the Core times it out results in a spurious EOF.
+	 */
+	unsigned int clientHeaderTimeout, clientBodyTimeout, clientKeepAliveTimeout;
+	/**
+	 * The maximum number of responses to pipelined requests that are written
+	 * to a client together. 1 disables coalescing.
+	 */
+	unsigned int pipelineDepth;
 	unsigned long totalRequestsBegun, lastTotalRequestsBegun;
+	/**
+	 * The number of responses that were held back, to be written together
+	 * with the response to a later pipelined request.
+	 */
+	unsigned long totalResponsesCorked;
 	double requestBeginSpeed1m, requestBeginSpeed1h;
 
 private:
@@ -254,7 +283,108 @@ private:
 
 		client->currentRequest = req = checkoutRequestObject(client);
 		req->client = client;
+		client->moreRequestsBuffered = false;
 		reinitializeRequest(client, req);
+
+		if (client->requestsBegun == 0) {
+			setClientTimeoutIfEnabled(client, clientHeaderTimeout);
+		} else {
+			setClientTimeoutIfEnabled(client, clientKeepAliveTimeout);
+		}
+	}
+
+
+	/***** Pipelined request batching *****/
+
+	/*
+	 * When a client pipelines requests, the next requests are usually
+	 * already in the input buffer when the current one ends. Responses that
+	 * we produce right away, like turbocache hits and error pages, are then
+	 * copied into `client->corkedOutput` instead of being written one by
+	 * one. We move on to the next buffered request immediately, and pass
+	 * all of them to `client->output` as a single buffer once we've served
+	 * the last buffered request, `pipelineDepth` requests, or a request that
+	 * we can't finish right away. Since the responses are only ever appended
+	 * in request order, and the corked output is always passed to
+	 * `client->output` before anything else, responses stay in order.
+	 */
+
+	void corkOutputIfPipelining(Client *client, Request *req) {
+		// endRequest() only skips flushing the output channel when it has
+		// nothing buffered, so start corking only when that is the case.
+		if (client->moreRequestsBuffered
+		 && pipelineDepth > 1
+		 && req->wantKeepAlive
+		 && !client->outputCorked
+		 && client->output.getTotalBytesBuffered() == 0)
+		{
+			client->outputCorked = true;
+		}
+	}
+
+	bool appendToCorkedOutput(Client *client, const MemoryKit::mbuf &buffer) {
+		if (buffer.empty()) {
+			// End of the response. endRequest() takes care of that.
+			return true;
+		}
+		if (client->corkedOutput.empty()) {
+			client->corkedOutput = MemoryKit::mbuf_get(&this->getContext()->mbuf_pool);
+			client->corkedOutputSize = 0;
+		}
+		if (buffer.size() > client->corkedOutput.size() - client->corkedOutputSize) {
+			return false;
+		}
+		memcpy(client->corkedOutput.start + client->corkedOutputSize,
+			buffer.start, buffer.size());
+		client->corkedOutputSize += buffer.size();
+		return true;
+	}
+
+	/**
+	 * Called from endRequest(). Returns whether the request's response may
+	 * stay in the corked output while we handle the next buffered request.
+	 */
+	bool shouldKeepOutputCorked(Client *client, Request *req) const {
+		return client->moreRequestsBuffered
+			&& client->corkedResponses + 1 < pipelineDepth
+			&& canKeepAlive(req);
+	}
+
+	void clearCorkedOutput(Client *client) {
+		client->corkedOutput = MemoryKit::mbuf();
+		client->corkedOutputSize = 0;
+		client->corkedResponses = 0;
+		client->outputCorked = false;
+	}
+
+
+	/***** Client timeouts *****/
+
+	void setClientTimeoutIfEnabled(Client *client, unsigned int timeout) {
+		if (timeout == 0) {
+			this->clearClientTimeout(client);
+		} else {
+			this->setClientTimeout(client, timeout);
+		}
+	}
+
+	/**
+	 * Re-arms the body timeout while we're waiting for more request body
+	 * data from the client. Clears it once the body has been fully read,
+	 * or while we're not reading because the request body channel is busy.
+	 */
+	void updateBodyTimeout(Client *client, Request *req) {
+		if (!client->connected() || client->currentRequest != req || req->ended()) {
+			return;
+		}
+		if (req->bodyType != Request::RBT_UPGRADE
+		 && !req->bodyFullyRead()
+		 && client->input.isStarted())
+		{
+			setClientTimeoutIfEnabled(client, clientBodyTimeout);
+		} else {
+			this->clearClientTimeout(client);
+		}
 	}
 
 
@@ -273,7 +403,9 @@ private:
 					feed(buffer);
 			}
 			if (req->httpState == Request::PARSING_HEADERS) {
-				// Not yet done parsing.
+				// Not yet done parsing. The rest of the request may take a
+				// while to arrive, so don't hold back earlier responses.
+				uncorkOutput(client);
 				return Channel::Result(buffer.size(), false);
 			}
 
@@ -281,6 +413,7 @@ private:
 			SKC_TRACE(client, 2, "New request received: #" << (totalRequestsBegun + 1));
 			headerParserStatePool.destroy(req->parserState.headerParser);
 			req->parserState.headerParser = NULL;
+			client->moreRequestsBuffered = ret < buffer.size();
 
 			if (HttpServer::serverState == HttpServer::SHUTTING_DOWN
 			 && shouldDisconnectClientOnShutdown(client))
@@ -292,21 +425,48 @@ private:
 			switch (req->httpState) {
 			case Request::COMPLETE:
 				req->detectingNextRequestEarlyReadError = true;
+				this->clearClientTimeout(client);
+				corkOutputIfPipelining(client, req);
 				onRequestBegin(client, req);
+				if (client->outputCorked && !req->ended()) {
+					// The response will be produced later, so write out
+					// the responses to the earlier requests now.
+					uncorkOutput(client);
+					if (req->ended()) {
+						return Channel::Result(0, true);
+					}
+				}
 				return Channel::Result(ret, false);
 			case Request::PARSING_BODY:
 				SKC_TRACE(client, 2, "Expecting a request body");
+				setClientTimeoutIfEnabled(client, clientBodyTimeout);
+				uncorkOutput(client);
+				if (req->ended()) {
+					// Writing the corked output failed.
+					return Channel::Result(0, true);
+				}
 				onRequestBegin(client, req);
 				return Channel::Result(ret, false);
 			case Request::PARSING_CHUNKED_BODY:
 				SKC_TRACE(client, 2, "Expecting a chunked request body");
 				prepareChunkedBodyParsing(client, req);
+				setClientTimeoutIfEnabled(client, clientBodyTimeout);
+				uncorkOutput(client);
+				if (req->ended()) {
+					// Writing the corked output failed.
+					return Channel::Result(0, true);
+				}
 				onRequestBegin(client, req);
 				return Channel::Result(ret, false);
 			case Request::UPGRADED:
 				assert(!req->wantKeepAlive);
 				if (supportsUpgrade(client, req)) {
 					SKC_TRACE(client, 2, "Expecting connection upgrade");
+					this->clearClientTimeout(client);
+					uncorkOutput(client);
+					if (req->ended()) {
+						return Channel::Result(0, true);
+					}
 					onRequestBegin(client, req);
 					return Channel::Result(ret, false);
 				} else {
@@ -656,6 +816,7 @@ private:
 				req->bodyChannel.feed(MemoryKit::mbuf());
 			} else {
 				client->input.start();
+				self->updateBodyTimeout(client, req);
 			}
 		}
 	}
@@ -712,6 +873,15 @@ protected:
 		bool ended = req->ended();
 
 		if (!ended) {
+			if (req->httpState == Request::PARSING_HEADERS
+			 && req->lastDataReceiveTime == 0
+			 && client->requestsBegun > 0
+			 && !buffer.empty())
+			{
+				// The first data of a keep-alive request. The connection
+				// is no longer idle.
+				setClientTimeoutIfEnabled(client, clientHeaderTimeout);
+			}
 			req->lastDataReceiveTime = ev_now(this->getLoop());
 		}
 		if (detectNextRequestEarlyReadError(client, req, buffer, errcode)) {
@@ -729,14 +899,20 @@ protected:
 					assert(!req->wantKeepAlive);
 					return Channel::Result(buffer.size(), true);
 				} else {
-					return processClientDataWhenParsingBody(client, req, buffer, errcode);
+					Channel::Result result = processClientDataWhenParsingBody(
+						client, req, buffer, errcode);
+					updateBodyTimeout(client, req);
+					return result;
 				}
 			case Request::RBT_CHUNKED:
 				if (ended) {
 					assert(!req->wantKeepAlive);
 					return Channel::Result(buffer.size(), true);
 				} else {
-					return processClientDataWhenParsingChunkedBody(client, req, buffer, errcode);
+					Channel::Result result = processClientDataWhenParsingChunkedBody(
+						client, req, buffer, errcode);
+					updateBodyTimeout(client, req);
+					return result;
 				}
 			case Request::RBT_UPGRADE:
 				if (ended) {
@@ -755,6 +931,7 @@ protected:
 
 	virtual void onClientDisconnecting(Client *client) {
 		ParentClass::onClientDisconnecting(client);
+		clearCorkedOutput(client);
 
 		// Handle client being disconnect()'ed without endRequest().
 
@@ -769,6 +946,7 @@ protected:
 	virtual void deinitializeClient(Client *client) {
 		ParentClass::deinitializeClient(client);
 		client->currentRequest = NULL;
+		clearCorkedOutput(client);
 	}
 
 	virtual bool shouldDisconnectClientOnShutdown(Client *client) {
@@ -776,6 +954,22 @@ protected:
 			|| client->currentRequest->upgraded();
 	}
 
+	virtual void onClientTimeout(Client *client) {
+		SKC_LOG_EVENT(HttpServer, client, "onClientTimeout");
+		Request *req = client->currentRequest;
+
+		if (req == NULL || req->httpState != Request::PARSING_HEADERS) {
+			this->disconnectWithError(&client, "timed out reading the request body",
+				LVL_INFO);
+		} else if (req->lastDataReceiveTime == 0 && client->requestsBegun > 0) {
+			SKC_DEBUG(client, "Keep-alive connection idle for too long; disconnecting");
+			this->disconnect(&client);
+		} else {
+			this->disconnectWithError(&client, "timed out reading the request header",
+				LVL_INFO);
+		}
+	}
+
 	virtual void onUpdateStatistics() {
 		ParentClass::onUpdateStatistics();
 		ev_tstamp now = ev_now(this->getLoop());
@@ -845,6 +1039,8 @@ protected:
 	virtual void reinitializeClient(Client *client, int fd) {
 		ParentClass::reinitializeClient(client, fd);
 		client->requestsBegun = 0;
+		client->moreRequestsBuffered = false;
+		assert(!client->outputCorked);
 		assert(client->currentRequest == NULL);
 	}
 
@@ -868,6 +1064,7 @@ protected:
 		req->bodyChannel.reinitialize();
 		req->aux.bodyInfo.contentLength = 0; // Sets the entire union to 0.
 		req->bodyAlreadyRead = 0;
+		req->responseStatus = 0;
 		req->lastDataReceiveTime = 0;
 		req->lastDataSendTime = 0;
 		req->queryStringIndex = -1;
@@ -930,8 +1127,13 @@ public:
 		: ParentClass(context),
 		  freeRequestCount(0),
 		  requestFreelistLimit(1024),
+		  clientHeaderTimeout(0),
+		  clientBodyTimeout(0),
+		  clientKeepAliveTimeout(0),
+		  pipelineDepth(16),
 		  totalRequestsBegun(0),
 		  lastTotalRequestsBegun(0),
+		  totalResponsesCorked(0),
 		  requestBeginSpeed1m(-1),
 		  requestBeginSpeed1h(-1),
 		  headerParserStatePool(16, 256)
@@ -1001,8 +1203,18 @@ public:
 	}
 
 	void writeResponse(Client *client, const MemoryKit::mbuf &buffer) {
-		client->currentRequest->responseBegun = true;
-		client->currentRequest->lastDataSendTime = ev_now(this->getLoop());
+		Request *req = client->currentRequest;
+		req->responseBegun = true;
+		req->lastDataSendTime = ev_now(this->getLoop());
+		if (OXT_UNLIKELY(client->outputCorked)) {
+			if (appendToCorkedOutput(client, buffer)) {
+				return;
+			}
+			uncorkOutput(client);
+			if (req->ended()) {
+				return;
+			}
+		}
 		client->output.feedWithoutRefGuard(buffer);
 	}
 
@@ -1037,6 +1249,7 @@ public:
 		const char *status;
 		const LString *value;
 
+		req->responseStatus = code;
 		status = getStatusCodeAndReasonPhrase(code);
 		if (status == NULL) {
 			snprintf(statusBuffer, sizeof(statusBuffer), "%d Unknown Reason-Phrase", code);
@@ -1048,7 +1261,7 @@ public:
 			"Status: %s\r\n",
 			(int) req->httpMajor, (int) req->httpMinor, status, status);
 
-		value = (headers != NULL) ? headers->lookup(P_STATIC_STRING("content-type")) : NULL;
+		value = (headers != NULL) ? headers->lookup(KH_CONTENT_TYPE) : NULL;
 		if (value == NULL) {
 			pos = appendData(pos, end, P_STATIC_STRING("Content-Type: text/html; charset=UTF-8\r\n"));
 		} else {
@@ -1057,7 +1270,7 @@ public:
 			pos = appendData(pos, end, P_STATIC_STRING("\r\n"));
 		}
 
-		value = (headers != NULL) ? headers->lookup(P_STATIC_STRING("date")) : NULL;
+		value = (headers != NULL) ? headers->lookup(KH_DATE) : NULL;
 		pos = appendData(pos, end, P_STATIC_STRING("Date: "));
 		if (value == NULL) {
 			time_t the_time = time(NULL);
@@ -1069,7 +1282,7 @@ public:
 		}
 		pos = appendData(pos, end, P_STATIC_STRING("\r\n"));
 
-		value = (headers != NULL) ? headers->lookup(P_STATIC_STRING("connection")) : NULL;
+		value = (headers != NULL) ? headers->lookup(KH_CONNECTION) : NULL;
 		if (value == NULL) {
 			if (canKeepAlive(req)) {
 				pos = appendData(pos, end, P_STATIC_STRING("Connection: keep-alive\r\n"));
@@ -1087,7 +1300,7 @@ public:
 			}
 		}
 
-		value = (headers != NULL) ? headers->lookup(P_STATIC_STRING("content-length")) : NULL;
+		value = (headers != NULL) ? headers->lookup(KH_CONTENT_LENGTH) : NULL;
 		pos = appendData(pos, end, P_STATIC_STRING("Content-Length: "));
 		if (value == NULL) {
 			pos += snprintf(pos, end - pos, "%u", (unsigned int) body.size());
@@ -1121,6 +1334,24 @@ public:
 		}
 	}
 
+	/**
+	 * Passes the responses that were corked while handling pipelined
+	 * requests to the client output channel, and stops corking. Must be
+	 * called before writing to the client socket without going through
+	 * writeResponse().
+	 */
+	void uncorkOutput(Client *client) {
+		if (client->outputCorked) {
+			MemoryKit::mbuf buffer(client->corkedOutput, 0, client->corkedOutputSize);
+			SKC_TRACE(client, 2, "Writing " << client->corkedOutputSize <<
+				" bytes of corked output");
+			clearCorkedOutput(client);
+			if (!buffer.empty()) {
+				client->output.feedWithoutRefGuard(buffer);
+			}
+		}
+	}
+
 	bool endRequest(Client **client, Request **request) {
 		Client *c = *client;
 		Request *req = *request;
@@ -1135,6 +1366,7 @@ public:
 
 		SKC_TRACE(c, 2, "Ending request");
 		assert(c->currentRequest == req);
+		this->clearClientTimeout(c);
 
 		if (OXT_UNLIKELY(!req->responseBegun)) {
 			writeDefault500Response(c, req);
@@ -1143,6 +1375,13 @@ public:
 			}
 		}
 
+		if (c->outputCorked && !shouldKeepOutputCorked(c, req)) {
+			uncorkOutput(c);
+			if (req->ended()) {
+				return false;
+			}
+		}
+
 		// The memory buffers that we're writing out during the
 		// FLUSHING_OUTPUT state might live in the palloc pool,
 		// so we want to deinitialize the request while preserving
@@ -1153,6 +1392,16 @@ public:
 		deinitializeRequestAndAddToFreelist(c, req);
 		req->pool = pool;
 
+		if (c->outputCorked) {
+			// The response has been copied into the corked output, and
+			// nothing has been passed to c->output during this request.
+			// Handle the next buffered request right away.
+			SKC_TRACE(c, 2, "Response corked; handling next pipelined request");
+			c->corkedResponses++;
+			totalResponsesCorked++;
+			doneWithCurrentRequest(&c);
+			return true;
+		}
 		if (!c->output.ended()) {
 			c->output.feedWithoutRefGuard(MemoryKit::mbuf());
 		}
@@ -1183,11 +1432,27 @@ public:
 		if (doc.isMember("request_freelist_limit")) {
 			requestFreelistLimit = doc["request_freelist_limit"].asUInt();
 		}
+		if (doc.isMember("client_header_timeout")) {
+			clientHeaderTimeout = doc["client_header_timeout"].asUInt();
+		}
+		if (doc.isMember("client_body_timeout")) {
+			clientBodyTimeout = doc["client_body_timeout"].asUInt();
+		}
+		if (doc.isMember("client_keepalive_timeout")) {
+			clientKeepAliveTimeout = doc["client_keepalive_timeout"].asUInt();
+		}
+		if (doc.isMember("pipeline_depth")) {
+			pipelineDepth = doc["pipeline_depth"].asUInt();
+		}
 	}
 
 	virtual Json::Value getConfigAsJson() const {
 		Json::Value doc = ParentClass::getConfigAsJson();
 		doc["request_freelist_limit"] = requestFreelistLimit;
+		doc["client_header_timeout"] = clientHeaderTimeout;
+		doc["client_body_timeout"] = clientBodyTimeout;
+		doc["client_keepalive_timeout"] = clientKeepAliveTimeout;
+		doc["pipeline_depth"] = pipelineDepth;
 		return doc;
 	}
 
@@ -1195,6 +1460,7 @@ public:
 		Json::Value doc = ParentClass::inspectStateAsJson();
 		doc["free_request_count"] = freeRequestCount;
 		doc["total_requests_begun"] = (Json::UInt64) totalRequestsBegun;
+		doc["total_responses_corked"] = (Json::UInt64) totalResponsesCorked;
 		doc["request_begin_speed"]["1m"] = averageSpeedToJson(
 			capFloatPrecision(requestBeginSpeed1m * 60),
 			"minute", "1 minute", -1);
@@ -1211,6 +1477,10 @@ public:
 		}
 		doc["requests_begun"] = client->requestsBegun;
 		doc["lingering_request_count"] = client->lingeringRequestCount;
+		if (client->outputCorked) {
+			doc["corked_responses"] = client->corkedResponses;
+			doc["corked_output_size"] = client->corkedOutputSize;
+		}
 		return doc;
 	}
 
@@ -1262,7 +1532,7 @@ public:
 			}
 			doc["path"] = str;
 
-			const LString *host = req->headers.lookup("host");
+			const LString *host = req->headers.lookup(KH_HOST);
 			if (host != NULL) {
 				str.clear();
 				str.reserve(host->size);
@@ -0,0 +1,167 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_SERVER_KIT_KNOWN_HEADERS_H_
+#define _PASSENGER_SERVER_KIT_KNOWN_HEADERS_H_
+
+/*
+ * KnownHeaders.h is automatically generated from KnownHeaders.h.cxxcodebuilder by the build system.
+ * It maps the names of frequently used HTTP headers to small integer IDs, using a
+ * perfect hash function over their Hasher values that is found at generation time.
+ *
+ * To force regenerating this file:
+ *   rm -f src/cxx_supportlib/ServerKit/KnownHeaders.h
+ *   rake src/cxx_supportlib/ServerKit/KnownHeaders.h
+ */
+
+#include <boost/cstdint.hpp>
+#include <DataStructures/HashedStaticString.h>
+
+namespace Passenger {
+namespace ServerKit {
+
+
+enum KnownHeader {
+	KH_HOST,
+	KH_COOKIE,
+	KH_SET_COOKIE,
+	KH_CONTENT_LENGTH,
+	KH_CONTENT_TYPE,
+	KH_TRANSFER_ENCODING,
+	KH_CONNECTION,
+	KH_CACHE_CONTROL,
+	KH_PRAGMA,
+	KH_AUTHORIZATION,
+	KH_EXPECT,
+	KH_ACCEPT_ENCODING,
+	KH_DATE,
+	KH_STATUS,
+	KH_VARY,
+	KH_WWW_AUTHENTICATE,
+	KH_X_SENDFILE,
+	KH_X_ACCEL_REDIRECT,
+	KH_EXPIRES,
+	KH_LAST_MODIFIED,
+	KH_CONTENT_ENCODING,
+	KH_CONTENT_RANGE,
+	KH_ETAG,
+	KH_LOCATION,
+	KH_CONTENT_LOCATION,
+	KH_IF_MODIFIED_SINCE,
+	KH_IF_NONE_MATCH,
+	KH_IF_RANGE,
+	KH_RANGE,
+
+	KNOWN_HEADER_COUNT,
+	KH_NONE = KNOWN_HEADER_COUNT
+};
+
+struct KnownHeaderInfo {
+	const char *name;
+	unsigned int size;
+	boost::uint32_t hash;
+};
+
+static const KnownHeaderInfo KNOWN_HEADERS[KNOWN_HEADER_COUNT] = {
+	{ "host", 4, 0x44f2512e },
+	{ "cookie", 6, 0xd5f33cfb },
+	{ "set-cookie", 10, 0x904a3ac0 },
+	{ "content-length", 14, 0x7979a608 },
+	{ "content-type", 12, 0x180b8ed7 },
+	{ "transfer-encoding", 17, 0x74743b80 },
+	{ "connection", 10, 0x980dcdf4 },
+	{ "cache-control", 13, 0xcba2d637 },
+	{ "pragma", 6, 0x18f10621 },
+	{ "authorization", 13, 0x0ccab278 },
+	{ "expect", 6, 0x51d5a50f },
+	{ "accept-encoding", 15, 0x6bccc677 },
+	{ "date", 4, 0x2ad1f31b },
+	{ "status", 6, 0xca52ccb5 },
+	{ "vary", 4, 0x06d1ebd0 },
+	{ "www-authenticate", 16, 0xd6078fe6 },
+	{ "x-sendfile", 10, 0x4310c1e8 },
+	{ "x-accel-redirect", 16, 0xc7b2425f },
+	{ "expires", 7, 0xa3df71ef },
+	{ "last-modified", 13, 0x783a6698 },
+	{ "content-encoding", 16, 0xbce51ea9 },
+	{ "content-range", 13, 0x15c926df },
+	{ "etag", 4, 0xf4056f2c },
+	{ "location", 8, 0x113627b1 },
+	{ "content-location", 16, 0x5d617c17 },
+	{ "if-modified-since", 17, 0xf7f0b57f },
+	{ "if-none-match", 13, 0xcf994b03 },
+	{ "if-range", 8, 0xccf5e2ff },
+	{ "range", 5, 0x4c77a395 },
+};
+
+static const boost::uint32_t KNOWN_HEADER_MULTIPLIER = 0x9e377bbd;
+static const unsigned int KNOWN_HEADER_SLOT_BITS = 6;
+static const boost::uint8_t KNOWN_HEADER_SLOTS[64] = {
+	KH_NONE, KH_NONE, KH_RANGE, KH_ACCEPT_ENCODING,
+	KH_NONE, KH_IF_MODIFIED_SINCE, KH_NONE, KH_NONE,
+	KH_NONE, KH_NONE, KH_HOST, KH_NONE,
+	KH_NONE, KH_NONE, KH_NONE, KH_AUTHORIZATION,
+	KH_NONE, KH_NONE, KH_NONE, KH_NONE,
+	KH_SET_COOKIE, KH_EXPIRES, KH_NONE, KH_NONE,
+	KH_DATE, KH_NONE, KH_X_SENDFILE, KH_CONTENT_ENCODING,
+	KH_NONE, KH_NONE, KH_NONE, KH_LOCATION,
+	KH_NONE, KH_WWW_AUTHENTICATE, KH_CACHE_CONTROL, KH_NONE,
+	KH_NONE, KH_NONE, KH_TRANSFER_ENCODING, KH_IF_RANGE,
+	KH_CONTENT_LOCATION, KH_NONE, KH_NONE, KH_LAST_MODIFIED,
+	KH_CONTENT_TYPE, KH_CONTENT_RANGE, KH_CONNECTION, KH_CONTENT_LENGTH,
+	KH_NONE, KH_NONE, KH_EXPECT, KH_ETAG,
+	KH_NONE, KH_COOKIE, KH_STATUS, KH_NONE,
+	KH_IF_NONE_MATCH, KH_PRAGMA, KH_NONE, KH_VARY,
+	KH_NONE, KH_NONE, KH_X_ACCEL_REDIRECT, KH_NONE,
+};
+
+/**
+ * Returns the ID of the known header with the given hash, or KH_NONE. Only
+ * the hash is compared: the caller must compare the name as well, unless
+ * it already knows that the name is one of the known headers.
+ */
+inline KnownHeader
+lookupKnownHeader(boost::uint32_t hash) {
+	KnownHeader id = (KnownHeader) KNOWN_HEADER_SLOTS[
+		(boost::uint32_t) (hash * KNOWN_HEADER_MULTIPLIER) >> (32 - KNOWN_HEADER_SLOT_BITS)];
+	if (id != KH_NONE && KNOWN_HEADERS[id].hash == hash) {
+		return id;
+	} else {
+		return KH_NONE;
+	}
+}
+
+/** Returns the downcased name of a known header, without hashing anything. */
+inline HashedStaticString
+getKnownHeaderName(KnownHeader id) {
+	return HashedStaticString(KNOWN_HEADERS[id].name, KNOWN_HEADERS[id].size,
+		KNOWN_HEADERS[id].hash);
+}
+
+
+} // namespace ServerKit
+} // namespace Passenger
+
+#endif /* _PASSENGER_SERVER_KIT_KNOWN_HEADERS_H_ */
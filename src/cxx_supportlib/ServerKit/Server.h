@@ -56,6 +56,7 @@
 #include <ServerKit/Hooks.h>
 #include <ServerKit/Client.h>
 #include <ServerKit/ClientRef.h>
+#include <ServerKit/TimerWheel.h>
 #include <Algorithms/MovingAverage.h>
 #include <Utils.h>
 #include <Utils/ScopeGuard.h>
@@ -171,6 +172,13 @@ using namespace oxt;
  * The server can listen on multiple server endpoints at the same time (e.g. TCP and
  * Unix domain sockets), up to SERVER_KIT_MAX_SERVER_ENDPOINTS.
  *
+ * ### Client timeouts
+ *
+ * Derived servers can give each client a timeout with setClientTimeout(). The
+ * timeouts of all clients are tracked in a single TimerWheel, so that arming
+ * and re-arming them on every read is cheap even with many idle clients.
+ * When a timeout expires, onClientTimeout() is called.
+ *
  * ### Automatic backoff when too many file descriptors are active
  *
  * If ENFILES or EMFILES is encountered when accepting new clients, Server will stop
@@ -199,6 +207,8 @@ public:
 	};
 
 	static const unsigned int MAX_ACCEPT_BURST_COUNT = 127;
+	/** The granularity of client timeouts, in seconds. */
+	static const unsigned int CLIENT_TIMEOUT_RESOLUTION = 1;
 
 	typedef void (*Callback)(DerivedServer *server);
 
@@ -228,6 +238,9 @@ private:
 	ev::timer acceptResumptionWatcher;
 	ev::timer statisticsUpdateWatcher;
 	ev::io endpoints[SERVER_KIT_MAX_SERVER_ENDPOINTS];
+	TimerWheel clientTimeouts;
+	// Only active while `clientTimeouts` is non-empty.
+	ev::timer clientTimeoutWatcher;
 
 
 	/***** Private methods *****/
@@ -346,11 +359,27 @@ private:
 
 		this->onUpdateStatistics();
 		this->onFinalizeStatisticsUpdate();
+		ctx->trimMbufPools(ev_now(this->getLoop()));
 
 		timer.repeat = timeToNextMultipleD(5, ev_now(this->getLoop()));
 		timer.again();
 	}
 
+	void onClientTimeoutCheck(ev::timer &timer, int revents) {
+		TRACE_POINT();
+		clientTimeouts.expire(ev_now(this->getLoop()), _onClientTimedOut, this);
+		if (clientTimeouts.empty()) {
+			timer.stop();
+		}
+	}
+
+	static void _onClientTimedOut(TimerWheelEntry *entry, void *userData) {
+		BaseServer *server = static_cast<BaseServer *>(userData);
+		Client *client = static_cast<Client *>(static_cast<BaseClient *>(
+			entry->userData));
+		server->onClientTimeout(client);
+	}
+
 	unsigned int getNextClientNumber() {
 		return nextClientNumber++;
 	}
@@ -460,6 +489,7 @@ private:
 
 		acceptResumptionWatcher.stop();
 		statisticsUpdateWatcher.stop();
+		clientTimeoutWatcher.stop();
 
 		SKS_NOTICE("Shutdown finished");
 		serverState = FINISHED_SHUTDOWN;
@@ -519,6 +549,7 @@ protected:
 
 		client->hooks.impl        = this;
 		client->hooks.userData    = static_cast<BaseClient *>(client);
+		client->timeoutTimer.userData = static_cast<BaseClient *>(client);
 
 		client->input.setContext(ctx);
 		client->input.setHooks(&client->hooks);
@@ -593,6 +624,15 @@ protected:
 		return LVL_WARN;
 	}
 
+	/**
+	 * Called when the timeout set with setClientTimeout() expires.
+	 * The timeout is no longer armed at this point.
+	 */
+	virtual void onClientTimeout(Client *client) {
+		SKC_LOG_EVENT(DerivedServer, client, "onClientTimeout");
+		disconnectWithError(&client, "client timed out", LVL_INFO);
+	}
+
 	virtual void onUpdateStatistics() {
 		SKS_DEBUG("Updating statistics");
 		ev_tstamp now = ev_now(this->getLoop());
@@ -655,7 +695,8 @@ public:
 		  ctx(context),
 		  nextClientNumber(1),
 		  nEndpoints(0),
-		  accept4Available(true)
+		  accept4Available(true),
+		  clientTimeouts(CLIENT_TIMEOUT_RESOLUTION, ev_time())
 	{
 		STAILQ_INIT(&freeClients);
 		TAILQ_INIT(&activeClients);
@@ -672,6 +713,12 @@ public:
 			&BaseServer<DerivedServer, Client>::onStatisticsUpdateTimeout>(this);
 		statisticsUpdateWatcher.set(5, 5);
 		statisticsUpdateWatcher.start();
+
+		clientTimeoutWatcher.set(context->libev->getLoop());
+		clientTimeoutWatcher.set<
+			BaseServer<DerivedServer, Client>,
+			&BaseServer<DerivedServer, Client>::onClientTimeoutCheck>(this);
+		clientTimeoutWatcher.set(CLIENT_TIMEOUT_RESOLUTION, CLIENT_TIMEOUT_RESOLUTION);
 	}
 
 	virtual ~BaseServer() {
@@ -962,6 +1009,7 @@ public:
 		onClientDisconnecting(c);
 
 		c->setConnState(ClientType::DISCONNECTED);
+		clientTimeouts.disarm(&c->timeoutTimer);
 		TAILQ_REMOVE(&activeClients, c, nextClient.activeOrDisconnectedClient);
 		activeClientCount--;
 		TAILQ_INSERT_HEAD(&disconnectedClients, c, nextClient.activeOrDisconnectedClient);
@@ -983,6 +1031,27 @@ public:
 		return true;
 	}
 
+	/**
+	 * Disconnects the client if it doesn't clear or re-arm this timeout
+	 * within `timeout` seconds. Replaces any previous timeout of this client.
+	 * Costs O(1), so it's fine to call this upon every read.
+	 */
+	void setClientTimeout(Client *client, ev_tstamp timeout) {
+		assert(client->connected());
+		clientTimeouts.arm(&client->timeoutTimer, ev_now(getLoop()) + timeout);
+		if (!clientTimeoutWatcher.is_active()) {
+			clientTimeoutWatcher.start();
+		}
+	}
+
+	void clearClientTimeout(Client *client) {
+		clientTimeouts.disarm(&client->timeoutTimer);
+	}
+
+	bool hasClientTimeout(const Client *client) const {
+		return client->timeoutTimer.armed();
+	}
+
 	void disconnectWithWarning(Client **client, const StaticString &message) {
 		SKC_WARN(*client, "Disconnecting client with warning: " << message);
 		disconnect(client);
@@ -1061,6 +1130,7 @@ public:
 			"minute", "1 hour", -1);
 		doc["total_clients_accepted"] = (Json::UInt64) totalClientsAccepted;
 		doc["total_bytes_consumed"] = (Json::UInt64) totalBytesConsumed;
+		doc["client_timeout_count"] = clientTimeouts.size();
 
 		TAILQ_FOREACH (client, &activeClients, nextClient.activeOrDisconnectedClient) {
 			Json::Value subdoc;
@@ -0,0 +1,234 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_SERVER_KIT_TIMER_WHEEL_H_
+#define _PASSENGER_SERVER_KIT_TIMER_WHEEL_H_
+
+#include <boost/cstdint.hpp>
+#include <oxt/macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+
+namespace Passenger {
+namespace ServerKit {
+
+
+/**
+ * A timer that can be armed in a TimerWheel. Embed it in the object
+ * that it belongs to; the wheel does not allocate memory.
+ */
+struct TimerWheelEntry {
+	/** Both NULL when the timer is not armed. */
+	TimerWheelEntry *prev, *next;
+	/** The tick at which the timer expires. */
+	boost::uint64_t deadline;
+	void *userData;
+
+	TimerWheelEntry()
+		: prev(NULL),
+		  next(NULL),
+		  deadline(0),
+		  userData(NULL)
+		{ }
+
+	OXT_FORCE_INLINE
+	bool armed() const {
+		return next != NULL;
+	}
+};
+
+
+/**
+ * A hashed timing wheel: tracks the deadlines of a large number of timers,
+ * for example the timeouts of all clients of a server, without a libev
+ * timer per client.
+ *
+ * Time is divided in ticks of `resolution` seconds. A timer is put in the
+ * slot that corresponds to its deadline tick, modulo the number of slots.
+ * Arming, re-arming and disarming a timer are O(1). expire() only looks at
+ * the slots of the ticks that passed since the last call; timers in those
+ * slots that are due in a later round of the wheel are skipped.
+ *
+ * Timers never expire early, but may expire up to one tick late.
+ *
+ * Not thread-safe.
+ */
+class TimerWheel {
+public:
+	/** Number of slots. Must be a power of two. */
+	static const unsigned int SLOTS = 256;
+
+	typedef void (*Callback)(TimerWheelEntry *entry, void *userData);
+
+private:
+	/** Sentinels of circular doubly-linked lists. */
+	TimerWheelEntry slots[SLOTS];
+	double origin;
+	double resolution;
+	boost::uint64_t currentTick;
+	unsigned int count;
+
+	static void initList(TimerWheelEntry *head) {
+		head->prev = head->next = head;
+	}
+
+	static void insertBefore(TimerWheelEntry *pos, TimerWheelEntry *entry) {
+		entry->prev = pos->prev;
+		entry->next = pos;
+		pos->prev->next = entry;
+		pos->prev = entry;
+	}
+
+	static void unlink(TimerWheelEntry *entry) {
+		entry->prev->next = entry->next;
+		entry->next->prev = entry->prev;
+		entry->prev = entry->next = NULL;
+	}
+
+	boost::uint64_t getTick(double time) const {
+		if (time <= origin) {
+			return 0;
+		} else {
+			return (boost::uint64_t) ((time - origin) / resolution);
+		}
+	}
+
+public:
+	/**
+	 * @param resolution The duration of a tick, in seconds.
+	 * @param now The current time, in seconds.
+	 */
+	TimerWheel(double _resolution, double now)
+		: origin(now),
+		  resolution(_resolution),
+		  currentTick(0),
+		  count(0)
+	{
+		for (unsigned int i = 0; i < SLOTS; i++) {
+			initList(&slots[i]);
+		}
+	}
+
+	/**
+	 * Arms the timer so that it expires at time `deadline`, or re-arms
+	 * it if it was already armed.
+	 */
+	void arm(TimerWheelEntry *entry, double deadline) {
+		boost::uint64_t tick;
+
+		if (deadline <= origin) {
+			tick = 0;
+		} else {
+			tick = (boost::uint64_t) ceil((deadline - origin) / resolution);
+		}
+		if (tick <= currentTick) {
+			// Already due. Expire it upon the next tick.
+			tick = currentTick + 1;
+		}
+
+		if (entry->armed()) {
+			unlink(entry);
+		} else {
+			count++;
+		}
+		entry->deadline = tick;
+		insertBefore(&slots[tick & (SLOTS - 1)], entry);
+	}
+
+	void disarm(TimerWheelEntry *entry) {
+		if (entry->armed()) {
+			unlink(entry);
+			count--;
+		}
+	}
+
+	/**
+	 * Disarms all timers that are due at time `now`, and calls `callback`
+	 * for each of them. The callback may arm and disarm any timer,
+	 * including timers that are about to expire. Returns the number of
+	 * timers that expired.
+	 */
+	unsigned int expire(double now, Callback callback, void *userData) {
+		boost::uint64_t nowTick = getTick(now);
+		TimerWheelEntry expired;
+		unsigned int nslots, result = 0;
+
+		if (nowTick <= currentTick) {
+			return 0;
+		}
+
+		// Move all due timers to a separate list first, so that the
+		// callback can't modify the slots we're iterating over.
+		initList(&expired);
+		if (nowTick - currentTick < SLOTS) {
+			nslots = (unsigned int) (nowTick - currentTick);
+		} else {
+			nslots = SLOTS;
+		}
+		for (unsigned int i = 1; i <= nslots; i++) {
+			TimerWheelEntry *head = &slots[(currentTick + i) & (SLOTS - 1)];
+			TimerWheelEntry *entry = head->next;
+
+			while (entry != head) {
+				TimerWheelEntry *next = entry->next;
+				if (entry->deadline <= nowTick) {
+					unlink(entry);
+					insertBefore(&expired, entry);
+				}
+				entry = next;
+			}
+		}
+		currentTick = nowTick;
+
+		while (expired.next != &expired) {
+			TimerWheelEntry *entry = expired.next;
+			unlink(entry);
+			count--;
+			result++;
+			callback(entry, userData);
+		}
+		return result;
+	}
+
+	/** The number of armed timers. */
+	unsigned int size() const {
+		return count;
+	}
+
+	bool empty() const {
+		return count == 0;
+	}
+
+	double getResolution() const {
+		return resolution;
+	}
+};
+
+
+} // namespace ServerKit
+} // namespace Passenger
+
+#endif /* _PASSENGER_SERVER_KIT_TIMER_WHEEL_H_ */
@@ -55,4 +55,9 @@ pp_cached_file_stat_perform(PP_CachedFileStat *cstat,
 	}
 }
 
+int
+pp_cached_file_stat_enable_change_notifications(PP_CachedFileStat *cstat) {
+	return ((Passenger::CachedFileStat *) cstat)->enableChangeNotifications();
+}
+
 } // extern "C"
@@ -43,6 +43,7 @@ int  pp_cached_file_stat_perform(PP_CachedFileStat *cstat,
                                  const char *filename,
                                  struct stat *buf,
                                  unsigned int throttle_rate);
+int  pp_cached_file_stat_enable_change_notifications(PP_CachedFileStat *cstat);
 
 
 #ifdef __cplusplus
@@ -33,14 +33,19 @@
 
 #include <cerrno>
 #include <cassert>
+#include <cstring>
 #include <string>
-#include <boost/shared_ptr.hpp>
-#include <boost/make_shared.hpp>
+#include <vector>
+#include <set>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include <oxt/system_calls.hpp>
 
 #include <StaticString.h>
 #include <Utils/SystemTime.h>
-#include <Utils/StringMap.h>
+#include <Utils/DirectoryWatcher.h>
 
 namespace Passenger {
 
@@ -55,7 +60,20 @@ using namespace boost;
  *
  * The cache has a maximum size, which may be altered during runtime. If a
  * file that wasn't in the cache is being stat()ed, and the cache is full,
- * then the oldest cache entry will be removed.
+ * then the least recently used cache entry will be removed. This is exact
+ * for small caches and approximated for large ones.
+ *
+ * CachedFileStat is thread-safe. The cache is split into stripes, each with
+ * its own lock and hash table, so that threads only contend when they look
+ * up files in the same stripe. Looking up a cached file involves no memory
+ * allocations and no global state, except for an occasional update of
+ * the LRU clock.
+ *
+ * On Linux, `enableChangeNotifications()` makes it watch absolute paths with
+ * inotify instead. Cached stat data is then used until a change is noticed,
+ * regardless of the throttle rate, so lookups don't involve system calls
+ * and changes are seen immediately. Paths that cannot be watched, e.g.
+ * because the watch limit has been reached, are throttled as usual.
  */
 class CachedFileStat {
 public:
@@ -87,6 +105,13 @@ public:
 			return (unsigned int) (currentTime - begin) >= interval;
 		}
 
+		int restat(time_t currentTime) {
+			last_result = syscalls::stat(filename.c_str(), &info);
+			last_errno = errno;
+			last_time = currentTime;
+			return last_result;
+		}
+
 	public:
 		/** The cached stat info. */
 		struct stat info;
@@ -94,25 +119,49 @@ public:
 		/** This entry's filename. */
 		string filename;
 
+		/**
+		 * Whether changes to this file are noticed through a DirectoryWatcher.
+		 * If so, the file is only re-stat()ted after it has been marked stale.
+		 */
+		bool watched;
+
+		/** Whether a change was noticed since the last stat() call. */
+		bool stale;
+
+		/** The hash of `filename`. */
+		boost::uint32_t hash;
+
+		/** The next entry in the same hash bucket. */
+		Entry *next;
+
+		/** The value of the LRU clock when this entry was last used. */
+		boost::uint64_t lastUsed;
+
 		/**
 		 * Creates a new Entry object. The file will not be
 		 * stat()ted until you call refresh().
 		 *
 		 * @param filename The file to stat.
 		 */
-		Entry(const string &_filename)
-			: filename(_filename)
+		Entry(const string &_filename, boost::uint32_t _hash = 0)
+			: filename(_filename),
+			  hash(_hash),
+			  next(NULL),
+			  lastUsed(0)
 		{
 			memset(&info, 0, sizeof(struct stat));
 			last_result = -1;
 			last_errno = 0;
 			last_time = 0;
+			watched = false;
+			stale = true;
 		}
 
 		/**
 		 * Re-stat() the file, if necessary. If <tt>throttleRate</tt> seconds have
 		 * passed since the last time stat() was called, then the file will be
-		 * re-stat()ted.
+		 * re-stat()ted. If the entry is watched, the file is re-stat()ted only
+		 * if it's stale.
 		 *
 		 * The stat information, which may either be the result of a new stat() call
 		 * or just the old cached information, is be available in the <tt>info</tt>
@@ -128,11 +177,19 @@ public:
 		int refresh(unsigned int throttleRate) {
 			time_t currentTime;
 
+			if (watched) {
+				if (stale) {
+					stale = false;
+					return restat(SystemTime::get());
+				} else {
+					errno = last_errno;
+					return last_result;
+				}
+			}
+
+			stale = false;
 			if (expired(last_time, throttleRate, currentTime)) {
-				last_result = syscalls::stat(filename.c_str(), &info);
-				last_errno = errno;
-				last_time = currentTime;
-				return last_result;
+				return restat(currentTime);
 			} else {
 				errno = last_errno;
 				return last_result;
@@ -140,21 +197,417 @@ public:
 		}
 	};
 
-	typedef boost::shared_ptr<Entry> EntryPtr;
-	typedef list<EntryPtr> EntryList;
-	typedef StringMap<EntryList::iterator> EntryMap;
+private:
+	static const unsigned int STRIPES = 64;
+	/** Caches smaller than this are evicted from in exact LRU order. */
+	static const unsigned int EXACT_LRU_THRESHOLD = 256;
+	/** The number of stripes examined to find an eviction victim in larger caches. */
+	static const unsigned int EVICTION_SAMPLE_SIZE = 4;
+
+	struct Stripe {
+		mutable boost::mutex syncher;
+		vector<Entry *> buckets;
+		unsigned int count;
+		// Keep other stripes' locks off this one's cache line.
+		char padding[64];
+
+		Stripe()
+			: count(0)
+			{ }
+	};
+
+	Stripe stripes[STRIPES];
+	boost::atomic<unsigned int> maxSize;
+	boost::atomic<unsigned int> size;
+	boost::atomic<boost::uint64_t> lruClock;
+	boost::atomic<unsigned int> evictionCursor;
+
+	boost::mutex watcherSyncher;
+	boost::scoped_ptr<DirectoryWatcher> watcher;
+	boost::atomic<bool> watching;
+
+	/** FNV-1a. */
+	static boost::uint32_t hash(const StaticString &filename) {
+		const unsigned char *pos = (const unsigned char *) filename.data();
+		const unsigned char *end = pos + filename.size();
+		boost::uint32_t result = 2166136261u;
+
+		while (pos < end) {
+			result ^= *pos;
+			result *= 16777619u;
+			pos++;
+		}
+		return result;
+	}
+
+	Stripe &getStripe(boost::uint32_t hash) {
+		return stripes[hash % STRIPES];
+	}
+
+	const Stripe &getStripe(boost::uint32_t hash) const {
+		return stripes[hash % STRIPES];
+	}
+
+	static Entry **getBucket(const Stripe &stripe, boost::uint32_t hash) {
+		return const_cast<Entry **>(&stripe.buckets[(hash / STRIPES) & (stripe.buckets.size() - 1)]);
+	}
+
+	static Entry *lookup(const Stripe &stripe, const StaticString &filename, boost::uint32_t hash) {
+		if (stripe.buckets.empty()) {
+			return NULL;
+		}
+
+		Entry *entry = *getBucket(stripe, hash);
+		while (entry != NULL) {
+			if (entry->hash == hash
+			 && entry->filename.size() == filename.size()
+			 && memcmp(entry->filename.data(), filename.data(), filename.size()) == 0)
+			{
+				return entry;
+			}
+			entry = entry->next;
+		}
+		return NULL;
+	}
+
+	Entry *insert(Stripe &stripe, const StaticString &filename, boost::uint32_t hash) {
+		if (stripe.count >= stripe.buckets.size()) {
+			rehash(stripe, std::max<unsigned int>(8, stripe.buckets.size() * 2));
+		}
+
+		Entry *entry = new Entry(filename, hash);
+		Entry **bucket = getBucket(stripe, hash);
+		entry->next = *bucket;
+		entry->lastUsed = lruClock.fetch_add(1, boost::memory_order_relaxed) + 1;
+		*bucket = entry;
+		stripe.count++;
+		size.fetch_add(1, boost::memory_order_relaxed);
+		return entry;
+	}
+
+	static void rehash(Stripe &stripe, unsigned int newSize) {
+		vector<Entry *> oldBuckets(newSize, (Entry *) NULL);
+		vector<Entry *>::iterator it, end;
+
+		oldBuckets.swap(stripe.buckets);
+		for (it = oldBuckets.begin(), end = oldBuckets.end(); it != end; it++) {
+			Entry *entry = *it;
+			while (entry != NULL) {
+				Entry *next = entry->next;
+				Entry **bucket = getBucket(stripe, entry->hash);
+				entry->next = *bucket;
+				*bucket = entry;
+				entry = next;
+			}
+		}
+	}
+
+	/**
+	 * Removes the given entry from the stripe, if it's still there.
+	 * `entry` is only dereferenced if it is.
+	 */
+	bool remove(Stripe &stripe, Entry *entry, boost::uint32_t hash) {
+		Entry **pos = getBucket(stripe, hash);
+		while (*pos != NULL) {
+			if (*pos == entry) {
+				*pos = entry->next;
+				delete entry;
+				stripe.count--;
+				size.fetch_sub(1, boost::memory_order_relaxed);
+				return true;
+			}
+			pos = &(*pos)->next;
+		}
+		return false;
+	}
+
+	/**
+	 * Marks the entry as most recently used. In large caches, entries that
+	 * were used recently enough aren't marked again, so that threads that
+	 * keep looking up the same files don't contend on the LRU clock.
+	 */
+	void markUsed(Entry *entry) {
+		boost::uint64_t now = lruClock.load(boost::memory_order_relaxed);
+		if (now - entry->lastUsed > size.load(boost::memory_order_relaxed) / 16) {
+			entry->lastUsed = lruClock.fetch_add(1, boost::memory_order_relaxed) + 1;
+		}
+	}
+
+	/**
+	 * Removes the least recently used entry among the examined stripes.
+	 * Small caches are examined entirely. Returns whether an entry was removed.
+	 */
+	bool evictOne() {
+		unsigned int count = (maxSize.load(boost::memory_order_relaxed) < EXACT_LRU_THRESHOLD)
+			? STRIPES
+			: EVICTION_SAMPLE_SIZE;
+		unsigned int start = evictionCursor.fetch_add(count, boost::memory_order_relaxed);
+		Entry *victim = NULL;
+		unsigned int victimStripe = 0;
+		boost::uint32_t victimHash = 0;
+		boost::uint64_t victimLastUsed = 0;
+
+		// Keep looking beyond the sample if it only contains empty stripes.
+		for (unsigned int i = 0; i < STRIPES && (i < count || victim == NULL); i++) {
+			unsigned int index = (start + i) % STRIPES;
+			Stripe &stripe = stripes[index];
+			boost::lock_guard<boost::mutex> l(stripe.syncher);
+			vector<Entry *>::const_iterator it, end = stripe.buckets.end();
+
+			for (it = stripe.buckets.begin(); it != end; it++) {
+				for (Entry *entry = *it; entry != NULL; entry = entry->next) {
+					if (victim == NULL || entry->lastUsed < victimLastUsed) {
+						victim = entry;
+						victimStripe = index;
+						victimHash = entry->hash;
+						victimLastUsed = entry->lastUsed;
+					}
+				}
+			}
+		}
+
+		if (victim == NULL) {
+			return false;
+		}
 
-	unsigned int maxSize;
-	EntryList entries;
-	EntryMap cache;
+		// The victim may have been used or even removed by another thread
+		// in the mean time. Using it doesn't matter much for an approximate
+		// LRU. If it was removed, then the caller checks the size again.
+		Stripe &stripe = stripes[victimStripe];
+		boost::lock_guard<boost::mutex> l(stripe.syncher);
+		if (!stripe.buckets.empty()) {
+			remove(stripe, victim, victimHash);
+		}
+		return true;
+	}
+
+	void evictIfNecessary() {
+		unsigned int max = maxSize.load(boost::memory_order_relaxed);
+		while (max != 0 && size.load(boost::memory_order_relaxed) > max) {
+			if (!evictOne()) {
+				break;
+			}
+		}
+	}
+
+	template<typename Func>
+	void forEachEntry(const Func &func) {
+		for (unsigned int i = 0; i < STRIPES; i++) {
+			Stripe &stripe = stripes[i];
+			boost::lock_guard<boost::mutex> l(stripe.syncher);
+			vector<Entry *>::const_iterator it, end = stripe.buckets.end();
+
+			for (it = stripe.buckets.begin(); it != end; it++) {
+				for (Entry *entry = *it; entry != NULL; entry = entry->next) {
+					func(entry);
+				}
+			}
+		}
+	}
+
+	static bool isWatchablePath(const string &filename) {
+		return !filename.empty()
+			&& filename[0] == '/'
+			&& filename[filename.size() - 1] != '/'
+			&& filename.find("//") == string::npos
+			&& filename.find("/./") == string::npos
+			&& filename.find("/../") == string::npos
+			&& (filename.size() < 2 || filename.compare(filename.size() - 2, 2, "/.") != 0)
+			&& (filename.size() < 3 || filename.compare(filename.size() - 3, 3, "/..") != 0);
+	}
 
+	/**
+	 * Watches all ancestor directories of the entry's file, from the root
+	 * down, so that the replacement of any of them is noticed too. This
+	 * matters for deployments that switch a symlink to a new release.
+	 * Watching stops at the first directory that doesn't exist: its parent
+	 * reports when it's created.
+	 */
+	void watch(Entry &entry) {
+		const string &filename = entry.filename;
+		string::size_type pos = 0;
+
+		entry.watched = false;
+		if (!isWatchablePath(filename)) {
+			return;
+		}
+		while ((pos = filename.find('/', pos)) != string::npos) {
+			switch (watcher->watch(pos == 0 ? string("/") : filename.substr(0, pos))) {
+			case DirectoryWatcher::WATCHED:
+				break;
+			case DirectoryWatcher::NONEXISTENT:
+				entry.watched = true;
+				return;
+			default:
+				return;
+			}
+			pos++;
+		}
+		entry.watched = true;
+	}
+
+	/**
+	 * A directory's own timestamps change when its children do, which its
+	 * parent doesn't report. So directories are watched themselves, too.
+	 * Returns whether the directory is watched.
+	 */
+	bool watchDirectory(Entry &entry) {
+		switch (watcher->watch(entry.filename)) {
+		case DirectoryWatcher::WATCHED:
+			return true;
+		case DirectoryWatcher::NONEXISTENT:
+			// It was removed in the mean time. Its parent reports that.
+			return true;
+		default:
+			entry.watched = false;
+			return false;
+		}
+	}
+
+	static bool changed(const string &filename, const set<string> &changedPaths,
+		const set<string> &changedParents)
+	{
+		string::size_type pos = 0;
+
+		// A change to a child changes a directory's timestamps.
+		if (changedPaths.find(filename) != changedPaths.end()
+		 || changedParents.find(filename) != changedParents.end())
+		{
+			return true;
+		}
+
+		// A change to an ancestor directory affects everything below it.
+		while ((pos = filename.find('/', pos + 1)) != string::npos) {
+			if (changedPaths.find(filename.substr(0, pos)) != changedPaths.end()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	struct MarkStale {
+		bool unwatch;
+
+		MarkStale(bool _unwatch)
+			: unwatch(_unwatch)
+			{ }
+
+		void operator()(Entry *entry) const {
+			entry->stale = true;
+			if (unwatch) {
+				entry->watched = false;
+			}
+		}
+	};
+
+	struct MarkChanged {
+		const set<string> &changedPaths;
+		const set<string> &changedParents;
+
+		MarkChanged(const set<string> &_changedPaths, const set<string> &_changedParents)
+			: changedPaths(_changedPaths),
+			  changedParents(_changedParents)
+			{ }
+
+		void operator()(Entry *entry) const {
+			if (entry->watched && !entry->stale
+			 && changed(entry->filename, changedPaths, changedParents))
+			{
+				entry->stale = true;
+			}
+		}
+	};
+
+	/**
+	 * Marks the entries whose files have changed as stale. The watcher lock
+	 * is never held while locking a stripe, because stat() locks them in
+	 * the opposite order.
+	 */
+	void processChanges() {
+		set<string> changedPaths;
+		bool overflowed = false;
+		bool alive;
+
+		{
+			boost::lock_guard<boost::mutex> l(watcherSyncher);
+			if (!watcher->takeChanges(changedPaths, overflowed)) {
+				return;
+			}
+			alive = watcher->isAlive();
+		}
+
+		if (overflowed || !alive) {
+			if (!alive) {
+				watching.store(false, boost::memory_order_release);
+			}
+			forEachEntry(MarkStale(true));
+			return;
+		}
+
+		set<string> changedParents;
+		set<string>::const_iterator it, end = changedPaths.end();
+		for (it = changedPaths.begin(); it != end; it++) {
+			string::size_type pos = it->rfind('/');
+			if (pos != string::npos && pos > 0) {
+				changedParents.insert(it->substr(0, pos));
+			}
+		}
+		forEachEntry(MarkChanged(changedPaths, changedParents));
+	}
+
+	/**
+	 * Refreshes a stale entry while change notifications are enabled.
+	 * Its paths are watched before stat()ing, so that no change can slip
+	 * through in between.
+	 */
+	int refreshAndWatch(Entry *entry, unsigned int throttleRate) {
+		{
+			boost::lock_guard<boost::mutex> l(watcherSyncher);
+			watch(*entry);
+		}
+
+		int ret = entry->refresh(throttleRate);
+		if (entry->watched && ret == 0 && S_ISDIR(entry->info.st_mode)) {
+			bool watchedAnew;
+			{
+				boost::lock_guard<boost::mutex> l(watcherSyncher);
+				watchedAnew = !watcher->isWatching(entry->filename)
+					&& watchDirectory(*entry);
+			}
+			if (watchedAnew) {
+				entry->stale = true;
+				ret = entry->refresh(throttleRate);
+			}
+		}
+		return ret;
+	}
+
+public:
 	/**
 	 * Creates a new CachedFileStat object.
 	 *
 	 * @param maxSize The maximum cache size. A size of 0 means unlimited.
 	 */
-	CachedFileStat(unsigned int maxSize = 0) {
-		this->maxSize = maxSize;
+	CachedFileStat(unsigned int _maxSize = 0)
+		: maxSize(_maxSize),
+		  size(0),
+		  lruClock(0),
+		  evictionCursor(0),
+		  watching(false)
+		{ }
+
+	~CachedFileStat() {
+		for (unsigned int i = 0; i < STRIPES; i++) {
+			vector<Entry *>::iterator it, end = stripes[i].buckets.end();
+			for (it = stripes[i].buckets.begin(); it != end; it++) {
+				Entry *entry = *it;
+				while (entry != NULL) {
+					Entry *next = entry->next;
+					delete entry;
+					entry = next;
+				}
+			}
+		}
 	}
 
 	/**
@@ -176,63 +629,92 @@ public:
 	 * @throws boost::thread_interrupted
 	 */
 	int stat(const StaticString &filename, struct stat *buf, unsigned int throttleRate = 0) {
-		EntryList::iterator it(cache.get(filename, entries.end()));
-		EntryPtr entry;
-		int ret;
-
-		if (it == entries.end()) {
-			// Filename not in cache.
-			// If cache is full, remove the least recently used
-			// cache entry.
-			if (maxSize != 0 && cache.size() == maxSize) {
-				EntryList::iterator listEnd(entries.end());
-				listEnd--;
-				string filename2((*listEnd)->filename);
-				entries.pop_back();
-				cache.remove(filename2);
-			}
-
-			// Add to cache as most recently used.
-			entry = boost::make_shared<Entry>(filename);
-			entries.push_front(entry);
-			cache.set(filename, entries.begin());
-		} else {
-			// Cache hit.
-			entry = *it;
-
-			// Mark this cache item as most recently used.
-			entries.splice(entries.begin(), entries, it);
-			cache.set(filename, entries.begin());
-		}
-		ret = entry->refresh(throttleRate);
-		*buf = entry->info;
+		bool notifying = watching.load(boost::memory_order_acquire);
+		if (notifying && OXT_UNLIKELY(watcher->hasChanges())) {
+			processChanges();
+		}
+
+		boost::uint32_t h = hash(filename);
+		Stripe &stripe = getStripe(h);
+		bool inserted = false;
+		int ret, e;
+
+		{
+			boost::lock_guard<boost::mutex> l(stripe.syncher);
+			Entry *entry = lookup(stripe, filename, h);
+
+			if (entry == NULL) {
+				entry = insert(stripe, filename, h);
+				inserted = true;
+			} else {
+				markUsed(entry);
+			}
+
+			if (!notifying || !entry->stale) {
+				ret = entry->refresh(throttleRate);
+			} else {
+				ret = refreshAndWatch(entry, throttleRate);
+			}
+			e = errno;
+			*buf = entry->info;
+		}
+
+		if (inserted) {
+			evictIfNecessary();
+		}
+		errno = e;
 		return ret;
 	}
 
 	/**
-	 * Change the maximum size of the cache. If the new size is larger
-	 * than the old size, then the oldest entries in the cache are
-	 * removed.
+	 * Starts noticing changes through inotify, if available. Returns whether
+	 * that succeeded. Call this after forking.
 	 *
-	 * A size of 0 means unlimited.
+	 * Changes made by other hosts on network filesystems are not noticed.
 	 */
-	void setMaxSize(unsigned int maxSize) {
-		if (maxSize != 0) {
-			int toRemove = cache.size() - maxSize;
-			for (int i = 0; i < toRemove; i++) {
-				string filename(entries.back()->filename);
-				entries.pop_back();
-				cache.remove(filename);
+	bool enableChangeNotifications() {
+		{
+			boost::lock_guard<boost::mutex> l(watcherSyncher);
+			if (watcher != NULL) {
+				return watching.load(boost::memory_order_acquire);
+			}
+
+			watcher.reset(new DirectoryWatcher());
+			if (!watcher->start()) {
+				watcher.reset();
+				return false;
 			}
 		}
-		this->maxSize = maxSize;
+
+		watching.store(true, boost::memory_order_release);
+		forEachEntry(MarkStale(false));
+		return true;
+	}
+
+	bool changeNotificationsEnabled() const {
+		return watching.load(boost::memory_order_acquire);
+	}
+
+	/**
+	 * Change the maximum size of the cache. If the new size is smaller
+	 * than the old size, then the least recently used entries in the
+	 * cache are removed.
+	 *
+	 * A size of 0 means unlimited.
+	 */
+	void setMaxSize(unsigned int maxSize) {
+		this->maxSize.store(maxSize, boost::memory_order_relaxed);
+		evictIfNecessary();
 	}
 
 	/**
 	 * Returns whether `filename` is in the cache.
 	 */
 	bool knows(const StaticString &filename) const {
-		return cache.has(filename);
+		boost::uint32_t h = hash(filename);
+		const Stripe &stripe = getStripe(h);
+		boost::lock_guard<boost::mutex> l(stripe.syncher);
+		return lookup(stripe, filename, h) != NULL;
 	}
 };
 
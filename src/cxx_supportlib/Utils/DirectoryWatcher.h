@@ -0,0 +1,413 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_DIRECTORY_WATCHER_H_
+#define _PASSENGER_DIRECTORY_WATCHER_H_
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <oxt/macros.hpp>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#ifdef __linux__
+	#include <sys/inotify.h>
+#endif
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * Watches directories for changes using inotify. This allows CachedFileStat
+ * to find out that a path may have changed without having to stat() it.
+ *
+ * Events are read by a background thread and queued. The owner collects them
+ * with `takeChanges()`, which only checks an atomic flag if nothing happened.
+ * Only the owner thread may call the other methods. This is why the
+ * watch descriptor bookkeeping isn't protected by a lock.
+ *
+ * A watch on a directory reports changes to the directory itself and to
+ * its direct children, so a change to a path is noticed by watching all of
+ * its ancestor directories. Watches are never removed, except by the
+ * kernel when the directory is deleted.
+ *
+ * Only available on Linux. On other platforms `start()` always fails.
+ */
+class DirectoryWatcher {
+public:
+	enum WatchResult {
+		/** The directory is now being watched. */
+		WATCHED,
+		/** The directory does not exist (yet). */
+		NONEXISTENT,
+		/** The directory cannot be watched, e.g. because the watch limit was reached. */
+		FAILED
+	};
+
+private:
+	struct Event {
+		int wd;
+		boost::uint32_t mask;
+		string name;
+	};
+
+	typedef map<string, int> PathMap;
+	typedef multimap<int, string> WatchDescriptorMap;
+
+	int fd;
+	int quitPipe[2];
+	unsigned int maxWatches;
+	boost::thread *thr;
+	PathMap pathToWd;
+	WatchDescriptorMap wdToPaths;
+
+	boost::mutex syncher;
+	vector<Event> queue;
+	bool queueOverflowed;
+	boost::atomic<bool> hasEvents;
+	boost::atomic<bool> alive;
+
+	void readEvents() {
+		#ifdef __linux__
+			char buf[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+			struct pollfd fds[2];
+
+			fds[0].fd = fd;
+			fds[0].events = POLLIN;
+			fds[1].fd = quitPipe[0];
+			fds[1].events = POLLIN;
+
+			while (true) {
+				int ret = poll(fds, 2, -1);
+				if (ret == -1) {
+					if (errno == EINTR) {
+						continue;
+					}
+					break;
+				} else if (fds[1].revents != 0) {
+					return;
+				}
+
+				ssize_t n = read(fd, buf, sizeof(buf));
+				if (n == -1 && (errno == EINTR || errno == EAGAIN)) {
+					continue;
+				} else if (n <= 0) {
+					break;
+				}
+
+				boost::lock_guard<boost::mutex> l(syncher);
+				const char *pos = buf;
+				while (pos < buf + n) {
+					const struct inotify_event *ev = (const struct inotify_event *) pos;
+					if (ev->mask & IN_Q_OVERFLOW) {
+						queueOverflowed = true;
+					} else {
+						queue.push_back(Event());
+						Event &event = queue.back();
+						event.wd = ev->wd;
+						event.mask = ev->mask;
+						if (ev->len > 0) {
+							event.name.assign(ev->name);
+						}
+					}
+					pos += sizeof(struct inotify_event) + ev->len;
+				}
+				hasEvents.store(true, boost::memory_order_release);
+			}
+		#endif
+
+		// Something went wrong, so we can't tell what changed anymore.
+		boost::lock_guard<boost::mutex> l(syncher);
+		queueOverflowed = true;
+		alive.store(false, boost::memory_order_release);
+		hasEvents.store(true, boost::memory_order_release);
+	}
+
+	void forgetWatch(int wd) {
+		pair<WatchDescriptorMap::iterator, WatchDescriptorMap::iterator> range =
+			wdToPaths.equal_range(wd);
+		WatchDescriptorMap::iterator it;
+
+		for (it = range.first; it != range.second; it++) {
+			pathToWd.erase(it->second);
+		}
+		wdToPaths.erase(range.first, range.second);
+	}
+
+	/**
+	 * Stops watching `path` and everything below it. Used when a directory
+	 * entry has been replaced: the existing watches refer to the old inode
+	 * (e.g. the old target of a symlink), so the paths must be watched anew.
+	 */
+	void unwatchTree(const string &path) {
+		PathMap::iterator it = pathToWd.lower_bound(path);
+
+		while (it != pathToWd.end()
+		 && it->first.compare(0, path.size(), path) == 0)
+		{
+			if (it->first.size() != path.size() && it->first[path.size()] != '/') {
+				it++;
+				continue;
+			}
+
+			int wd = it->second;
+			pair<WatchDescriptorMap::iterator, WatchDescriptorMap::iterator> range =
+				wdToPaths.equal_range(wd);
+			WatchDescriptorMap::iterator wit = range.first;
+			unsigned int sharers = 0;
+			while (wit != range.second) {
+				if (wit->second == it->first) {
+					wdToPaths.erase(wit++);
+				} else {
+					sharers++;
+					wit++;
+				}
+			}
+			#ifdef __linux__
+				if (sharers == 0) {
+					inotify_rm_watch(fd, wd);
+				}
+			#endif
+			pathToWd.erase(it++);
+		}
+	}
+
+	static string joinPath(const string &dir, const string &name) {
+		if (dir == "/") {
+			return dir + name;
+		} else {
+			return dir + "/" + name;
+		}
+	}
+
+public:
+	/**
+	 * @param maxWatches The maximum number of directories to watch. The
+	 *     kernel's own limit (fs.inotify.max_user_watches) applies as well.
+	 */
+	DirectoryWatcher(unsigned int _maxWatches = 8192)
+		: fd(-1),
+		  maxWatches(_maxWatches),
+		  thr(NULL),
+		  queueOverflowed(false),
+		  hasEvents(false),
+		  alive(false)
+	{
+		quitPipe[0] = -1;
+		quitPipe[1] = -1;
+	}
+
+	~DirectoryWatcher() {
+		if (thr != NULL) {
+			ssize_t ret;
+			do {
+				ret = write(quitPipe[1], "x", 1);
+			} while (ret == -1 && errno == EINTR);
+			thr->join();
+			delete thr;
+		}
+		if (fd != -1) {
+			close(fd);
+		}
+		if (quitPipe[0] != -1) {
+			close(quitPipe[0]);
+			close(quitPipe[1]);
+		}
+	}
+
+	/**
+	 * Creates the inotify instance and starts the background thread. Returns
+	 * whether that succeeded. Call this after forking: neither the inotify
+	 * instance nor the thread can be shared with a child process.
+	 */
+	bool start() {
+		#ifdef __linux__
+			if (thr != NULL) {
+				return true;
+			}
+
+			fd = inotify_init();
+			if (fd == -1) {
+				return false;
+			}
+			fcntl(fd, F_SETFD, FD_CLOEXEC);
+			if (pipe(quitPipe) == -1) {
+				quitPipe[0] = quitPipe[1] = -1;
+				close(fd);
+				fd = -1;
+				return false;
+			}
+			fcntl(quitPipe[0], F_SETFD, FD_CLOEXEC);
+			fcntl(quitPipe[1], F_SETFD, FD_CLOEXEC);
+
+			// The web server's signals must not be delivered to our thread.
+			sigset_t set, oldSet;
+			sigfillset(&set);
+			pthread_sigmask(SIG_SETMASK, &set, &oldSet);
+			alive.store(true, boost::memory_order_release);
+			try {
+				thr = new boost::thread(boost::bind(&DirectoryWatcher::readEvents, this));
+			} catch (const boost::thread_resource_error &) {
+				alive.store(false, boost::memory_order_release);
+			}
+			pthread_sigmask(SIG_SETMASK, &oldSet, NULL);
+			return thr != NULL;
+		#else
+			return false;
+		#endif
+	}
+
+	/**
+	 * Returns whether events arrived since the last call to `takeChanges()`.
+	 * Unlike the other methods, this may be called from any thread.
+	 */
+	bool hasChanges() const {
+		return hasEvents.load(boost::memory_order_acquire);
+	}
+
+	/**
+	 * Returns whether the background thread is running, i.e. whether
+	 * changes are still being noticed.
+	 */
+	bool isAlive() const {
+		return alive.load(boost::memory_order_acquire);
+	}
+
+	/**
+	 * Starts watching the given absolute directory path, unless it's
+	 * already being watched.
+	 */
+	WatchResult watch(const string &dir) {
+		#ifdef __linux__
+			if (pathToWd.find(dir) != pathToWd.end()) {
+				return WATCHED;
+			} else if (pathToWd.size() >= maxWatches) {
+				return FAILED;
+			}
+
+			int wd = inotify_add_watch(fd, dir.c_str(), IN_ONLYDIR
+				| IN_ATTRIB | IN_MODIFY | IN_CREATE | IN_DELETE
+				| IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+			if (wd == -1) {
+				if (errno == ENOENT || errno == ENOTDIR) {
+					return NONEXISTENT;
+				} else {
+					return FAILED;
+				}
+			}
+
+			// Different paths may refer to the same directory through
+			// symlinks, in which case they share a watch descriptor.
+			pathToWd.insert(make_pair(dir, wd));
+			wdToPaths.insert(make_pair(wd, dir));
+			return WATCHED;
+		#else
+			return FAILED;
+		#endif
+	}
+
+	bool isWatching(const string &dir) const {
+		return pathToWd.find(dir) != pathToWd.end();
+	}
+
+	unsigned int getWatchCount() const {
+		return pathToWd.size();
+	}
+
+	/**
+	 * Collects the events that arrived since the last call. Returns false,
+	 * without taking a lock, if there were none. Otherwise, the paths that
+	 * changed are inserted into `changedPaths`: for events about a child of
+	 * a watched directory, the child's path, and for events about a watched
+	 * directory itself, the directory's path. A change to a path may affect
+	 * everything below it. If events were lost, `overflowed` is set to true,
+	 * and any path may have changed.
+	 */
+	bool takeChanges(set<string> &changedPaths, bool &overflowed) {
+		if (OXT_LIKELY(!hasEvents.load(boost::memory_order_acquire))) {
+			return false;
+		}
+
+		vector<Event> events;
+		{
+			boost::lock_guard<boost::mutex> l(syncher);
+			events.swap(queue);
+			overflowed = queueOverflowed;
+			queueOverflowed = false;
+			hasEvents.store(false, boost::memory_order_relaxed);
+		}
+
+		#ifdef __linux__
+			vector<Event>::const_iterator it, end = events.end();
+			for (it = events.begin(); it != end; it++) {
+				pair<WatchDescriptorMap::iterator, WatchDescriptorMap::iterator> range =
+					wdToPaths.equal_range(it->wd);
+				WatchDescriptorMap::iterator wit;
+				vector<string> paths;
+
+				for (wit = range.first; wit != range.second; wit++) {
+					if (it->name.empty()) {
+						paths.push_back(wit->second);
+					} else {
+						paths.push_back(joinPath(wit->second, it->name));
+					}
+				}
+				changedPaths.insert(paths.begin(), paths.end());
+
+				if (it->mask & IN_IGNORED) {
+					// The kernel removed the watch because the directory
+					// is gone. It can be watched again once it reappears.
+					forgetWatch(it->wd);
+				} else if (it->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM
+					| IN_MOVED_TO | IN_MOVE_SELF))
+				{
+					vector<string>::const_iterator pit;
+					for (pit = paths.begin(); pit != paths.end(); pit++) {
+						unwatchTree(*pit);
+					}
+				}
+			}
+		#endif
+
+		return true;
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_DIRECTORY_WATCHER_H_ */
@@ -51,6 +51,8 @@ using namespace oxt;
  * FileChangeChecker uses stat() to retrieve file information. It also
  * supports throttling in order to limit the number of actual stat() calls.
  * This can improve performance on systems where disk I/O is a problem.
+ * Alternatively, on Linux, changes can be noticed through inotify; see
+ * enableChangeNotifications().
  */
 class FileChangeChecker {
 private:
@@ -191,6 +193,16 @@ public:
 		cstat.setMaxSize(maxSize);
 	}
 
+	/**
+	 * Notices changes through inotify instead of polling, if available,
+	 * so that changed() neither calls stat() nor is affected by throttling
+	 * unless a file has actually changed. Returns whether that succeeded.
+	 * See CachedFileStat::enableChangeNotifications().
+	 */
+	bool enableChangeNotifications() {
+		return cstat.enableChangeNotifications();
+	}
+
 	/**
 	 * Returns whether <tt>filename</tt> is in the internal file list.
 	 */
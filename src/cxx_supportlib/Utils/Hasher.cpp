@@ -26,6 +26,8 @@
 
 // Implementation is in its own file so that we can enable compiler optimizations for these functions only.
 
+#include <boost/detail/endian.hpp>
+#include <cstring>
 #include <Utils/Hasher.h>
 
 namespace Passenger {
@@ -50,4 +52,95 @@ JenkinsHash::finalize() {
 	return hash;
 }
 
+
+static const boost::uint32_t MURMUR_C1 = 0xcc9e2d51;
+static const boost::uint32_t MURMUR_C2 = 0x1b873593;
+
+static inline boost::uint32_t
+rotateLeft(boost::uint32_t x, int r) {
+	return (x << r) | (x >> (32 - r));
+}
+
+static inline boost::uint32_t
+scrambleWord(boost::uint32_t k) {
+	k *= MURMUR_C1;
+	k = rotateLeft(k, 15);
+	k *= MURMUR_C2;
+	return k;
+}
+
+static inline boost::uint32_t
+mixWord(boost::uint32_t h, boost::uint32_t k) {
+	h ^= scrambleWord(k);
+	h = rotateLeft(h, 13);
+	return h * 5 + 0xe6546b64;
+}
+
+/** Reads a little-endian word, which may be unaligned. */
+static inline boost::uint32_t
+readWord(const unsigned char *data) {
+	#ifdef BOOST_LITTLE_ENDIAN
+		boost::uint32_t result;
+		memcpy(&result, data, sizeof(result));
+		return result;
+	#else
+		return (boost::uint32_t) data[0]
+			| ((boost::uint32_t) data[1] << 8)
+			| ((boost::uint32_t) data[2] << 16)
+			| ((boost::uint32_t) data[3] << 24);
+	#endif
+}
+
+void
+MurmurHash3::update(const char *data, unsigned int size) {
+	const unsigned char *pos = (const unsigned char *) data;
+	const unsigned char *end = pos + size;
+	unsigned int tailSize = length & 3;
+	boost::uint32_t h = hash;
+
+	length += size;
+
+	if (tailSize != 0) {
+		// Complete the word that a previous call started.
+		while (tailSize < 4 && pos < end) {
+			tail |= (boost::uint32_t) *pos << (tailSize * 8);
+			tailSize++;
+			pos++;
+		}
+		if (tailSize < 4) {
+			return;
+		}
+		h = mixWord(h, tail);
+		tail = 0;
+	}
+
+	while (end - pos >= 4) {
+		h = mixWord(h, readWord(pos));
+		pos += 4;
+	}
+
+	for (tailSize = 0; pos < end; tailSize++, pos++) {
+		tail |= (boost::uint32_t) *pos << (tailSize * 8);
+	}
+
+	hash = h;
+}
+
+boost::uint32_t
+MurmurHash3::finalize() const {
+	boost::uint32_t h = hash;
+
+	if ((length & 3) != 0) {
+		h ^= scrambleWord(tail);
+	}
+
+	h ^= length;
+	h ^= h >> 16;
+	h *= 0x85ebca6b;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35;
+	h ^= h >> 16;
+	return h;
+}
+
 } // namespace Passenger
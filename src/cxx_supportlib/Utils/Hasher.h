@@ -31,9 +31,10 @@
 namespace Passenger {
 
 
-// TODO: use SpookyHash on x86_64
-// TODO: use streaming murmurhash implementation: https://github.com/c9/murmur3
-
+/**
+ * Bob Jenkins's one-at-a-time hash. Simple, but it processes one byte
+ * at a time. Only kept around as a reference for benchmarks; use Hasher.
+ */
 struct JenkinsHash {
 	static const boost::uint32_t EMPTY_STRING_HASH = 0;
 
@@ -51,7 +52,41 @@ struct JenkinsHash {
 	}
 };
 
-typedef JenkinsHash Hasher;
+/**
+ * MurmurHash3 (x86, 32-bit, seed 0), which processes input one 32-bit word
+ * at a time. See https://github.com/aappleby/smhasher.
+ *
+ * This is a streaming implementation: input may be passed to update() in
+ * arbitrary pieces, for example the parts of an LString or the chunks in which
+ * a header name arrives from the network, and the result is the same as if
+ * the whole input had been passed at once. Bytes that don't form a complete
+ * word yet are kept in `tail` until the next update() or finalize().
+ */
+struct MurmurHash3 {
+	static const boost::uint32_t EMPTY_STRING_HASH = 0;
+
+	boost::uint32_t hash;
+	boost::uint32_t tail;
+	/** The number of bytes passed so far. `length % 4` bytes are in `tail`. */
+	boost::uint32_t length;
+
+	MurmurHash3()
+		: hash(0),
+		  tail(0),
+		  length(0)
+		{ }
+
+	void update(const char *data, unsigned int size);
+	boost::uint32_t finalize() const;
+
+	void reset() {
+		hash = 0;
+		tail = 0;
+		length = 0;
+	}
+};
+
+typedef MurmurHash3 Hasher;
 
 
 } // namespace Passenger
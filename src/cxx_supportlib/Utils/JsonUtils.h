@@ -33,6 +33,7 @@
 #include <jsoncpp/json.h>
 #include <boost/cstdint.hpp>
 #include <StaticString.h>
+#include <Algorithms/Histogram.h>
 #include <Utils/SystemTime.h>
 #include <Utils/StrIntUtils.h>
 #include <Utils/VariantMap.h>
@@ -353,6 +354,23 @@ byteSizeAndCountToJson(size_t size, unsigned int count) {
 	return doc;
 }
 
+/**
+ * Summarizes a histogram of durations in microseconds.
+ */
+inline Json::Value
+durationHistogramToJson(const LogHistogram &histogram) {
+	Json::Value doc;
+	doc["count"] = (Json::UInt64) histogram.getCount();
+	if (histogram.getCount() > 0) {
+		doc["mean"] = durationToJson(histogram.getMean());
+		doc["p50"] = durationToJson(histogram.getPercentile(50));
+		doc["p90"] = durationToJson(histogram.getPercentile(90));
+		doc["p99"] = durationToJson(histogram.getPercentile(99));
+		doc["max"] = durationToJson(histogram.getMax());
+	}
+	return doc;
+}
+
 
 } // namespace Passenger
 
@@ -0,0 +1,306 @@
+/*
+ *  Phusion Passenger - https://www.phusionpassenger.com/
+ *  Copyright (c) 2016 Phusion Holding B.V.
+ *
+ *  "Passenger", "Phusion Passenger" and "Union Station" are registered
+ *  trademarks of Phusion Holding B.V.
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ *  all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ *  THE SOFTWARE.
+ */
+#ifndef _PASSENGER_METRICS_REGISTRY_H_
+#define _PASSENGER_METRICS_REGISTRY_H_
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <StaticString.h>
+
+namespace Passenger {
+
+using namespace std;
+
+
+/**
+ * Collects counters and gauges that are published by several threads,
+ * and renders them in the OpenMetrics text format.
+ *
+ * Each thread that has metrics to report gets its own Publisher. It
+ * periodically builds a complete snapshot of its metrics and publishes it.
+ * Publishers are double-buffered: a snapshot is built in a private buffer
+ * and then swapped into the spare slot, which becomes the readable slot.
+ * Readers pin the readable slot with a reader count while they render it.
+ * Neither side ever waits for the other: if a slow reader still pins the
+ * spare slot when the publisher wants to reuse it, that publication is
+ * skipped and the reader keeps seeing the previous snapshot.
+ *
+ * Rendering therefore costs O(number of samples), no matter how busy the
+ * publishing threads are, and never touches their locks.
+ *
+ * Publishers must be created before any thread starts publishing or
+ * rendering; the set of publishers is fixed after that.
+ */
+class MetricsRegistry: public boost::noncopyable {
+public:
+	enum Type {
+		COUNTER,
+		GAUGE
+	};
+
+	/**
+	 * Describes a metric. Define these as static constants: samples
+	 * refer to them by pointer. `name` must not have a "_total" suffix;
+	 * it is appended to the sample names of counters.
+	 */
+	struct Family {
+		const char *name;
+		Type type;
+		const char *help;
+	};
+
+	struct Sample {
+		const Family *family;
+		/** Rendered label set without braces, e.g. `app="foo",pid="123"`. */
+		string labels;
+		double value;
+	};
+
+	typedef vector<Sample> SampleList;
+
+	class Publisher: public boost::noncopyable {
+	private:
+		friend class MetricsRegistry;
+
+		SampleList slots[2];
+		boost::atomic<unsigned int> current;
+		boost::atomic<unsigned int> readers[2];
+		SampleList pending;
+		unsigned int skipped;
+
+		const SampleList *pin() {
+			while (true) {
+				unsigned int i = current.load();
+				readers[i].fetch_add(1);
+				if (current.load() == i) {
+					return &slots[i];
+				}
+				// The publisher flipped in the meantime, and may be
+				// writing to the slot we just pinned.
+				readers[i].fetch_sub(1);
+			}
+		}
+
+		void unpin(const SampleList *slot) {
+			readers[slot - slots].fetch_sub(1);
+		}
+
+	public:
+		Publisher()
+			: current(0),
+			  skipped(0)
+		{
+			readers[0].store(0);
+			readers[1].store(0);
+		}
+
+		/** Adds a sample to the snapshot that is being built. */
+		void add(const Family &family, double value) {
+			add(family, StaticString(), value);
+		}
+
+		void add(const Family &family, const StaticString &labels, double value) {
+			pending.push_back(Sample());
+			Sample &sample = pending.back();
+			sample.family = &family;
+			sample.labels.assign(labels.data(), labels.size());
+			sample.value = value;
+		}
+
+		/**
+		 * Makes the snapshot built with add() visible to readers, and starts
+		 * a new, empty one. Returns false if the snapshot had to be dropped
+		 * because a reader was still rendering the spare slot.
+		 *
+		 * Only call this from the thread that owns this publisher.
+		 */
+		bool publish() {
+			unsigned int spare = 1 - current.load(boost::memory_order_relaxed);
+			if (readers[spare].load() != 0) {
+				skipped++;
+				pending.clear();
+				return false;
+			}
+			slots[spare].swap(pending);
+			current.store(spare);
+			pending.clear();
+			return true;
+		}
+
+		/** The number of snapshots that publish() had to drop. */
+		unsigned int getSkipped() const {
+			return skipped;
+		}
+	};
+
+private:
+	vector<Publisher *> publishers;
+
+	static void appendNumber(string &output, double value) {
+		char buf[32];
+		int size = snprintf(buf, sizeof(buf), "%.15g", value);
+		output.append(buf, size);
+	}
+
+	static void appendSamples(string &output, const Family *family,
+		const SampleList &samples)
+	{
+		SampleList::const_iterator it, end = samples.end();
+
+		for (it = samples.begin(); it != end; it++) {
+			if (it->family != family) {
+				continue;
+			}
+			output.append(family->name);
+			if (family->type == COUNTER) {
+				output.append("_total");
+			}
+			if (!it->labels.empty()) {
+				output.append(1, '{');
+				output.append(it->labels);
+				output.append(1, '}');
+			}
+			output.append(1, ' ');
+			appendNumber(output, it->value);
+			output.append(1, '\n');
+		}
+	}
+
+public:
+	~MetricsRegistry() {
+		vector<Publisher *>::iterator it, end = publishers.end();
+		for (it = publishers.begin(); it != end; it++) {
+			delete *it;
+		}
+	}
+
+	/**
+	 * Creates a publisher that is owned by this registry. Not thread-safe;
+	 * call this during initialization only.
+	 */
+	Publisher *createPublisher() {
+		publishers.push_back(new Publisher());
+		return publishers.back();
+	}
+
+	/**
+	 * Renders the latest snapshots of all publishers in the OpenMetrics text
+	 * format. Samples of the same family are grouped together, even if they
+	 * come from different publishers. Thread-safe.
+	 */
+	string render() {
+		vector<const SampleList *> snapshots;
+		vector<const Family *> families;
+		string output;
+		unsigned int i, j;
+
+		snapshots.reserve(publishers.size());
+		for (i = 0; i < publishers.size(); i++) {
+			snapshots.push_back(publishers[i]->pin());
+		}
+
+		for (i = 0; i < snapshots.size(); i++) {
+			SampleList::const_iterator it, end = snapshots[i]->end();
+			for (it = snapshots[i]->begin(); it != end; it++) {
+				if (families.empty() || families.back() != it->family) {
+					for (j = 0; j < families.size(); j++) {
+						if (families[j] == it->family) {
+							break;
+						}
+					}
+					if (j == families.size()) {
+						families.push_back(it->family);
+					}
+				}
+			}
+		}
+
+		for (i = 0; i < families.size(); i++) {
+			const Family *family = families[i];
+			output.append("# TYPE ");
+			output.append(family->name);
+			output.append(family->type == COUNTER ? " counter\n" : " gauge\n");
+			output.append("# HELP ");
+			output.append(family->name);
+			output.append(1, ' ');
+			output.append(family->help);
+			output.append(1, '\n');
+			for (j = 0; j < snapshots.size(); j++) {
+				appendSamples(output, family, *snapshots[j]);
+			}
+		}
+		output.append("# EOF\n");
+
+		for (i = 0; i < publishers.size(); i++) {
+			publishers[i]->unpin(snapshots[i]);
+		}
+		return output;
+	}
+
+	/**
+	 * Appends `name="value"` to a label set, with the value escaped as
+	 * OpenMetrics requires.
+	 */
+	static void appendLabel(string &labels, const StaticString &name,
+		const StaticString &value)
+	{
+		const char *pos = value.data();
+		const char *end = value.data() + value.size();
+
+		if (!labels.empty()) {
+			labels.append(1, ',');
+		}
+		labels.append(name.data(), name.size());
+		labels.append("=\"", 2);
+		while (pos < end) {
+			switch (*pos) {
+			case '\\':
+				labels.append("\\\\", 2);
+				break;
+			case '"':
+				labels.append("\\\"", 2);
+				break;
+			case '\n':
+				labels.append("\\n", 2);
+				break;
+			default:
+				labels.append(1, *pos);
+				break;
+			}
+			pos++;
+		}
+		labels.append(1, '"');
+	}
+};
+
+
+} // namespace Passenger
+
+#endif /* _PASSENGER_METRICS_REGISTRY_H_ */
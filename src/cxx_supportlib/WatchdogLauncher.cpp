@@ -25,6 +25,7 @@
  */
 #include <oxt/thread.hpp>
 #include <set>
+#include <vector>
 #include <cerrno>
 #include <cstring>
 #include <string.h>
@@ -100,11 +101,16 @@ psg_variant_map_set_strset(PsgVariantMap *m,
 {
 	Passenger::VariantMap *vm = (Passenger::VariantMap *) m;
 	std::set<string> the_set;
+	std::vector<string> the_list;
 
+	// Preserve the order: the Nginx module refers to
+	// location_configs elements by index.
 	for (unsigned int i = 0; i < count; i++) {
-		the_set.insert(strs[i]);
+		if (the_set.insert(strs[i]).second) {
+			the_list.push_back(strs[i]);
+		}
 	}
-	vm->setStrSet(name, the_set);
+	vm->setStrSet(name, the_list);
 }
 
 void
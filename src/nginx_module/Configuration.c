@@ -61,6 +61,8 @@ static ngx_path_init_t  ngx_http_proxy_temp_path = {
     ngx_string(NGX_HTTP_PROXY_TEMP_PATH), { 1, 2, 0 }
 };
 
+static ngx_int_t register_location_config(ngx_conf_t *cf,
+    passenger_loc_conf_t *plconf);
 static ngx_int_t postprocess_location_conf(ngx_conf_t *cf,
     ngx_http_core_srv_conf_t *server_conf,
     ngx_http_core_loc_conf_t *location_conf,
@@ -122,6 +124,7 @@ passenger_create_main_conf(ngx_conf_t *cf)
     conf->pool_idle_time = NGX_CONF_UNSET_UINT;
     conf->response_buffer_high_watermark = NGX_CONF_UNSET_UINT;
     conf->stat_throttle_rate = NGX_CONF_UNSET_UINT;
+    conf->file_change_notifications = NGX_CONF_UNSET;
     conf->core_file_descriptor_ulimit = NGX_CONF_UNSET_UINT;
     conf->user_switching = NGX_CONF_UNSET;
     conf->show_version_in_header = NGX_CONF_UNSET;
@@ -148,6 +151,11 @@ passenger_create_main_conf(ngx_conf_t *cf)
         return NGX_CONF_ERROR;
     }
 
+    conf->location_configs = ngx_array_create(cf->pool, 4, sizeof(ngx_str_t));
+    if (conf->location_configs == NULL) {
+        return NGX_CONF_ERROR;
+    }
+
     return conf;
 }
 
@@ -219,6 +227,10 @@ passenger_init_main_conf(ngx_conf_t *cf, void *conf_pointer)
         conf->stat_throttle_rate = DEFAULT_STAT_THROTTLE_RATE;
     }
 
+    if (conf->file_change_notifications == NGX_CONF_UNSET) {
+        conf->file_change_notifications = 0;
+    }
+
     if (conf->user_switching == NGX_CONF_UNSET) {
         conf->user_switching = 1;
     }
@@ -386,6 +398,7 @@ passenger_create_loc_conf(ngx_conf_t *cf)
     conf->options_cache.len   = 0;
     conf->env_vars_cache.data = NULL;
     conf->env_vars_cache.len  = 0;
+    conf->config_id = -1;
 
     return conf;
 }
@@ -1137,9 +1150,92 @@ postprocess_location_conf(ngx_conf_t *cf,
         passenger_main_conf.union_station_support = 1;
     }
 
+    if (register_location_config(cf, location_conf->loc_conf[
+            ngx_http_passenger_module.ctx_index]) != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
     return traverse_location_confs_nested_in_server_conf(cf, server_conf, location_conf, ctx);
 }
 
+/**
+ * Adds the cached header data of the given location to the list of location
+ * configurations that is passed to the core at startup, so that requests
+ * only have to send the index in that list (!~PASSENGER_CONFIG_ID) instead
+ * of all the data. Locations with identical data share an index.
+ *
+ * Locations that aren't traversed here, such as named locations and
+ * locations created by `if`, keep sending the data with every request.
+ */
+static ngx_int_t
+register_location_config(ngx_conf_t *cf, passenger_loc_conf_t *plconf)
+{
+    ngx_str_t   *configs, *config, *union_station_filters;
+    ngx_uint_t   i;
+    size_t       len;
+    u_char      *buf, *pos;
+
+    if (plconf->config_id != -1 || plconf->options_cache.data == NULL) {
+        return NGX_OK;
+    }
+
+    len = plconf->options_cache.len;
+    if (plconf->env_vars_cache.data != NULL) {
+        len += sizeof("!~PASSENGER_ENV_VARS: \r\n") - 1 + plconf->env_vars_cache.len;
+    }
+    if (plconf->union_station_filters != NGX_CONF_UNSET_PTR
+     && plconf->union_station_filters != NULL)
+    {
+        union_station_filters = (ngx_str_t *) plconf->union_station_filters->elts;
+        for (i = 0; i < plconf->union_station_filters->nelts; i++) {
+            len += sizeof("!~UNION_STATION_FILTERS: \r\n") - 1 + union_station_filters[i].len;
+        }
+    } else {
+        union_station_filters = NULL;
+    }
+
+    buf = ngx_pnalloc(cf->pool, len + 1);
+    if (buf == NULL) {
+        return NGX_ERROR;
+    }
+
+    pos = ngx_copy(buf, plconf->options_cache.data, plconf->options_cache.len);
+    if (plconf->env_vars_cache.data != NULL) {
+        pos = ngx_copy(pos, "!~PASSENGER_ENV_VARS: ", sizeof("!~PASSENGER_ENV_VARS: ") - 1);
+        pos = ngx_copy(pos, plconf->env_vars_cache.data, plconf->env_vars_cache.len);
+        pos = ngx_copy(pos, "\r\n", sizeof("\r\n") - 1);
+    }
+    if (union_station_filters != NULL) {
+        for (i = 0; i < plconf->union_station_filters->nelts; i++) {
+            pos = ngx_copy(pos, "!~UNION_STATION_FILTERS: ",
+                sizeof("!~UNION_STATION_FILTERS: ") - 1);
+            pos = ngx_copy(pos, union_station_filters[i].data,
+                union_station_filters[i].len);
+            pos = ngx_copy(pos, "\r\n", sizeof("\r\n") - 1);
+        }
+    }
+    *pos = '\0';
+
+    configs = (ngx_str_t *) passenger_main_conf.location_configs->elts;
+    for (i = 0; i < passenger_main_conf.location_configs->nelts; i++) {
+        if (configs[i].len == len && ngx_memcmp(configs[i].data, buf, len) == 0) {
+            plconf->config_id = i;
+            return NGX_OK;
+        }
+    }
+
+    config = (ngx_str_t *) ngx_array_push(passenger_main_conf.location_configs);
+    if (config == NULL) {
+        return NGX_ERROR;
+    }
+    config->data = buf;
+    config->len  = len;
+    plconf->config_id = passenger_main_conf.location_configs->nelts - 1;
+
+    return NGX_OK;
+}
+
 static ngx_int_t
 traverse_location_confs_nested_in_server_conf(ngx_conf_t *cf,
     ngx_http_core_srv_conf_t *server_conf,
@@ -1553,6 +1649,13 @@ const ngx_command_t passenger_commands[] = {
       offsetof(passenger_main_conf_t, stat_throttle_rate),
       NULL },
 
+    { ngx_string("passenger_file_change_notifications"),
+      NGX_HTTP_MAIN_CONF | NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      NGX_HTTP_MAIN_CONF_OFFSET,
+      offsetof(passenger_main_conf_t, file_change_notifications),
+      NULL },
+
     { ngx_string("passenger_show_version_in_header"),
       NGX_HTTP_MAIN_CONF | NGX_CONF_FLAG,
       ngx_conf_set_flag_slot,
@@ -50,6 +50,7 @@ typedef struct {
     ngx_uint_t   pool_idle_time;
     ngx_uint_t   response_buffer_high_watermark;
     ngx_uint_t   stat_throttle_rate;
+    ngx_flag_t   file_change_notifications;
     ngx_uint_t   core_file_descriptor_ulimit;
     ngx_flag_t   turbocaching;
     ngx_flag_t   show_version_in_header;
@@ -64,6 +65,9 @@ typedef struct {
     ngx_str_t    union_station_gateway_cert;
     ngx_str_t    union_station_proxy_address;
     ngx_array_t *prestart_uris;
+    /** Cached header data of all locations, registered with the core at
+     * startup. Array of null-terminated ngx_str_t. */
+    ngx_array_t *location_configs;
 } passenger_main_conf_t;
 
 extern const ngx_command_t   passenger_commands[];
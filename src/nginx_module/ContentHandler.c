@@ -705,7 +705,15 @@ construct_request_buffer(ngx_http_request_t *r, passenger_loc_conf_t *slcf,
     total_size += state->app_type.len;
     PUSH_STATIC_STR("\r\n");
 
-    if (slcf->union_station_filters != NGX_CONF_UNSET_PTR
+    if (slcf->config_id != -1) {
+        /* The core already knows this location's configuration. */
+        if (b != NULL) {
+            b->last = ngx_sprintf(b->last, "!~PASSENGER_CONFIG_ID: %i\r\n",
+                slcf->config_id);
+        }
+        total_size += (sizeof("!~PASSENGER_CONFIG_ID: \r\n") - 1) + NGX_INT_T_LEN;
+
+    } else if (slcf->union_station_filters != NGX_CONF_UNSET_PTR
      && slcf->union_station_filters->nelts > 0)
     {
         union_station_filters = (ngx_str_t *) slcf->union_station_filters->elts;
@@ -720,12 +728,14 @@ construct_request_buffer(ngx_http_request_t *r, passenger_loc_conf_t *slcf,
         }
     }
 
-    if (b != NULL) {
-        b->last = ngx_copy(b->last, slcf->options_cache.data, slcf->options_cache.len);
+    if (slcf->config_id == -1) {
+        if (b != NULL) {
+            b->last = ngx_copy(b->last, slcf->options_cache.data, slcf->options_cache.len);
+        }
+        total_size += slcf->options_cache.len;
     }
-    total_size += slcf->options_cache.len;
 
-    if (slcf->env_vars_cache.data != NULL) {
+    if (slcf->config_id == -1 && slcf->env_vars_cache.data != NULL) {
         PUSH_STATIC_STR("!~PASSENGER_ENV_VARS: ");
         if (b != NULL) {
             b->last = ngx_copy(b->last, slcf->env_vars_cache.data, slcf->env_vars_cache.len);
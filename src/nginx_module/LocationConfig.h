@@ -47,6 +47,10 @@ typedef struct {
     /** Raw HTTP header data for this location are cached here. */
     ngx_str_t    options_cache;
     ngx_str_t    env_vars_cache;
+    /** Index of this location's cached header data in the list of location
+     * configurations that is registered with the core at startup, or -1
+     * if the header data must be sent with every request. */
+    ngx_int_t    config_id;
 
     ngx_int_t abort_websockets_on_process_shutdown;
     ngx_uint_t app_file_descriptor_ulimit;
@@ -228,6 +228,8 @@ start_watchdog(ngx_cycle_t *cycle) {
     ngx_uint_t       i;
     ngx_str_t       *prestart_uris;
     char           **prestart_uris_ary = NULL;
+    ngx_str_t       *location_configs;
+    const char     **location_configs_ary = NULL;
     ngx_keyval_t    *ctl = NULL;
     PsgVariantMap   *params = NULL;
     u_char  filename[NGX_MAX_PATH], *last;
@@ -254,6 +256,16 @@ start_watchdog(ngx_cycle_t *cycle) {
         }
     }
 
+    /* The location configs are already null-terminated, see register_location_config(). */
+    location_configs = (ngx_str_t *) passenger_main_conf.location_configs->elts;
+    location_configs_ary = calloc(sizeof(char *), passenger_main_conf.location_configs->nelts + 1);
+    if (location_configs_ary == NULL) {
+        goto error_enomem;
+    }
+    for (i = 0; i < passenger_main_conf.location_configs->nelts; i++) {
+        location_configs_ary[i] = (const char *) location_configs[i].data;
+    }
+
     psg_variant_map_set_int    (params, "web_server_control_process_pid", getpid());
     psg_variant_map_set        (params, "server_software", NGINX_VER, strlen(NGINX_VER));
     psg_variant_map_set        (params, "server_version", NGINX_VERSION, strlen(NGINX_VERSION));
@@ -284,6 +296,7 @@ start_watchdog(ngx_cycle_t *cycle) {
     psg_variant_map_set_ngx_str(params, "union_station_gateway_cert", &passenger_main_conf.union_station_gateway_cert);
     psg_variant_map_set_ngx_str(params, "union_station_proxy_address", &passenger_main_conf.union_station_proxy_address);
     psg_variant_map_set_strset (params, "prestart_urls", (const char **) prestart_uris_ary, passenger_main_conf.prestart_uris->nelts);
+    psg_variant_map_set_strset (params, "location_configs", location_configs_ary, passenger_main_conf.location_configs->nelts);
 
     if (passenger_main_conf.core_file_descriptor_ulimit != NGX_CONF_UNSET_UINT) {
         psg_variant_map_set_int(params, "core_file_descriptor_ulimit", passenger_main_conf.core_file_descriptor_ulimit);
@@ -353,6 +366,7 @@ cleanup:
         }
         free(prestart_uris_ary);
     }
+    free(location_configs_ary);
 
     if (result == NGX_ERROR && passenger_main_conf.abort_on_startup_error) {
         exit(1);
@@ -452,6 +466,17 @@ init_worker_process(ngx_cycle_t *cycle) {
         if (core_conf->master) {
             psg_watchdog_launcher_detach(psg_watchdog_launcher);
         }
+
+        /* The inotify instance and its thread must belong to this process,
+         * which is why this isn't done before forking.
+         */
+        if (passenger_main_conf.file_change_notifications
+         && !pp_cached_file_stat_enable_change_notifications(pp_stat_cache))
+        {
+            ngx_log_error(NGX_LOG_WARN, cycle->log, 0,
+                "cannot enable file change notifications; "
+                "falling back to passenger_stat_throttle_rate");
+        }
     }
     return NGX_OK;
 }
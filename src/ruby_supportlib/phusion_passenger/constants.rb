@@ -71,6 +71,18 @@ module SharedConstants
     DEFAULT_HTTP_SERVER_LISTEN_ADDRESS = "tcp://127.0.0.1:3000"
     DEFAULT_UST_ROUTER_LISTEN_ADDRESS = "tcp://127.0.0.1:9344"
     DEFAULT_LVE_MIN_UID = 500
+    DEFAULT_ACCESS_LOG_FORMAT = '$remote_addr - $remote_user [$time_iso8601] ' \
+      '"$request_method $request_uri $server_protocol" $status ' \
+      '$request_time $queue_time $connect_time $app_pid $turbocache'
+    DEFAULT_RESPONSE_COMPRESSION_LEVEL = 6
+    DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE = 1024
+    DEFAULT_RESPONSE_COMPRESSION_TYPES = 'text/html,text/plain,text/css,text/xml,' \
+      'text/javascript,application/javascript,application/x-javascript,' \
+      'application/json,application/xml,application/rss+xml,' \
+      'application/atom+xml,image/svg+xml'
+    DEFAULT_CLIENT_HEADER_TIMEOUT = 60
+    DEFAULT_CLIENT_BODY_TIMEOUT = 60
+    DEFAULT_CLIENT_KEEPALIVE_TIMEOUT = 75
 
     # Size limits
     MESSAGE_SERVER_MAX_USERNAME_SIZE = 100
@@ -80,6 +92,11 @@ module SharedConstants
     # also introduce context switching and smaller transfer writes. The size is picked 
     # to balance this out.
     DEFAULT_MBUF_CHUNK_SIZE = 1024 * 4
+    # Additional mbuf size classes. Channels pick the smallest class that fits
+    # the amount of data that they expect to read.
+    SMALL_MBUF_CHUNK_SIZE = 1024
+    LARGE_MBUF_CHUNK_SIZE = 1024 * 16
+    XLARGE_MBUF_CHUNK_SIZE = 1024 * 64
     # Affects input and output buffering (between app and client). Threshold is picked
     # such that it fits most output (i.e. html page size, not assets), and allows for
     # high concurrency with low mem overhead. On the upload side there is a penalty 
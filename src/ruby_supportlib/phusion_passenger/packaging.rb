@@ -38,6 +38,7 @@ module Packaging
     # Files that must be generated before packaging.
     PREGENERATED_FILES = [
       'src/cxx_supportlib/Constants.h',
+      'src/cxx_supportlib/ServerKit/KnownHeaders.h',
       'doc/Packaging.html',
       'doc/CloudLicensingConfiguration.html',
       'doc/ServerOptimizationGuide.html'
@@ -251,8 +251,13 @@ module Standalone
       {
         :name      => :static_files_dir,
         :type      => :path,
-        :desc      => "Specify the static files dir (Nginx engine\n" \
-                      'only)'
+        :desc      => 'Specify the static files dir'
+      },
+      {
+        :name      => :static_files_gzip,
+        :type      => :boolean,
+        :desc      => "Serve <file>.gz to clients that accept\n" \
+                      'gzip (builtin engine only)'
       },
       {
         :name      => :restart_dir,
@@ -437,6 +442,62 @@ module Standalone
           options[:turbocaching] = false
         end
       },
+      {
+        :name      => :response_compression,
+        :type      => :boolean,
+        :desc      => "Compress responses with gzip or deflate\n" \
+                      'if the client accepts it'
+      },
+      {
+        :name      => :response_compression_level,
+        :type      => :integer,
+        :type_desc => 'LEVEL',
+        :min       => 1,
+        :desc      => "zlib compression level (1-9).\n" \
+                      "Default: #{DEFAULT_RESPONSE_COMPRESSION_LEVEL}"
+      },
+      {
+        :name      => :response_compression_min_size,
+        :type      => :integer,
+        :type_desc => 'BYTES',
+        :min       => 0,
+        :desc      => "Do not compress responses smaller than\n" \
+                      "this. Default: #{DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE}"
+      },
+      {
+        :name      => :response_compression_types,
+        :type_desc => 'LIST',
+        :desc      => "Comma-separated content types to\n" \
+                      "compress. 'type/*' matches all subtypes"
+      },
+      {
+        :name      => :client_header_timeout,
+        :type      => :integer,
+        :type_desc => 'SECONDS',
+        :min       => 0,
+        :desc      => "Close the connection if a client takes\n" \
+                      "longer than this to send the request\n" \
+                      "header (builtin engine only). Default:\n" \
+                      "#{DEFAULT_CLIENT_HEADER_TIMEOUT}"
+      },
+      {
+        :name      => :client_body_timeout,
+        :type      => :integer,
+        :type_desc => 'SECONDS',
+        :min       => 0,
+        :desc      => "Close the connection if a client sends\n" \
+                      "no request body data for this long\n" \
+                      "(builtin engine only). Default: #{DEFAULT_CLIENT_BODY_TIMEOUT}"
+      },
+      {
+        :name      => :client_keepalive_timeout,
+        :type      => :integer,
+        :type_desc => 'SECONDS',
+        :min       => 0,
+        :desc      => "Close keep-alive connections that are\n" \
+                      "idle for this long (builtin engine\n" \
+                      "only). Default: #{DEFAULT_CLIENT_KEEPALIVE_TIMEOUT}"
+      },
       {
         :name      => :unlimited_concurrency_paths,
         :type      => :array,
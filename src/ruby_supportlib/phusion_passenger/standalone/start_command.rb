@@ -192,7 +192,6 @@ def sanity_check_options_and_set_defaults
           check_nginx_option_used_with_builtin_engine(:ssl_certificate, "--ssl-certificate")
           check_nginx_option_used_with_builtin_engine(:ssl_certificate_key, "--ssl-certificate-key")
           check_nginx_option_used_with_builtin_engine(:ssl_port, "--ssl-port")
-          check_nginx_option_used_with_builtin_engine(:static_files_dir, "--static-files-dir")
         end
 
         #############
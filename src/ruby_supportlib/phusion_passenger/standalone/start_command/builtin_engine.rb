@@ -137,6 +137,13 @@ def build_daemon_controller_options
           add_param(command, :startup_file, "--startup-file")
           add_param(command, :spawn_method, "--spawn-method")
           add_param(command, :restart_dir, "--restart-dir")
+          # Let the Core serve static files only if the user asked for it.
+          # Until then they're served by the app, as before.
+          if @options[:static_files_dir] || @options[:static_files_gzip]
+            static_files_dir = @options[:static_files_dir] || "#{@apps[0][:root]}/public"
+            command << " --static-files-dir #{Shellwords.escape static_files_dir}"
+            add_flag_param(command, :static_files_gzip, "--static-files-gzip")
+          end
           if @options.has_key?(:friendly_error_pages)
             if @options[:friendly_error_pages]
               command << " --force-friendly-error-pages"
@@ -168,6 +175,13 @@ def build_daemon_controller_options
           add_flag_param(command, :sticky_sessions, "--sticky-sessions")
           add_param(command, :vary_turbocache_by_cookie, "--vary-turbocache-by-cookie")
           add_param(command, :sticky_sessions_cookie_name, "--sticky-sessions-cookie-name")
+          add_flag_param(command, :response_compression, "--response-compression")
+          add_param(command, :response_compression_level, "--response-compression-level")
+          add_param(command, :response_compression_min_size, "--response-compression-min-size")
+          add_param(command, :response_compression_types, "--response-compression-types")
+          add_param(command, :client_header_timeout, "--client-header-timeout")
+          add_param(command, :client_body_timeout, "--client-body-timeout")
+          add_param(command, :client_keepalive_timeout, "--client-keepalive-timeout")
           add_param(command, :union_station_gateway_address, "--union-station-gateway-address")
           add_param(command, :union_station_gateway_port, "--union-station-gateway-port")
           add_param(command, :union_station_key, "--union-station-key")
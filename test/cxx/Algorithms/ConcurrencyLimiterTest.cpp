@@ -0,0 +1,179 @@
+#include <TestSupport.h>
+#include <Algorithms/ConcurrencyLimiter.h>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	/**
+	 * A synthetic app that can process `capacity` requests in parallel,
+	 * each in `baseLatency` microseconds. Requests beyond its capacity
+	 * share the available capacity, so latency grows linearly with the
+	 * number of requests in flight.
+	 */
+	struct SyntheticApp {
+		unsigned int capacity;
+		unsigned long long baseLatency;
+
+		SyntheticApp(unsigned int _capacity, unsigned long long _baseLatency)
+			: capacity(_capacity),
+			  baseLatency(_baseLatency)
+			{ }
+
+		unsigned long long latency(unsigned int inFlight) const {
+			if (inFlight <= capacity) {
+				return baseLatency;
+			} else {
+				return baseLatency * inFlight / capacity;
+			}
+		}
+	};
+
+	struct Algorithms_ConcurrencyLimiterTest {
+		ConcurrencyLimiter limiter;
+		unsigned long long now;
+		unsigned long long totalLatency;
+		unsigned int rounds;
+
+		Algorithms_ConcurrencyLimiterTest()
+			: now(1000000),
+			  totalLatency(0),
+			  rounds(0)
+			{ }
+
+		/**
+		 * Simulates `n` rounds in which `clients` clients send requests
+		 * to the app, of which the limiter lets through as many as its
+		 * limit allows. All requests in a round complete at the same time.
+		 */
+		void simulate(const SyntheticApp &app, unsigned int clients, unsigned int n) {
+			totalLatency = 0;
+			rounds = 0;
+			for (unsigned int i = 0; i < n; i++) {
+				unsigned int inFlight = std::min(clients, limiter.getLimit());
+				unsigned long long latency = app.latency(inFlight);
+				now += latency;
+				for (unsigned int j = 0; j < inFlight; j++) {
+					limiter.update(latency, inFlight, now);
+				}
+				totalLatency += latency;
+				rounds++;
+			}
+		}
+
+		unsigned long long averageLatency() const {
+			return totalLatency / rounds;
+		}
+	};
+
+	DEFINE_TEST_GROUP(Algorithms_ConcurrencyLimiterTest);
+
+	TEST_METHOD(1) {
+		set_test_name("It is disabled if the target latency is 0");
+		ensure(!limiter.isEnabled());
+		ensure(!limiter.update(1000000, 1000, now));
+		ensure_equals(limiter.getLimit(), 1000u);
+		ensure(!limiter.isOverloaded());
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("The limit grows while latency is below the target and the limit is fully utilized");
+		SyntheticApp app(1000, 10000);
+		limiter.setTargetLatency(15000);
+		simulate(app, 100, 500);
+		ensure(limiter.getLimit() >= 100);
+		ensure_equals(limiter.getDecreases(), 0u);
+		ensure(!limiter.isOverloaded());
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("The limit does not grow while it is not fully utilized");
+		SyntheticApp app(1000, 10000);
+		limiter.setTargetLatency(15000);
+		simulate(app, 3, 500);
+		ensure_equals(limiter.getLimit(), 10u);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("The limit settles around the concurrency at which latency reaches the target");
+		SyntheticApp app(8, 10000);
+		limiter.setTargetLatency(15000);
+		simulate(app, 64, 1000);
+		simulate(app, 64, 2000);
+		// Without a limit, latency would be 80 msec.
+		ensure("Limit is at least the app's capacity", limiter.getLimit() >= 8);
+		ensure("Limit is at most the concurrency that yields the target latency",
+			limiter.getLimit() <= 12);
+		ensure("Average latency stays near the target", averageLatency() <= 16000);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("The limit is reduced when the app slows down");
+		limiter.setTargetLatency(15000);
+		simulate(SyntheticApp(8, 10000), 64, 1000);
+		ensure(limiter.getLimit() >= 8);
+
+		// Simulate a database slowdown.
+		SyntheticApp slowApp(2, 10000);
+		limiter.update(slowApp.latency(limiter.getLimit()), limiter.getLimit(), now);
+		ensure("The app is overloaded", limiter.isOverloaded());
+
+		simulate(slowApp, 64, 2000);
+		ensure(limiter.getLimit() >= 2);
+		ensure(limiter.getLimit() <= 3);
+		ensure("Average latency stays near the target", averageLatency() <= 16000);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("The limit never drops below the minimum");
+		limiter.setTargetLatency(1000);
+		simulate(SyntheticApp(1, 10000), 64, 100);
+		ensure_equals(limiter.getLimit(), 1u);
+		ensure(limiter.isOverloaded());
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("The limit is decreased at most once per latency period");
+		limiter.setTargetLatency(1000);
+		for (unsigned int i = 0; i < 10; i++) {
+			limiter.update(10000, 10, now);
+		}
+		ensure_equals(limiter.getDecreases(), 1u);
+		ensure_equals(limiter.getLimit(), 5u);
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("Changing the target latency resets the limiter");
+		limiter.setTargetLatency(1000);
+		limiter.update(10000, 10, now);
+		ensure(limiter.isOverloaded());
+		limiter.setTargetLatency(20000);
+		ensure(!limiter.isOverloaded());
+		ensure_equals(limiter.getLimit(), 10u);
+		ensure_equals(limiter.getSmoothedLatency(), -1.0);
+	}
+
+	TEST_METHOD(9) {
+		set_test_name("The limit starts at the app's configured concurrency and never exceeds it");
+		limiter.setTargetLatency(15000);
+		limiter.setConcurrency(4);
+		ensure_equals(limiter.getLimit(), 4u);
+		simulate(SyntheticApp(1000, 10000), 100, 500);
+		ensure_equals(limiter.getLimit(), 4u);
+
+		limiter.setConcurrency(2);
+		ensure_equals("Lowering the concurrency clamps the limit", limiter.getLimit(), 2u);
+		limiter.setTargetLatency(20000);
+		ensure_equals("Resetting starts at the concurrency", limiter.getLimit(), 2u);
+	}
+
+	TEST_METHOD(10) {
+		set_test_name("Apps with unlimited concurrency start at the default limit");
+		limiter.setTargetLatency(15000);
+		limiter.setConcurrency(4);
+		limiter.setConcurrency(0);
+		ensure_equals(limiter.getLimit(), (unsigned int) ConcurrencyLimiter::DEFAULT_INITIAL_LIMIT);
+		simulate(SyntheticApp(1000, 10000), 100, 500);
+		ensure(limiter.getLimit() >= 100);
+	}
+}
@@ -0,0 +1,155 @@
+#include <TestSupport.h>
+#include <Algorithms/Histogram.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct Algorithms_HistogramTest {
+		LogHistogram histogram;
+		AtomicLogHistogram atomicHistogram;
+
+		void recordMany(unsigned int n) {
+			for (unsigned int i = 1; i <= n; i++) {
+				atomicHistogram.record(i);
+			}
+		}
+	};
+
+	DEFINE_TEST_GROUP(Algorithms_HistogramTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Small values are counted exactly");
+		for (unsigned int i = 0; i < LogHistogram::SUB_BUCKETS * 2; i++) {
+			ensure_equals(LogHistogram::bucketIndex(i), i);
+			ensure_equals(LogHistogram::bucketUpperBound(i), (boost::uint64_t) i);
+		}
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Every value falls into a bucket whose bounds contain it");
+		boost::uint64_t values[] = { 16, 17, 31, 32, 1000, 1023, 1024, 123456789,
+			~((boost::uint64_t) 0) };
+		for (unsigned int i = 0; i < sizeof(values) / sizeof(boost::uint64_t); i++) {
+			unsigned int index = LogHistogram::bucketIndex(values[i]);
+			ensure(index < LogHistogram::NBUCKETS);
+			ensure(values[i] <= LogHistogram::bucketUpperBound(index));
+			ensure(values[i] > LogHistogram::bucketUpperBound(index - 1));
+		}
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Bucket upper bounds are within 12.5% of the bucket's values");
+		for (unsigned int i = LogHistogram::SUB_BUCKETS; i < LogHistogram::NBUCKETS; i++) {
+			boost::uint64_t lower = LogHistogram::bucketUpperBound(i - 1) + 1;
+			boost::uint64_t upper = LogHistogram::bucketUpperBound(i);
+			ensure(upper >= lower);
+			ensure((upper - lower) * LogHistogram::SUB_BUCKETS < lower);
+		}
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Summary statistics");
+		ensure_equals(histogram.getPercentile(50), 0u);
+		for (unsigned int i = 1; i <= 100; i++) {
+			histogram.record(i * 1000);
+		}
+		ensure_equals(histogram.getCount(), 100u);
+		ensure_equals(histogram.getSum(), 5050000u);
+		ensure_equals(histogram.getMean(), 50500u);
+		ensure_equals(histogram.getMax(), 100000u);
+		ensure(histogram.getPercentile(50) >= 50000);
+		ensure(histogram.getPercentile(50) <= 50000 * 1.125);
+		ensure(histogram.getPercentile(99) >= 99000);
+		ensure_equals(histogram.getPercentile(100), 100000u);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Merging histograms");
+		LogHistogram other;
+		histogram.record(10);
+		histogram.record(20);
+		other.record(30);
+		other.record(1000);
+		histogram.merge(other);
+		ensure_equals(histogram.getCount(), 4u);
+		ensure_equals(histogram.getSum(), 1060u);
+		ensure_equals(histogram.getMax(), 1000u);
+		ensure_equals(histogram.getBucketCount(LogHistogram::bucketIndex(30)), 1u);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("toXml() only writes the summary statistics");
+		for (unsigned int i = 1; i <= 1000; i++) {
+			histogram.record(i * 1000);
+		}
+		stringstream stream;
+		histogram.toXml(stream);
+		string xml = stream.str();
+		ensure(containsSubstring(xml, "<count>1000</count>"));
+		ensure(containsSubstring(xml, "<p50>"));
+		ensure(containsSubstring(xml, "<p999>"));
+		ensure(containsSubstring(xml, "<max>1000000</max>"));
+		ensure(!containsSubstring(xml, "bucket"));
+	}
+
+
+	/***** AtomicLogHistogram *****/
+
+	TEST_METHOD(10) {
+		set_test_name("AtomicLogHistogram only allocates buckets when a sample is recorded");
+		ensure(!atomicHistogram.bucketsAllocated());
+		ensure_equals(atomicHistogram.snapshot().getCount(), 0u);
+		atomicHistogram.record(5);
+		ensure(atomicHistogram.bucketsAllocated());
+	}
+
+	TEST_METHOD(11) {
+		set_test_name("AtomicLogHistogram uses the same buckets as LogHistogram");
+		const boost::uint64_t values[] = { 0, 7, 8, 1000, 123456789 };
+		for (unsigned int i = 0; i < sizeof(values) / sizeof(boost::uint64_t); i++) {
+			atomicHistogram.record(values[i]);
+			histogram.record(values[i]);
+		}
+		LogHistogram snapshot = atomicHistogram.snapshot();
+		ensure_equals(snapshot.getCount(), histogram.getCount());
+		ensure_equals(snapshot.getSum(), histogram.getSum());
+		ensure_equals(snapshot.getMax(), histogram.getMax());
+		for (unsigned int i = 0; i < LogHistogram::NBUCKETS; i++) {
+			ensure_equals(snapshot.getBucketCount(i), histogram.getBucketCount(i));
+		}
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("AtomicLogHistogram counts huge samples in its last bucket");
+		boost::uint64_t huge = ((boost::uint64_t) 1) << 50;
+		atomicHistogram.record(huge);
+		LogHistogram snapshot = atomicHistogram.snapshot();
+		ensure_equals(snapshot.getBucketCount(AtomicLogHistogram::NBUCKETS - 1), 1u);
+		ensure_equals(snapshot.getMax(), huge);
+		ensure_equals(snapshot.getPercentile(100),
+			(((boost::uint64_t) 1) << AtomicLogHistogram::MAX_VALUE_BITS) - 1);
+	}
+
+	TEST_METHOD(13) {
+		set_test_name("Many threads can record into an AtomicLogHistogram concurrently");
+		const unsigned int nthreads = 8;
+		const unsigned int perThread = 10000;
+		boost::thread_group threads;
+
+		for (unsigned int i = 0; i < nthreads; i++) {
+			threads.create_thread(boost::bind(&Algorithms_HistogramTest::recordMany,
+				this, perThread));
+		}
+		threads.join_all();
+
+		LogHistogram snapshot = atomicHistogram.snapshot();
+		ensure_equals(snapshot.getCount(), (boost::uint64_t) nthreads * perThread);
+		ensure_equals(snapshot.getSum(),
+			(boost::uint64_t) nthreads * perThread * (perThread + 1) / 2);
+		ensure_equals(snapshot.getMax(), (boost::uint64_t) perThread);
+		ensure_equals(snapshot.getBucketCount(1), (boost::uint64_t) nthreads);
+	}
+}
@@ -1,8 +1,12 @@
 #include "TestSupport.h"
 #include "Utils/CachedFileStat.hpp"
 #include "Utils/SystemTime.h"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <sys/types.h>
 #include <utime.h>
+#include <cstdio>
+#include <cstdlib>
 
 using namespace std;
 using namespace Passenger;
@@ -399,4 +403,131 @@ namespace tut {
 		ensure("(4)", stat.knows("test4.txt"));
 		ensure("(5)", stat.knows("test5.txt"));
 	}
+	
+	/************ Tests involving change notifications ************/
+	
+	#ifdef __linux__
+		TEST_METHOD(17) {
+			// With change notifications, a file is re-statted as soon
+			// as it changes, regardless of the throttle rate.
+			TempDir tmpdir("tmp.cstat");
+			string filename = absolutizePath("tmp.cstat/test.txt");
+			CachedFileStat stat;
+			ensure(stat.enableChangeNotifications());
+			
+			touch(filename.c_str(), 1);
+			ensure_equals(stat.stat(filename, &buf, 1000), 0);
+			ensure_equals(buf.st_mtime, (time_t) 1);
+			touch(filename.c_str(), 2);
+			EVENTUALLY(5,
+				stat.stat(filename, &buf, 1000);
+				result = buf.st_mtime == (time_t) 2;
+			);
+		}
+		
+		TEST_METHOD(18) {
+			// With change notifications, the creation of a file that
+			// didn't exist is noticed.
+			TempDir tmpdir("tmp.cstat");
+			string filename = absolutizePath("tmp.cstat/restart.txt");
+			CachedFileStat stat;
+			ensure(stat.enableChangeNotifications());
+			
+			ensure_equals(stat.stat(filename, &buf, 1000), -1);
+			ensure_equals(errno, ENOENT);
+			touch(filename.c_str(), 1);
+			EVENTUALLY(5,
+				result = stat.stat(filename, &buf, 1000) == 0;
+			);
+		}
+		
+		TEST_METHOD(19) {
+			// With change notifications, replacing a symlink to one of the
+			// file's ancestor directories is noticed.
+			TempDir tmpdir("tmp.cstat");
+			makeDirTree("tmp.cstat/releases/1/tmp");
+			makeDirTree("tmp.cstat/releases/2/tmp");
+			touch("tmp.cstat/releases/1/tmp/restart.txt", 1);
+			touch("tmp.cstat/releases/2/tmp/restart.txt", 2);
+			ensure_equals(symlink("releases/1", "tmp.cstat/current"), 0);
+			string filename = absolutizePath("tmp.cstat/current/tmp/restart.txt");
+			CachedFileStat stat;
+			ensure(stat.enableChangeNotifications());
+			
+			stat.stat(filename, &buf, 1000);
+			ensure_equals(buf.st_mtime, (time_t) 1);
+			ensure_equals(symlink("releases/2", "tmp.cstat/current.new"), 0);
+			ensure_equals(rename("tmp.cstat/current.new", "tmp.cstat/current"), 0);
+			EVENTUALLY(5,
+				stat.stat(filename, &buf, 1000);
+				result = buf.st_mtime == (time_t) 2;
+			);
+			
+			// Changes in the new release are noticed too.
+			touch("tmp.cstat/releases/2/tmp/restart.txt", 3);
+			EVENTUALLY(5,
+				stat.stat(filename, &buf, 1000);
+				result = buf.st_mtime == (time_t) 3;
+			);
+		}
+		
+		TEST_METHOD(20) {
+			// With change notifications, paths that cannot be watched,
+			// such as relative paths, are throttled as usual.
+			CachedFileStat stat;
+			ensure(stat.enableChangeNotifications());
+			SystemTime::force(5);
+			touch("test.txt", 1);
+			stat.stat("test.txt", &buf, 1);
+			touch("test.txt", 1000);
+			stat.stat("test.txt", &buf, 1);
+			ensure_equals(buf.st_mtime, (time_t) 1);
+			SystemTime::force(6);
+			stat.stat("test.txt", &buf, 1);
+			ensure_equals(buf.st_mtime, (time_t) 1000);
+		}
+	#endif
+	
+	
+	/************ Tests involving multiple threads ************/
+	
+	static void lookUpConcurrently(CachedFileStat *stat, const vector<string> *filenames,
+		unsigned int iterations, bool *ok)
+	{
+		struct stat buf;
+		for (unsigned int i = 0; i < iterations; i++) {
+			const string &filename = (*filenames)[i % filenames->size()];
+			if (stat->stat(filename, &buf, 10) != 0 || buf.st_mtime != (time_t) 1) {
+				*ok = false;
+			}
+		}
+	}
+	
+	TEST_METHOD(21) {
+		// Many threads can look up files concurrently, and eviction
+		// keeps the cache within its maximum size.
+		TempDir tmpdir("tmp.cstat");
+		vector<string> filenames;
+		boost::thread_group threads;
+		bool ok = true;
+		
+		for (unsigned int i = 0; i < 128; i++) {
+			filenames.push_back("tmp.cstat/" + toString(i));
+			touch(filenames.back().c_str(), 1);
+		}
+		
+		CachedFileStat stat(100);
+		for (unsigned int i = 0; i < 64; i++) {
+			threads.create_thread(boost::bind(lookUpConcurrently, &stat,
+				&filenames, 20000, &ok));
+		}
+		threads.join_all();
+		ensure("All lookups returned the right information", ok);
+		
+		unsigned int known = 0;
+		for (unsigned int i = 0; i < filenames.size(); i++) {
+			known += stat.knows(filenames[i]);
+		}
+		ensure("The cache doesn't exceed its maximum size", known <= 100);
+	}
 }
@@ -0,0 +1,290 @@
+#include <TestSupport.h>
+#include <boost/bind.hpp>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <MemoryKit/palloc.h>
+#include <Core/Controller/Request.h>
+#include <Core/AccessLog.h>
+#include <Utils/IOUtils.h>
+
+using namespace Passenger;
+using namespace Passenger::Core;
+using namespace Passenger::ServerKit;
+using namespace std;
+
+namespace tut {
+	struct Core_AccessLogTest {
+		Request req;
+		string out;
+		vector<string> rotatedPaths;
+
+		Core_AccessLogTest() {
+			req.pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+			req.httpMajor = 1;
+			req.httpMinor = 1;
+			req.method    = HTTP_GET;
+			psg_lstr_init(&req.path);
+			psg_lstr_append(&req.path, req.pool, "/foo?bar=1");
+			req.host      = createLString("foo.com");
+			req.startedAt = 0;
+			req.responseStatus = 0;
+			req.timed     = false;
+			req.turboCacheHit = false;
+		}
+
+		~Core_AccessLogTest() {
+			psg_destroy_pool(req.pool);
+			unlink("tmp.access_log");
+			unlink("tmp.access_log.1");
+			unlink("tmp.access_log.fifo");
+		}
+
+		static void submitAndDestroy(AccessLog *log, string *buffer, bool *done) {
+			log->submit(*buffer, 1);
+			delete log;
+			*done = true;
+		}
+
+		/**
+		 * Destroys the given log in a background thread and checks that
+		 * it finishes within a few seconds.
+		 */
+		void ensureDestroyedInTime(AccessLog *log, string &buffer) {
+			bool done = false;
+			boost::thread thr(boost::bind(submitAndDestroy, log, &buffer, &done));
+			if (!thr.timed_join(boost::posix_time::seconds(5))) {
+				thr.detach();
+				fail("The AccessLog destructor hangs");
+			}
+			ensure(done);
+		}
+
+		LString *createLString(const StaticString &value) {
+			LString *str = (LString *) psg_palloc(req.pool, sizeof(LString));
+			psg_lstr_init(str);
+			psg_lstr_append(str, req.pool, value.data(), value.size());
+			return str;
+		}
+
+		void insertHeader(HeaderTable &table, const HashedStaticString &key,
+			const StaticString &val)
+		{
+			Header *header = (Header *) psg_palloc(req.pool, sizeof(Header));
+			psg_lstr_init(&header->key);
+			psg_lstr_init(&header->origKey);
+			psg_lstr_init(&header->val);
+			psg_lstr_append(&header->key, req.pool, key.data(), key.size());
+			psg_lstr_append(&header->origKey, req.pool, key.data(), key.size());
+			psg_lstr_append(&header->val, req.pool, val.data(), val.size());
+			header->hash = key.hash();
+			table.insert(&header, req.pool);
+		}
+
+		string format(const StaticString &fmt, ev_tstamp now = 0) {
+			AccessLogFormat format(fmt);
+			out.clear();
+			format.format(out, &req, now);
+			return out;
+		}
+
+		void onRotate(const string &path) {
+			rotatedPaths.push_back(path);
+		}
+	};
+
+	DEFINE_TEST_GROUP(Core_AccessLogTest);
+
+
+	/***** Formats *****/
+
+	TEST_METHOD(1) {
+		set_test_name("A format is compiled into literals and variables");
+		AccessLogFormat format("[$request_method] $$ $status$host");
+		const vector<AccessLogFormat::Field> &fields = format.getFields();
+		ensure_equals(fields.size(), 5u);
+		ensure_equals(fields[0].type, AccessLogFormat::LITERAL);
+		ensure_equals(fields[0].text, "[");
+		ensure_equals(fields[1].type, AccessLogFormat::REQUEST_METHOD);
+		ensure_equals("$$ is merged with the surrounding literals",
+			fields[2].text, "] $ ");
+		ensure_equals(fields[3].type, AccessLogFormat::STATUS);
+		ensure_equals(fields[4].type, AccessLogFormat::HOST);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Unknown variables and dangling dollar signs are rejected");
+		try {
+			AccessLogFormat format("$status $foo");
+			fail("ArgumentException expected");
+		} catch (const ArgumentException &) {
+			// Pass.
+		}
+		try {
+			AccessLogFormat format("$status $");
+			fail("ArgumentException expected");
+		} catch (const ArgumentException &) {
+			// Pass.
+		}
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Only formats with phase timings need request timings");
+		ensure(!AccessLogFormat("$status $request_time").needsRequestTimings());
+		ensure(AccessLogFormat("$status $queue_time").needsRequestTimings());
+		ensure(AccessLogFormat(DEFAULT_ACCESS_LOG_FORMAT).needsRequestTimings());
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Request line, status and host");
+		req.responseStatus = 404;
+		ensure_equals(format("$host \"$request_method $request_uri $server_protocol\" $status"),
+			"foo.com \"GET /foo?bar=1 HTTP/1.1\" 404\n");
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Missing values are logged as '-'");
+		ensure_equals(format("$remote_addr $remote_user $status $app_pid $app_group "
+			"$turbocache $http_referer $request_time $queue_time"),
+			"- - - - - - - - -\n");
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("Header variables");
+		insertHeader(req.headers, "user-agent", "curl/7.0");
+		insertHeader(req.secureHeaders, "!~REMOTE_ADDR", "127.0.0.1");
+		insertHeader(req.secureHeaders, "!~REMOTE_USER", "admin");
+		ensure_equals(format("$remote_addr $remote_user $http_user_agent"),
+			"127.0.0.1 admin curl/7.0\n");
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("Control characters, quotes and backslashes are escaped");
+		insertHeader(req.headers, "user-agent", StaticString("a\"b\\c\nd\x80", 8));
+		ensure_equals(format("$http_user_agent"),
+			"a\\x22b\\x5Cc\\x0Ad\\x80\n");
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("Durations and timestamps have millisecond resolution");
+		req.startedAt = 100;
+		req.timed = true;
+		memset(&req.timings, 0, sizeof(req.timings));
+		req.timings.checkoutBegun = 100.001;
+		req.timings.sessionCheckedOut = 100.026;
+		req.timings.requestHeaderSent = 100.5;
+		req.turboCacheHit = true;
+		ensure_equals(format("$msec $request_time $queue_time $connect_time "
+			"$app_response_time $turbocache", 101.25),
+			"101.250 1.250 0.025 0.474 - HIT\n");
+	}
+
+
+	/***** Writer *****/
+
+	TEST_METHOD(10) {
+		set_test_name("Submitted lines are written in order by the background thread");
+		AccessLog log("tmp.access_log");
+		string buffer = "line 1\nline 2\n";
+		log.submit(buffer, 2);
+		ensure("The buffer is handed over", buffer.empty());
+		buffer = "line 3\n";
+		log.submit(buffer, 1);
+		log.flush();
+		ensure_equals(log.getLinesWritten(), 3u);
+		ensure_equals(log.getLinesDropped(), 0u);
+		ensure_equals(readAll("tmp.access_log"), "line 1\nline 2\nline 3\n");
+	}
+
+	TEST_METHOD(11) {
+		set_test_name("Lines are appended to an existing log file");
+		writeFile("tmp.access_log", "old\n");
+		{
+			AccessLog log("tmp.access_log");
+			string buffer = "new\n";
+			log.submit(buffer, 1);
+		}
+		ensure_equals("The destructor writes pending lines",
+			readAll("tmp.access_log"), "old\nnew\n");
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("Lines are dropped while too much data is pending");
+		AccessLog log("tmp.access_log", 0, 10);
+		string buffer = "too long line\n";
+		log.submit(buffer, 1);
+		log.flush();
+		ensure_equals(log.getLinesWritten(), 0u);
+		ensure_equals(log.getLinesDropped(), 1u);
+	}
+
+	TEST_METHOD(13) {
+		set_test_name("The log file is rotated once it reaches the rotation size");
+		AccessLog log("tmp.access_log", 10);
+		log.setRotationHook(boost::bind(&Core_AccessLogTest::onRotate, this, _1));
+		string buffer = "12345\n";
+		log.submit(buffer, 1);
+		log.flush();
+		ensure_equals(log.getRotations(), 0u);
+
+		buffer = "67890\n";
+		log.submit(buffer, 1);
+		log.flush();
+		ensure_equals(log.getRotations(), 1u);
+		ensure_equals(rotatedPaths.size(), 1u);
+		ensure_equals(rotatedPaths[0], "tmp.access_log.1");
+		ensure_equals(readAll("tmp.access_log.1"), "12345\n67890\n");
+
+		buffer = "abc\n";
+		log.submit(buffer, 1);
+		log.flush();
+		ensure_equals(readAll("tmp.access_log"), "abc\n");
+	}
+
+	TEST_METHOD(15) {
+		set_test_name("Destroying a log that points to a FIFO without a reader doesn't hang");
+		ensure_equals(mkfifo("tmp.access_log.fifo", 0600), 0);
+		// Silence the open error.
+		setLogLevel(LVL_CRIT);
+		AccessLog *log = new AccessLog("tmp.access_log.fifo");
+		string buffer = "line\n";
+		ensureDestroyedInTime(log, buffer);
+		setLogLevel(DEFAULT_LOG_LEVEL);
+	}
+
+	TEST_METHOD(16) {
+		set_test_name("Destroying a log whose FIFO reader doesn't read doesn't hang");
+		ensure_equals(mkfifo("tmp.access_log.fifo", 0600), 0);
+		FileDescriptor reader(open("tmp.access_log.fifo", O_RDONLY | O_NONBLOCK),
+			__FILE__, __LINE__);
+		AccessLog *log = new AccessLog("tmp.access_log.fifo");
+		// More than fits in the pipe buffer.
+		string buffer(4 * 1024 * 1024, 'x');
+		ensureDestroyedInTime(log, buffer);
+	}
+
+	TEST_METHOD(14) {
+		set_test_name("Every submitted line is either written or counted as dropped");
+		const unsigned int n = 20000;
+		const unsigned int linesPerBatch = 256;
+		AccessLogFormat format(DEFAULT_ACCESS_LOG_FORMAT);
+		AccessLog log("tmp.access_log");
+		string buffer;
+		unsigned int lines = 0;
+
+		insertHeader(req.secureHeaders, "!~REMOTE_ADDR", "127.0.0.1");
+		req.startedAt = 100;
+		req.responseStatus = 200;
+		for (unsigned int i = 0; i < n; i++) {
+			format.format(buffer, &req, 100.002);
+			if (++lines == linesPerBatch) {
+				log.submit(buffer, lines);
+				lines = 0;
+			}
+		}
+		log.submit(buffer, lines);
+		log.flush();
+
+		ensure_equals(log.getLinesWritten() + log.getLinesDropped(), (boost::uint64_t) n);
+	}
+}
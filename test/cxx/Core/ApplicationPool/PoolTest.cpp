@@ -2001,6 +2001,161 @@ namespace tut {
 		currentSession.reset();
 	}
 
+	TEST_METHOD(80) {
+		// If a request's queue deadline passes before a process becomes
+		// available, then it is removed from the getWaitlist and
+		// a RequestQueueTimeoutException is returned.
+		Options options = createOptions();
+		options.appGroupName = "test1";
+		GroupPtr group = pool->findOrCreateGroup(options);
+		initPoolDebugging();
+		pool->setMax(1);
+
+		options.requestQueueDeadline = SystemTime::getUsec() + 100000;
+		pool->asyncGet(options, callback);
+		ensure_equals(number, 0);
+
+		EVENTUALLY(5,
+			result = number == 1;
+		);
+		ensure(currentSession == NULL);
+		ensure(dynamic_pointer_cast<RequestQueueTimeoutException>(currentException) != NULL);
+		{
+			LockGuard l(pool->syncher);
+			ensure_equals(group->getWaitlist.size(), 0u);
+			ensure_equals(group->requestQueueTimeouts, 1u);
+		}
+
+		debug->messages->send("Proceed with spawn loop iteration 1");
+		debug->messages->send("Spawn loop done");
+	}
+
+	TEST_METHOD(81) {
+		// cancelAsyncGet() removes the request from the getWaitlist and
+		// calls the callback with a GetAbortedException.
+		Options options = createOptions();
+		options.appGroupName = "test1";
+		GroupPtr group = pool->findOrCreateGroup(options);
+		initPoolDebugging();
+		pool->setMax(1);
+
+		pool->asyncGet(options, callback);
+		ensure_equals(number, 0);
+		ensure(pool->cancelAsyncGet(options, callback));
+		ensure_equals(number, 1);
+		ensure(currentSession == NULL);
+		ensure(dynamic_pointer_cast<GetAbortedException>(currentException) != NULL);
+		ensure("Canceling twice has no effect", !pool->cancelAsyncGet(options, callback));
+		{
+			LockGuard l(pool->syncher);
+			ensure_equals(group->getWaitlist.size(), 0u);
+		}
+
+		debug->messages->send("Proceed with spawn loop iteration 1");
+		debug->messages->send("Spawn loop done");
+	}
+
+	TEST_METHOD(82) {
+		// If a request's queue deadline passes while it is in the Pool's
+		// top-level getWaitlist, then it is removed from there and
+		// a RequestQueueTimeoutException is returned.
+		Options options = createOptions();
+		options.appGroupName = "test";
+		options.minProcesses = 0;
+		pool->setMax(1);
+		spawningKitConfig->spawnTime = 1000000;
+
+		// Begin spawning a process.
+		pool->asyncGet(options, callback);
+		ensure(pool->atFullCapacity());
+
+		// asyncGet() on another group should now put it on the waiting list.
+		Options options2 = createOptions();
+		options2.appGroupName = "test2";
+		options2.minProcesses = 0;
+		options2.requestQueueDeadline = SystemTime::getUsec() + 100000;
+		pool->asyncGet(options2, callback);
+		{
+			LockGuard l(pool->syncher);
+			ensure_equals(pool->getWaitlist.size(), 1u);
+		}
+
+		EVENTUALLY(5,
+			result = number == 1;
+		);
+		ensure(currentSession == NULL);
+		ensure(dynamic_pointer_cast<RequestQueueTimeoutException>(currentException) != NULL);
+		{
+			LockGuard l(pool->syncher);
+			ensure_equals(pool->getWaitlist.size(), 0u);
+			ensure(pool->groups.lookupCopy("test2") == NULL);
+		}
+
+		EVENTUALLY(5,
+			result = number == 2;
+		);
+	}
+
+	TEST_METHOD(83) {
+		// The concurrency limiter of a group starts at the concurrency
+		// of its processes.
+		Options options = createOptions();
+		options.appGroupName = "test";
+		options.targetLatency = 100;
+		options.forceMaxConcurrentRequestsPerProcess = 3;
+
+		pool->asyncGet(options, callback);
+		EVENTUALLY(5,
+			result = number == 1;
+		);
+		LockGuard l(pool->syncher);
+		GroupPtr group = pool->groups.lookupCopy("test");
+		ensure(group->concurrencyLimiter.isEnabled());
+		ensure_equals(group->concurrencyLimiter.getLimit(), 3u);
+	}
+
+	TEST_METHOD(84) {
+		// Session latencies are recorded per process and per group,
+		// and can be inspected as JSON.
+		Options options = createOptions();
+		options.appGroupName = "test";
+
+		SessionPtr session = pool->get(options, &ticket);
+		pid_t pid = session->getPid();
+		session.reset();
+
+		Json::Value doc = pool->inspectSessionLatenciesAsJson();
+		ensure_equals("(1)", doc["count"].asUInt(), 1u);
+		Json::Value group = doc["groups"]["test"];
+		ensure_equals("(2)", group["count"].asUInt(), 1u);
+		ensure_equals("(3)", group["processes"].size(), 1u);
+		Json::Value process = group["processes"][0];
+		ensure_equals("(4)", process["pid"].asInt(), (int) pid);
+		ensure_equals("(5)", process["count"].asUInt(), 1u);
+		ensure("(6)", process.isMember("p99"));
+	}
+
+	TEST_METHOD(86) {
+		// The concurrency limiter measures latency until the app began
+		// its response, so that streaming responses and upgraded
+		// connections don't count as slow.
+		Options options = createOptions();
+		options.appGroupName = "test";
+		options.targetLatency = 50;
+
+		SessionPtr session = pool->get(options, &ticket);
+		session->responseBegun();
+		usleep(100000);
+		session.reset();
+
+		LockGuard l(pool->syncher);
+		GroupPtr group = pool->groups.lookupCopy("test");
+		ensure("(1)", group->concurrencyLimiter.getSmoothedLatency() >= 0);
+		ensure("(2)", group->concurrencyLimiter.getSmoothedLatency() < 50000);
+		ensure_equals("(3)", group->concurrencyLimiter.getDecreases(), 0u);
+		ensure("(4)", group->sessionLatencies.snapshot().getMax() >= 100000);
+	}
+
 	// TODO: Persistent connections.
 	// TODO: If one closes the session before it has reached EOF, and process's maximum concurrency
 	//       has already been reached, then the pool should ping the process so that it can detect
@@ -0,0 +1,149 @@
+#include <TestSupport.h>
+#include <Core/Controller/CgiHeaderNameCache.h>
+#include <DataStructures/HashedStaticString.h>
+
+using namespace Passenger;
+using namespace Passenger::Core;
+using namespace std;
+
+namespace tut {
+	struct Core_CgiHeaderNameCacheTest {
+		CgiHeaderNameCache cache;
+		psg_pool_t *pool;
+
+		Core_CgiHeaderNameCacheTest() {
+			pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+		}
+
+		~Core_CgiHeaderNameCacheTest() {
+			psg_destroy_pool(pool);
+		}
+
+		LString *makeKey(const StaticString &name) {
+			return psg_lstr_create(pool, name.data(), name.size());
+		}
+
+		string lookup(const StaticString &name, boost::uint32_t hash) {
+			LString *key = makeKey(name);
+			const char *result = cache.lookup(key, hash, pool);
+			ensure_equals("NUL-terminated",
+				result[key->size + CgiHeaderNameCache::OVERHEAD - 1], '\0');
+			return string(result, key->size + CgiHeaderNameCache::OVERHEAD - 1);
+		}
+
+		string lookup(const StaticString &name) {
+			return lookup(name, HashedStaticString(name).hash());
+		}
+
+		static string convertSlowly(const string &data) {
+			string result;
+			for (string::size_type i = 0; i < data.size(); i++) {
+				unsigned char ch = data[i];
+				if (ch >= 'a' && ch <= 'z') {
+					result.append(1, ch - 'a' + 'A');
+				} else if (ch == '-') {
+					result.append(1, '_');
+				} else {
+					result.append(1, ch);
+				}
+			}
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(Core_CgiHeaderNameCacheTest);
+
+	TEST_METHOD(1) {
+		set_test_name("It converts header names to CGI variable names");
+		ensure_equals(lookup("user-agent"), "HTTP_USER_AGENT");
+		ensure_equals(lookup("x-forwarded-for"), "HTTP_X_FORWARDED_FOR");
+		ensure_equals(lookup("accept"), "HTTP_ACCEPT");
+		ensure_equals(lookup("x-3d-thing-0123456789"), "HTTP_X_3D_THING_0123456789");
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("convertName() agrees with the scalar conversion for all bytes,"
+			" alignments and lengths");
+		unsigned char data[40], output[40];
+		for (unsigned int ch = 0; ch < 256; ch++) {
+			for (unsigned int len = 1; len <= 24; len++) {
+				for (unsigned int pos = 0; pos < len; pos++) {
+					for (unsigned int i = 0; i < len; i++) {
+						data[i] = "a-Z_zm0@"[(i + ch) % 8];
+					}
+					data[pos] = (unsigned char) ch;
+					memset(output, 'x', sizeof(output));
+					CgiHeaderNameCache::convertName(data, output, len);
+
+					string expected = convertSlowly(string((const char *) data, len));
+					ensure_equals(string((const char *) output, len), expected);
+					ensure_equals("No overflow", output[len], 'x');
+				}
+			}
+		}
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Repeated lookups are served from the cache");
+		ensure_equals(lookup("user-agent"), "HTTP_USER_AGENT");
+		ensure_equals(lookup("accept"), "HTTP_ACCEPT");
+		ensure_equals(cache.getMisses(), 2u);
+		ensure_equals(cache.getHits(), 0u);
+
+		cache.nextRequest();
+		ensure_equals(lookup("user-agent"), "HTTP_USER_AGENT");
+		ensure_equals(lookup("accept"), "HTTP_ACCEPT");
+		ensure_equals(cache.getMisses(), 2u);
+		ensure_equals(cache.getHits(), 2u);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Names that collide with a name used by the same request"
+			" do not evict it");
+		LString *key1 = makeKey("user-agent");
+		LString *key2 = makeKey("accept");
+		const char *name1 = cache.lookup(key1, 1, pool);
+		const char *name2 = cache.lookup(key2, 1 + CgiHeaderNameCache::SIZE, pool);
+		ensure_equals(string(name1), "HTTP_USER_AGENT");
+		ensure_equals(string(name2), "HTTP_ACCEPT");
+
+		cache.nextRequest();
+		ensure_equals(lookup("user-agent", 1), "HTTP_USER_AGENT");
+		ensure_equals(cache.getHits(), 1u);
+		ensure_equals(lookup("accept", 1 + CgiHeaderNameCache::SIZE), "HTTP_ACCEPT");
+		ensure_equals(cache.getHits(), 1u);
+
+		cache.nextRequest();
+		ensure_equals("Names of previous requests are evicted",
+			lookup("accept", 1 + CgiHeaderNameCache::SIZE), "HTTP_ACCEPT");
+		ensure_equals(cache.getHits(), 1u);
+		cache.nextRequest();
+		ensure_equals(lookup("accept", 1 + CgiHeaderNameCache::SIZE), "HTTP_ACCEPT");
+		ensure_equals(cache.getHits(), 2u);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Names with equal hashes but different contents are not confused");
+		ensure_equals(lookup("accept", 7), "HTTP_ACCEPT");
+		cache.nextRequest();
+		ensure_equals(lookup("expect", 7), "HTTP_EXPECT");
+		ensure_equals(cache.getHits(), 0u);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("Multi-part and long names are converted without caching");
+		LString key;
+		psg_lstr_init(&key);
+		psg_lstr_append(&key, pool, "x-request");
+		psg_lstr_append(&key, pool, "-start");
+		const char *result = cache.lookup(&key, 1, pool);
+		ensure_equals(string(result), "HTTP_X_REQUEST_START");
+
+		string longName(CgiHeaderNameCache::MAX_KEY_SIZE + 1, 'a');
+		ensure_equals(lookup(longName), "HTTP_" + convertSlowly(longName));
+		cache.nextRequest();
+		ensure_equals(lookup(longName), "HTTP_" + convertSlowly(longName));
+		ensure_equals(cache.getHits(), 0u);
+		ensure_equals(cache.getMisses(), 0u);
+	}
+}
@@ -18,16 +18,31 @@ namespace tut {
 			virtual void asyncGetFromApplicationPool(Request *req,
 				ApplicationPool2::GetCallback callback)
 			{
+				if (requestsToReject > 0) {
+					requestsToReject--;
+					callback(ApplicationPool2::AbstractSessionPtr(),
+						boost::make_shared<RequestQueueFullException>(1));
+					return;
+				}
 				callback(sessionToReturn, exceptionToReturn);
 				sessionToReturn.reset();
 			}
 
+			virtual void onClientAccepted(Client *client) {
+				Core::Controller::onClientAccepted(client);
+				lastClientFd = client->getFd();
+			}
+
 		public:
 			ApplicationPool2::AbstractSessionPtr sessionToReturn;
 			ApplicationPool2::ExceptionPtr exceptionToReturn;
+			unsigned int requestsToReject;
+			boost::atomic<int> lastClientFd;
 
 			MyController(ServerKit::Context *context, const VariantMap *agentsOptions)
-				: Core::Controller(context, agentsOptions)
+				: Core::Controller(context, agentsOptions),
+				  requestsToReject(0),
+				  lastClientFd(-1)
 				{ }
 		};
 
@@ -170,6 +185,13 @@ namespace tut {
 			return *peerRequestHeader;
 		}
 
+		void readPeerFiller() {
+			string filler(testSession.getFillerSize(), '\0');
+			ensure_equals(readExact(testSession.peerFd(), &filler[0], filler.size()),
+				filler.size());
+			ensure_equals(filler, string(filler.size(), 'x'));
+		}
+
 		void sendPeerResponse(const StaticString &data) {
 			writeExact(testSession.peerFd(), data);
 			testSession.closePeerFd();
@@ -239,6 +261,46 @@ namespace tut {
 			} while (true);
 		}
 
+		size_t fillClientSocketBuffer() {
+			char buf[1024];
+			size_t result = 0;
+			ssize_t ret;
+
+			memset(buf, 'x', sizeof(buf));
+			do {
+				ret = syscalls::write(controller->lastClientFd, buf, sizeof(buf));
+				if (ret > 0) {
+					result += ret;
+				}
+			} while (ret > 0);
+			return result;
+		}
+
+		void _fillClientSocketBuffer(size_t *fillerSize) {
+			*fillerSize = fillClientSocketBuffer();
+		}
+
+		void _readFillerAndSendPeerResponse(size_t fillerSize, const StaticString &data) {
+			string filler(fillerSize, '\0');
+			readExact(clientConnection, &filler[0], fillerSize);
+			sendPeerResponse(data);
+		}
+
+		void _inspectStateAsJson(Json::Value *doc) {
+			*doc = controller->inspectStateAsJson();
+		}
+
+		Json::Value inspectStateAsJson() {
+			Json::Value doc;
+			bg.safe->runSync(boost::bind(&Core_ControllerTest::_inspectStateAsJson,
+				this, &doc));
+			return doc;
+		}
+
+		void blockEventLoop(unsigned int msec) {
+			syscalls::usleep(msec * 1000);
+		}
+
 		string readResponseHeader() {
 			return readHeader(clientConnectionIO);
 		}
@@ -248,7 +310,7 @@ namespace tut {
 		}
 	};
 
-	DEFINE_TEST_GROUP(Core_ControllerTest);
+	DEFINE_TEST_GROUP_WITH_LIMIT(Core_ControllerTest, 80);
 
 
 	/***** Passing request information to the app *****/
@@ -292,6 +354,51 @@ namespace tut {
 			"GET /hello?foo=bar HTTP/1.1\r\n"));
 	}
 
+	TEST_METHOD(3) {
+		set_test_name("Session protocol: header is sent intact if the app socket is full");
+
+		init();
+		useTestSessionObject();
+		testSession.setFillSocketBufferOnInitiate(true);
+
+		connectToServer();
+		sendRequest(
+			"GET /hello?foo=bar HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+
+		readPeerFiller();
+		readPeerRequestHeader();
+		ensure(containsSubstring(peerRequestHeader,
+			P_STATIC_STRING("REQUEST_URI\0/hello?foo=bar\0")));
+		ensure(containsSubstring(peerRequestHeader,
+			P_STATIC_STRING("HTTP_HOST\0localhost\0")));
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("HTTP protocol: header is sent intact if the app socket is full");
+
+		init();
+		useTestSessionObject();
+		testSession.setProtocol("http_session");
+		testSession.setFillSocketBufferOnInitiate(true);
+
+		connectToServer();
+		sendRequest(
+			"GET /hello?foo=bar HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+
+		readPeerFiller();
+		readPeerRequestHeader();
+		ensure(startsWith(peerRequestHeader,
+			"GET /hello?foo=bar HTTP/1.1\r\n"));
+	}
+
 
 	/***** Application response body handling *****/
 
@@ -853,4 +960,203 @@ namespace tut {
 		string header = readResponseHeader();
 		ensure(containsSubstring(header, "HTTP/1.1 502"));
 	}
+
+
+	/***** Location configurations *****/
+
+	TEST_METHOD(50) {
+		set_test_name("Requests can refer to a location configuration that was registered at startup");
+
+		vector<string> locationConfigs;
+		locationConfigs.push_back("!~PASSENGER_STICKY_SESSIONS: true\r\n");
+		locationConfigs.push_back("!~PASSENGER_SHOW_VERSION_IN_HEADER: false\r\n"
+			"!~PASSENGER_MAX_REQUESTS: 100\r\n");
+		options.setStrSet("location_configs", locationConfigs);
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"!~: \r\n"
+			"!~PASSENGER_CONFIG_ID: 1\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+
+		readPeerRequestHeader();
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Connection: close\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello");
+
+		string header = readResponseHeader();
+		ensure(containsSubstring(header, "HTTP/1.1 200 OK\r\n"));
+		ensure(containsSubstring(header, "X-Powered-By: " PROGRAM_NAME "\r\n"));
+	}
+
+	TEST_METHOD(51) {
+		set_test_name("Requests that refer to an unknown location configuration are rejected");
+
+		vector<string> locationConfigs;
+		locationConfigs.push_back("!~PASSENGER_STICKY_SESSIONS: true\r\n");
+		options.setStrSet("location_configs", locationConfigs);
+		init();
+		useTestSessionObject();
+
+		// Hide the expected error message.
+		setLogLevel(LVL_CRIT);
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"!~: \r\n"
+			"!~PASSENGER_CONFIG_ID: 1\r\n"
+			"\r\n");
+
+		ensure_equals(readResponseHeader(), "");
+		ensure_equals(testSession.fd(), -1);
+	}
+
+
+	/***** Pipelining *****/
+
+	TEST_METHOD(60) {
+		set_test_name("An app response header is not written ahead of the unsent"
+			" responses to earlier pipelined requests");
+
+		init();
+		controller->requestsToReject = 2;
+		useTestSessionObject();
+
+		// Hide the expected request queue errors.
+		setLogLevel(LVL_CRIT);
+		connectToServer();
+		EVENTUALLY(5,
+			result = controller->lastClientFd != -1;
+		);
+
+		// Fill the client socket so that the responses to the rejected
+		// requests stay in the client output channel.
+		size_t fillerSize;
+		bg.safe->runSync(boost::bind(&Core_ControllerTest::_fillClientSocketBuffer,
+			this, &fillerSize));
+		sendRequest(
+			"GET /rejected1 HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"\r\n"
+			"GET /rejected2 HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"\r\n"
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+		readPeerRequestHeader();
+
+		// Make room in the client socket and let the app respond in the
+		// same event loop iteration, so that the app response is handled
+		// before the client output channel is flushed.
+		bg.safe->runSync(boost::bind(&Core_ControllerTest::_readFillerAndSendPeerResponse,
+			this, fillerSize,
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello"));
+
+		string response = readResponseBody();
+		ensure("(1)", startsWith(response, "HTTP/1.1 503"));
+		string::size_type pos = response.find("HTTP/1.1 503", 1);
+		ensure("(2)", pos != string::npos);
+		ensure("(3)", response.find("HTTP/1.1 200 OK") > pos);
+		ensure("(4)", containsSubstring(response, "\r\n\r\nhello"));
+	}
+
+
+	/***** Request timings *****/
+
+	TEST_METHOD(70) {
+		set_test_name("The phases of sampled requests are timed");
+
+		options.setUint("request_timing_sample_rate", 1);
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+		readPeerRequestHeader();
+		// Time spent in the app.
+		syscalls::usleep(50000);
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello");
+		ensure(containsSubstring(readResponseBody(), "\r\n\r\nhello"));
+
+		Json::Value doc;
+		EVENTUALLY(5,
+			doc = inspectStateAsJson();
+			result = doc["request_timings"]["total"]["count"].asUInt() == 1;
+		);
+		Json::Value timings = doc["request_timings"];
+		ensure_equals(timings["sample_rate"].asUInt(), 1u);
+		ensure_equals(timings["initialization"]["count"].asUInt(), 1u);
+		ensure_equals(timings["checkout"]["count"].asUInt(), 1u);
+		ensure_equals(timings["send_request_header"]["count"].asUInt(), 1u);
+		ensure_equals(timings["app"]["count"].asUInt(), 1u);
+		ensure_equals(timings["response"]["count"].asUInt(), 1u);
+		ensure("The app phase includes the time spent in the app",
+			timings["app"]["max"]["microseconds"].asUInt64() >= 50000);
+		ensure("The other phases don't",
+			timings["response"]["max"]["microseconds"].asUInt64() < 50000);
+		ensure(timings["total"]["max"]["microseconds"].asUInt64() >= 50000);
+	}
+
+	TEST_METHOD(71) {
+		set_test_name("Requests are not timed if the sample rate is 0");
+
+		init();
+		useTestSessionObject();
+
+		connectToServer();
+		sendRequest(
+			"GET /hello HTTP/1.1\r\n"
+			"Host: localhost\r\n"
+			"Connection: close\r\n"
+			"\r\n");
+		waitUntilSessionInitiated();
+		readPeerRequestHeader();
+		sendPeerResponse(
+			"HTTP/1.1 200 OK\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello");
+		readResponseBody();
+
+		Json::Value doc = inspectStateAsJson();
+		ensure(!doc.isMember("request_timings"));
+		ensure(!doc.isMember("event_loop_lag"));
+	}
+
+	TEST_METHOD(72) {
+		set_test_name("Event loop iterations that block are recorded as event loop lag");
+
+		options.setUint("request_timing_sample_rate", 1);
+		init();
+
+		bg.safe->runSync(boost::bind(&Core_ControllerTest::blockEventLoop, this, 50));
+		// Let the blocked iteration end.
+		bg.safe->runSync(boost::bind(&Core_ControllerTest::blockEventLoop, this, 0));
+
+		Json::Value lag = inspectStateAsJson()["event_loop_lag"];
+		ensure(lag["count"].asUInt() >= 1);
+		ensure(lag["max"]["microseconds"].asUInt64() >= 50000);
+	}
 }
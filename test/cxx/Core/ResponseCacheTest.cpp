@@ -64,6 +64,7 @@ namespace tut {
 			req.hasPragmaHeader = false;
 			req.host = createHostString();
 			req.bodyBytesBuffered = 0;
+			req.acceptedEncoding = ResponseCompressor::IDENTITY;
 			req.cacheKey = HashedStaticString();
 			req.cacheControl = NULL;
 			req.varyCookie = NULL;
@@ -0,0 +1,328 @@
+#include <TestSupport.h>
+#include <cstdlib>
+#include <zlib.h>
+#include <MemoryKit/palloc.h>
+#include <Core/Controller/Request.h>
+#include <Core/Controller/AppResponse.h>
+#include <Core/ResponseCompression.h>
+
+using namespace Passenger;
+using namespace Passenger::Core;
+using namespace Passenger::ServerKit;
+using namespace std;
+
+namespace tut {
+	typedef ResponseCompression<Request> ResponseCompressionType;
+
+	struct Core_ResponseCompressionTest {
+		ResponseCompressionType compression;
+		Request req;
+
+		Core_ResponseCompressionTest()
+			: compression(true, 6, 10, "text/html, application/json,image/*")
+		{
+			req.pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+			req.headers.clear();
+			req.acceptedEncoding = ResponseCompressor::GZIP;
+			req.dechunkResponse = false;
+			req.appResponse.headers.clear();
+			req.appResponse.statusCode = 200;
+			req.appResponse.bodyType = AppResponse::RBT_CONTENT_LENGTH;
+			req.appResponse.aux.bodyInfo.contentLength = 1000;
+			insertAppResponseHeader("content-type", "text/html; charset=utf-8");
+		}
+
+		~Core_ResponseCompressionTest() {
+			psg_destroy_pool(req.pool);
+		}
+
+		void insertHeader(HeaderTable &table, const HashedStaticString &key,
+			const StaticString &val)
+		{
+			Header *header = (Header *) psg_palloc(req.pool, sizeof(Header));
+			psg_lstr_init(&header->key);
+			psg_lstr_init(&header->origKey);
+			psg_lstr_init(&header->val);
+			psg_lstr_append(&header->key, req.pool, key.data(), key.size());
+			psg_lstr_append(&header->origKey, req.pool, key.data(), key.size());
+			psg_lstr_append(&header->val, req.pool, val.data(), val.size());
+			header->hash = key.hash();
+			table.insert(&header, req.pool);
+		}
+
+		void insertAppResponseHeader(const HashedStaticString &key, const StaticString &val) {
+			insertHeader(req.appResponse.headers, key, val);
+		}
+
+		string appResponseHeader(const HashedStaticString &key) {
+			const LString *value = req.appResponse.headers.lookup(key);
+			if (value == NULL) {
+				return "(null)";
+			} else {
+				value = psg_lstr_make_contiguous(value, req.pool);
+				return string(value->start->data, value->size);
+			}
+		}
+
+		// The default output buffer is small in order to exercise the
+		// 'more output pending' case.
+		string compress(ResponseCompressor &compressor, const string &data,
+			size_t bufsize = 64)
+		{
+			string result;
+			const char *input = data.data();
+			size_t inputSize = data.size();
+			vector<char> buf(bufsize);
+			bool done = false;
+
+			while (!done) {
+				size_t size = compressor.compress(input, inputSize, &buf[0], bufsize,
+					Z_FINISH, done);
+				result.append(&buf[0], size);
+			}
+			return result;
+		}
+
+		string decompress(const string &data, int windowBits) {
+			z_stream stream;
+			string result;
+			char buf[1024];
+			int ret;
+
+			memset(&stream, 0, sizeof(stream));
+			ensure_equals(inflateInit2(&stream, windowBits), Z_OK);
+			stream.next_in = (Bytef *) data.data();
+			stream.avail_in = data.size();
+			do {
+				stream.next_out = (Bytef *) buf;
+				stream.avail_out = sizeof(buf);
+				ret = inflate(&stream, Z_NO_FLUSH);
+				ensure("Valid compressed data", ret == Z_OK || ret == Z_STREAM_END);
+				result.append(buf, sizeof(buf) - stream.avail_out);
+			} while (ret != Z_STREAM_END);
+			inflateEnd(&stream);
+			return result;
+		}
+
+		string createHtml(unsigned int size) {
+			string result = "<!DOCTYPE html>\n<html><body><ul>\n";
+			unsigned int i = 0;
+			while (result.size() < size) {
+				result.append("<li class=\"item\"><a href=\"/items/");
+				result.append(toString(i));
+				result.append("\">Item ");
+				result.append(toString(i * 7919 % 10007));
+				result.append("</a></li>\n");
+				i++;
+			}
+			result.resize(size);
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(Core_ResponseCompressionTest);
+
+
+	/***** Negotiation *****/
+
+	TEST_METHOD(1) {
+		set_test_name("Accept-Encoding negotiation");
+		ensure_equals(ResponseCompressionType::negotiate(""), ResponseCompressor::IDENTITY);
+		ensure_equals(ResponseCompressionType::negotiate("br"), ResponseCompressor::IDENTITY);
+		ensure_equals(ResponseCompressionType::negotiate("gzip"), ResponseCompressor::GZIP);
+		ensure_equals(ResponseCompressionType::negotiate("x-gzip"), ResponseCompressor::GZIP);
+		ensure_equals(ResponseCompressionType::negotiate("deflate"), ResponseCompressor::DEFLATE);
+		ensure_equals("gzip is preferred",
+			ResponseCompressionType::negotiate("deflate, gzip"), ResponseCompressor::GZIP);
+		ensure_equals("Codings are case-insensitive",
+			ResponseCompressionType::negotiate("br, GZip;q=0.8"), ResponseCompressor::GZIP);
+		ensure_equals(ResponseCompressionType::negotiate("*"), ResponseCompressor::GZIP);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Codings with a quality of zero are refused");
+		ensure_equals(ResponseCompressionType::negotiate("gzip;q=0"),
+			ResponseCompressor::IDENTITY);
+		ensure_equals(ResponseCompressionType::negotiate("gzip; q=0.000, deflate"),
+			ResponseCompressor::DEFLATE);
+		ensure_equals(ResponseCompressionType::negotiate("*, gzip;q=0"),
+			ResponseCompressor::DEFLATE);
+		ensure_equals(ResponseCompressionType::negotiate("deflate, *;q=0"),
+			ResponseCompressor::DEFLATE);
+		ensure_equals(ResponseCompressionType::negotiate("gzip;q=0.001"),
+			ResponseCompressor::GZIP);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Content type matching");
+		ensure(compression.contentTypeAllowed("text/html"));
+		ensure(compression.contentTypeAllowed("Text/HTML; charset=utf-8"));
+		ensure(compression.contentTypeAllowed("application/json"));
+		ensure(compression.contentTypeAllowed("image/svg+xml"));
+		ensure(!compression.contentTypeAllowed("text/plain"));
+		ensure(!compression.contentTypeAllowed("text/htmlx"));
+		ensure(!compression.contentTypeAllowed("image/"));
+		ensure(!compression.contentTypeAllowed(""));
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Compression levels outside 1-9 are rejected");
+		try {
+			ResponseCompressionType c(true, 10);
+			fail("ArgumentException expected");
+		} catch (const ArgumentException &) {
+			// Pass.
+		}
+	}
+
+
+	/***** Response eligibility *****/
+
+	TEST_METHOD(10) {
+		set_test_name("Eligible responses");
+		ensure(compression.responseAllowsCompression(&req));
+		req.appResponse.bodyType = AppResponse::RBT_CHUNKED;
+		ensure("Responses of unknown size", compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(11) {
+		set_test_name("Clients that do not accept a supported coding");
+		req.acceptedEncoding = ResponseCompressor::IDENTITY;
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("Responses smaller than the minimum size");
+		req.appResponse.aux.bodyInfo.contentLength = 9;
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(13) {
+		set_test_name("Responses without a body, and partial responses");
+		req.appResponse.bodyType = AppResponse::RBT_NO_BODY;
+		ensure(!compression.responseAllowsCompression(&req));
+		req.appResponse.bodyType = AppResponse::RBT_CONTENT_LENGTH;
+		req.appResponse.statusCode = 206;
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(14) {
+		set_test_name("Responses that are already encoded");
+		insertAppResponseHeader("content-encoding", "br");
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(15) {
+		set_test_name("Responses with Cache-Control: no-transform");
+		insertAppResponseHeader("cache-control", "public, no-transform");
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(16) {
+		set_test_name("Responses without an allowed content type");
+		req.appResponse.headers.clear();
+		ensure(!compression.responseAllowsCompression(&req));
+		insertAppResponseHeader("content-type", "application/octet-stream");
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+	TEST_METHOD(17) {
+		set_test_name("Responses to requests that must be dechunked");
+		req.dechunkResponse = true;
+		ensure(!compression.responseAllowsCompression(&req));
+		req.appResponse.bodyType = AppResponse::RBT_CHUNKED;
+		ensure(!compression.responseAllowsCompression(&req));
+	}
+
+
+	/***** Response headers *****/
+
+	TEST_METHOD(20) {
+		set_test_name("Content-Encoding and Vary are set");
+		compression.prepareResponseHeaders(&req);
+		ensure_equals(appResponseHeader("content-encoding"), "gzip");
+		ensure_equals(appResponseHeader("vary"), "Accept-Encoding");
+	}
+
+	TEST_METHOD(21) {
+		set_test_name("An existing Vary header is extended");
+		insertAppResponseHeader("vary", "Cookie");
+		req.acceptedEncoding = ResponseCompressor::DEFLATE;
+		compression.prepareResponseHeaders(&req);
+		ensure_equals(appResponseHeader("content-encoding"), "deflate");
+		ensure_equals(appResponseHeader("vary"), "Cookie,Accept-Encoding");
+	}
+
+	TEST_METHOD(22) {
+		set_test_name("Strong ETags are weakened, weak ETags are kept");
+		insertAppResponseHeader("etag", "\"abc\"");
+		compression.prepareResponseHeaders(&req);
+		ensure_equals(appResponseHeader("etag"), "W/\"abc\"");
+
+		req.appResponse.headers.clear();
+		insertAppResponseHeader("etag", "W/\"def\"");
+		compression.prepareResponseHeaders(&req);
+		ensure_equals(appResponseHeader("etag"), "W/\"def\"");
+	}
+
+
+	/***** Compressor *****/
+
+	TEST_METHOD(30) {
+		set_test_name("gzip and deflate output can be decompressed");
+		string html = createHtml(20000);
+		ResponseCompressor compressor;
+
+		compressor.reset(ResponseCompressor::GZIP, 6);
+		string gzipped = compress(compressor, html);
+		ensure(gzipped.size() < html.size() / 2);
+		ensure_equals("gzip magic", (unsigned char) gzipped[0], 0x1f);
+		ensure_equals(decompress(gzipped, 15 + 16), html);
+
+		compressor.reset(ResponseCompressor::DEFLATE, 6);
+		string deflated = compress(compressor, html);
+		ensure_equals(decompress(deflated, 15), html);
+	}
+
+	TEST_METHOD(31) {
+		set_test_name("Compressors can be reused");
+		ResponseCompressor compressor;
+		compressor.reset(ResponseCompressor::GZIP, 1);
+		// Abandon a stream halfway.
+		const char *input = "hello";
+		size_t inputSize = 5;
+		char buf[64];
+		bool done;
+		compressor.compress(input, inputSize, buf, sizeof(buf), Z_NO_FLUSH, done);
+		ensure(done);
+		ensure_equals(inputSize, 0u);
+
+		compressor.reset(ResponseCompressor::GZIP, 1);
+		ensure_equals(decompress(compress(compressor, "world"), 15 + 16), "world");
+	}
+
+	TEST_METHOD(32) {
+		set_test_name("Sync flushing makes all data so far decompressible");
+		ResponseCompressor compressor;
+		compressor.reset(ResponseCompressor::DEFLATE, 6);
+		const char *input = "streamed data";
+		size_t inputSize = strlen(input);
+		char buf[128];
+		bool done;
+		size_t size = compressor.compress(input, inputSize, buf, sizeof(buf),
+			Z_SYNC_FLUSH, done);
+		ensure(done);
+
+		z_stream stream;
+		char out[128];
+		memset(&stream, 0, sizeof(stream));
+		ensure_equals(inflateInit(&stream), Z_OK);
+		stream.next_in = (Bytef *) buf;
+		stream.avail_in = size;
+		stream.next_out = (Bytef *) out;
+		stream.avail_out = sizeof(out);
+		ensure_equals(inflate(&stream, Z_SYNC_FLUSH), Z_OK);
+		ensure_equals(string(out, sizeof(out) - stream.avail_out), "streamed data");
+		inflateEnd(&stream);
+	}
+}
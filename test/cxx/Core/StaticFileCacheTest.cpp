@@ -0,0 +1,269 @@
+#include <TestSupport.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <Core/StaticFileCache.h>
+#include <Utils/CachedFileStat.hpp>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct Core_StaticFileCacheTest {
+		TempDir tmpdir;
+		CachedFileStat cstat;
+		StaticFileCache cache;
+		boost::uint64_t begin, end;
+
+		Core_StaticFileCacheTest()
+			: tmpdir("tmp.static"),
+			  cache("tmp.static/", &cstat, 0),
+			  begin(0),
+			  end(0)
+		{
+			mkdir("tmp.static/assets", 0700);
+			mkdir("tmp.static/docs", 0700);
+			writeFile("tmp.static/robots.txt", "User-agent: *\n");
+			writeFile("tmp.static/about.html", "<h1>About</h1>");
+			writeFile("tmp.static/docs/index.html", "<h1>Docs</h1>");
+			writeFile("tmp.static/assets/app.css", "body {}");
+			writeFile("tmp.static/assets/app.css.gz", "gzipped");
+		}
+
+		StaticFileCache::RangeResult parseRange(const StaticString &range,
+			boost::uint64_t size)
+		{
+			begin = end = 12345;
+			return StaticFileCache::parseRange(range, size, begin, end);
+		}
+	};
+
+	DEFINE_TEST_GROUP(Core_StaticFileCacheTest);
+
+
+	/***** Lookups *****/
+
+	TEST_METHOD(1) {
+		set_test_name("A path that refers to a regular file maps to that file");
+		StaticFileCache::FilePtr file = cache.lookup("/robots.txt");
+		ensure(file != NULL);
+		ensure_equals(file->filename, "tmp.static/robots.txt");
+		ensure_equals(file->size, 14u);
+		ensure_equals(file->contentType, "text/plain");
+		ensure(file->fd != -1);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("A path that refers to a directory maps to its index.html");
+		bool redirect = true;
+		StaticFileCache::FilePtr file = cache.lookup("/docs/", &redirect);
+		ensure(file != NULL);
+		ensure_equals(file->filename, "tmp.static/docs/index.html");
+		ensure(!redirect);
+		ensure("A directory without index.html", cache.lookup("/assets/") == NULL);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("A nonexistent path maps to <path>.html, if it exists");
+		StaticFileCache::FilePtr file = cache.lookup("/about");
+		ensure(file != NULL);
+		ensure_equals(file->filename, "tmp.static/about.html");
+		ensure(cache.lookup("/contact") == NULL);
+		ensure(cache.lookup("/about/") == NULL);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Paths are percent-decoded");
+		writeFile("tmp.static/hello world.txt", "hi");
+		StaticFileCache::FilePtr file = cache.lookup("/hello%20world.txt");
+		ensure(file != NULL);
+		ensure_equals(file->filename, "tmp.static/hello world.txt");
+		ensure("Invalid escape", cache.lookup("/robots%2.txt") == NULL);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Paths outside the document root, or with NUL bytes, are rejected");
+		writeFile("tmp.secret", "secret");
+		ensure(cache.lookup("/../tmp.secret") == NULL);
+		ensure(cache.lookup("/%2e%2e/tmp.secret") == NULL);
+		ensure(cache.lookup("/docs/../../tmp.secret") == NULL);
+		ensure(cache.lookup("/robots.txt%00.html") == NULL);
+		ensure(cache.lookup("robots.txt") == NULL);
+		unlink("tmp.secret");
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("Unchanged files are served from the same open file descriptor");
+		StaticFileCache::FilePtr file = cache.lookup("/robots.txt");
+		ensure(cache.lookup("/robots.txt") == file);
+		ensure_equals(cache.size(), 1u);
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("Changed files are reopened, while old references stay valid");
+		StaticFileCache::FilePtr file = cache.lookup("/robots.txt");
+		writeFile("tmp.static/robots.txt.new", "Disallow: /\n");
+		rename("tmp.static/robots.txt.new", "tmp.static/robots.txt");
+
+		StaticFileCache::FilePtr file2 = cache.lookup("/robots.txt");
+		ensure(file2 != NULL);
+		ensure(file2 != file);
+		ensure_equals(file2->size, 12u);
+
+		char buf[32];
+		ensure_equals(pread(file->fd, buf, sizeof(buf), 0), (ssize_t) 14);
+		ensure_equals(StaticString(buf, 14), "User-agent: *\n");
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("Deleted files are no longer served");
+		ensure(cache.lookup("/robots.txt") != NULL);
+		unlink("tmp.static/robots.txt");
+		ensure(cache.lookup("/robots.txt") == NULL);
+	}
+
+	TEST_METHOD(9) {
+		set_test_name("The cache is cleared once it reaches its maximum size");
+		StaticFileCache smallCache("tmp.static", &cstat, 0, 2);
+		StaticFileCache::FilePtr file = smallCache.lookup("/robots.txt");
+		smallCache.lookup("/about.html");
+		ensure_equals(smallCache.size(), 2u);
+		smallCache.lookup("/docs/");
+		ensure_equals(smallCache.size(), 1u);
+		ensure("Files in use stay open", fcntl(file->fd, F_GETFD) != -1);
+	}
+
+	TEST_METHOD(10) {
+		set_test_name("lookupPrecompressed() finds <filename>.gz");
+		StaticFileCache::FilePtr file = cache.lookup("/assets/app.css");
+		StaticFileCache::FilePtr gzFile = cache.lookupPrecompressed(*file);
+		ensure(gzFile != NULL);
+		ensure_equals(gzFile->filename, "tmp.static/assets/app.css.gz");
+		ensure(cache.lookupPrecompressed(*cache.lookup("/robots.txt")) == NULL);
+	}
+
+	TEST_METHOD(11) {
+		set_test_name("A directory path without a trailing slash asks for a redirect");
+		bool redirect = false;
+		ensure(cache.lookup("/docs", &redirect) == NULL);
+		ensure(redirect);
+		ensure("A directory without index.html is left to the app",
+			cache.lookup("/assets", &redirect) == NULL);
+		ensure(!redirect);
+		ensure(cache.lookup("/docs") == NULL);
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("Symlinks to files outside the document root are not followed");
+		writeFile("tmp.secret", "secret");
+		ensure_equals(symlink("../tmp.secret", "tmp.static/secret.txt"), 0);
+		ensure_equals(symlink("..", "tmp.static/parent"), 0);
+		ensure(cache.lookup("/secret.txt") == NULL);
+		ensure(cache.lookup("/secret") == NULL);
+		ensure(cache.lookup("/parent/tmp.secret") == NULL);
+		unlink("tmp.secret");
+	}
+
+	TEST_METHOD(13) {
+		set_test_name("Symlinks within the document root are followed");
+		ensure_equals(symlink("robots.txt", "tmp.static/robots2.txt"), 0);
+		ensure_equals(symlink("docs", "tmp.static/docs2"), 0);
+		StaticFileCache::FilePtr file = cache.lookup("/robots2.txt");
+		ensure(file != NULL);
+		ensure_equals(file->filename, "tmp.static/robots2.txt");
+		ensure(cache.lookup("/docs2/") != NULL);
+	}
+
+
+	/***** Headers *****/
+
+	TEST_METHOD(20) {
+		set_test_name("Content types are determined by extension");
+		ensure_equals(StaticFileCache::getContentType("foo/bar.CSS"), "text/css");
+		ensure_equals(StaticFileCache::getContentType("a.min.js"), "application/javascript");
+		ensure_equals(StaticFileCache::getContentType("logo.svg"), "image/svg+xml");
+		ensure_equals(StaticFileCache::getContentType("font.woff2"), "font/woff2");
+		ensure_equals(StaticFileCache::getContentType("README"), "application/octet-stream");
+		ensure_equals(StaticFileCache::getContentType("foo.d/README"), "application/octet-stream");
+		ensure_equals(StaticFileCache::getContentType("foo.exe"), "application/octet-stream");
+	}
+
+	TEST_METHOD(21) {
+		set_test_name("ETag and Last-Modified are based on the modification time and size");
+		touchFile("tmp.static/robots.txt", 784111777);
+		StaticFileCache::FilePtr file = cache.lookup("/robots.txt");
+		ensure_equals(file->getEtag(), "\"2ebc98a1-e\"");
+		ensure_equals(file->getLastModified(), "Sun, 06 Nov 1994 08:49:37 GMT");
+	}
+
+	TEST_METHOD(22) {
+		set_test_name("If-None-Match uses weak comparison and supports lists and '*'");
+		StaticString etag = "\"2ebc98a1-e\"";
+		ensure(StaticFileCache::etagMatches("\"2ebc98a1-e\"", etag));
+		ensure(StaticFileCache::etagMatches("W/\"2ebc98a1-e\"", etag));
+		ensure(StaticFileCache::etagMatches("\"foo\", \"2ebc98a1-e\" ", etag));
+		ensure(StaticFileCache::etagMatches("*", etag));
+		ensure(!StaticFileCache::etagMatches("\"foo\"", etag));
+		ensure(!StaticFileCache::etagMatches("", etag));
+	}
+
+	TEST_METHOD(23) {
+		set_test_name("If-Modified-Since");
+		ensure(!StaticFileCache::modifiedSince("Sun, 06 Nov 1994 08:49:37 GMT", 784111777));
+		ensure(!StaticFileCache::modifiedSince("Sun, 06 Nov 1994 08:49:38 GMT", 784111777));
+		ensure(StaticFileCache::modifiedSince("Sun, 06 Nov 1994 08:49:36 GMT", 784111777));
+		ensure("Invalid dates", StaticFileCache::modifiedSince("yesterday", 784111777));
+	}
+
+	TEST_METHOD(24) {
+		set_test_name("If-Range requires an exact ETag or Last-Modified match");
+		touchFile("tmp.static/robots.txt", 784111777);
+		StaticFileCache::FilePtr file = cache.lookup("/robots.txt");
+		ensure(StaticFileCache::ifRangeMatches("\"2ebc98a1-e\"", *file));
+		ensure(StaticFileCache::ifRangeMatches("Sun, 06 Nov 1994 08:49:37 GMT", *file));
+		ensure(!StaticFileCache::ifRangeMatches("W/\"2ebc98a1-e\"", *file));
+		ensure(!StaticFileCache::ifRangeMatches("Sun, 06 Nov 1994 08:49:38 GMT", *file));
+	}
+
+	TEST_METHOD(25) {
+		set_test_name("Single byte ranges");
+		ensure_equals(parseRange("bytes=0-9", 100), StaticFileCache::SATISFIABLE_RANGE);
+		ensure_equals(begin, 0u);
+		ensure_equals(end, 10u);
+
+		ensure_equals(parseRange("bytes=90-", 100), StaticFileCache::SATISFIABLE_RANGE);
+		ensure_equals(begin, 90u);
+		ensure_equals(end, 100u);
+
+		ensure_equals(parseRange("bytes=-10", 100), StaticFileCache::SATISFIABLE_RANGE);
+		ensure_equals(begin, 90u);
+		ensure_equals(end, 100u);
+
+		ensure_equals("Ranges are truncated to the file size",
+			parseRange("bytes=50-1000", 100), StaticFileCache::SATISFIABLE_RANGE);
+		ensure_equals(end, 100u);
+		ensure_equals(parseRange("bytes=-1000", 100), StaticFileCache::SATISFIABLE_RANGE);
+		ensure_equals(begin, 0u);
+	}
+
+	TEST_METHOD(26) {
+		set_test_name("Unsatisfiable, invalid and multiple ranges");
+		ensure_equals(parseRange("bytes=100-", 100), StaticFileCache::UNSATISFIABLE_RANGE);
+		ensure_equals(parseRange("bytes=-0", 100), StaticFileCache::UNSATISFIABLE_RANGE);
+		ensure_equals(parseRange("bytes=9-0", 100), StaticFileCache::NO_RANGE);
+		ensure_equals(parseRange("bytes=a-b", 100), StaticFileCache::NO_RANGE);
+		ensure_equals(parseRange("items=0-9", 100), StaticFileCache::NO_RANGE);
+		ensure_equals(parseRange("bytes=0-9,20-29", 100), StaticFileCache::NO_RANGE);
+	}
+
+	TEST_METHOD(27) {
+		set_test_name("Fingerprinted assets are recognized");
+		ensure(StaticFileCache::isFingerprintedAsset(
+			"/assets/application-0123456789abcdef0123456789abcdef.css"));
+		ensure(StaticFileCache::isFingerprintedAsset(
+			"/assets/admin/app-0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef.js"));
+		ensure(!StaticFileCache::isFingerprintedAsset("/assets/application.css"));
+		ensure(!StaticFileCache::isFingerprintedAsset("/assets/jquery-1.2.3.js"));
+		ensure(!StaticFileCache::isFingerprintedAsset(
+			"/images/application-0123456789abcdef0123456789abcdef.css"));
+	}
+}
@@ -0,0 +1,145 @@
+#include <TestSupport.h>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <Logging.h>
+#include <Utils/StrIntUtils.h>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct LoggingTest {
+		int oldStderr;
+
+		LoggingTest() {
+			// Log entries go to stderr, so redirect it to a file.
+			int fd = open("tmp.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			oldStderr = dup(STDERR_FILENO);
+			dup2(fd, STDERR_FILENO);
+			close(fd);
+		}
+
+		~LoggingTest() {
+			stopAsyncLogging();
+			dup2(oldStderr, STDERR_FILENO);
+			close(oldStderr);
+			unlink("tmp.log");
+		}
+
+		static void logLines(const string &prefix, unsigned int n) {
+			for (unsigned int i = 0; i < n; i++) {
+				P_WARN(prefix << i);
+			}
+		}
+
+		vector<string> readLogLines() {
+			vector<string> lines;
+			split(readAll("tmp.log"), '\n', lines);
+			if (!lines.empty() && lines.back().empty()) {
+				lines.pop_back();
+			}
+			return lines;
+		}
+
+		unsigned int countLinesContaining(const vector<string> &lines, const string &str) {
+			unsigned int result = 0;
+			for (unsigned int i = 0; i < lines.size(); i++) {
+				if (lines[i].find(str) != string::npos) {
+					result++;
+				}
+			}
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(LoggingTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Log entries of a thread are written in order");
+		ensure(startAsyncLogging());
+		logLines("line ", 100);
+		flushAsyncLogging();
+
+		vector<string> lines = readLogLines();
+		ensure_equals(lines.size(), 100u);
+		for (unsigned int i = 0; i < lines.size(); i++) {
+			ensure(containsSubstring(lines[i], "line " + toString(i)));
+		}
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Errors are written after the entries that were buffered before them");
+		ensure(startAsyncLogging());
+		P_WARN("warning");
+		P_ERROR("error");
+
+		vector<string> lines = readLogLines();
+		ensure_equals(lines.size(), 2u);
+		ensure(containsSubstring(lines[0], "warning"));
+		ensure(containsSubstring(lines[1], "error"));
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Entries are dropped and counted if a thread's buffer is full");
+		unsigned long long droppedBefore = getAsyncLoggingDroppedMessages();
+		// The smallest buffer fits about 10 entries.
+		ensure(startAsyncLogging(1024));
+		logLines(string(80, 'x') + " ", 1000);
+		stopAsyncLogging();
+
+		unsigned long long dropped = getAsyncLoggingDroppedMessages() - droppedBefore;
+		vector<string> lines = readLogLines();
+		unsigned int written = countLinesContaining(lines, string(80, 'x'));
+		ensure("Some entries are dropped", dropped > 0);
+		ensure_equals(written + dropped, 1000u);
+		ensure("The number of dropped entries is logged",
+			countLinesContaining(lines, "log messages were dropped") > 0);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("stopAsyncLogging() writes all entries, including those of other threads");
+		ensure(startAsyncLogging());
+		boost::thread thr(boost::bind(logLines, "thread ", 50));
+		thr.join();
+		logLines("main ", 50);
+		stopAsyncLogging();
+		ensure(!asyncLoggingEnabled());
+
+		vector<string> lines = readLogLines();
+		ensure_equals(countLinesContaining(lines, "thread "), 50u);
+		ensure_equals(countLinesContaining(lines, "main "), 50u);
+
+		P_WARN("synchronous");
+		ensure(containsSubstring(readAll("tmp.log"), "synchronous"));
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("A forked child logs synchronously and doesn't write the parent's entries");
+		ensure(startAsyncLogging());
+		// This entry is probably still buffered when we fork.
+		P_WARN("parent");
+
+		pid_t pid = fork();
+		if (pid == 0) {
+			bool ok = !asyncLoggingEnabled();
+			P_WARN("child");
+			flushAsyncLogging();
+			_exit(ok ? 0 : 1);
+		}
+		ensure(pid != -1);
+		int status;
+		ensure_equals(waitpid(pid, &status, 0), pid);
+		ensure("Async logging is disabled in the child",
+			WIFEXITED(status) && WEXITSTATUS(status) == 0);
+		ensure(asyncLoggingEnabled());
+		stopAsyncLogging();
+
+		vector<string> lines = readLogLines();
+		ensure_equals(countLinesContaining(lines, "child"), 1u);
+		ensure_equals(countLinesContaining(lines, "parent"), 1u);
+	}
+}
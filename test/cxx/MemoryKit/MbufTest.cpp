@@ -2,6 +2,7 @@
 #include <boost/move/move.hpp>
 #include <Constants.h>
 #include <MemoryKit/mbuf.h>
+#include <vector>
 
 using namespace Passenger;
 using namespace Passenger::MemoryKit;
@@ -10,14 +11,84 @@ using namespace std;
 namespace tut {
 	struct MemoryKit_MbufTest {
 		struct mbuf_pool pool;
+		struct mbuf_pool smallPool, largePool;
 
 		MemoryKit_MbufTest() {
 			pool.mbuf_block_chunk_size = DEFAULT_MBUF_CHUNK_SIZE;
 			mbuf_pool_init(&pool);
+			smallPool.mbuf_block_chunk_size = SMALL_MBUF_CHUNK_SIZE;
+			mbuf_pool_init(&smallPool);
+			largePool.mbuf_block_chunk_size = XLARGE_MBUF_CHUNK_SIZE;
+			mbuf_pool_init(&largePool);
 		}
 
 		~MemoryKit_MbufTest() {
 			mbuf_pool_deinit(&pool);
+			mbuf_pool_deinit(&smallPool);
+			mbuf_pool_deinit(&largePool);
+		}
+
+		void linkSizeClasses() {
+			mbuf_pool_link_size_classes(&smallPool, &pool);
+			mbuf_pool_link_size_classes(&pool, &largePool);
+		}
+
+		size_t poolMemory() const {
+			return (smallPool.nfree_mbuf_blockq + smallPool.nactive_mbuf_blockq)
+					* smallPool.mbuf_block_chunk_size
+				+ (pool.nfree_mbuf_blockq + pool.nactive_mbuf_blockq)
+					* pool.mbuf_block_chunk_size
+				+ (largePool.nfree_mbuf_blockq + largePool.nactive_mbuf_blockq)
+					* largePool.mbuf_block_chunk_size;
+		}
+
+		/**
+		 * A mix of clients that send small requests, and clients that upload
+		 * `uploadSize` bytes. With `sizeClasses`, each piece of data is read
+		 * into the smallest size class that fits it; otherwise everything is
+		 * read into the default size class. Returns the peak amount of memory
+		 * held by the pools.
+		 */
+		size_t runMixedWorkload(bool sizeClasses, unsigned int rounds,
+			unsigned int clients, size_t uploadSize)
+		{
+			vector<mbuf> buffers;
+			size_t peak = 0;
+
+			mbuf_pool_compact(&smallPool);
+			mbuf_pool_compact(&pool);
+			mbuf_pool_compact(&largePool);
+
+			for (unsigned int round = 0; round < rounds; round++) {
+				for (unsigned int i = 0; i < clients; i++) {
+					if (i % 10 == 0) {
+						size_t remaining = uploadSize;
+						while (remaining > 0) {
+							mbuf buffer(sizeClasses
+								? mbuf_get_at_least(&smallPool, remaining)
+								: mbuf_get(&pool));
+							size_t size = std::min(remaining, buffer.size());
+							memset(buffer.start, 'x', size);
+							buffers.push_back(mbuf(buffer, 0, size));
+							remaining -= size;
+						}
+					} else {
+						mbuf buffer(sizeClasses
+							? mbuf_get_at_least(&smallPool, 600)
+							: mbuf_get(&pool));
+						memset(buffer.start, 'x', 600);
+						buffers.push_back(mbuf(buffer, 0, 600));
+					}
+				}
+				peak = std::max(peak, poolMemory());
+				buffers.clear();
+				if (round % 4 == 3) {
+					mbuf_pool_trim(&smallPool);
+					mbuf_pool_trim(&pool);
+					mbuf_pool_trim(&largePool);
+				}
+			}
+			return peak;
 		}
 	};
 
@@ -264,4 +335,97 @@ namespace tut {
 		ensure_equals("(5)", pool.nfree_mbuf_blockq, 0u);
 		ensure_equals("(6)", pool.nactive_mbuf_blockq, 0u);
 	}
+
+	TEST_METHOD(24) {
+		set_test_name("mbuf_get_with_size() uses larger size classes before"
+			" falling back to standalone mbuf_blocks");
+		linkSizeClasses();
+		{
+			mbuf buffer(mbuf_get_with_size(&pool, mbuf_pool_data_size(&pool) + 10));
+			ensure_equals("(1)", buffer.size(), mbuf_pool_data_size(&pool) + 10);
+			ensure("(2)", buffer.mbuf_block->pool == &largePool);
+			ensure_equals("(3)", largePool.nactive_mbuf_blockq, 1u);
+			ensure_equals("(4)", pool.nactive_mbuf_blockq, 0u);
+
+			mbuf buffer2(mbuf_get_with_size(&pool, mbuf_pool_data_size(&largePool) + 1));
+			ensure("(5)", buffer2.mbuf_block->pool == &pool);
+			ensure("(6)", buffer2.mbuf_block->offset > 0);
+			ensure_equals("(7)", pool.nactive_mbuf_blockq, 1u);
+		}
+		ensure_equals("(8)", largePool.nfree_mbuf_blockq, 1u);
+		ensure_equals("(9)", largePool.nactive_mbuf_blockq, 0u);
+		ensure_equals("(10)", pool.nfree_mbuf_blockq, 0u);
+		ensure_equals("(11)", pool.nactive_mbuf_blockq, 0u);
+	}
+
+	TEST_METHOD(25) {
+		set_test_name("mbuf_get_at_least() picks the smallest size class that fits");
+		linkSizeClasses();
+		{
+			mbuf buffer(mbuf_get_at_least(&smallPool, 100));
+			ensure("(1)", buffer.mbuf_block->pool == &smallPool);
+			ensure_equals("(2)", buffer.size(), mbuf_pool_data_size(&smallPool));
+
+			mbuf buffer2(mbuf_get_at_least(&smallPool, mbuf_pool_data_size(&smallPool) + 1));
+			ensure("(3)", buffer2.mbuf_block->pool == &pool);
+			ensure_equals("(4)", buffer2.size(), mbuf_pool_data_size(&pool));
+
+			mbuf buffer3(mbuf_get_at_least(&pool, 1024 * 1024));
+			ensure("(5)", buffer3.mbuf_block->pool == &largePool);
+			ensure_equals("(6)", buffer3.size(), mbuf_pool_data_size(&largePool));
+		}
+		ensure_equals("(7)", smallPool.nfree_mbuf_blockq, 1u);
+		ensure_equals("(8)", pool.nfree_mbuf_blockq, 1u);
+		ensure_equals("(9)", largePool.nfree_mbuf_blockq, 1u);
+	}
+
+	TEST_METHOD(26) {
+		set_test_name("mbuf_pool_trim() releases half of the free mbuf_blocks"
+			" that were not needed since the previous trim");
+		vector<mbuf> buffers;
+		for (unsigned int i = 0; i < 10; i++) {
+			buffers.push_back(mbuf_get(&pool));
+		}
+		buffers.clear();
+		ensure_equals("(1)", pool.nfree_mbuf_blockq, 10u);
+		ensure_equals("Blocks that were just freed were needed",
+			mbuf_pool_trim(&pool), 0u);
+
+		for (unsigned int i = 0; i < 4; i++) {
+			buffers.push_back(mbuf_get(&pool));
+		}
+		buffers.clear();
+		ensure_equals("(2)", mbuf_pool_trim(&pool), 3u);
+		ensure_equals("(3)", pool.nfree_mbuf_blockq, 7u);
+		ensure_equals("(4)", mbuf_pool_trim(&pool), 4u);
+		ensure_equals("(5)", pool.nfree_mbuf_blockq, 3u);
+		ensure_equals("(6)", mbuf_pool_trim(&pool), 2u);
+		ensure_equals("(7)", mbuf_pool_trim(&pool), 1u);
+		ensure_equals("(8)", pool.nfree_mbuf_blockq, 0u);
+		ensure_equals("(9)", mbuf_pool_trim(&pool), 0u);
+		ensure_equals("(10)", pool.nfreed, 10u);
+	}
+
+	TEST_METHOD(27) {
+		set_test_name("Allocation counters");
+		{
+			mbuf buffer(mbuf_get(&pool));
+			mbuf buffer2(mbuf_get_with_size(&pool, mbuf_pool_data_size(&pool) + 1));
+		}
+		{
+			mbuf buffer(mbuf_get(&pool));
+		}
+		ensure_equals("(1)", pool.nget, 3u);
+		ensure_equals("(2)", pool.nmalloc, 2u);
+		ensure_equals("(3)", mbuf_pool_compact(&pool), 1u);
+		ensure_equals("(4)", pool.nfreed, 1u);
+	}
+
+	TEST_METHOD(28) {
+		set_test_name("Size classes use less memory under a mixed workload");
+		linkSizeClasses();
+		size_t withoutSizeClasses = runMixedWorkload(false, 4, 100, 256 * 1024);
+		size_t withSizeClasses = runMixedWorkload(true, 4, 100, 256 * 1024);
+		ensure(withSizeClasses < withoutSizeClasses);
+	}
 }
@@ -0,0 +1,215 @@
+#include <TestSupport.h>
+#include <BackgroundEventLoop.h>
+#include <SafeLibev.h>
+#include <Exceptions.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct SafeLibevTest {
+		BackgroundEventLoop bg;
+		boost::mutex syncher;
+		vector<int> log;
+		vector<unsigned int> iterations;
+		vector<unsigned int> ids;
+		unsigned int counter;
+		bool onLoopThread;
+
+		SafeLibevTest()
+			: bg(false, false),
+			  counter(0),
+			  onLoopThread(true)
+		{
+			bg.start();
+		}
+
+		~SafeLibevTest() {
+			bg.stop();
+		}
+
+		void append(int value) {
+			boost::lock_guard<boost::mutex> l(syncher);
+			log.push_back(value);
+			onLoopThread = onLoopThread && bg.safe->onEventLoopThread();
+			iterations.push_back(ev_iteration(bg.libev_loop));
+		}
+
+		void increment() {
+			counter++;
+		}
+
+		vector<int> getLog() {
+			boost::lock_guard<boost::mutex> l(syncher);
+			return log;
+		}
+
+		void scheduleAppends(int n) {
+			for (int i = 0; i < n; i++) {
+				ids.push_back(bg.safe->runLater(boost::bind(&SafeLibevTest::append, this, i)));
+			}
+		}
+
+		void cancelFromLoop(unsigned int index, bool *result) {
+			*result = bg.safe->cancelCommand(ids[index]);
+		}
+
+		void produce(unsigned int n) {
+			for (unsigned int i = 0; i < n; i++) {
+				bg.safe->runLater(boost::bind(&SafeLibevTest::increment, this));
+			}
+		}
+
+		void setMaxCommandsPerIteration(unsigned int value) {
+			bg.safe->setMaxCommandsPerIteration(value);
+		}
+
+		void sleep(unsigned int msec) {
+			usleep(msec * 1000);
+		}
+	};
+
+	DEFINE_TEST_GROUP(SafeLibevTest);
+
+	TEST_METHOD(1) {
+		set_test_name("runLater() runs callbacks in the event loop thread, in order");
+		scheduleAppends(100);
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		vector<int> log = getLog();
+		ensure_equals(log.size(), 100u);
+		for (int i = 0; i < 100; i++) {
+			ensure_equals(log[i], i);
+		}
+		ensure(onLoopThread);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("cancelCommand() returns false for callbacks that have already run");
+		bool result;
+		bg.safe->runSync(boost::bind(&SafeLibevTest::scheduleAppends, this, 3));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::cancelFromLoop, this, 1, &result));
+		ensure(!result);
+		ensure_equals(getLog().size(), 3u);
+		ensure(!bg.safe->cancelCommand(0));
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("cancelCommand() from the event loop thread prevents a pending callback from running");
+		struct Local {
+			static void scheduleAndCancel(SafeLibevTest *self, bool *result) {
+				self->scheduleAppends(3);
+				*result = self->bg.safe->cancelCommand(self->ids[1]);
+			}
+		};
+		bool result = false;
+		bg.safe->runSync(boost::bind(Local::scheduleAndCancel, this, &result));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		ensure(result);
+		vector<int> log = getLog();
+		ensure_equals(log.size(), 2u);
+		ensure_equals(log[0], 0);
+		ensure_equals(log[1], 2);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("cancelCommand() from within a callback in the same batch");
+		struct Local {
+			static void cancelLater(SafeLibevTest *self, bool *result) {
+				*result = self->bg.safe->cancelCommand(self->ids[2]);
+			}
+
+			static void schedule(SafeLibevTest *self, bool *result) {
+				self->scheduleAppends(1);
+				self->ids.push_back(self->bg.safe->runLater(
+					boost::bind(cancelLater, self, result)));
+				self->scheduleAppends(1);
+			}
+		};
+		bool result = false;
+		bg.safe->runSync(boost::bind(Local::schedule, this, &result));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		ensure(result);
+		ensure_equals(getLog().size(), 1u);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("cancelCommand() from another thread");
+		bg.safe->runLater(boost::bind(&SafeLibevTest::sleep, this, 100));
+		unsigned int id = bg.safe->runLater(boost::bind(&SafeLibevTest::append, this, 1));
+		ensure("The command is cancelled", bg.safe->cancelCommand(id));
+		ensure("The command cannot be cancelled twice", !bg.safe->cancelCommand(id));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		ensure_equals(getLog().size(), 0u);
+
+		id = bg.safe->runLater(boost::bind(&SafeLibevTest::append, this, 2));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		ensure("A command that has already run cannot be cancelled",
+			!bg.safe->cancelCommand(id));
+		ensure_equals(getLog().size(), 1u);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("setMaxCommandsPerIteration() spreads callbacks over multiple loop iterations");
+		bg.safe->runSync(boost::bind(&SafeLibevTest::setMaxCommandsPerIteration, this, 2));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::scheduleAppends, this, 5));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+
+		vector<int> log = getLog();
+		ensure_equals(log.size(), 5u);
+		for (int i = 0; i < 5; i++) {
+			ensure_equals(log[i], i);
+		}
+		ensure_equals(iterations[1], iterations[0]);
+		ensure(iterations[2] > iterations[1]);
+		ensure_equals(iterations[3], iterations[2]);
+		ensure(iterations[4] > iterations[3]);
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("Many threads can schedule callbacks concurrently");
+		const unsigned int nthreads = 16;
+		const unsigned int perThread = 20000;
+		boost::thread_group threads;
+
+		for (unsigned int i = 0; i < nthreads; i++) {
+			threads.create_thread(boost::bind(&SafeLibevTest::produce, this, perThread));
+		}
+		threads.join_all();
+		bg.safe->runSync(boost::bind(&SafeLibevTest::sleep, this, 0));
+		ensure_equals(counter, nthreads * perThread);
+	}
+
+	TEST_METHOD(8) {
+		set_test_name("cancelCommand() doesn't wait for the event loop");
+		bg.stop();
+		unsigned int id = bg.safe->runLater(boost::bind(&SafeLibevTest::increment, this));
+		ensure("The command is cancelled", bg.safe->cancelCommand(id));
+		ensure("The command cannot be cancelled twice", !bg.safe->cancelCommand(id));
+	}
+
+	TEST_METHOD(9) {
+		set_test_name("The rest of a batch is still run if a callback throws");
+		struct Local {
+			static void throwError() {
+				throw RuntimeException("oops");
+			}
+		};
+		SafeLibev safe(ev_loop_new(EVFLAG_AUTO));
+		safe.runLater(Local::throwError);
+		safe.runLater(boost::bind(&SafeLibevTest::increment, this));
+		try {
+			ev_run(safe.getLoop(), EVRUN_NOWAIT);
+			fail("RuntimeException expected");
+		} catch (const RuntimeException &) {
+			// Pass.
+		}
+		ensure_equals(counter, 0u);
+		ev_run(safe.getLoop(), EVRUN_NOWAIT);
+		ensure_equals(counter, 1u);
+	}
+
+}
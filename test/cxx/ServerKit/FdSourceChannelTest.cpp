@@ -0,0 +1,212 @@
+#include <TestSupport.h>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include <BackgroundEventLoop.h>
+#include <Constants.h>
+#include <FileDescriptor.h>
+#include <ServerKit/FdSourceChannel.h>
+#include <Utils/IOUtils.h>
+#include <Utils/StrIntUtils.h>
+
+using namespace Passenger;
+using namespace Passenger::ServerKit;
+using namespace Passenger::MemoryKit;
+using namespace std;
+
+namespace tut {
+	struct ServerKit_FdSourceChannelTest: public ServerKit::Hooks {
+		BackgroundEventLoop bg;
+		ServerKit::Context context;
+		FdSourceChannel channel;
+		FileDescriptor reader, writer;
+		boost::mutex syncher;
+		bool consumeAsynchronously;
+		string log;
+		unsigned int lastBufferSize;
+		boost::uint64_t bytesReceived;
+		size_t largestChunkSize;
+		bool corrupted;
+
+		ServerKit_FdSourceChannelTest()
+			: bg(false, true),
+			  context(bg.safe, bg.libuv_loop),
+			  channel(&context),
+			  consumeAsynchronously(false),
+			  lastBufferSize(0),
+			  bytesReceived(0),
+			  largestChunkSize(0),
+			  corrupted(false)
+		{
+			int fds[2];
+
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == -1) {
+				int e = errno;
+				throw SystemException("socketpair() failed", e);
+			}
+			reader.assign(fds[0], __FILE__, __LINE__);
+			writer.assign(fds[1], __FILE__, __LINE__);
+			setNonBlocking(reader);
+
+			channel.setDataCallback(dataCallback);
+			channel.setHooks(this);
+			Hooks::impl = NULL;
+			Hooks::userData = NULL;
+			channel.reinitialize(reader);
+			bg.start();
+			bg.safe->runSync(boost::bind(&FdSourceChannel::startReading, &channel));
+		}
+
+		~ServerKit_FdSourceChannelTest() {
+			bg.safe->runSync(boost::bind(&FdSourceChannel::deinitialize, &channel));
+			bg.stop();
+		}
+
+		static Channel::Result dataCallback(Channel *_channel, const mbuf &buffer, int errcode) {
+			FdSourceChannel *channel = reinterpret_cast<FdSourceChannel *>(_channel);
+			ServerKit_FdSourceChannelTest *self = (ServerKit_FdSourceChannelTest *)
+				channel->getHooks();
+			boost::lock_guard<boost::mutex> l(self->syncher);
+
+			if (errcode != 0) {
+				self->log.append("Error: " + toString(errcode) + "\n");
+			} else if (buffer.empty()) {
+				self->log.append("EOF\n");
+			} else {
+				unsigned int expected = self->bytesReceived % 251;
+				for (unsigned int i = 0; i < buffer.size(); i++) {
+					if ((unsigned char) buffer.start[i] != expected) {
+						self->corrupted = true;
+					}
+					expected = (expected == 250) ? 0 : expected + 1;
+				}
+				self->bytesReceived += buffer.size();
+				self->lastBufferSize = buffer.size();
+				self->largestChunkSize = std::max(self->largestChunkSize,
+					buffer.mbuf_block->pool->mbuf_block_chunk_size);
+			}
+
+			if (self->consumeAsynchronously) {
+				return Channel::Result(-1, false);
+			} else {
+				return Channel::Result(buffer.size(), false);
+			}
+		}
+
+		/** Writes `size` bytes of a pattern that dataCallback() checks. */
+		static void writePattern(int fd, size_t size) {
+			// A multiple of the pattern's period.
+			char buffer[251 * 256];
+			size_t written = 0;
+
+			for (size_t i = 0; i < sizeof(buffer); i++) {
+				buffer[i] = i % 251;
+			}
+			while (written < size) {
+				size_t n = std::min(size - written, sizeof(buffer));
+				writeExact(fd, buffer, n);
+				written += n;
+			}
+		}
+
+		boost::uint64_t getBytesReceived() {
+			boost::lock_guard<boost::mutex> l(syncher);
+			return bytesReceived;
+		}
+
+		void consumeLastBufferIfWaiting() {
+			boost::lock_guard<boost::mutex> l(syncher);
+			if (channel.getState() == Channel::WAITING_FOR_CALLBACK) {
+				channel.consumed(lastBufferSize, false);
+			}
+		}
+
+		void getActiveBlocks(unsigned int *result) {
+			*result = context.small_mbuf_pool.nactive_mbuf_blockq
+				+ context.mbuf_pool.nactive_mbuf_blockq
+				+ context.large_mbuf_pool.nactive_mbuf_blockq
+				+ context.xlarge_mbuf_pool.nactive_mbuf_blockq;
+		}
+
+		unsigned int getActiveBlocks() {
+			unsigned int result;
+			bg.safe->runSync(boost::bind(&ServerKit_FdSourceChannelTest::getActiveBlocks,
+				this, &result));
+			return result;
+		}
+	};
+
+	DEFINE_TEST_GROUP(ServerKit_FdSourceChannelTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Small reads are copied into the smallest size class that fits,"
+			" and do not pin any buffer afterwards");
+		writePattern(writer, 100);
+		EVENTUALLY(5,
+			result = getBytesReceived() == 100;
+		);
+		ensure(!corrupted);
+		ensure_equals(largestChunkSize, (size_t) SMALL_MBUF_CHUNK_SIZE);
+		ensure_equals(getActiveBlocks(), 0u);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Bulk data is read with readv() into increasingly large buffers");
+		boost::uint64_t size = 8 * 1024 * 1024;
+		boost::thread thr(boost::bind(writePattern, (int) writer, size));
+		EVENTUALLY(10,
+			result = getBytesReceived() == size;
+		);
+		thr.join();
+		ensure(!corrupted);
+		ensure_equals(largestChunkSize, (size_t) XLARGE_MBUF_CHUNK_SIZE);
+		ensure_equals(getActiveBlocks(), 0u);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Buffers that were read while the consumer was busy are fed,"
+			" in order, once it is done");
+		boost::uint64_t size = 2 * 1024 * 1024;
+		consumeAsynchronously = true;
+		boost::thread thr(boost::bind(writePattern, (int) writer, size));
+		EVENTUALLY(10,
+			bg.safe->runSync(boost::bind(
+				&ServerKit_FdSourceChannelTest::consumeLastBufferIfWaiting, this));
+			result = getBytesReceived() == size;
+		);
+		thr.join();
+		ensure(!corrupted);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("End of file is fed as an empty buffer");
+		writePattern(writer, 10);
+		writer.close();
+		EVENTUALLY(5,
+			boost::lock_guard<boost::mutex> l(syncher);
+			result = log == "EOF\n";
+		);
+		ensure_equals(getBytesReceived(), 10u);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("A large upload arrives intact and leaves no buffers behind");
+		boost::uint64_t size = 16 * 1024 * 1024;
+		boost::thread thr(boost::bind(writePattern, (int) writer, size));
+		EVENTUALLY(60,
+			result = getBytesReceived() == size;
+		);
+		thr.join();
+		ensure(!corrupted);
+
+		// Once a client has sent its request, its channel holds no buffers,
+		// so an idle connection only costs the channel object itself.
+		writePattern(writer, 500);
+		EVENTUALLY(5,
+			result = getBytesReceived() == size + 500;
+		);
+		ensure_equals(getActiveBlocks(), 0u);
+	}
+}
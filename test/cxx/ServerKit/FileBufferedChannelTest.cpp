@@ -178,6 +178,17 @@ namespace tut {
 			*result = channel.getBytesBuffered();
 		}
 
+		bool channelIsReadingAhead() {
+			bool result;
+			bg.safe->runSync(boost::bind(&ServerKit_FileBufferedChannelTest::_channelIsReadingAhead,
+				this, &result));
+			return result;
+		}
+
+		void _channelIsReadingAhead(bool *result) {
+			*result = channel.inspectAsJson().isMember("reading_ahead");
+		}
+
 		void channelEnableAutoStartMover(bool enabled) {
 			bg.safe->runSync(boost::bind(&ServerKit_FileBufferedChannelTest::_channelEnableAutoStartMover,
 				this, enabled));
@@ -622,7 +633,9 @@ namespace tut {
 
 		// Consume the initial "hello" so that the FileBufferedChannel starts
 		// reading "world" from disk.
+		// Reading ahead is tested separately.
 		context.defaultFileBufferedChannelConfig.maxDiskChunkReadSize = sizeof("world") - 1;
+		context.defaultFileBufferedChannelConfig.readAhead = false;
 		channelConsumed(sizeof("hello") - 1, false);
 		EVENTUALLY(5,
 			LOCK();
@@ -919,6 +932,121 @@ namespace tut {
 	}
 
 
+	/***** Read-ahead and batched moves *****/
+
+	TEST_METHOD(42) {
+		set_test_name("Suppose that a data chunk from disk is being passed to the callback. "
+			"While the callback consumes it asynchronously, the next chunk is read ahead");
+
+		// Setup a FileBufferedChannel in the in-file mode.
+		toConsume = -1;
+		context.defaultFileBufferedChannelConfig.threshold = 1;
+		startLoop();
+		feedChannel("hello");
+		feedChannel("world!");
+		EVENTUALLY(5,
+			result = getChannelMode() == FileBufferedChannel::IN_FILE_MODE;
+		);
+		EVENTUALLY(5,
+			result = getChannelWriterState() == FileBufferedChannel::WS_INACTIVE;
+		);
+
+		context.defaultFileBufferedChannelConfig.maxDiskChunkReadSize = sizeof("world") - 1;
+		channelConsumed(sizeof("hello") - 1, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = log ==
+				"Data: hello\n"
+				"Data: world\n";
+		);
+		ensure_equals(getChannelReaderState(), FileBufferedChannel::RS_WAITING_FOR_CHANNEL_IDLE);
+		ensure(channelIsReadingAhead());
+
+		channelConsumed(sizeof("world") - 1, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = log ==
+				"Data: hello\n"
+				"Data: world\n"
+				"Data: !\n";
+		);
+		ensure(!channelIsReadingAhead());
+	}
+
+	TEST_METHOD(43) {
+		set_test_name("Upon feeding an error, a chunk that has been read ahead is discarded");
+
+		toConsume = -1;
+		context.defaultFileBufferedChannelConfig.threshold = 1;
+		startLoop();
+		feedChannel("hello");
+		feedChannel("world!");
+		EVENTUALLY(5,
+			result = getChannelMode() == FileBufferedChannel::IN_FILE_MODE;
+		);
+		EVENTUALLY(5,
+			result = getChannelWriterState() == FileBufferedChannel::WS_INACTIVE;
+		);
+
+		context.defaultFileBufferedChannelConfig.maxDiskChunkReadSize = sizeof("world") - 1;
+		channelConsumed(sizeof("hello") - 1, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = counter == 2;
+		);
+		ensure(channelIsReadingAhead());
+		// Give the read-ahead time to finish.
+		usleep(50000);
+
+		feedChannelError(EIO);
+		EVENTUALLY(5,
+			result = getChannelReaderState() == FileBufferedChannel::RS_TERMINATED;
+		);
+		ensure(getChannelMode() >= FileBufferedChannel::ERROR);
+		channelConsumed(sizeof("world") - 1, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = log ==
+				"Data: hello\n"
+				"Data: world\n"
+				"Error: " + toString(EIO) + "\n";
+		);
+	}
+
+	TEST_METHOD(44) {
+		set_test_name("The mover writes several in-memory buffers to disk at once");
+
+		toConsume = -1;
+		context.defaultFileBufferedChannelConfig.threshold = 1;
+		context.defaultFileBufferedChannelConfig.maxWriteBatchSize = 3;
+		startLoop();
+
+		string expected;
+		for (unsigned int i = 0; i < 20; i++) {
+			string data = toString(i + 10);
+			feedChannel(data);
+			expected.append(data);
+		}
+		EVENTUALLY(5,
+			result = getChannelMode() == FileBufferedChannel::IN_FILE_MODE
+				&& getChannelBytesBuffered() == 0;
+		);
+		ensure_equals(getChannelWriterState(), FileBufferedChannel::WS_INACTIVE);
+
+		{
+			LOCK();
+			toConsume = CONSUME_FULLY;
+		}
+		channelConsumed(2, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = log ==
+				"Data: 10\n"
+				"Data: " + expected.substr(2) + "\n";
+		);
+	}
+
+
 	/***** When stopped *****/
 
 	TEST_METHOD(45) {
@@ -995,4 +1123,287 @@ namespace tut {
 			ensure_equals(counter, 2u);
 		}
 	}
+
+
+	/***** Memory budget *****/
+
+	static Channel::Result neverConsume(Channel *channel, const mbuf &buffer, int errcode) {
+		return Channel::Result(-1, false);
+	}
+
+	static void feedChannelSync(FileBufferedChannel *channel, const char *data) {
+		channel->feed(data);
+	}
+
+	static void _getMemoryUsage(ServerKit_FileBufferedChannelTest *test,
+		FileBufferedChannelMemoryUsage *result)
+	{
+		*result = test->context.fileBufferedChannelMemoryUsage;
+	}
+
+	static FileBufferedChannelMemoryUsage getMemoryUsage(ServerKit_FileBufferedChannelTest *test) {
+		FileBufferedChannelMemoryUsage result;
+		test->bg.safe->runSync(boost::bind(_getMemoryUsage, test, &result));
+		return result;
+	}
+
+	static void destroyChannel(FileBufferedChannel *channel) {
+		delete channel;
+	}
+
+	TEST_METHOD(47) {
+		set_test_name("With a memory budget, it stays in the in-memory mode beyond "
+			"the threshold, as long as the budget isn't exceeded");
+
+		toConsume = -1;
+		context.defaultFileBufferedChannelConfig.threshold = 1;
+		context.fileBufferedChannelMemoryBudget = 1024;
+		startLoop();
+
+		feedChannel("hello");
+		feedChannel("world");
+		feedChannel("!");
+		SHOULD_NEVER_HAPPEN(100,
+			result = getChannelMode() != FileBufferedChannel::IN_MEMORY_MODE;
+		);
+		ensure_equals(getChannelBytesBuffered(), 6u);
+
+		FileBufferedChannelMemoryUsage usage = getMemoryUsage(this);
+		ensure_equals(usage.bytesBuffered, 6u);
+		ensure_equals(usage.inMemoryModeBytesBuffered, 6u);
+		ensure_equals(usage.spills, 0u);
+
+		toConsume = CONSUME_FULLY;
+		channelConsumed(sizeof("hello") - 1, false);
+		EVENTUALLY(5,
+			result = getChannelBytesBuffered() == 0;
+		);
+		usage = getMemoryUsage(this);
+		ensure_equals(usage.bytesBuffered, 0u);
+		ensure_equals(usage.inMemoryModeBytesBuffered, 0u);
+		ensure(usage.inMemoryModeChannels == NULL);
+	}
+
+	TEST_METHOD(48) {
+		set_test_name("When the memory budget is exceeded, the channels that buffer "
+			"the most switch to the in-file mode");
+
+		FileBufferedChannel *other = new FileBufferedChannel(&context);
+		other->setDataCallback(neverConsume);
+		toConsume = -1;
+		context.fileBufferedChannelMemoryBudget = 16;
+		startLoop();
+
+		// The first buffer of each channel is passed to the data callback
+		// right away, so it doesn't count.
+		feedChannel("x");
+		feedChannel("hello world");
+		bg.safe->runSync(boost::bind(feedChannelSync, other, "y"));
+		bg.safe->runSync(boost::bind(feedChannelSync, other, "abc"));
+		ensure_equals(getMemoryUsage(this).inMemoryModeBytesBuffered, 14u);
+		ensure_equals(getChannelMode(), FileBufferedChannel::IN_MEMORY_MODE);
+
+		bg.safe->runSync(boost::bind(feedChannelSync, other, "defg"));
+		ensure_equals(getChannelMode(), FileBufferedChannel::IN_FILE_MODE);
+		ensure_equals(other->getMode(), FileBufferedChannel::IN_MEMORY_MODE);
+
+		FileBufferedChannelMemoryUsage usage = getMemoryUsage(this);
+		ensure_equals(usage.inMemoryModeBytesBuffered, 7u);
+		ensure_equals(usage.spills, 1u);
+		ensure_equals(usage.budgetSpills, 1u);
+		EVENTUALLY(5,
+			result = getChannelBytesBuffered() == 0;
+		);
+		ensure_equals(getMemoryUsage(this).bytesBuffered, 7u);
+
+		bg.safe->runSync(boost::bind(destroyChannel, other));
+		usage = getMemoryUsage(this);
+		ensure_equals(usage.bytesBuffered, 0u);
+		ensure(usage.inMemoryModeChannels == NULL);
+
+		channelConsumed(1, false);
+		EVENTUALLY(5,
+			LOCK();
+			result = log ==
+				"Data: x\n"
+				"Data: hello world\n";
+		);
+	}
+
+	TEST_METHOD(49) {
+		set_test_name("Channels that buffer the same amount switch to the in-file mode "
+			"in the order in which they started buffering");
+
+		FileBufferedChannel *others[3];
+		context.fileBufferedChannelMemoryBudget = 8;
+		startLoop();
+		for (unsigned int i = 0; i < 3; i++) {
+			others[i] = new FileBufferedChannel(&context);
+			others[i]->setDataCallback(neverConsume);
+			bg.safe->runSync(boost::bind(feedChannelSync, others[i], "x"));
+			bg.safe->runSync(boost::bind(feedChannelSync, others[i], "abc"));
+		}
+
+		ensure_equals(others[0]->getMode(), FileBufferedChannel::IN_FILE_MODE);
+		ensure_equals(others[1]->getMode(), FileBufferedChannel::IN_MEMORY_MODE);
+		ensure_equals(others[2]->getMode(), FileBufferedChannel::IN_MEMORY_MODE);
+		ensure_equals(getMemoryUsage(this).inMemoryModeBytesBuffered, 6u);
+
+		for (unsigned int i = 0; i < 3; i++) {
+			bg.safe->runSync(boost::bind(destroyChannel, others[i]));
+		}
+	}
+
+
+	/***** Concurrent uploads *****/
+
+	struct ConcurrentUpload: public ServerKit::Hooks {
+		ServerKit_FileBufferedChannelTest *test;
+		FileBufferedChannel channel;
+		unsigned int id;
+		boost::uint64_t size;
+		boost::uint64_t fed;
+		boost::uint64_t received;
+		bool waitingForFlush;
+
+		ConcurrentUpload(ServerKit_FileBufferedChannelTest *_test, unsigned int _id,
+			boost::uint64_t _size)
+			: test(_test),
+			  channel(&_test->context),
+			  id(_id),
+			  size(_size),
+			  fed(0),
+			  received(0),
+			  waitingForFlush(false)
+		{
+			Hooks::impl = NULL;
+			Hooks::userData = NULL;
+			channel.setHooks(this);
+			channel.setDataCallback(consumeUpload);
+			channel.setBuffersFlushedCallback(uploadBuffersFlushed);
+		}
+
+		// The data consists of 64-byte runs of the same byte, so that
+		// generating and checking it doesn't dominate the benchmark.
+		static unsigned char byteAt(unsigned int id, boost::uint64_t offset) {
+			return (unsigned char) (((offset >> 6) + id) % 251);
+		}
+
+		// Feeds data like a ServerKit client does: it stops reading from the
+		// socket once the threshold has been passed, and resumes once the
+		// in-memory buffers have been flushed to disk.
+		static void produce(ConcurrentUpload *self) {
+			unsigned int threshold = self->test->context.defaultFileBufferedChannelConfig.threshold;
+
+			while (self->fed < self->size && self->channel.getBytesBuffered() < threshold) {
+				mbuf buffer = mbuf_get(&self->test->context.mbuf_pool);
+				unsigned int size = (unsigned int) std::min<boost::uint64_t>(
+					buffer.size(), self->size - self->fed);
+				unsigned int i = 0;
+				while (i < size) {
+					unsigned int run = std::min<unsigned int>(
+						64 - (self->fed + i) % 64, size - i);
+					memset(buffer.start + i, byteAt(self->id, self->fed + i), run);
+					i += run;
+				}
+				self->fed += size;
+				self->channel.feed(mbuf(buffer, 0, size));
+			}
+			if (self->fed == self->size) {
+				self->channel.feed(mbuf());
+			} else {
+				self->waitingForFlush = true;
+			}
+		}
+
+		// Checks one byte of every run, and the last byte.
+		bool isIntact(const mbuf &buffer) const {
+			for (unsigned int i = 0; i < buffer.size(); i += 61) {
+				if ((unsigned char) buffer.start[i] != byteAt(id, received + i)) {
+					return false;
+				}
+			}
+			return (unsigned char) buffer.start[buffer.size() - 1]
+				== byteAt(id, received + buffer.size() - 1);
+		}
+
+		static void uploadBuffersFlushed(FileBufferedChannel *channel) {
+			ConcurrentUpload *self = (ConcurrentUpload *) channel->getHooks();
+			if (self->waitingForFlush) {
+				self->waitingForFlush = false;
+				self->test->bg.safe->runLater(boost::bind(produce, self));
+			}
+		}
+
+		static Channel::Result consumeUpload(Channel *_channel, const mbuf &buffer, int errcode) {
+			FileBufferedChannel *channel = reinterpret_cast<FileBufferedChannel *>(_channel);
+			ConcurrentUpload *self = (ConcurrentUpload *) channel->getHooks();
+
+			if (errcode != 0 || buffer.empty()) {
+				boost::lock_guard<boost::mutex> l(self->test->syncher);
+				if (errcode != 0) {
+					self->test->log.append("Upload " + toString(self->id) + ": error "
+						+ toString(errcode) + "\n");
+				} else if (self->received != self->size) {
+					self->test->log.append("Upload " + toString(self->id) + ": received "
+						+ toString(self->received) + " bytes\n");
+				}
+				self->test->counter++;
+				return Channel::Result(0, true);
+			}
+
+			if (!self->isIntact(buffer)) {
+				boost::lock_guard<boost::mutex> l(self->test->syncher);
+				self->test->log.append("Upload " + toString(self->id) + ": corrupt data at offset "
+					+ toString(self->received) + "\n");
+			}
+			self->received += buffer.size();
+
+			// Consume asynchronously, like a socket that only becomes writable
+			// again in a next event loop iteration.
+			self->test->bg.safe->runLater(boost::bind(consumed, self, buffer.size()));
+			return Channel::Result(-1, false);
+		}
+
+		static void consumed(ConcurrentUpload *self, unsigned int size) {
+			self->channel.consumed(size, false);
+		}
+	};
+
+	static void destroyUploads(vector<ConcurrentUpload *> *uploads) {
+		for (unsigned int i = 0; i < uploads->size(); i++) {
+			(*uploads)[i]->channel.deinitialize();
+			delete (*uploads)[i];
+		}
+		uploads->clear();
+	}
+
+	TEST_METHOD(50) {
+		set_test_name("Many concurrent uploads that are buffered to disk are delivered intact");
+
+		// The uploads are consumed slower than they're produced. Both
+		// moving one buffer per write without reading ahead, and the
+		// defaults, are exercised.
+		const unsigned int count = 20;
+		FileBufferedChannelConfig &config = context.defaultFileBufferedChannelConfig;
+		vector<ConcurrentUpload *> uploads;
+
+		startLoop();
+		for (unsigned int i = 0; i < 2; i++) {
+			config.maxWriteBatchSize = (i == 0) ? 1 : FileBufferedChannelConfig().maxWriteBatchSize;
+			config.readAhead = (i != 0);
+			counter = 0;
+			for (unsigned int j = 0; j < count; j++) {
+				uploads.push_back(new ConcurrentUpload(this, j, 1024 * 1024));
+				bg.safe->runLater(boost::bind(ConcurrentUpload::produce, uploads.back()));
+			}
+			EVENTUALLY(60,
+				LOCK();
+				result = counter == count;
+			);
+			bg.safe->runSync(boost::bind(destroyUploads, &uploads));
+			LOCK();
+			ensure_equals(log, "");
+		}
+	}
 }
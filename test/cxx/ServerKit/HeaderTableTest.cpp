@@ -1,5 +1,10 @@
 #include <TestSupport.h>
 #include <ServerKit/HeaderTable.h>
+#include <ServerKit/KnownHeaders.h>
+#include <Utils/Hasher.h>
+#include <Utils/StrIntUtils.h>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace Passenger;
 using namespace Passenger::ServerKit;
@@ -191,4 +196,181 @@ namespace tut {
 
 		ensure_equals<void *>("(3)", table.lookup("Content-Length"), NULL);
 	}
+
+	TEST_METHOD(11) {
+		set_test_name("Small tables keep working while growing beyond, and compacting back into,"
+			" the inline storage");
+		// Headers refer to these strings' data, so don't let the vectors reallocate.
+		vector<string> names, values;
+		names.reserve(40);
+		values.reserve(40);
+		table = HeaderTable(4);
+
+		for (unsigned int i = 0; i < 40; i++) {
+			names.push_back("x-header-" + toString(i));
+			values.push_back(toString(i));
+			insertHeader(createHeader(names.back(), values.back()), pool);
+		}
+		ensure_equals("(1)", table.size(), 40u);
+		ensure("(2)", table.arraySize() > HeaderTable::INLINE_SIZE);
+
+		for (unsigned int i = 10; i < 40; i++) {
+			table.erase(names[i]);
+		}
+		table.compact();
+		ensure_equals("(3)", table.size(), 10u);
+		ensure("(4)", table.arraySize() <= HeaderTable::INLINE_SIZE);
+		for (unsigned int i = 0; i < 40; i++) {
+			if (i < 10) {
+				ensure("(5)", psg_lstr_cmp(table.lookup(names[i]), values[i]));
+			} else {
+				ensure_equals<void *>("(6)", table.lookup(names[i]), NULL);
+			}
+		}
+	}
+
+	TEST_METHOD(12) {
+		set_test_name("Copies of small tables are independent of the original");
+		table = HeaderTable(8);
+		insertHeader(createHeader("Host", "foo.com"), pool);
+
+		HeaderTable copy(table);
+		insertHeader(createHeader("Accept", "*/*"), pool);
+		ensure_equals(copy.size(), 1u);
+		ensure(psg_lstr_cmp(copy.lookup("Host"), "foo.com"));
+		ensure_equals<void *>(copy.lookup("Accept"), NULL);
+
+		table = copy;
+		ensure_equals(table.size(), 1u);
+		ensure_equals<void *>(table.lookup("Accept"), NULL);
+		table = table;
+		ensure(psg_lstr_cmp(table.lookup("Host"), "foo.com"));
+	}
+
+	TEST_METHOD(13) {
+		set_test_name("Insertion and lookup of typical request headers in many tables");
+		// Models as many concurrent requests, whose tables are not looked
+		// at in the order in which they were filled.
+		static const char *names[] = {
+			"host", "user-agent", "accept", "accept-language", "accept-encoding",
+			"referer", "cookie", "connection", "upgrade-insecure-requests",
+			"cache-control", "x-forwarded-for", "x-forwarded-proto"
+		};
+		const unsigned int count = sizeof(names) / sizeof(const char *);
+		const unsigned int ntables = 1024;
+		vector<HeaderTable *> tables;
+		vector<unsigned int> order;
+		vector<HashedStaticString> present, absent;
+		unsigned int i, j, found = 0;
+
+		for (i = 0; i < count; i++) {
+			present.push_back(names[i]);
+			// Names of headers that requests don't have.
+			absent.push_back(names[i] + 1);
+		}
+		for (j = 0; j < ntables; j++) {
+			tables.push_back(new HeaderTable(16));
+			order.push_back(j);
+			for (i = 0; i < count; i++) {
+				Header *header = createHeader(present[i], "value");
+				tables[j]->insert(&header, pool);
+			}
+		}
+		srand(1234);
+		random_shuffle(order.begin(), order.end());
+
+		for (j = 0; j < ntables; j++) {
+			HeaderTable *table = tables[order[j]];
+			for (i = 0; i < count; i++) {
+				found += table->lookupCell(present[i]) != NULL;
+				found += table->lookupCell(absent[i]) != NULL;
+			}
+		}
+
+		for (j = 0; j < ntables; j++) {
+			ensure_equals(tables[j]->size(), count);
+			delete tables[j];
+		}
+		ensure_equals(found, count * ntables);
+	}
+
+	TEST_METHOD(14) {
+		set_test_name("The generated known header table matches Hasher, and its hash function is perfect");
+		for (unsigned int i = 0; i < KNOWN_HEADER_COUNT; i++) {
+			KnownHeader id = (KnownHeader) i;
+			string name(KNOWN_HEADERS[id].name, KNOWN_HEADERS[id].size);
+			Hasher h;
+
+			h.update(name.data(), name.size());
+			ensure_equals((name + " hash").c_str(), KNOWN_HEADERS[id].hash, h.finalize());
+			ensure_equals((name + " name").c_str(), getKnownHeaderName(id).hash(), h.finalize());
+			ensure_equals((name + " lookup").c_str(), lookupKnownHeader(KNOWN_HEADERS[id].hash), id);
+		}
+
+		for (unsigned int i = 0; i < 10000; i++) {
+			string name = "x-header-" + toString(i);
+			ensure_equals(lookupKnownHeader(HashedStaticString(name).hash()), KH_NONE);
+		}
+	}
+
+	TEST_METHOD(15) {
+		set_test_name("Known headers can be looked up by ID");
+		insertHeader(createHeader("x-foo", "1"), pool);
+		insertHeader(createHeader("host", "foo.com"), pool);
+		insertHeader(createHeader("cookie", "a"), pool);
+		insertHeader(createHeader("cookie", "b"), pool);
+
+		ensure(psg_lstr_cmp(table.lookup(KH_HOST), "foo.com"));
+		ensure(psg_lstr_cmp(table.lookup(KH_COOKIE), "a;b"));
+		ensure(table.lookupHeader(KH_HOST) == table.lookupHeader("host"));
+		ensure_equals<void *>(table.lookup(KH_CONTENT_TYPE), NULL);
+
+		table.erase(KH_HOST);
+		ensure_equals<void *>(table.lookup(KH_HOST), NULL);
+		ensure_equals<void *>(table.lookup("host"), NULL);
+		ensure_equals(table.size(), 2u);
+
+		table.clear();
+		ensure_equals<void *>(table.lookup(KH_COOKIE), NULL);
+	}
+
+	TEST_METHOD(16) {
+		set_test_name("Known header IDs keep referring to the right headers while cells"
+			" are moved around by erasing, growing, compacting and copying");
+		// Headers refer to these strings' data, so don't let the vectors reallocate.
+		vector<string> names, values;
+		names.reserve(KNOWN_HEADER_COUNT + 40);
+		values.reserve(KNOWN_HEADER_COUNT + 40);
+		table = HeaderTable(4);
+
+		for (unsigned int i = 0; i < KNOWN_HEADER_COUNT + 40; i++) {
+			if (i % 2 == 0 && i / 2 < KNOWN_HEADER_COUNT) {
+				names.push_back(KNOWN_HEADERS[i / 2].name);
+			} else {
+				names.push_back("x-header-" + toString(i));
+			}
+			values.push_back(toString(i));
+			insertHeader(createHeader(names.back(), values.back()), pool);
+		}
+		ensure_equals("(1)", table.size(), (unsigned int) names.size());
+
+		// Erasing causes neighboring cells to be shifted back.
+		for (unsigned int i = 0; i < names.size(); i += 3) {
+			table.erase(names[i]);
+		}
+		table.compact();
+		HeaderTable copy(table);
+
+		for (unsigned int i = 0; i < KNOWN_HEADER_COUNT; i++) {
+			unsigned int index = i * 2;
+			KnownHeader id = (KnownHeader) i;
+			if (index % 3 == 0) {
+				ensure_equals<void *>("(2)", table.lookup(id), NULL);
+				ensure_equals<void *>("(3)", copy.lookup(id), NULL);
+			} else {
+				ensure("(4)", psg_lstr_cmp(table.lookup(id), values[index]));
+				ensure("(5)", copy.lookup(id) == copy.lookup(names[index]));
+			}
+		}
+	}
 }
@@ -0,0 +1,148 @@
+#include <TestSupport.h>
+#include <BackgroundEventLoop.h>
+#include <ServerKit/Context.h>
+#include <ServerKit/HttpRequest.h>
+#include <ServerKit/HttpHeaderParser.h>
+#include <ServerKit/KnownHeaders.h>
+#include <Utils/StrIntUtils.h>
+#include <cstring>
+
+using namespace Passenger;
+using namespace Passenger::ServerKit;
+using namespace Passenger::MemoryKit;
+using namespace std;
+
+namespace tut {
+	struct ServerKit_HttpHeaderParserTest {
+		BackgroundEventLoop bg;
+		ServerKit::Context context;
+		HttpHeaderParserState state;
+		HttpRequest req;
+
+		ServerKit_HttpHeaderParserTest()
+			: bg(false, true),
+			  context(bg.safe, bg.libuv_loop)
+		{
+			req.pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+			psg_lstr_init(&req.path);
+			reset();
+		}
+
+		~ServerKit_HttpHeaderParserTest() {
+			deinitializeHeaders();
+			psg_destroy_pool(req.pool);
+		}
+
+		HttpHeaderParser<HttpRequest> createParser() {
+			return HttpHeaderParser<HttpRequest>(&context, &state, &req, req.pool);
+		}
+
+		void deinitializeHeaders() {
+			HeaderTable::Iterator it(req.headers);
+			while (*it != NULL) {
+				psg_lstr_deinit(&it->header->key);
+				psg_lstr_deinit(&it->header->origKey);
+				psg_lstr_deinit(&it->header->val);
+				it.next();
+			}
+			psg_lstr_deinit(&req.path);
+			req.headers.clear();
+			req.secureHeaders.clear();
+		}
+
+		/** Prepares `req` for parsing the next request, like HttpServer does. */
+		void reset() {
+			deinitializeHeaders();
+			psg_reset_pool(req.pool, PSG_DEFAULT_POOL_SIZE);
+			psg_lstr_init(&req.path);
+			req.httpState = HttpRequest::PARSING_HEADERS;
+			req.bodyType = HttpRequest::RBT_NO_BODY;
+			req.queryStringIndex = -1;
+			createParser().initialize();
+		}
+
+		void feed(const StaticString &data) {
+			mbuf buffer(mbuf_get(&context.mbuf_pool));
+			ensure(data.size() <= buffer.size());
+			memcpy(buffer.start, data.data(), data.size());
+			buffer = mbuf(buffer, 0, data.size());
+			createParser().feed(buffer);
+		}
+	};
+
+	DEFINE_TEST_GROUP(ServerKit_HttpHeaderParserTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Parsed known headers can be looked up by ID and by name");
+		feed("GET / HTTP/1.1\r\n"
+			"Host: foo.com\r\n"
+			"COOKIE: a=1\r\n"
+			"X-Foo: bar\r\n"
+			"Content-Type: text/plain\r\n"
+			"Cookie: b=2\r\n"
+			"\r\n");
+		ensure_equals(req.httpState, HttpRequest::COMPLETE);
+
+		ensure(psg_lstr_cmp(req.headers.lookup(KH_HOST), "foo.com"));
+		ensure(psg_lstr_cmp(req.headers.lookup(KH_CONTENT_TYPE), "text/plain"));
+		ensure("Multiple cookie headers are joined",
+			psg_lstr_cmp(req.headers.lookup(KH_COOKIE), "a=1;b=2"));
+		ensure(req.headers.lookup(KH_COOKIE) == req.headers.lookup("cookie"));
+		ensure(psg_lstr_cmp(req.headers.lookup("x-foo"), "bar"));
+		ensure_equals<void *>(req.headers.lookup(KH_CONTENT_LENGTH), NULL);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Headers whose names resemble known ones don't get their IDs");
+		feed("GET / HTTP/1.1\r\n"
+			"Hos: foo.com\r\n"
+			"Hosts: bar.com\r\n"
+			"X-Host: baz.com\r\n"
+			"\r\n");
+		ensure_equals(req.httpState, HttpRequest::COMPLETE);
+		ensure_equals(req.headers.size(), 3u);
+		ensure_equals<void *>(req.headers.lookup(KH_HOST), NULL);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Parsing a request and looking up the headers that the Core needs");
+		// Lookups by ID must find the same headers as lookups by name.
+		static const char request[] =
+			"GET /assets/application.css?v=3 HTTP/1.1\r\n"
+			"Host: www.example.com\r\n"
+			"Connection: keep-alive\r\n"
+			"Cache-Control: max-age=0\r\n"
+			"Upgrade-Insecure-Requests: 1\r\n"
+			"User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+				"(KHTML, like Gecko) Chrome/54.0.2840.71 Safari/537.36\r\n"
+			"Accept: text/css,*/*;q=0.1\r\n"
+			"Referer: https://www.example.com/\r\n"
+			"Accept-Encoding: gzip, deflate, sdch, br\r\n"
+			"Accept-Language: en-US,en;q=0.8,nl;q=0.6\r\n"
+			"Cookie: _session_id=0123456789abcdef0123456789abcdef; _ga=GA1.2.1234567890.1234567890\r\n"
+			"If-None-Match: W/\"5e15153d-120f\"\r\n"
+			"If-Modified-Since: Tue, 08 Nov 2016 10:00:00 GMT\r\n"
+			"\r\n";
+		// The headers that InitRequest, ResponseCache, ResponseCompression,
+		// SendRequest and ServeStaticFile look up for a typical request.
+		static const KnownHeader ids[] = {
+			KH_HOST, KH_COOKIE, KH_CACHE_CONTROL, KH_PRAGMA, KH_AUTHORIZATION,
+			KH_ACCEPT_ENCODING, KH_CONTENT_TYPE, KH_CONTENT_LENGTH, KH_EXPECT,
+			KH_IF_NONE_MATCH, KH_IF_MODIFIED_SINCE, KH_RANGE
+		};
+		const unsigned int nids = sizeof(ids) / sizeof(KnownHeader);
+		unsigned int i, found = 0;
+
+		feed(StaticString(request, sizeof(request) - 1));
+		ensure_equals(req.httpState, HttpRequest::COMPLETE);
+
+		for (i = 0; i < nids; i++) {
+			// Constructed from a plain string, as the Core used to do.
+			HashedStaticString name(KNOWN_HEADERS[ids[i]].name, KNOWN_HEADERS[ids[i]].size);
+			LString *value = req.headers.lookup(ids[i]);
+			ensure_equals<void *>(value, req.headers.lookup(name));
+			found += value != NULL;
+		}
+		ensure_equals(found, 6u);
+	}
+}
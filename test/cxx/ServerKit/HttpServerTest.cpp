@@ -433,6 +433,37 @@ namespace tut {
 			*result = server->clientDataErrors;
 		}
 
+		unsigned long getTotalResponsesCorked() {
+			unsigned long result;
+			bg.safe->runSync(boost::bind(
+				&ServerKit_HttpServerTest::_getTotalResponsesCorked,
+				this, &result));
+			return result;
+		}
+
+		void _getTotalResponsesCorked(unsigned long *result) {
+			*result = server->totalResponsesCorked;
+		}
+
+		void setPipelineDepth(unsigned int depth) {
+			bg.safe->runSync(boost::bind(&ServerKit_HttpServerTest::_setPipelineDepth,
+				this, depth));
+		}
+
+		void _setPipelineDepth(unsigned int depth) {
+			server->pipelineDepth = depth;
+		}
+
+		static string helloResponse(const StaticString &path, const StaticString &connection) {
+			return "HTTP/1.1 200 OK\r\n"
+				"Status: 200 OK\r\n"
+				"Content-Type: text/plain\r\n"
+				"Date: Thu, 11 Sep 2014 12:54:09 GMT\r\n"
+				"Connection: " + connection + "\r\n"
+				"Content-Length: " + toString(path.size() + 6) + "\r\n\r\n"
+				"hello " + path;
+		}
+
 		void startAcceptingBody() {
 			bg.safe->runLater(boost::bind(&ServerKit_HttpServerTest::_startAcceptingBody,
 				this));
@@ -480,7 +511,7 @@ namespace tut {
 		}
 	};
 
-	DEFINE_TEST_GROUP_WITH_LIMIT(ServerKit_HttpServerTest, 100);
+	DEFINE_TEST_GROUP_WITH_LIMIT(ServerKit_HttpServerTest, 120);
 
 
 	/***** Valid HTTP header parsing *****/
@@ -1727,4 +1758,285 @@ namespace tut {
 			result = getActiveClientCount() == 0;
 		);
 	}
+
+
+	/***** Client timeouts *****/
+
+	TEST_METHOD(100) {
+		set_test_name("Clients that don't send a request header in time are disconnected");
+
+		server->clientHeaderTimeout = 1;
+		connectToServer();
+		sendRequest(
+			"GET / HTTP/1.1\r\n"
+			"Host: foo\r\n");
+		EVENTUALLY(5,
+			result = getActiveClientCount() == 0;
+		);
+		ensure_equals(readAll(fd), "");
+	}
+
+	TEST_METHOD(101) {
+		set_test_name("Idle keep-alive connections are disconnected");
+
+		server->clientHeaderTimeout = 100;
+		server->clientKeepAliveTimeout = 1;
+		connectToServer();
+		sendRequest(
+			"GET / HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n");
+		string header = readResponseHeader();
+		ensure(containsSubstring(header, "Connection: keep-alive"));
+		EVENTUALLY(5,
+			result = getActiveClientCount() == 0;
+		);
+	}
+
+	TEST_METHOD(102) {
+		set_test_name("Clients that stop sending the request body are disconnected");
+
+		server->clientBodyTimeout = 1;
+		connectToServer();
+		sendRequest(
+			"GET /body_test HTTP/1.1\r\n"
+			"Host: foo\r\n"
+			"Content-Length: 10\r\n\r\n"
+			"ok");
+		EVENTUALLY(5,
+			result = getActiveClientCount() == 0;
+		);
+	}
+
+	TEST_METHOD(103) {
+		set_test_name("The body timeout is re-armed whenever body data is received");
+
+		server->clientBodyTimeout = 1;
+		connectToServer();
+		sendRequest(
+			"GET /body_test HTTP/1.1\r\n"
+			"Host: foo\r\n"
+			"Content-Length: 5\r\n\r\n");
+		for (int i = 0; i < 4; i++) {
+			sendRequest("x");
+			syscalls::usleep(500000);
+			ensure_equals(getActiveClientCount(), 1u);
+		}
+		sendRequest("x");
+		string header = readResponseHeader();
+		ensure(containsSubstring(header, "200 OK"));
+	}
+
+	TEST_METHOD(104) {
+		set_test_name("Client timeouts are off by default");
+
+		ensure_equals(server->clientHeaderTimeout, 0u);
+		ensure_equals(server->clientBodyTimeout, 0u);
+		ensure_equals(server->clientKeepAliveTimeout, 0u);
+	}
+
+
+	/***** Pipelining *****/
+
+	TEST_METHOD(110) {
+		set_test_name("Responses to pipelined requests are written together, in order");
+
+		connectToServer();
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /b HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /c HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /d HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /e HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+
+		string response = readAll(fd);
+		ensure_equals(response,
+			helloResponse("/a", "keep-alive") +
+			helloResponse("/b", "keep-alive") +
+			helloResponse("/c", "keep-alive") +
+			helloResponse("/d", "keep-alive") +
+			helloResponse("/e", "close"));
+		ensure_equals(getTotalResponsesCorked(), 4u);
+	}
+
+	TEST_METHOD(111) {
+		set_test_name("At most pipelineDepth responses are written together");
+
+		server->pipelineDepth = 3;
+		connectToServer();
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /b HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /c HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /d HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /e HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /f HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /g HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+
+		string response = readAll(fd);
+		ensure_equals(response,
+			helloResponse("/a", "keep-alive") +
+			helloResponse("/b", "keep-alive") +
+			helloResponse("/c", "keep-alive") +
+			helloResponse("/d", "keep-alive") +
+			helloResponse("/e", "keep-alive") +
+			helloResponse("/f", "keep-alive") +
+			helloResponse("/g", "close"));
+		// /a + /b + /c, /d + /e + /f, /g
+		ensure_equals(getTotalResponsesCorked(), 4u);
+	}
+
+	TEST_METHOD(112) {
+		set_test_name("Responses to pipelined requests stay in order when a request"
+			" can't be finished right away");
+
+		connectToServer();
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"POST /body_test HTTP/1.1\r\n"
+			"Host: foo\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello"
+			"GET /b HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /c HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+
+		string response = readAll(fd);
+		string::size_type bodyResponse = response.find("5 bytes: hello");
+		ensure(startsWith(response, helloResponse("/a", "keep-alive")));
+		ensure(bodyResponse != string::npos);
+		ensure_equals(response.substr(bodyResponse + sizeof("5 bytes: hello") - 1),
+			helloResponse("/b", "keep-alive") +
+			helloResponse("/c", "close"));
+	}
+
+	TEST_METHOD(113) {
+		set_test_name("Errors in pipelined requests are answered after the responses"
+			" to the earlier requests");
+
+		connectToServer();
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /b HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"INVALID /c HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /d HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n");
+
+		string response = readAll(fd);
+		string expectedStart =
+			helloResponse("/a", "keep-alive") +
+			helloResponse("/b", "keep-alive");
+		ensure(startsWith(response, expectedStart));
+		string statusLine = response.substr(expectedStart.size());
+		statusLine = statusLine.substr(0, statusLine.find("\r\n"));
+		ensure(containsSubstring(statusLine, " 400 Bad Request"));
+		ensure("It stops at the invalid request", !containsSubstring(response, "hello /d"));
+	}
+
+	TEST_METHOD(114) {
+		set_test_name("A partially received pipelined request does not hold back"
+			" the responses to the earlier ones");
+
+		connectToServer();
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /b HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"GET /c HTTP/1.1\r\n");
+
+		string expected =
+			helloResponse("/a", "keep-alive") +
+			helloResponse("/b", "keep-alive");
+		char buf[1024];
+		ensure(expected.size() <= sizeof(buf));
+		readExact(fd, buf, expected.size());
+		ensure_equals(string(buf, expected.size()), expected);
+
+		sendRequest(
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+		ensure_equals(readAll(fd), helloResponse("/c", "close"));
+	}
+
+	TEST_METHOD(115) {
+		set_test_name("Batches of pipelined requests are answered in order,"
+			" whether or not their responses are written together");
+		const unsigned int batchSize = 16;
+		const unsigned int batches = 20;
+		string request =
+			"GET /cached HTTP/1.1\r\n"
+			"Host: foo\r\n"
+			"Accept: */*\r\n\r\n";
+		string batch, expected;
+
+		for (unsigned int i = 0; i < batchSize; i++) {
+			batch.append(request);
+			expected.append(helloResponse("/cached", "keep-alive"));
+		}
+
+		connectToServer();
+		for (unsigned int round = 0; round < 2; round++) {
+			// Round 0 writes every response separately, like before
+			// pipelined requests were batched.
+			setPipelineDepth((round == 0) ? 1 : batchSize);
+			for (unsigned int i = 0; i < batches; i++) {
+				string response;
+				response.resize(expected.size());
+				sendRequest(batch);
+				readExact(fd, &response[0], response.size());
+				ensure_equals(response, expected);
+			}
+		}
+
+		ensure(getTotalResponsesCorked() >= batches);
+	}
+
+	TEST_METHOD(116) {
+		set_test_name("Pipelined requests to a client that has stopped reading"
+			" don't crash the server");
+
+		setLogLevel(LVL_CRIT);
+		connectToServer();
+		// Writing the corked response to /a fails with EPIPE as soon as
+		// the POST request begins.
+		shutdown(fd, SHUT_RD);
+		sendRequest(
+			"GET /a HTTP/1.1\r\n"
+			"Host: foo\r\n\r\n"
+			"POST /body_test HTTP/1.1\r\n"
+			"Host: foo\r\n"
+			"Content-Length: 5\r\n\r\n"
+			"hello");
+		EVENTUALLY(5,
+			result = getActiveClientCount() == 0;
+		);
+		setLogLevel(DEFAULT_LOG_LEVEL);
+
+		connectToServer();
+		sendRequest(
+			"GET /b HTTP/1.1\r\n"
+			"Connection: close\r\n"
+			"Host: foo\r\n\r\n");
+		ensure_equals(readAll(fd), helloResponse("/b", "close"));
+	}
 }
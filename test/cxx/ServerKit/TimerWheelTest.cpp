@@ -0,0 +1,148 @@
+#include <TestSupport.h>
+#include <ServerKit/TimerWheel.h>
+#include <vector>
+
+using namespace Passenger;
+using namespace Passenger::ServerKit;
+using namespace std;
+
+namespace tut {
+	struct ServerKit_TimerWheelTest {
+		TimerWheel wheel;
+		TimerWheelEntry entries[10];
+		vector<TimerWheelEntry *> expired;
+
+		ServerKit_TimerWheelTest()
+			: wheel(1, 1000)
+		{
+			for (unsigned int i = 0; i < 10; i++) {
+				entries[i].userData = this;
+			}
+		}
+
+		unsigned int expire(double now) {
+			return wheel.expire(now, onExpired, this);
+		}
+
+		static void onExpired(TimerWheelEntry *entry, void *userData) {
+			ServerKit_TimerWheelTest *self = (ServerKit_TimerWheelTest *) userData;
+			self->expired.push_back(entry);
+		}
+
+		static void onExpiredRearmOthers(TimerWheelEntry *entry, void *userData) {
+			ServerKit_TimerWheelTest *self = (ServerKit_TimerWheelTest *) userData;
+			self->expired.push_back(entry);
+			if (entry == &self->entries[0]) {
+				self->wheel.disarm(&self->entries[1]);
+				self->wheel.arm(&self->entries[2], 1010);
+				self->wheel.arm(&self->entries[0], 1020);
+			}
+		}
+	};
+
+	DEFINE_TEST_GROUP(ServerKit_TimerWheelTest);
+
+	TEST_METHOD(1) {
+		set_test_name("Timers expire at their deadline, never early and at most one tick late");
+		wheel.arm(&entries[0], 1002);
+		wheel.arm(&entries[1], 1002.5);
+		ensure(entries[0].armed());
+		ensure_equals(wheel.size(), 2u);
+
+		ensure_equals(expire(1001.9), 0u);
+		ensure_equals(expire(1002), 1u);
+		ensure_equals(expired.size(), 1u);
+		ensure(expired[0] == &entries[0]);
+		ensure(!entries[0].armed());
+
+		ensure_equals(expire(1002.9), 0u);
+		ensure_equals(expire(1003), 1u);
+		ensure(expired[1] == &entries[1]);
+		ensure(wheel.empty());
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Timers can be re-armed and disarmed");
+		wheel.arm(&entries[0], 1002);
+		wheel.arm(&entries[1], 1002);
+		wheel.arm(&entries[0], 1005);
+		wheel.disarm(&entries[1]);
+		wheel.disarm(&entries[1]);
+		ensure(!entries[1].armed());
+		ensure_equals(wheel.size(), 1u);
+
+		ensure_equals(expire(1004), 0u);
+		ensure_equals(expire(1005), 1u);
+		ensure(expired[0] == &entries[0]);
+		ensure_equals(wheel.size(), 0u);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Timers that are already due expire upon the next tick");
+		ensure_equals(expire(1010), 0u);
+		wheel.arm(&entries[0], 900);
+		wheel.arm(&entries[1], 1010);
+		ensure_equals(expire(1010.5), 0u);
+		ensure_equals(expire(1011), 2u);
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("Timers that are more than one round away are skipped until due");
+		wheel.arm(&entries[0], 1000 + TimerWheel::SLOTS + 3);
+		wheel.arm(&entries[1], 1000 + 3);
+		ensure_equals(expire(1003), 1u);
+		ensure(expired[0] == &entries[1]);
+		ensure_equals(expire(1000 + TimerWheel::SLOTS), 0u);
+		ensure_equals(expire(1000 + TimerWheel::SLOTS + 3), 1u);
+		ensure(expired[1] == &entries[0]);
+
+		wheel.arm(&entries[2], 5000);
+		ensure_equals("Long pauses are handled", expire(100000), 1u);
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("The callback may arm and disarm other timers");
+		wheel.arm(&entries[0], 1001);
+		wheel.arm(&entries[1], 1001);
+		wheel.arm(&entries[2], 1001);
+		unsigned int count = wheel.expire(1001, onExpiredRearmOthers, this);
+		// entries[1] and entries[2] were already moved to the expired list
+		// when entries[0]'s callback ran; disarming or re-arming them
+		// removes them from it.
+		ensure_equals(count, 1u);
+		ensure_equals(expired.size(), 1u);
+		ensure(!entries[1].armed());
+		ensure(entries[2].armed());
+		ensure(entries[0].armed());
+		ensure_equals(wheel.size(), 2u);
+
+		ensure_equals(wheel.expire(1010, onExpired, this), 1u);
+		ensure(expired.back() == &entries[2]);
+		ensure_equals(wheel.expire(1020, onExpired, this), 1u);
+		ensure(expired.back() == &entries[0]);
+		ensure(wheel.empty());
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("Many timers");
+		// Models 100k idle clients whose timeouts are re-armed whenever
+		// they send data.
+		const unsigned int count = 100000;
+		const unsigned int rounds = 10;
+		vector<TimerWheelEntry> timers(count);
+
+		for (unsigned int i = 0; i < count; i++) {
+			wheel.arm(&timers[i], 1000 + 60 + i % 30);
+		}
+		for (unsigned int round = 0; round < rounds; round++) {
+			for (unsigned int i = 0; i < count; i++) {
+				wheel.arm(&timers[i], 1000 + round + 60 + i % 30);
+			}
+			expire(1000 + round + 0.5);
+		}
+		ensure_equals(wheel.size(), count);
+		ensure_equals(expire(1000 + rounds + 58), 0u);
+		ensure_equals(expire(1000 + rounds + 90), count);
+		ensure(wheel.empty());
+	}
+}
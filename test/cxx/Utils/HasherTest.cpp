@@ -0,0 +1,213 @@
+#include <TestSupport.h>
+#include <Utils/Hasher.h>
+#include <Utils/StrIntUtils.h>
+#include <DataStructures/HashedStaticString.h>
+#include <ServerKit/HeaderTable.h>
+#include <boost/cstdint.hpp>
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	struct HasherTest {
+		HasherTest() {
+			srand(1234);
+		}
+
+		template<typename H>
+		static boost::uint32_t hash(const StaticString &data) {
+			H h;
+			h.update(data.data(), data.size());
+			return h.finalize();
+		}
+
+		static string randomString(unsigned int size) {
+			string result;
+			result.reserve(size);
+			for (unsigned int i = 0; i < size; i++) {
+				result.append(1, (char) (rand() & 0xff));
+			}
+			return result;
+		}
+
+		/**
+		 * Checks that flipping any single input bit flips every output bit
+		 * with a probability of about 50%. Returns the largest deviation
+		 * from 50% that was found.
+		 */
+		static double measureAvalanche(unsigned int size, unsigned int samples) {
+			vector<unsigned int> flips(size * 8 * 32, 0);
+			double worst = 0;
+
+			for (unsigned int i = 0; i < samples; i++) {
+				string input = randomString(size);
+				boost::uint32_t h = hash<Hasher>(input);
+				for (unsigned int bit = 0; bit < size * 8; bit++) {
+					input[bit / 8] ^= (char) (1 << (bit % 8));
+					boost::uint32_t diff = h ^ hash<Hasher>(input);
+					input[bit / 8] ^= (char) (1 << (bit % 8));
+					for (unsigned int j = 0; j < 32; j++) {
+						if (diff & (1u << j)) {
+							flips[bit * 32 + j]++;
+						}
+					}
+				}
+			}
+
+			for (unsigned int i = 0; i < flips.size(); i++) {
+				double deviation = (double) flips[i] / samples - 0.5;
+				if (deviation < 0) {
+					deviation = -deviation;
+				}
+				worst = std::max(worst, deviation);
+			}
+			return worst;
+		}
+
+		/**
+		 * Fills a HeaderTable like the request header parser does, and looks
+		 * headers up like the Core does, both including the hashing of names.
+		 * Returns the number of lookups that found a header.
+		 */
+		template<typename H>
+		static unsigned int fillAndLookUpHeaderTable() {
+			static const char *names[] = {
+				"host", "user-agent", "accept", "accept-language", "accept-encoding",
+				"referer", "cookie", "connection", "upgrade-insecure-requests",
+				"cache-control", "x-forwarded-for", "x-forwarded-proto",
+				"if-none-match", "if-modified-since"
+			};
+			static const char *lookups[] = {
+				"host", "cookie", "content-type", "content-length", "expect",
+				"transfer-encoding", "accept-encoding", "x-sendfile"
+			};
+			const unsigned int nnames = sizeof(names) / sizeof(const char *);
+			const unsigned int nlookups = sizeof(lookups) / sizeof(const char *);
+			psg_pool_t *pool = psg_create_pool(PSG_DEFAULT_POOL_SIZE);
+			ServerKit::HeaderTable table(16);
+			unsigned int i, found = 0;
+
+			for (i = 0; i < nnames; i++) {
+				ServerKit::Header *header = (ServerKit::Header *)
+					psg_palloc(pool, sizeof(ServerKit::Header));
+				psg_lstr_init(&header->key);
+				psg_lstr_init(&header->origKey);
+				psg_lstr_init(&header->val);
+				psg_lstr_append(&header->key, pool, names[i]);
+				psg_lstr_append(&header->origKey, pool, names[i]);
+				psg_lstr_append(&header->val, pool, "value");
+				header->hash = hash<H>(names[i]);
+				table.insert(&header, pool);
+			}
+			for (i = 0; i < nlookups; i++) {
+				StaticString name(lookups[i]);
+				HashedStaticString key(name.data(), name.size(), hash<H>(name));
+				found += table.lookup(key) != NULL;
+			}
+
+			psg_destroy_pool(pool);
+			return found;
+		}
+	};
+
+	DEFINE_TEST_GROUP(HasherTest);
+
+	TEST_METHOD(1) {
+		set_test_name("It produces the MurmurHash3 reference values");
+		ensure_equals(hash<Hasher>(""), 0u);
+		ensure_equals(hash<Hasher>("a"), 0x3c2569b2u);
+		ensure_equals(hash<Hasher>("abc"), 0xb3dd93fau);
+		ensure_equals(hash<Hasher>("hello"), 0x248bfa47u);
+		ensure_equals(hash<Hasher>("The quick brown fox jumps over the lazy dog"),
+			0x2e4ff723u);
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("The empty string hashes to EMPTY_STRING_HASH");
+		boost::uint32_t expected = Hasher::EMPTY_STRING_HASH;
+		ensure_equals(hash<Hasher>(""), expected);
+		ensure_equals(HashedStaticString().hash(), expected);
+		ensure_equals(HashedStaticString("").hash(), expected);
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("The result doesn't depend on how the input is split over update() calls");
+		for (unsigned int size = 0; size <= 40; size++) {
+			string input = randomString(size);
+			boost::uint32_t expected = hash<Hasher>(input);
+
+			for (unsigned int i = 0; i <= size; i++) {
+				for (unsigned int j = i; j <= size; j++) {
+					Hasher h;
+					h.update(input.data(), i);
+					h.update(input.data() + i, j - i);
+					h.update(input.data() + j, size - j);
+					string message = "Split in three at " + toString(i) + " and "
+						+ toString(j) + " of " + toString(size);
+					ensure_equals(message.c_str(), h.finalize(), expected);
+				}
+			}
+
+			Hasher h;
+			for (unsigned int i = 0; i < size; i++) {
+				h.update(input.data() + i, 1);
+			}
+			ensure_equals("Byte by byte", h.finalize(), expected);
+		}
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("reset() allows reusing the hasher");
+		Hasher h;
+		h.update("hello world", 11);
+		h.reset();
+		h.update("hel", 3);
+		h.update("lo", 2);
+		ensure_equals(h.finalize(), hash<Hasher>("hello"));
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Every input bit affects every output bit");
+		ensure("Short keys", measureAvalanche(5, 2000) < 0.1);
+		ensure("Header name sized keys", measureAvalanche(16, 1000) < 0.1);
+	}
+
+	TEST_METHOD(6) {
+		set_test_name("Similar keys are spread evenly over the low bits,"
+			" which are what the hash tables use");
+		const unsigned int count = 20000;
+		const unsigned int buckets = 1024;
+		vector<unsigned int> load(buckets, 0);
+		set<boost::uint32_t> hashes;
+		unsigned int maxLoad = 0;
+
+		for (unsigned int i = 0; i < count; i++) {
+			boost::uint32_t h;
+			if (i % 2 == 0) {
+				h = hash<Hasher>("x-header-" + toString(i));
+			} else {
+				h = hash<Hasher>("/assets/application-" + toString(i) + ".css");
+			}
+			hashes.insert(h);
+			load[h & (buckets - 1)]++;
+		}
+		for (unsigned int i = 0; i < buckets; i++) {
+			maxLoad = std::max(maxLoad, load[i]);
+		}
+
+		ensure_equals("No collisions", hashes.size(), (size_t) count);
+		// The average load is about 20.
+		ensure("The fullest bucket isn't much fuller than average (" +
+			toString(maxLoad) + ")", maxLoad < 45);
+	}
+
+	TEST_METHOD(7) {
+		set_test_name("HeaderTable finds the same headers with Hasher as with JenkinsHash");
+		ensure_equals(fillAndLookUpHeaderTable<Hasher>(), 3u);
+		ensure_equals(fillAndLookUpHeaderTable<JenkinsHash>(), 3u);
+	}
+}
@@ -0,0 +1,125 @@
+#include <TestSupport.h>
+#include <Utils/MetricsRegistry.h>
+#include <Utils/StrIntUtils.h>
+#include <boost/bind.hpp>
+#include <oxt/thread.hpp>
+
+using namespace Passenger;
+using namespace std;
+
+namespace tut {
+	static const MetricsRegistry::Family TEST_REQUESTS = {
+		"test_requests", MetricsRegistry::COUNTER, "Number of requests."
+	};
+	static const MetricsRegistry::Family TEST_SESSIONS = {
+		"test_sessions", MetricsRegistry::GAUGE, "Number of sessions."
+	};
+
+	struct MetricsRegistryTest {
+		MetricsRegistry registry;
+		boost::atomic<bool> stop;
+
+		MetricsRegistryTest() {
+			stop.store(false);
+		}
+
+		void publishContinuously(MetricsRegistry::Publisher *publisher) {
+			unsigned int generation = 0;
+			while (!stop.load()) {
+				generation++;
+				for (unsigned int i = 0; i < 20; i++) {
+					publisher->add(TEST_SESSIONS, "i=\"" + toString(i) + "\"",
+						generation);
+				}
+				publisher->publish();
+			}
+		}
+	};
+
+	DEFINE_TEST_GROUP(MetricsRegistryTest);
+
+	TEST_METHOD(1) {
+		set_test_name("An empty registry renders only the EOF marker");
+		ensure_equals(registry.render(), "# EOF\n");
+		registry.createPublisher();
+		ensure_equals(registry.render(), "# EOF\n");
+	}
+
+	TEST_METHOD(2) {
+		set_test_name("Samples are grouped by family across publishers");
+		MetricsRegistry::Publisher *pool = registry.createPublisher();
+		MetricsRegistry::Publisher *thread = registry.createPublisher();
+
+		pool->add(TEST_SESSIONS, "app=\"foo\"", 3);
+		pool->add(TEST_REQUESTS, "app=\"foo\"", 10);
+		pool->add(TEST_SESSIONS, "app=\"bar\"", 0.5);
+		ensure(pool->publish());
+		thread->add(TEST_REQUESTS, 12345678901ull);
+		ensure(thread->publish());
+
+		ensure_equals(registry.render(),
+			"# TYPE test_sessions gauge\n"
+			"# HELP test_sessions Number of sessions.\n"
+			"test_sessions{app=\"foo\"} 3\n"
+			"test_sessions{app=\"bar\"} 0.5\n"
+			"# TYPE test_requests counter\n"
+			"# HELP test_requests Number of requests.\n"
+			"test_requests_total{app=\"foo\"} 10\n"
+			"test_requests_total 12345678901\n"
+			"# EOF\n");
+	}
+
+	TEST_METHOD(3) {
+		set_test_name("Samples only become visible once published,"
+			" and replace the previous snapshot");
+		MetricsRegistry::Publisher *publisher = registry.createPublisher();
+
+		publisher->add(TEST_SESSIONS, 1);
+		ensure_equals(registry.render(), "# EOF\n");
+		publisher->publish();
+		ensure(containsSubstring(registry.render(), "test_sessions 1\n"));
+
+		publisher->add(TEST_SESSIONS, 2);
+		publisher->publish();
+		string output = registry.render();
+		ensure(!containsSubstring(output, "test_sessions 1\n"));
+		ensure(containsSubstring(output, "test_sessions 2\n"));
+
+		publisher->publish();
+		ensure_equals("Empty snapshots can be published",
+			registry.render(), "# EOF\n");
+	}
+
+	TEST_METHOD(4) {
+		set_test_name("appendLabel() escapes label values");
+		string labels;
+		MetricsRegistry::appendLabel(labels, "app", "/srv/app (production)");
+		ensure_equals(labels, "app=\"/srv/app (production)\"");
+		MetricsRegistry::appendLabel(labels, "x", "a\"b\\c\nd");
+		ensure_equals(labels, "app=\"/srv/app (production)\",x=\"a\\\"b\\\\c\\nd\"");
+	}
+
+	TEST_METHOD(5) {
+		set_test_name("Readers never see partially published snapshots");
+		MetricsRegistry::Publisher *publisher = registry.createPublisher();
+		oxt::thread thr(boost::bind(&MetricsRegistryTest::publishContinuously,
+			this, publisher));
+
+		for (unsigned int i = 0; i < 2000; i++) {
+			vector<string> lines;
+			split(registry.render(), '\n', lines);
+			if (lines.size() == 2) {
+				// Nothing published yet.
+				continue;
+			}
+			ensure_equals(lines.size(), 2u + 20u + 2u);
+			string value = lines[2].substr(lines[2].find(' ') + 1);
+			for (unsigned int j = 3; j < 22; j++) {
+				ensure_equals(lines[j].substr(lines[j].find(' ') + 1), value);
+			}
+		}
+
+		stop.store(true);
+		thr.join();
+	}
+}